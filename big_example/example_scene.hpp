@@ -17,11 +17,11 @@ class ExampleScene : public raygun::Scene {
     static constexpr raygun::vec3 CAMERA_OFFSET = {5.0f, 10.0f, 10.0f};
     static constexpr int NUM_OBSTACLES = 40;
 
-    std::shared_ptr<Ball> m_ball;
+    raygun::EntityPtr<Ball> m_ball;
     std::unique_ptr<Obstacles> m_obstacles;
 
     std::unique_ptr<raygun::ui::Factory> m_uiFactory;
-    std::shared_ptr<raygun::ui::Window> m_menu;
+    raygun::EntityPtr<raygun::ui::Window> m_menu;
 
     void showMenu();
 };
@@ -32,7 +32,7 @@ void Obstacles::createRandomObstacle(raygun::Entity* parent, int index)
     RAYGUN_INFO("Obstacles: Creating random {} at index {}", name, index);
     
     // Create entity
-    auto entity = std::make_shared<Entity>(name + "_" + std::to_string(index));
+    auto entity = makeEntity(name + "_" + std::to_string(index));
     
     // Create and assign random material
     auto material = createRandomMaterial();
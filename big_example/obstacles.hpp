@@ -24,5 +24,5 @@ private:
     std::shared_ptr<raygun::Material> createRandomMaterial();
 
     std::mt19937 m_generator;
-    std::vector<std::shared_ptr<raygun::Entity>> m_obstacles;
+    std::vector<raygun::EntityPtr<>> m_obstacles;
 };
\ No newline at end of file
@@ -7,7 +7,7 @@ using namespace raygun;
 using namespace raygun::physics;
 using namespace physx;
 
-Ball::Ball() : Entity("Ball", RG().resourceManager().entityLoadPath("ball")), m_bumpSound(RG().resourceManager().loadSound("bonk"))
+Ball::Ball() : Entity("Ball", RG().resourceManager().importEntity("ball")), m_bumpSound(RG().resourceManager().loadSound("bonk"))
 {
     RAYGUN_INFO("Ball: Creating ball entity");
     
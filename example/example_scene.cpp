@@ -10,9 +10,18 @@ ExampleScene::ExampleScene()
 {
     RAYGUN_INFO("ExampleScene: Creating scene");
     
+    // start loading resources in the background, decoding overlaps with
+    // scene construction
+    ResourceManifest manifest;
+    manifest.entities = {"room"};
+    manifest.sounds = {"lone_rider", "bonk"};
+    manifest.fonts = {"NotoSans"};
+
+    const auto resources = RG().resourceManager().loadAll(manifest);
+
     // setup level
     RAYGUN_INFO("ExampleScene: Loading level entity 'room'");
-    auto level = RG().resourceManager().loadEntity("room");
+    auto level = resources.entities.at("room").get();
     
     RAYGUN_INFO("ExampleScene: Setting up physics for level objects");
     level->forEachEntity([](Entity& entity) {
@@ -22,12 +31,15 @@ ExampleScene::ExampleScene()
         }
     });
     
+    // level geometry never moves and can be merged on scene load
+    level->setMobility(Mobility::Static);
+
     RAYGUN_INFO("ExampleScene: Adding level to scene root");
     root->addChild(level);
 
     // setup ball
     RAYGUN_INFO("ExampleScene: Creating ball entity");
-    m_ball = std::make_shared<Ball>();
+    m_ball = makeEntity<Ball>();
     m_ball->moveTo({3.0f, 0.0f, -3.0f});
     
     RAYGUN_INFO("ExampleScene: Adding ball to scene root");
@@ -35,14 +47,14 @@ ExampleScene::ExampleScene()
 
     // setup music
     RAYGUN_INFO("ExampleScene: Loading music track 'lone_rider'");
-    auto musicTrack = RG().resourceManager().loadSound("lone_rider");
+    auto musicTrack = resources.sounds.at("lone_rider").get();
     
     RAYGUN_INFO("ExampleScene: Starting music playback");
     RG().audioSystem().music().play(musicTrack);
 
     // setup ui stuff
     RAYGUN_INFO("ExampleScene: Loading font 'NotoSans'");
-    const auto font = RG().resourceManager().loadFont("NotoSans");
+    const auto font = resources.fonts.at("NotoSans").get();
     
     RAYGUN_INFO("ExampleScene: Creating UI factory");
     m_uiFactory = std::make_unique<ui::Factory>(font);
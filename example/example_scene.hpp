@@ -15,10 +15,10 @@ class ExampleScene : public raygun::Scene {
   private:
     static constexpr raygun::vec3 CAMERA_OFFSET = {5.0f, 10.0f, 10.0f};
 
-    std::shared_ptr<Ball> m_ball;
+    raygun::EntityPtr<Ball> m_ball;
 
     std::unique_ptr<raygun::ui::Factory> m_uiFactory;
-    std::shared_ptr<raygun::ui::Window> m_menu;
+    raygun::EntityPtr<raygun::ui::Window> m_menu;
 
     void showMenu();
 };
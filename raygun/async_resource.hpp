@@ -0,0 +1,92 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#pragma once
+
+namespace raygun {
+
+/// Owning pointer type of a resource, specialized for types with their own
+/// ownership model.
+template<typename T>
+struct ResourcePointer {
+    using Type = std::shared_ptr<T>;
+};
+
+/// Handle to a resource loaded asynchronously by the ResourceManager.
+/// Loading is split into decoding, which runs on a worker thread, and
+/// finalization (e.g. creating GPU or audio objects), which runs once on the
+/// first thread calling get(). ResourceManager::update finalizes decoded
+/// resources on the main thread. Copies share the same resource.
+template<typename T>
+class AsyncResource {
+  public:
+    using Pointer = typename ResourcePointer<T>::Type;
+
+    /// Produced by decoding, creates the final resource.
+    using Finalizer = std::function<Pointer()>;
+
+    AsyncResource() = default;
+
+    /// Wraps an already available resource.
+    explicit AsyncResource(Pointer value) : m_state(std::make_shared<State>())
+    {
+        m_state->value = std::move(value);
+        m_state->finalized = true;
+    }
+
+    explicit AsyncResource(std::shared_future<Finalizer> decoded) : m_state(std::make_shared<State>()) { m_state->decoded = std::move(decoded); }
+
+    bool valid() const { return m_state != nullptr; }
+
+    /// True if get() does not need to wait for decoding.
+    bool ready() const { return finalized() || m_state->decoded.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+
+    bool finalized() const { return m_state->finalized; }
+
+    /// Waits for decoding to complete and finalizes the resource on first
+    /// use.
+    const Pointer& get() const
+    {
+        if(!m_state->finalized) {
+            std::call_once(m_state->once, [&state = *m_state] {
+                state.value = state.decoded.get()();
+                state.finalized = true;
+            });
+        }
+
+        return m_state->value;
+    }
+
+  private:
+    struct State {
+        std::shared_future<Finalizer> decoded;
+        Pointer value;
+
+        std::once_flag once;
+        std::atomic<bool> finalized = false;
+    };
+
+    std::shared_ptr<State> m_state;
+};
+
+} // namespace raygun
@@ -0,0 +1,100 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#include "raygun/atom.hpp"
+
+#include "raygun/logging.hpp"
+
+namespace raygun {
+
+namespace {
+    class AtomTable {
+      public:
+        AtomTable() { intern(""); }
+
+        uint32_t intern(string_view str)
+        {
+            {
+                std::shared_lock lock(m_mutex);
+
+                const auto it = m_ids.find(str);
+                if(it != m_ids.end()) return it->second;
+            }
+
+            std::unique_lock lock(m_mutex);
+
+            const auto it = m_ids.find(str);
+            if(it != m_ids.end()) return it->second;
+
+            const auto id = m_count;
+            if(id == CHUNK_SIZE * MAX_CHUNKS) {
+                RAYGUN_FATAL("Atom table exhausted");
+            }
+
+            auto& chunk = m_chunks[id / CHUNK_SIZE];
+            if(!chunk) {
+                chunk = std::make_unique<Chunk>();
+            }
+
+            // The map refers to the stored string, which never moves.
+            auto& entry = (*chunk)[id % CHUNK_SIZE];
+            entry = str;
+            m_ids.emplace(entry, id);
+
+            ++m_count;
+
+            return id;
+        }
+
+        // No lock required, an id can only be known once its entry has been
+        // published through intern.
+        const string& lookup(uint32_t id) const { return (*m_chunks[id / CHUNK_SIZE])[id % CHUNK_SIZE]; }
+
+      private:
+        static constexpr uint32_t CHUNK_SIZE = 4096;
+        static constexpr uint32_t MAX_CHUNKS = 1024;
+
+        using Chunk = std::array<string, CHUNK_SIZE>;
+
+        std::shared_mutex m_mutex;
+        std::unordered_map<string_view, uint32_t> m_ids;
+        std::array<std::unique_ptr<Chunk>, MAX_CHUNKS> m_chunks;
+        uint32_t m_count = 0;
+    };
+
+    AtomTable& atomTable()
+    {
+        // Intentionally leaked, atoms may be used during static destruction.
+        static auto table = new AtomTable;
+        return *table;
+    }
+} // namespace
+
+Atom::Atom(string_view str) : m_id(str.empty() ? 0 : atomTable().intern(str)) {}
+
+const string& Atom::str() const
+{
+    return atomTable().lookup(m_id);
+}
+
+} // namespace raygun
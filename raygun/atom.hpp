@@ -0,0 +1,80 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#pragma once
+
+namespace raygun {
+
+/// Interned string. Atoms are created from a global, thread-safe table and
+/// represented by a 32-bit id, making copies, comparisons and hashing as cheap
+/// as for integers. Interned strings are never released, avoid creating atoms
+/// from unbounded input.
+class Atom {
+  public:
+    /// The empty string.
+    Atom() = default;
+
+    Atom(string_view str);
+    Atom(const char* str) : Atom(string_view(str)) {}
+    Atom(const string& str) : Atom(string_view(str)) {}
+
+    uint32_t id() const { return m_id; }
+
+    const string& str() const;
+    const char* c_str() const { return str().c_str(); }
+
+    bool empty() const { return m_id == 0; }
+
+    operator string_view() const { return str(); }
+
+    bool operator==(Atom other) const { return m_id == other.m_id; }
+    bool operator!=(Atom other) const { return m_id != other.m_id; }
+
+    /// Orders by id, not lexicographically.
+    bool operator<(Atom other) const { return m_id < other.m_id; }
+
+    // Comparing with strings does not intern them. Defined as hidden friends
+    // so they do not interfere with comparisons between plain strings.
+    friend bool operator==(Atom atom, string_view str) { return atom.str() == str; }
+    friend bool operator==(string_view str, Atom atom) { return atom.str() == str; }
+    friend bool operator==(Atom atom, const char* str) { return atom.str() == str; }
+    friend bool operator==(const char* str, Atom atom) { return atom.str() == str; }
+    friend bool operator==(Atom atom, const string& str) { return atom.str() == str; }
+    friend bool operator==(const string& str, Atom atom) { return atom.str() == str; }
+    friend bool operator!=(Atom atom, string_view str) { return !(atom == str); }
+    friend bool operator!=(string_view str, Atom atom) { return !(atom == str); }
+    friend bool operator!=(Atom atom, const char* str) { return !(atom == str); }
+    friend bool operator!=(const char* str, Atom atom) { return !(atom == str); }
+    friend bool operator!=(Atom atom, const string& str) { return !(atom == str); }
+    friend bool operator!=(const string& str, Atom atom) { return !(atom == str); }
+
+  private:
+    uint32_t m_id = 0;
+};
+
+} // namespace raygun
+
+template<>
+struct std::hash<raygun::Atom> {
+    size_t operator()(raygun::Atom atom) const noexcept { return atom.id(); }
+};
@@ -67,7 +67,20 @@ void AudioSystem::update()
 
     moveListener(scene.camera->transform());
 
-    // Reposition audio sources
+    // Reposition audio sources which moved or got attached.
+    const auto incremental = scene.journal.consume(m_journalCursor, [](const ChangeRecord& record) {
+        if(record.kind != ChangeKind::Added && record.kind != ChangeKind::Transform && record.kind != ChangeKind::AudioAttached) return;
+
+        const auto* entity = Entity::resolve(record.entity);
+        if(!entity) return;
+
+        if(entity->audioSource) {
+            entity->audioSource->move(entity->transform().position);
+        }
+    });
+
+    if(incremental) return;
+
     scene.root->forEachEntity([](const Entity& entity) {
         if(entity.audioSource) {
             entity.audioSource->move(entity.transform().position);
@@ -25,6 +25,7 @@
 #include "raygun/assert.hpp"
 #include "raygun/audio/audio_source.hpp"
 #include "raygun/audio/sound.hpp"
+#include "raygun/change_journal.hpp"
 #include "raygun/logging.hpp"
 #include "raygun/transform.hpp"
 
@@ -56,6 +57,8 @@ class AudioSystem {
     unsigned m_soundEffectsIndex = 0;
     std::array<UniqueSource, 32> m_soundEffects = {};
 
+    ChangeJournal::Cursor m_journalCursor;
+
     void moveListener(const Transform& transform);
 
     void setupMusic();
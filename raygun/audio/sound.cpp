@@ -23,48 +23,82 @@
 #include "raygun/audio/sound.hpp"
 
 #include "raygun/assert.hpp"
+#include "raygun/load_telemetry.hpp"
 #include "raygun/logging.hpp"
 #include "raygun/raygun.hpp"
+#include "raygun/utils/mapped_file.hpp"
 
 namespace raygun::audio {
 
-Sound::Sound(string_view name, const fs::path& path) : m_name(name)
+namespace {
+    DecodedSound decode(string_view name, OggOpusFile* file, int error)
+    {
+        if(error != 0) {
+            RAYGUN_FATAL("Unable to open audio file ({}): {}", error, name);
+        }
+
+        DecodedSound result;
+        result.numChannels = op_channel_count(file, -1);
+        if(result.numChannels > 2) {
+            op_free(file);
+            RAYGUN_FATAL("Invalid sound file with more than 2 channels ({}): {}", result.numChannels, name);
+        }
+
+        const auto numSamplesPerChannel = op_pcm_total(file, -1);
+
+        auto& buf = result.samples;
+        buf.resize(numSamplesPerChannel * result.numChannels);
+        for(size_t readSamples = 0; readSamples < buf.size();) {
+            auto readSamplesPerChannel = op_read(file, buf.data() + readSamples, (int)(buf.size() - readSamples), nullptr);
+            readSamples += readSamplesPerChannel * result.numChannels;
+        }
+
+        op_free(file);
+
+        return result;
+    }
+} // namespace
+
+DecodedSound decodeSound(string_view name, const fs::path& path)
 {
+    // Decoded straight from the mapping instead of through stdio.
+    const io::MappedFile mapping(path, io::Access::Sequential);
+    if(mapping) return decodeSound(name, mapping.data(), mapping.size());
+
     auto error = 0;
     const auto file = op_open_file(path.string().c_str(), &error);
-    if(error != 0) {
-        RAYGUN_FATAL("Unable to open audio file ({}): {}", error, m_name);
-    }
+    return decode(name, file, error);
+}
 
-    const auto numChannels = op_channel_count(file, -1);
-    if(numChannels > 2) {
-        op_free(file);
-        RAYGUN_FATAL("Invalid sound file with more than 2 channels ({}): {}", numChannels, m_name);
-    }
+DecodedSound decodeSound(string_view name, const std::byte* data, size_t size)
+{
+    auto error = 0;
+    const auto file = op_open_memory(reinterpret_cast<const unsigned char*>(data), size, &error);
+    return decode(name, file, error);
+}
 
-    const auto numSamplesPerChannel = op_pcm_total(file, -1);
+Sound::Sound(string_view name, const fs::path& path) : Sound(name, decodeSound(name, path)) {}
 
-    std::vector<opus_int16> buf(numSamplesPerChannel * numChannels);
-    for(size_t readSamples = 0; readSamples < buf.size();) {
-        auto readSamplesPerChannel = op_read(file, buf.data() + readSamples, (int)(buf.size() - readSamples), nullptr);
-        readSamples += readSamplesPerChannel * numChannels;
-    }
+Sound::Sound(string_view name, const DecodedSound& decoded) : m_name(name)
+{
+    const auto& buf = decoded.samples;
+    m_size = buf.size() * sizeof(buf[0]);
 
     alGenBuffers(1, &m_buffer);
     if(RG().audioSystem().getError() != AL_NO_ERROR) {
-        op_free(file);
         RAYGUN_FATAL("Unable to generate audio buffer");
     }
 
-    const auto format = numChannels == 2 ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16;
+    const auto format = decoded.numChannels == 2 ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16;
+
+    {
+        LoadStageTimer timer(LoadStage::Upload);
+        alBufferData(m_buffer, format, buf.data(), (int)m_size, SAMPLE_RATE);
+    }
 
-    alBufferData(m_buffer, format, buf.data(), (int)(buf.size() * sizeof(buf[0])), SAMPLE_RATE);
     if(RG().audioSystem().getError() != AL_NO_ERROR) {
-        op_free(file);
         RAYGUN_FATAL("Unable to fill audio buffer");
     }
-
-    op_free(file);
 }
 
 Sound::~Sound()
@@ -24,22 +24,40 @@
 
 namespace raygun::audio {
 
+/// PCM samples of a decoded sound file.
+struct DecodedSound {
+    int numChannels = 0;
+    std::vector<opus_int16> samples;
+};
+
+/// Decodes the given opus file, does not require the audio system.
+DecodedSound decodeSound(string_view name, const fs::path& path);
+
+/// Same as above, but decodes an opus file held in memory.
+DecodedSound decodeSound(string_view name, const std::byte* data, size_t size);
+
 class Sound {
   public:
     Sound(string_view name, const fs::path& path);
+    Sound(string_view name, const DecodedSound& decoded);
     ~Sound();
 
-    const string& name() const { return m_name; }
+    Atom name() const { return m_name; }
+
+    /// Size of the samples held by the buffer.
+    size_t sizeInBytes() const { return m_size; }
 
     operator ALuint() { return m_buffer; }
 
   private:
     static constexpr auto SAMPLE_RATE = 48000;
 
-    string m_name;
+    Atom m_name;
 
     /// This is the OpenAL buffer object, holding the sound samples.
     ALuint m_buffer;
+
+    size_t m_size = 0;
 };
 
 } // namespace raygun::audio
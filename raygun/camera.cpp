@@ -41,6 +41,7 @@ void Camera::updateProjection()
     }
 
     m_projection = glm::perspective(glm::radians(FOV), aspectRatio, NEAR, FAR);
+    m_projectionScale = (float)std::max(windowSize.height, 1u) / (2.0f * std::tan(glm::radians(FOV) / 2.0f));
 
     // Take GLM's flipped Y coordinate into account.
     m_projection[1][1] *= -1;
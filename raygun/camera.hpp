@@ -35,10 +35,14 @@ class Camera : public Entity {
 
     mat4 projInverse() const { return glm::inverse(m_projection); }
 
+    /// Height in pixels of an object of unit size at unit distance.
+    float projectionScale() const { return m_projectionScale; }
+
     void updateProjection();
 
   private:
     mat4 m_projection = mat4{1.0f};
+    float m_projectionScale = 1.0f;
 
     static constexpr float FOV = 45.f;
     static constexpr float NEAR = 0.1f;
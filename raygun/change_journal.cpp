@@ -0,0 +1,97 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#include "raygun/change_journal.hpp"
+
+#include "raygun/logging.hpp"
+
+namespace raygun {
+
+namespace {
+    std::atomic<uint32_t> nextJournalId = 1;
+}
+
+ChangeJournal::ChangeJournal() : m_id(nextJournalId++) {}
+
+ChangeJournal::Sequence ChangeJournal::record(EntityHandle entity, ChangeKind kind, Sequence pending)
+{
+    if(pending != NO_RECORD && isUnread(pending)) {
+        return pending;
+    }
+
+    m_records.push_back({entity, kind});
+    return head() - 1;
+}
+
+void ChangeJournal::compact()
+{
+    auto readByAll = head();
+
+    for(auto& subscriber: m_subscribers) {
+        if(subscriber.position == NO_RECORD) continue;
+
+        if(++subscriber.idleCompactions > MAX_IDLE_COMPACTIONS) {
+            subscriber.position = NO_RECORD;
+            continue;
+        }
+
+        readByAll = std::min(readByAll, subscriber.position);
+    }
+
+    // Protect against a subscriber falling behind indefinitely, it has to
+    // resync instead.
+    if(head() - readByAll > MAX_RECORDS) {
+        RAYGUN_WARN("Change journal exceeded {} records, forcing resync", MAX_RECORDS);
+        readByAll = head();
+    }
+
+    if(readByAll == m_base) return;
+
+    m_records.erase(m_records.begin(), m_records.begin() + (ptrdiff_t)(readByAll - m_base));
+    m_base = readByAll;
+}
+
+ChangeJournal::Cursor ChangeJournal::subscribe()
+{
+    Cursor cursor;
+    cursor.journalId = m_id;
+    cursor.subscriber = (uint32_t)m_subscribers.size();
+
+    auto& subscriber = m_subscribers.emplace_back();
+    subscriber.position = head();
+
+    return cursor;
+}
+
+bool ChangeJournal::isUnread(Sequence seq) const
+{
+    if(seq < m_base || seq >= head()) return false;
+
+    for(const auto& subscriber: m_subscribers) {
+        if(subscriber.position != NO_RECORD && subscriber.position > seq) return false;
+    }
+
+    return true;
+}
+
+} // namespace raygun
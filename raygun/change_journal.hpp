@@ -0,0 +1,170 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#pragma once
+
+namespace raygun {
+
+class Entity;
+
+/// Stable, generation-checked reference to an Entity. Handles of destroyed
+/// entities never resolve, even when their slot is reused.
+struct EntityHandle {
+    uint32_t index = 0;
+    uint32_t generation = 0;
+
+    bool operator==(const EntityHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const EntityHandle& other) const { return !(*this == other); }
+};
+
+enum class ChangeKind : uint8_t {
+    Added,
+    Removed,
+    Reparented,
+
+    /// Local transform changed, affects the global transform of the whole
+    /// subtree.
+    Transform,
+
+    Model,
+
+    /// Instance array assigned or removed.
+    InstanceArray,
+
+    /// Affects the whole subtree.
+    Visibility,
+
+    /// Effective mobility changed, affects the whole subtree.
+    Mobility,
+
+    PhysicsAttached,
+    PhysicsDetached,
+    AudioAttached,
+    AudioDetached,
+};
+
+struct ChangeRecord {
+    EntityHandle entity;
+    ChangeKind kind;
+};
+
+/// Append-only log of structural and component changes of a scene. Systems
+/// subscribe with a Cursor and only process the records appended since their
+/// last visit instead of walking the whole entity tree every frame.
+class ChangeJournal {
+  public:
+    /// Sequence number of a record within the journal.
+    using Sequence = uint64_t;
+
+    static constexpr Sequence NO_RECORD = ~Sequence(0);
+
+    /// Per-subscriber read position. A default constructed cursor is not
+    /// subscribed to any journal and triggers a resync on first use.
+    struct Cursor {
+        uint32_t journalId = 0;
+        uint32_t subscriber = 0;
+    };
+
+    ChangeJournal();
+
+    ChangeJournal(const ChangeJournal&) = delete;
+    ChangeJournal& operator=(const ChangeJournal&) = delete;
+
+    /// Appends a record and returns its sequence number. If pending refers to a
+    /// record which none of the subscribers have read yet, it is returned
+    /// instead and nothing is appended.
+    Sequence record(EntityHandle entity, ChangeKind kind, Sequence pending = NO_RECORD);
+
+    /// Calls f for every record appended since the cursor's last visit.
+    /// Returns false if the cursor cannot be served incrementally (first use,
+    /// different journal, or records already discarded), in which case the
+    /// caller must resync from the scene directly. Either way the cursor is
+    /// positioned at the end of the journal afterwards.
+    template<typename Fun>
+    bool consume(Cursor& cursor, Fun f)
+    {
+        if(cursor.journalId != m_id) {
+            cursor = subscribe();
+            return false;
+        }
+
+        auto& subscriber = m_subscribers[cursor.subscriber];
+        subscriber.idleCompactions = 0;
+
+        if(subscriber.position == NO_RECORD || subscriber.position < m_base) {
+            subscriber.position = head();
+            return false;
+        }
+
+        // f may append new records, these are picked up on the next visit.
+        const auto end = head();
+        for(auto seq = subscriber.position; seq < end; ++seq) {
+            const auto record = m_records[seq - m_base];
+            f(record);
+        }
+
+        subscriber.position = end;
+        return true;
+    }
+
+    /// Discards records all active subscribers have read. Subscribers which
+    /// did not consume for a while are deactivated and resync when they come
+    /// back.
+    void compact();
+
+    Sequence head() const { return m_base + m_records.size(); }
+
+    /// Set once the scene has been loaded, from then on static entities of
+    /// the scene no longer move.
+    void setSceneLoaded() { m_sceneLoaded = true; }
+    bool sceneLoaded() const { return m_sceneLoaded; }
+
+  private:
+    static constexpr uint32_t MAX_IDLE_COMPACTIONS = 8;
+    static constexpr size_t MAX_RECORDS = 1 << 20;
+
+    struct Subscriber {
+        Sequence position = 0;
+        uint32_t idleCompactions = 0;
+    };
+
+    Cursor subscribe();
+
+    bool isUnread(Sequence seq) const;
+
+    uint32_t m_id;
+
+    Sequence m_base = 0;
+    std::vector<ChangeRecord> m_records;
+
+    std::vector<Subscriber> m_subscribers;
+
+    bool m_sceneLoaded = false;
+};
+
+} // namespace raygun
+
+template<>
+struct std::hash<raygun::EntityHandle> {
+    size_t operator()(const raygun::EntityHandle& handle) const noexcept { return ((size_t)handle.generation << 32) | handle.index; }
+};
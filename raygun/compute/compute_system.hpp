@@ -37,6 +37,8 @@ class ComputePass {
   public:
     void dispatch(vk::CommandBuffer& cmd, uint32_t width, uint32_t height = 1, uint32_t depth = 1);
 
+    Atom shaderName() const { return computeShader->name; }
+
   private:
     ComputePass(string_view name);
 
@@ -134,4 +134,18 @@ fs::path configDirectory()
     return path;
 }
 
+fs::path cacheDirectory()
+{
+    const fs::path path{"cache"};
+
+    std::error_code err;
+    fs::create_directories(path, err);
+    if(err) {
+        RAYGUN_WARN("Unable to create cache directory, using working directory");
+        return fs::current_path();
+    }
+
+    return path;
+}
+
 } // namespace raygun
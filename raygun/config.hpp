@@ -63,4 +63,7 @@ using UniqueConfig = std::unique_ptr<Config>;
 
 fs::path configDirectory();
 
+/// Directory for derived data which can be regenerated, e.g. converted meshes.
+fs::path cacheDirectory();
+
 } // namespace raygun
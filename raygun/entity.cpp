@@ -24,104 +24,167 @@
 
 #include "raygun/logging.hpp"
 #include "raygun/raygun.hpp"
-#include "raygun/utils/assimp_utils.hpp"
+#include "raygun/render/model_import.hpp"
 
 namespace raygun {
 
 namespace {
-    std::shared_ptr<render::Mesh> loadMesh(const aiMesh& aimesh)
-    {
-        auto result = std::make_shared<render::Mesh>();
+    /// Maps entity handles to entities, slots are recycled with an increased
+    /// generation so stale handles do not resolve.
+    class HandleRegistry {
+      public:
+        EntityHandle acquire(Entity& entity)
+        {
+            std::lock_guard lock(m_mutex);
+
+            uint32_t index;
+            if(m_freeSlots.empty()) {
+                index = (uint32_t)m_slots.size();
+                m_slots.emplace_back();
+            }
+            else {
+                index = m_freeSlots.back();
+                m_freeSlots.pop_back();
+            }
 
-        result->vertices.reserve(aimesh.mNumVertices);
-        for(auto i = 0u; i < aimesh.mNumVertices; ++i) {
-            const auto& position = aimesh.mVertices[i];
-            const auto& normal = aimesh.mNormals[i];
+            auto& slot = m_slots[index];
+            slot.entity = &entity;
 
-            auto& vertex = result->vertices.emplace_back();
-            vertex.position = {position.x, position.y, position.z};
-            vertex.normal = {normal.x, normal.y, normal.z};
-            vertex.matIndex = aimesh.mMaterialIndex;
+            return {index, slot.generation};
         }
 
-        result->indices.reserve((size_t)aimesh.mNumFaces * 3);
-        for(auto i = 0u; i < aimesh.mNumFaces; ++i) {
-            const auto& face = aimesh.mFaces[i];
+        void release(EntityHandle handle)
+        {
+            std::lock_guard lock(m_mutex);
 
-            if(face.mNumIndices != 3) {
-                RAYGUN_WARN("Face {} of mesh {} has {} vertices, skipping", i, aimesh.mName.C_Str(), face.mNumIndices);
-                continue;
-            }
+            auto& slot = m_slots[handle.index];
+            slot.entity = nullptr;
+            ++slot.generation;
 
-            result->indices.push_back(face.mIndices[0]);
-            result->indices.push_back(face.mIndices[1]);
-            result->indices.push_back(face.mIndices[2]);
+            m_freeSlots.push_back(handle.index);
         }
 
-        RAYGUN_DEBUG("Loaded Mesh: {}: {} vertices", aimesh.mName.C_Str(), result->vertices.size());
+        Entity* resolve(EntityHandle handle)
+        {
+            std::lock_guard lock(m_mutex);
 
-        return result;
-    }
-
-    std::shared_ptr<render::Mesh> collapseMeshes(const aiScene* aiscene, const aiNode* ainode)
-    {
-        auto result = std::make_shared<render::Mesh>();
+            if(handle.index >= m_slots.size()) return nullptr;
 
-        for(auto i = 0u; i < ainode->mNumMeshes; ++i) {
-            const auto mesh = loadMesh(*aiscene->mMeshes[ainode->mMeshes[i]]);
-            result->merge(*mesh);
+            const auto& slot = m_slots[handle.index];
+            return slot.generation == handle.generation ? slot.entity : nullptr;
         }
 
-        for(auto i = 0u; i < ainode->mNumChildren; ++i) {
-            const auto childMesh = collapseMeshes(aiscene, ainode->mChildren[i]);
-            result->merge(*childMesh);
-        }
+      private:
+        struct Slot {
+            Entity* entity = nullptr;
+            uint32_t generation = 1;
+        };
 
-        return result;
+        std::mutex m_mutex;
+        std::vector<Slot> m_slots;
+        std::vector<uint32_t> m_freeSlots;
+    };
+
+    HandleRegistry& handleRegistry()
+    {
+        static HandleRegistry registry;
+        return registry;
     }
 } // namespace
 
-Entity::Entity(string_view name) : name(name) {}
+Entity::Entity(string_view name) : name(name), m_handle(handleRegistry().acquire(*this)) {}
 
-Entity::Entity(string_view name, fs::path filepath, bool loadMaterials) : Entity(name)
+Entity::~Entity()
 {
-    Assimp::Importer importer;
+    // Children may outlive this entity.
+    for(const auto& child: m_children) {
+        child->clearParent();
+    }
 
-    const auto aiscene = importer.ReadFile(filepath.string(), aiProcess_Triangulate);
-    if(!aiscene) {
-        RAYGUN_ERROR("Unable to load: {}: {}", name, importer.GetErrorString());
-        return;
+    handleRegistry().release(m_handle);
+}
+
+void intrusiveRelease(const Entity* entity)
+{
+    RAYGUN_ASSERT(entity->m_refCount > 0);
+    if(--entity->m_refCount > 0) return;
+
+    auto* owned = const_cast<Entity*>(entity);
+    if(owned->m_destroy) {
+        owned->m_destroy(owned);
     }
+    else {
+        delete owned;
+    }
+}
 
-    std::vector<std::shared_ptr<Material>> materials;
-    if(loadMaterials) {
-        materials.reserve(aiscene->mNumMaterials);
+Entity* Entity::resolve(EntityHandle handle)
+{
+    return handleRegistry().resolve(handle);
+}
 
-        for(auto i = 0u; i < aiscene->mNumMaterials; ++i) {
-            const auto aimaterial = aiscene->mMaterials[i];
+void Entity::setMobility(Mobility mobility)
+{
+    forEachEntity([mobility](Entity& entity) { entity.m_mobility = mobility; });
 
-            aiString matName;
-            aimaterial->Get(AI_MATKEY_NAME, matName);
-            materials.push_back(RG().resourceManager().loadMaterial(matName.C_Str()));
-        }
+    const auto previous = m_effectiveMobility;
+    updateEffectiveMobility();
+
+    if(m_effectiveMobility != previous) {
+        recordChange(ChangeKind::Mobility);
     }
+}
 
-    for(auto i = 0u; i < aiscene->mRootNode->mNumChildren; ++i) {
-        const auto ainode = aiscene->mRootNode->mChildren[i];
+void Entity::setVisible(bool visible)
+{
+    if(m_visible == visible) return;
+
+    m_visible = visible;
+    recordChange(ChangeKind::Visibility);
+}
+
+Entity::Entity(string_view name, fs::path filepath, bool loadMaterials) : Entity(name)
+{
+    const auto imported = render::importModel(filepath);
+    if(!imported) return;
+
+    addImportedNodes(*imported, loadMaterials);
+}
+
+Entity::Entity(string_view name, const render::ImportedModel& imported, bool loadMaterials) : Entity(name)
+{
+    addImportedNodes(imported, loadMaterials);
+}
+
+void Entity::addImportedNodes(const render::ImportedModel& imported, bool loadMaterials)
+{
+    std::vector<std::shared_ptr<Material>> materials;
+    if(loadMaterials) {
+        materials = RG().resourceManager().loadMaterials(imported);
+    }
+
+    for(uint32_t i = 0; i < imported.nodes.size(); ++i) {
+        const auto& node = imported.nodes[i];
 
         auto childModel = std::make_shared<render::Model>();
-        childModel->mesh = collapseMeshes(aiscene, ainode);
+        childModel->mesh = node.mesh;
         childModel->materials = materials;
+        childModel->sourcePath = imported.sourcePath;
+        childModel->sourceNode = i;
+
+        if(!node.lods.empty()) {
+            childModel->setLods(node.lods);
+        }
 
         RG().resourceManager().registerModel(childModel);
 
-        auto child = emplaceChild(ainode->mName.C_Str());
-        child->setTransform(utils::toTransform(ainode->mTransformation));
+        auto child = emplaceChild(node.name);
+        child->setTransform(node.transform);
         child->model = childModel;
     }
 }
 
-void Entity::addChild(std::shared_ptr<Entity> child)
+void Entity::addChild(EntityPtr<> child)
 {
     RAYGUN_ASSERT(!child->m_parent);
     child->setParent(this);
@@ -129,15 +192,15 @@ void Entity::addChild(std::shared_ptr<Entity> child)
     m_children.push_back(child);
 }
 
-std::shared_ptr<raygun::Entity> Entity::emplaceChild(string_view childName)
+EntityPtr<> Entity::emplaceChild(string_view childName)
 {
-    auto child = std::make_shared<Entity>(childName);
+    auto child = makeEntity(childName);
     child->setParent(this);
 
     return m_children.emplace_back(child);
 }
 
-void Entity::replaceChild(const std::shared_ptr<Entity>& oldChild, std::shared_ptr<Entity> newChild)
+void Entity::replaceChild(const EntityPtr<>& oldChild, EntityPtr<> newChild)
 {
     RAYGUN_ASSERT(oldChild->m_parent == this);
 
@@ -153,7 +216,7 @@ void Entity::replaceChild(const std::shared_ptr<Entity>& oldChild, std::shared_p
     *it = newChild;
 }
 
-void Entity::removeChild(const std::shared_ptr<Entity>& child)
+void Entity::removeChild(const EntityPtr<>& child)
 {
     RAYGUN_ASSERT(child->m_parent == this);
 
@@ -177,11 +240,41 @@ void Entity::clearChildren()
     m_children.clear();
 }
 
+void Entity::moveChild(const EntityPtr<>& child, Entity& newParent)
+{
+    RAYGUN_ASSERT(child->m_parent == this);
+
+    for(const Entity* ancestor = &newParent; ancestor; ancestor = ancestor->m_parent) {
+        RAYGUN_ASSERT(ancestor != child.get());
+    }
+
+    auto it = std::find(m_children.cbegin(), m_children.cend(), child);
+    if(it == m_children.cend()) {
+        RAYGUN_WARN("Supposed to move entity {} from {}, but not found.", child->name, name);
+        return;
+    }
+
+    // child may refer to the element we are about to erase.
+    auto movedChild = child;
+    m_children.erase(it);
+
+    const auto sameScene = m_journal && m_journal == newParent.m_journal;
+
+    movedChild->setParent(&newParent);
+    newParent.m_children.push_back(movedChild);
+
+    if(sameScene) {
+        movedChild->recordChange(ChangeKind::Reparented);
+    }
+}
+
 void Entity::setTransform(Transform transform)
 {
+    if(rejectMove()) return;
+
     invalidateChildrenCachedParentTransform();
     m_transform = transform;
-    updatePhysicsTransform();
+    onTransformChanged();
 }
 
 Transform Entity::parentTransform() const
@@ -200,64 +293,112 @@ Transform Entity::globalTransform() const
 
 void Entity::move(const vec3& translation)
 {
+    if(rejectMove()) return;
+
     invalidateChildrenCachedParentTransform();
     m_transform.move(translation);
-    updatePhysicsTransform();
+    onTransformChanged();
 }
 
 void Entity::moveTo(const vec3& position)
 {
+    if(rejectMove()) return;
+
     invalidateChildrenCachedParentTransform();
     m_transform.position = position;
-    updatePhysicsTransform();
+    onTransformChanged();
 }
 
 void Entity::rotate(float angle, vec3 axis)
 {
+    if(rejectMove()) return;
+
     invalidateChildrenCachedParentTransform();
     m_transform.rotate(angle, axis);
-    updatePhysicsTransform();
+    onTransformChanged();
 }
 
 void Entity::rotate(vec3 rotation)
 {
+    if(rejectMove()) return;
+
     invalidateChildrenCachedParentTransform();
     m_transform.rotate(rotation);
-    updatePhysicsTransform();
+    onTransformChanged();
 }
 
 void Entity::rotateAround(vec3 pivot, vec3 rotation)
 {
+    if(rejectMove()) return;
+
     invalidateChildrenCachedParentTransform();
     m_transform.rotateAround(pivot, rotation);
-    updatePhysicsTransform();
+    onTransformChanged();
 }
 
 void Entity::lookAt(const vec3& target)
 {
+    if(rejectMove()) return;
+
     invalidateChildrenCachedParentTransform();
     m_transform.lookAt(target);
-    updatePhysicsTransform();
+    onTransformChanged();
 }
 
 void Entity::scale(vec3 s)
 {
+    if(rejectMove()) return;
+
     invalidateChildrenCachedParentTransform();
     m_transform.scale(s);
-    updatePhysicsTransform();
+    onTransformChanged();
 }
 
 void Entity::scale(float s)
 {
+    if(rejectMove()) return;
+
     invalidateChildrenCachedParentTransform();
     m_transform.scale(s);
-    updatePhysicsTransform();
+    onTransformChanged();
 }
 
 void Entity::setParent(const Entity* parent)
 {
     invalidateCachedParentTransform();
     m_parent = parent;
+
+    updateEffectiveMobility();
+    setJournal(parent ? parent->m_journal : nullptr);
+}
+
+void Entity::setJournal(ChangeJournal* journal)
+{
+    // Invariant: All entities of a subtree share the same journal.
+    if(m_journal == journal) return;
+
+    if(m_journal) m_journal->record(m_handle, ChangeKind::Removed);
+
+    m_journal = journal;
+    m_transformRecord = ChangeJournal::NO_RECORD;
+
+    if(m_journal) m_journal->record(m_handle, ChangeKind::Added);
+
+    for(const auto& child: m_children) {
+        child->setJournal(journal);
+    }
+}
+
+void Entity::recordChange(ChangeKind kind)
+{
+    if(!m_journal) return;
+
+    if(kind == ChangeKind::Transform) {
+        m_transformRecord = m_journal->record(m_handle, kind, m_transformRecord);
+    }
+    else {
+        m_journal->record(m_handle, kind);
+    }
 }
 
 void Entity::invalidateCachedParentTransform()
@@ -274,6 +415,30 @@ void Entity::invalidateChildrenCachedParentTransform()
     }
 }
 
+void Entity::updateEffectiveMobility()
+{
+    const auto parentMobility = m_parent ? m_parent->m_effectiveMobility : Mobility::Static;
+    m_effectiveMobility = std::max(m_mobility, parentMobility);
+
+    for(const auto& child: m_children) {
+        child->updateEffectiveMobility();
+    }
+}
+
+bool Entity::rejectMove() const
+{
+    if(m_effectiveMobility != Mobility::Static || !m_journal || !m_journal->sceneLoaded()) return false;
+
+    RAYGUN_WARN("Ignoring transform change of static entity {}", name);
+    return true;
+}
+
+void Entity::onTransformChanged()
+{
+    updatePhysicsTransform();
+    recordChange(ChangeKind::Transform);
+}
+
 void Entity::updatePhysicsTransform()
 {
     auto* actor = physicsActor.get();
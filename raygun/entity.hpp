@@ -22,15 +22,102 @@
 
 #pragma once
 
+#include "raygun/async_resource.hpp"
+#include "raygun/atom.hpp"
 #include "raygun/audio/audio_source.hpp"
+#include "raygun/change_journal.hpp"
 #include "raygun/physics/physics_utils.hpp"
+#include "raygun/render/instance_array.hpp"
 #include "raygun/render/model.hpp"
 #include "raygun/transform.hpp"
+#include "raygun/utils/intrusive_ptr.hpp"
+#include "raygun/utils/pool_allocator.hpp"
+#include "raygun/utils/small_vector.hpp"
 
 namespace raygun {
 
+class Entity;
+struct Scene;
+
+namespace render {
+    struct ImportedModel;
+}
+
+/// Owning pointer to an entity. Reference counts are not atomic, entity
+/// pointers must only be copied or dropped by the thread owning the scene.
+template<typename T = Entity>
+using EntityPtr = utils::IntrusivePtr<T>;
+
+template<>
+struct ResourcePointer<Entity> {
+    using Type = EntityPtr<>;
+};
+
+template<typename T = Entity, typename... Args>
+EntityPtr<T> makeEntity(Args&&... args);
+
+/// Ordered from least to most mobile, an entity is always at least as mobile
+/// as its parent.
+enum class Mobility {
+    /// Never moves once the scene has been loaded, allows for static batching
+    /// and is skipped by physics write-back. Moving it afterwards is ignored.
+    Static,
+
+    /// Does not move, but may be shown, hidden or have its model swapped.
+    Stationary,
+
+    /// May move every frame.
+    Dynamic,
+};
+
+/// Component member of an Entity, behaves like the wrapped smart pointer.
+/// Assignments are recorded in the change journal of the entity's scene.
+template<typename T, ChangeKind AttachKind, ChangeKind DetachKind>
+class EntityComponent {
+  public:
+    explicit EntityComponent(Entity& owner) : m_owner(owner) {}
+
+    EntityComponent(const EntityComponent&) = delete;
+
+    EntityComponent& operator=(EntityComponent&& other)
+    {
+        if(&other != this) {
+            T value = std::move(other.m_value);
+            if(value) other.m_owner.recordChange(DetachKind);
+
+            assign(std::move(value));
+        }
+        return *this;
+    }
+
+    template<typename U>
+    EntityComponent& operator=(U&& value)
+    {
+        assign(T(std::forward<U>(value)));
+        return *this;
+    }
+
+    void reset() { assign(nullptr); }
+
+    auto get() const { return m_value.get(); }
+    auto operator->() const { return m_value.get(); }
+    auto& operator*() const { return *m_value; }
+
+    explicit operator bool() const { return m_value != nullptr; }
+    operator const T&() const { return m_value; }
+
+  private:
+    void assign(T value);
+
+    Entity& m_owner;
+    T m_value;
+};
+
 class Entity {
   public:
+    /// Most entities only have a few children, these are stored inline.
+    using ChildList = utils::SmallVector<EntityPtr<>, 4>;
+
     explicit Entity(string_view name);
 
     /// Loads the given entity by path, all containing models are automatically
@@ -38,7 +125,22 @@ class Entity {
     /// automatically.
     Entity(string_view name, fs::path filepath, bool loadMaterials = true);
 
-    virtual ~Entity() {}
+    /// Same as above, but from an already imported model.
+    Entity(string_view name, const render::ImportedModel& imported, bool loadMaterials = true);
+
+    virtual ~Entity();
+
+    EntityHandle handle() const { return m_handle; }
+
+    /// Returns the entity referred to by handle, or nullptr if it no longer
+    /// exists.
+    static Entity* resolve(EntityHandle handle);
+
+    const Entity* parent() const { return m_parent; }
+
+    /// Journal of the scene this entity is part of, nullptr if it is not
+    /// attached to a scene.
+    const ChangeJournal* journal() const { return m_journal; }
 
     const Transform& transform() const { return m_transform; }
     void setTransform(Transform transform);
@@ -49,21 +151,32 @@ class Entity {
     /// Returns the accumulated Transform of all (direct and transitive) parents and self.
     Transform globalTransform() const;
 
+    /// Effective mobility, i.e. the mobility set for this entity raised to
+    /// the mobility of its parent.
+    Mobility mobility() const { return m_effectiveMobility; }
+
+    /// Sets the mobility of this entity and all its descendants.
+    void setMobility(Mobility mobility);
+
     bool isVisible() const { return m_visible; }
-    void setVisible(bool visible) { m_visible = visible; }
+    void setVisible(bool visible);
     void show() { setVisible(true); }
     void hide() { setVisible(false); }
 
-    const std::vector<std::shared_ptr<Entity>>& children() const { return m_children; }
+    const ChildList& children() const { return m_children; }
 
-    void addChild(std::shared_ptr<Entity> child);
-    std::shared_ptr<Entity> emplaceChild(string_view childName = {});
+    void addChild(EntityPtr<> child);
+    EntityPtr<> emplaceChild(string_view childName = {});
 
-    void replaceChild(const std::shared_ptr<Entity>& oldChild, std::shared_ptr<Entity> newChild);
+    void replaceChild(const EntityPtr<>& oldChild, EntityPtr<> newChild);
 
-    void removeChild(const std::shared_ptr<Entity>& child);
+    void removeChild(const EntityPtr<>& child);
     void clearChildren();
 
+    /// Moves a child to a different parent without detaching it from the
+    /// scene in between.
+    void moveChild(const EntityPtr<>& child, Entity& newParent);
+
     template<typename Fun>
     void forEachEntity(Fun f)
     {
@@ -98,27 +211,76 @@ class Entity {
 
     //////////////////////////////////////////////////////////////////////////
 
-    string name;
+    Atom name;
+
+    EntityComponent<std::shared_ptr<render::Model>, ChangeKind::Model, ChangeKind::Model> model{*this};
 
-    std::shared_ptr<render::Model> model;
+    /// Additional copies of a model, placed relative to this entity.
+    EntityComponent<render::InstanceArrayPtr, ChangeKind::InstanceArray, ChangeKind::InstanceArray> instances{*this};
 
-    physics::UniqueActor physicsActor;
+    EntityComponent<physics::UniqueActor, ChangeKind::PhysicsAttached, ChangeKind::PhysicsDetached> physicsActor{*this};
 
-    audio::UniqueSource audioSource;
+    EntityComponent<audio::UniqueSource, ChangeKind::AudioAttached, ChangeKind::AudioDetached> audioSource{*this};
 
   private:
+    template<typename T, ChangeKind AttachKind, ChangeKind DetachKind>
+    friend class EntityComponent;
+
+    friend struct Scene;
+
+    template<typename T, typename... Args>
+    friend EntityPtr<T> makeEntity(Args&&... args);
+
+    friend void intrusiveRetain(const Entity* entity) { ++entity->m_refCount; }
+    friend void intrusiveRelease(const Entity* entity);
+
     void setParent(const Entity* parent);
     void clearParent() { setParent(nullptr); }
 
+    void addImportedNodes(const render::ImportedModel& imported, bool loadMaterials);
+
+    /// Attaches this subtree to the given journal, recording the removal from
+    /// the previous and the addition to the new journal.
+    void setJournal(ChangeJournal* journal);
+
+    void recordChange(ChangeKind kind);
+
     void invalidateCachedParentTransform();
     void invalidateChildrenCachedParentTransform();
 
+    void updateEffectiveMobility();
+
+    /// True if this entity is static and its scene has been loaded, logs a
+    /// warning in that case. Checked before each transform change.
+    bool rejectMove() const;
+
+    void onTransformChanged();
     void updatePhysicsTransform();
 
+    EntityHandle m_handle;
+
+    /// Number of EntityPtr owning this entity.
+    mutable uint32_t m_refCount = 0;
+
+    /// Destroys and frees a pooled entity, see makeEntity. Others are
+    /// deleted.
+    void (*m_destroy)(Entity* entity) = nullptr;
+
+    ChangeJournal* m_journal = nullptr;
+
+    /// Last Transform record, used to avoid recording the same change
+    /// multiple times per frame.
+    ChangeJournal::Sequence m_transformRecord = ChangeJournal::NO_RECORD;
+
     Transform m_transform;
 
     bool m_visible = true;
 
+    Mobility m_mobility = Mobility::Dynamic;
+
+    // Invariant: Needs to be updated when parent or mobility changes.
+    Mobility m_effectiveMobility = Mobility::Dynamic;
+
     // Invariant: Pointer to parent needs to be set / cleared when adding /
     // removing children.
     const Entity* m_parent = nullptr;
@@ -127,9 +289,52 @@ class Entity {
     // changes.
     mutable std::optional<Transform> m_cachedParentTransform;
 
-    std::vector<std::shared_ptr<Entity>> m_children;
+    ChildList m_children;
 };
 
+template<typename T, ChangeKind AttachKind, ChangeKind DetachKind>
+void EntityComponent<T, AttachKind, DetachKind>::assign(T value)
+{
+    const auto hadValue = m_value != nullptr;
+
+    m_value = std::move(value);
+
+    if(m_value) {
+        m_owner.recordChange(AttachKind);
+    }
+    else if(hadValue) {
+        m_owner.recordChange(DetachKind);
+    }
+}
+
+/// Creates an entity of type T from the entity pool, which keeps nodes
+/// created together (e.g. UI elements or text) close in memory.
+template<typename T, typename... Args>
+EntityPtr<T> makeEntity(Args&&... args)
+{
+    static_assert(std::is_base_of_v<Entity, T>);
+
+    auto& pool = utils::slabPool<sizeof(T), alignof(T)>();
+    auto memory = pool.allocate();
+
+    T* entity;
+    try {
+        entity = new(memory) T(std::forward<Args>(args)...);
+    }
+    catch(...) {
+        pool.deallocate(memory);
+        throw;
+    }
+
+    entity->m_destroy = [](Entity* e) {
+        auto object = static_cast<T*>(e);
+        object->~T();
+        utils::slabPool<sizeof(T), alignof(T)>().deallocate(object);
+    };
+
+    return EntityPtr<T>(entity);
+}
+
 class EntityAnimation {
   public:
     virtual ~EntityAnimation() {}
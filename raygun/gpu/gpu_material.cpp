@@ -54,21 +54,21 @@ void materialEditor()
     auto materials = RG().resourceManager().materials();
     if(materials.empty()) return;
 
-    static const char* selection = nullptr;
-    if(!selection) {
-        selection = materials[0]->name.c_str();
+    static Atom selection;
+    if(selection.empty()) {
+        selection = materials[0]->name;
     }
 
     auto changed = false;
 
     ImGui::Begin("Material Editor");
 
-    if(ImGui::BeginCombo("Material", selection)) {
+    if(ImGui::BeginCombo("Material", selection.c_str())) {
         for(const auto& material: materials) {
             auto selected = material->name == selection;
 
             if(ImGui::Selectable(material->name.c_str(), selected)) {
-                selection = material->name.c_str();
+                selection = material->name;
             }
 
             if(selected) {
@@ -89,7 +89,7 @@ void materialEditor()
     ImGui::End();
 
     if(changed) {
-        RG().renderSystem().updateModelBuffers();
+        RG().renderSystem().updateMaterial(**it);
     }
 }
 
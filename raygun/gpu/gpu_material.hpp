@@ -26,7 +26,7 @@ namespace raygun::gpu {
 
 struct Material {
 #define MAT_PARAM(_type, _name, _default, _min, _max) _type _name = _default;
-#define MAT_PARAM_PAD(_type, _name) _type _name;
+#define MAT_PARAM_PAD(_type, _name) _type _name = {};
 #include "resources/shaders/gpu_material.def"
 };
 
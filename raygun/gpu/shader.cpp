@@ -22,22 +22,29 @@
 
 #include "raygun/gpu/shader.hpp"
 
+#include "raygun/assert.hpp"
+#include "raygun/load_telemetry.hpp"
 #include "raygun/raygun.hpp"
-#include "raygun/utils/io_utils.hpp"
 
 namespace raygun::gpu {
 
-Shader::Shader(string_view, const fs::path& path)
+Shader::Shader(string_view name, const fs::path& path) : Shader(name, io::mapFile(path, io::Access::Sequential), path) {}
+
+Shader::Shader(string_view name, const io::FileData& code, const fs::path& path) : name(name), codeSize(code.size())
 {
     auto& vc = RG().vc();
 
-    const auto code = io::readFile(path);
+    RAYGUN_ASSERT(reinterpret_cast<uintptr_t>(code.data()) % alignof(uint32_t) == 0);
 
     vk::ShaderModuleCreateInfo info = {};
     info.setCodeSize(code.size());
     info.setPCode(reinterpret_cast<const uint32_t*>(code.data()));
 
-    shaderModule = vc.device->createShaderModuleUnique(info);
+    {
+        LoadStageTimer timer(LoadStage::Upload);
+        shaderModule = vc.device->createShaderModuleUnique(info);
+    }
+
     vc.setObjectName(*shaderModule, path.stem().string());
 }
 
@@ -54,21 +61,38 @@ vk::PipelineShaderStageCreateInfo Shader::shaderStageInfo(vk::ShaderStageFlagBit
     return info;
 }
 
+bool isShaderSource(const fs::path& path)
+{
+    // Same set as compiled by the build.
+    static const std::set<fs::path> extensions = {".frag", ".vert", ".comp", ".rgen", ".rint", ".rahit", ".rchit", ".rmiss", ".rcall"};
+
+    return extensions.find(path.extension()) != extensions.end();
+}
+
+bool compileShader(const fs::path& path)
+{
+#ifdef _WIN32
+    const auto glslc = "glslc.exe";
+#else
+    const auto glslc = "glslc";
+#endif
+
+    const auto cmd = fmt::format("{0} --target-env=vulkan1.2 -o {1}.spv {1}", glslc, path);
+    if(system(cmd.c_str()) != 0) {
+        RAYGUN_WARN("Compiling {} failed", path);
+        return false;
+    }
+
+    RAYGUN_INFO("Compiled {}", path);
+    return true;
+}
+
 void recompileAllShaders()
 {
     const auto shaderDir = fs::path{"resources/shaders"};
-    const std::set<fs::path> extensions = {".rgen", ".rint", ".rahit", ".rchit", ".rmiss", ".rcall"};
 
     for(const auto& entry: fs::directory_iterator(shaderDir)) {
-        if(extensions.find(entry.path().extension()) == extensions.end()) continue;
-
-        const auto cmd = fmt::format("glslc.exe --target-env=vulkan1.2 -o {0}.spv {0}", entry.path());
-        if(system(cmd.c_str()) != 0) {
-            RAYGUN_WARN("Compiling {} failed", entry.path());
-        }
-        else {
-            RAYGUN_INFO("Compiled {}", entry.path());
-        }
+        if(isShaderSource(entry.path())) compileShader(entry.path());
     }
 }
 
@@ -22,16 +22,35 @@
 
 #pragma once
 
+#include "raygun/atom.hpp"
+#include "raygun/utils/mapped_file.hpp"
+
 namespace raygun::gpu {
 
 struct Shader {
     Shader(string_view name, const fs::path& path);
 
+    /// Creates the shader module from already loaded SPIR-V code, which
+    /// needs to be 4 byte aligned.
+    Shader(string_view name, const io::FileData& code, const fs::path& path);
+
     vk::PipelineShaderStageCreateInfo shaderStageInfo(vk::ShaderStageFlagBits shaderStages) const;
 
+    Atom name;
+
     vk::UniqueShaderModule shaderModule;
+
+    /// Size of the SPIR-V code in bytes.
+    size_t codeSize = 0;
 };
 
+/// True for shader stage sources which are compiled to SPIR-V, e.g.
+/// raygen.rgen. Included headers are not.
+bool isShaderSource(const fs::path& path);
+
+/// Compiles the given shader source to <path>.spv, returns false on failure.
+bool compileShader(const fs::path& path);
+
 void recompileAllShaders();
 
 } // namespace raygun::gpu
@@ -0,0 +1,154 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "raygun/gpu/texture_image.hpp"
+
+#include "raygun/gpu/gpu_buffer.hpp"
+#include "raygun/gpu/gpu_utils.hpp"
+#include "raygun/raygun.hpp"
+
+namespace raygun::gpu {
+
+TextureImage::TextureImage(const render::TextureData& texture, uint32_t firstMip) : m_firstMip(firstMip), vc(RG().vc())
+{
+    RAYGUN_ASSERT(firstMip < texture.mipCount());
+
+    const auto& top = texture.mips[firstMip];
+    const auto format = static_cast<vk::Format>(texture.format);
+    const auto mipCount = texture.mipCount() - firstMip;
+
+    {
+        vk::ImageCreateInfo info;
+        info.setArrayLayers(1);
+        info.setExtent({top.width, top.height, 1});
+        info.setFormat(format);
+        info.setImageType(vk::ImageType::e2D);
+        info.setInitialLayout(vk::ImageLayout::eUndefined);
+        info.setMipLevels(mipCount);
+        info.setSamples(vk::SampleCountFlagBits::e1);
+        info.setSharingMode(vk::SharingMode::eExclusive);
+        info.setTiling(vk::ImageTiling::eOptimal);
+        info.setUsage(vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst);
+
+        m_image = vc.device->createImageUnique(info);
+    }
+
+    {
+        const auto requirements = vc.device->getImageMemoryRequirements(*m_image);
+
+        vk::MemoryAllocateInfo info;
+        info.setAllocationSize(requirements.size);
+        info.setMemoryTypeIndex(selectMemoryType(vc.physicalDevice, requirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal));
+
+        m_imageMemory = vc.device->allocateMemoryUnique(info);
+        m_memorySize = requirements.size;
+
+        vc.device->bindImageMemory(*m_image, *m_imageMemory, 0);
+    }
+
+    {
+        vk::ImageViewCreateInfo info;
+        info.setFormat(format);
+        info.setImage(*m_image);
+        info.setSubresourceRange(mipImageSubresourceRange(0, mipCount));
+        info.setViewType(vk::ImageViewType::e2D);
+
+        m_imageView = vc.device->createImageViewUnique(info);
+    }
+
+    upload(texture, mipCount);
+}
+
+void TextureImage::setName(string_view name)
+{
+    vc.setObjectName(*m_image, name);
+    vc.setObjectName(*m_imageMemory, name);
+    vc.setObjectName(*m_imageView, name);
+}
+
+void TextureImage::upload(const render::TextureData& texture, uint32_t mipCount)
+{
+    // Mips are stored consecutively, the range is copied in one go.
+    const auto baseOffset = texture.mips[m_firstMip].offset;
+    const auto size = texture.sizeInBytes(m_firstMip);
+
+    Buffer staging(size, vk::BufferUsageFlagBits::eTransferSrc, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+    memcpy(staging.map(), texture.mipData(m_firstMip), size);
+    staging.unmap();
+
+    std::vector<vk::BufferImageCopy> regions;
+    for(uint32_t i = 0; i < mipCount; ++i) {
+        const auto& mip = texture.mips[m_firstMip + i];
+
+        vk::ImageSubresourceLayers subresource;
+        subresource.setAspectMask(vk::ImageAspectFlagBits::eColor);
+        subresource.setMipLevel(i);
+        subresource.setLayerCount(1);
+
+        vk::BufferImageCopy region;
+        region.setBufferOffset(mip.offset - baseOffset);
+        region.setImageSubresource(subresource);
+        region.setImageExtent({mip.width, mip.height, 1});
+        regions.push_back(region);
+    }
+
+    auto cmd = vc.graphicsQueue->createCommandBuffer();
+    vc.setObjectName(*cmd, "Texture Upload");
+
+    auto fence = vc.device->createFenceUnique({});
+    vc.setObjectName(*fence, "Texture Upload");
+
+    vk::CommandBufferBeginInfo beginInfo;
+    beginInfo.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+    cmd->begin(beginInfo);
+
+    {
+        vk::ImageMemoryBarrier barrier;
+        barrier.setImage(*m_image);
+        barrier.setOldLayout(vk::ImageLayout::eUndefined);
+        barrier.setNewLayout(vk::ImageLayout::eTransferDstOptimal);
+        barrier.setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
+        barrier.setSubresourceRange(mipImageSubresourceRange(0, mipCount));
+
+        cmd->pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, barrier);
+    }
+
+    cmd->copyBufferToImage(staging, *m_image, vk::ImageLayout::eTransferDstOptimal, regions);
+
+    {
+        vk::ImageMemoryBarrier barrier;
+        barrier.setImage(*m_image);
+        barrier.setOldLayout(vk::ImageLayout::eTransferDstOptimal);
+        barrier.setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+        barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+        barrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+        barrier.setSubresourceRange(mipImageSubresourceRange(0, mipCount));
+
+        cmd->pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eRayTracingShaderKHR, {}, {}, {}, barrier);
+    }
+
+    cmd->end();
+    vc.graphicsQueue->submit(*cmd, *fence);
+    vc.waitForFence(*fence);
+}
+
+} // namespace raygun::gpu
@@ -0,0 +1,63 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#pragma once
+
+#include "raygun/render/texture_data.hpp"
+#include "raygun/vulkan_context.hpp"
+
+namespace raygun::gpu {
+
+/// Sampled image holding a range of mips of a texture, uploaded on
+/// construction. In contrast to Image, it may use block compressed formats
+/// but cannot be written by shaders.
+class TextureImage {
+  public:
+    /// Uploads mips [firstMip, texture.mipCount()), waits for the upload to
+    /// finish.
+    TextureImage(const render::TextureData& texture, uint32_t firstMip = 0);
+
+    uint32_t firstMip() const { return m_firstMip; }
+
+    /// Size of the device memory allocation.
+    vk::DeviceSize memorySize() const { return m_memorySize; }
+
+    const vk::ImageView& imageView() const { return *m_imageView; }
+
+    void setName(string_view name);
+
+  private:
+    uint32_t m_firstMip;
+    vk::DeviceSize m_memorySize = 0;
+
+    vk::UniqueImage m_image;
+    vk::UniqueDeviceMemory m_imageMemory;
+    vk::UniqueImageView m_imageView;
+
+    VulkanContext& vc;
+
+    void upload(const render::TextureData& texture, uint32_t mipCount);
+};
+
+using UniqueTextureImage = std::unique_ptr<TextureImage>;
+
+} // namespace raygun::gpu
@@ -0,0 +1,127 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "raygun/hot_reload.hpp"
+
+#include "raygun/logging.hpp"
+#include "raygun/raygun.hpp"
+
+namespace raygun {
+
+namespace {
+    /// Path of file relative to directory, std::nullopt if it is not located
+    /// below directory.
+    std::optional<fs::path> relativeTo(const fs::path& file, const fs::path& directory)
+    {
+        auto result = file.lexically_relative(directory);
+        if(result.empty() || *result.begin() == "..") return {};
+
+        return result;
+    }
+
+    /// Resource names which resolve to the given file, see
+    /// resolveResourcePath. Empty if the file does not end with suffix.
+    std::vector<string> resourceNames(const fs::path& relative, string_view suffix)
+    {
+        auto name = relative.generic_string();
+        if(name.size() <= suffix.size() || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) return {};
+
+        name.resize(name.size() - suffix.size());
+
+        std::vector<string> result = {name};
+
+        // ui/button.rgmat.json is also found as ui_button.
+        const auto slash = name.find('/');
+        if(slash != string::npos) {
+            result.push_back(name.substr(0, slash) + "_" + name.substr(slash + 1));
+        }
+
+        return result;
+    }
+} // namespace
+
+HotReload::HotReload() : m_watcher(RESOURCES_DIR)
+{
+    RAYGUN_INFO("Watching {} for changes", RESOURCES_DIR);
+}
+
+void HotReload::update()
+{
+    auto& resourceManager = RG().resourceManager();
+
+    // Models changed in earlier frames which finished importing.
+    auto geometryChanged = !resourceManager.applyModelReloads().empty();
+
+    const auto changedFiles = m_watcher.changedFiles();
+    if(changedFiles.empty() && !geometryChanged) return;
+
+    std::vector<Material*> materials;
+    std::vector<Atom> shaders;
+    auto headerChanged = false;
+
+    for(const auto& path: changedFiles) {
+        if(const auto relative = relativeTo(path, RESOURCES_DIR / "materials")) {
+            for(const auto& name: resourceNames(*relative, ".rgmat.json")) {
+                const auto reloaded = resourceManager.reloadMaterial(name);
+                materials.insert(materials.end(), reloaded.begin(), reloaded.end());
+            }
+        }
+        else if(const auto relative = relativeTo(path, RESOURCES_DIR / "shaders")) {
+            if(path.extension() == ".spv") {
+                for(const auto& name: resourceNames(*relative, ".spv")) {
+                    resourceManager.reloadShader(name);
+                    shaders.emplace_back(name);
+                }
+            }
+            else if(gpu::isShaderSource(path)) {
+                m_compiler.submit([path] { gpu::compileShader(path); });
+            }
+            else if(path.extension() == ".h" || path.extension() == ".def") {
+                headerChanged = true;
+            }
+        }
+        else {
+            resourceManager.reloadModels(path);
+        }
+    }
+
+    auto& renderSystem = RG().renderSystem();
+
+    for(const auto material: materials) {
+        renderSystem.updateMaterial(*material);
+    }
+
+    if(!shaders.empty()) {
+        renderSystem.reloadShaders(shaders);
+    }
+
+    if(geometryChanged) {
+        renderSystem.updateGeometry();
+    }
+
+    // Any shader may include the changed header.
+    if(headerChanged) {
+        m_compiler.submit([] { gpu::recompileAllShaders(); });
+    }
+}
+
+} // namespace raygun
@@ -0,0 +1,57 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#pragma once
+
+#include "raygun/utils/file_watcher.hpp"
+#include "raygun/utils/thread_pool.hpp"
+
+namespace raygun {
+
+/// Reloads resources while the engine is running as their files below
+/// RESOURCES_DIR change, touching only what depends on them:
+///
+/// - Material definitions are re-read in place, only their slots in the
+///   material buffer are rewritten.
+/// - Shader sources are recompiled in the background. Once the SPIR-V file
+///   changes, only the pipelines using it are rebuilt.
+/// - Model files are re-imported in the background, only the bottom level AS
+///   of the affected models are rebuilt. Collision shapes are not updated.
+class HotReload {
+  public:
+    HotReload();
+
+    /// Applies the changes observed since the last call, called once per
+    /// frame.
+    void update();
+
+  private:
+    io::FileWatcher m_watcher;
+
+    /// Compiles shader sources without stalling the main loop, the resulting
+    /// SPIR-V files are picked up by the watcher.
+    utils::ThreadPool m_compiler{1};
+};
+
+using UniqueHotReload = std::unique_ptr<HotReload>;
+
+} // namespace raygun
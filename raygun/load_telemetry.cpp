@@ -0,0 +1,312 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "raygun/load_telemetry.hpp"
+
+#include "raygun/config.hpp"
+#include "raygun/logging.hpp"
+#include "raygun/raygun.hpp"
+
+namespace raygun {
+
+namespace {
+    thread_local LoadTelemetry::Scope* currentScope = nullptr;
+
+    constexpr std::array<const char*, LOAD_STAGE_COUNT> STAGE_NAMES = {"IO", "Parse", "Convert", "Upload", "BLAS"};
+
+    double toMs(Clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    json toJson(const AssetLoadRecord& record)
+    {
+        json stages;
+        for(size_t i = 0; i < LOAD_STAGE_COUNT; ++i) {
+            stages[STAGE_NAMES[i]] = toMs(record.stages[i]);
+        }
+
+        return {
+            {"name", record.name.str()}, {"loads", record.loads}, {"bytesRead", record.bytesRead}, {"totalMs", toMs(record.total)}, {"stagesMs", stages},
+        };
+    }
+
+    bool slower(const AssetLoadRecord& a, const AssetLoadRecord& b)
+    {
+        return a.total > b.total;
+    }
+} // namespace
+
+string_view loadStageName(LoadStage stage)
+{
+    return STAGE_NAMES[(size_t)stage];
+}
+
+LoadTelemetry::Scope::Scope(LoadTelemetry& telemetry, string_view type, Atom name, bool continuation)
+    : m_telemetry(telemetry)
+    , m_type(type)
+    , m_name(name)
+    , m_continuation(continuation)
+    , m_outer(currentScope)
+{
+    currentScope = this;
+}
+
+LoadTelemetry::Scope::~Scope()
+{
+    currentScope = m_outer;
+    m_telemetry.finish(*this);
+}
+
+LoadStageTimer::~LoadStageTimer()
+{
+    if(currentScope) {
+        currentScope->m_stages[(size_t)m_stage] += Clock::now() - m_start;
+    }
+}
+
+void recordBytesRead(size_t bytes)
+{
+    if(currentScope) {
+        currentScope->m_bytesRead += bytes;
+    }
+}
+
+void recordCacheAccess(string_view type, bool hit)
+{
+    if(currentScope) {
+        currentScope->m_telemetry.recordCacheAccess(type, hit);
+    }
+}
+
+void LoadTelemetry::recordCacheAccess(string_view type, bool hit)
+{
+    std::lock_guard lock(m_mutex);
+
+    auto& cache = typeRecords(type).cache;
+    ++(hit ? cache.hits : cache.misses);
+}
+
+void LoadTelemetry::record(string_view type, Atom name, LoadStage stage, Clock::duration duration)
+{
+    std::lock_guard lock(m_mutex);
+
+    auto& record = assetRecord(type, name);
+    record.stages[(size_t)stage] += duration;
+    record.total += duration;
+}
+
+CacheCounters LoadTelemetry::cacheCounters(string_view type) const
+{
+    std::lock_guard lock(m_mutex);
+
+    const auto it = m_types.find(type);
+    return it != m_types.end() ? it->second.cache : CacheCounters{};
+}
+
+std::vector<AssetLoadRecord> LoadTelemetry::slowest(size_t count, bool currentScene) const
+{
+    std::vector<AssetLoadRecord> result;
+    {
+        std::lock_guard lock(m_mutex);
+
+        for(const auto& [type, records]: m_types) {
+            for(const auto& [name, record]: records.assets) {
+                if(!currentScene || record.scene == m_scene) result.push_back(record);
+            }
+        }
+    }
+
+    count = std::min(count, result.size());
+    std::partial_sort(result.begin(), result.begin() + count, result.end(), slower);
+    result.resize(count);
+
+    return result;
+}
+
+json LoadTelemetry::report() const
+{
+    json types = json::object();
+
+    std::lock_guard lock(m_mutex);
+
+    for(const auto& [type, records]: m_types) {
+        std::vector<const AssetLoadRecord*> sorted;
+        for(const auto& [name, record]: records.assets) {
+            sorted.push_back(&record);
+        }
+
+        std::sort(sorted.begin(), sorted.end(), [](const auto* a, const auto* b) { return slower(*a, *b); });
+
+        json assets = json::array();
+        Clock::duration total = {};
+        size_t bytesRead = 0;
+
+        for(const auto record: sorted) {
+            assets.push_back(toJson(*record));
+            total += record->total;
+            bytesRead += record->bytesRead;
+        }
+
+        types[type] = {
+            {"hits", records.cache.hits}, {"misses", records.cache.misses}, {"hitRate", records.cache.hitRate()},
+            {"totalMs", toMs(total)},     {"bytesRead", bytesRead},         {"assets", assets},
+        };
+    }
+
+    return {{"sceneLoads", m_scene}, {"types", types}};
+}
+
+void LoadTelemetry::sceneLoaded()
+{
+    const auto& config = RG().config();
+
+    const auto records = slowest(config.loadReportSlowest, true);
+    if(!records.empty()) {
+        RAYGUN_INFO("Slowest assets of scene load:");
+    }
+
+    for(const auto& record: records) {
+        RAYGUN_INFO("  {} {}: {:.1f} ms (IO {:.1f}, parse {:.1f}, convert {:.1f}, upload {:.1f}, BLAS {:.1f}), {} KiB", record.type, record.name,
+                    toMs(record.total), toMs(record.stage(LoadStage::IO)), toMs(record.stage(LoadStage::Parse)), toMs(record.stage(LoadStage::Convert)),
+                    toMs(record.stage(LoadStage::Upload)), toMs(record.stage(LoadStage::BlasBuild)), record.bytesRead / 1024);
+    }
+
+    if(config.loadReport) {
+        const auto path = configDirectory() / "load_report.json";
+
+        std::ofstream out(path);
+        if(out) {
+            out << report().dump(2);
+        }
+        else {
+            RAYGUN_WARN("Unable to write load report: {}", path);
+        }
+    }
+
+    std::lock_guard lock(m_mutex);
+    m_lastScene = records;
+    ++m_scene;
+}
+
+void LoadTelemetry::doUI() const
+{
+    ImGui::Begin("Asset Loading");
+
+    std::lock_guard lock(m_mutex);
+
+    if(ImGui::BeginTable("Caches", 5, ImGuiTableFlags_Borders)) {
+        for(const auto header: {"Type", "Hits", "Misses", "Hit rate", "Assets"}) {
+            ImGui::TableSetupColumn(header);
+        }
+        ImGui::TableHeadersRow();
+
+        for(const auto& [type, records]: m_types) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", type.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)records.cache.hits);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", (unsigned long long)records.cache.misses);
+            ImGui::TableNextColumn();
+            ImGui::Text("%5.1f %%", records.cache.hitRate() * 100.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", records.assets.size());
+        }
+
+        ImGui::EndTable();
+    }
+
+    ImGui::Text("Slowest assets of the last scene load (ms)");
+
+    if(ImGui::BeginTable("Slowest", 4 + (int)LOAD_STAGE_COUNT, ImGuiTableFlags_Borders)) {
+        ImGui::TableSetupColumn("Type");
+        ImGui::TableSetupColumn("Name");
+        ImGui::TableSetupColumn("Total");
+        for(const auto stage: STAGE_NAMES) {
+            ImGui::TableSetupColumn(stage);
+        }
+        ImGui::TableSetupColumn("KiB");
+        ImGui::TableHeadersRow();
+
+        for(const auto& record: m_lastScene) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", record.type.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", record.name.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", toMs(record.total));
+            for(const auto duration: record.stages) {
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", toMs(duration));
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", record.bytesRead / 1024);
+        }
+
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
+
+LoadTelemetry::TypeRecords& LoadTelemetry::typeRecords(string_view type)
+{
+    auto it = m_types.find(type);
+    if(it == m_types.end()) {
+        it = m_types.emplace(string{type}, TypeRecords{}).first;
+    }
+
+    return it->second;
+}
+
+AssetLoadRecord& LoadTelemetry::assetRecord(string_view type, Atom name)
+{
+    auto& record = typeRecords(type).assets[name];
+    if(record.type.empty()) {
+        record.type = type;
+        record.name = name;
+    }
+
+    record.scene = m_scene;
+    return record;
+}
+
+void LoadTelemetry::finish(const Scope& scope)
+{
+    const auto duration = Clock::now() - scope.m_start;
+
+    std::lock_guard lock(m_mutex);
+
+    auto& record = assetRecord(scope.m_type, scope.m_name);
+    for(size_t i = 0; i < LOAD_STAGE_COUNT; ++i) {
+        record.stages[i] += scope.m_stages[i];
+    }
+
+    record.total += duration;
+    record.bytesRead += scope.m_bytesRead;
+    if(!scope.m_continuation) ++record.loads;
+}
+
+} // namespace raygun
@@ -0,0 +1,173 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#pragma once
+
+#include "raygun/atom.hpp"
+
+namespace raygun {
+
+/// Stages of loading an asset. I/O only covers reading and decompressing
+/// files, pages of mapped files are mostly faulted in by the stage first
+/// touching them.
+enum class LoadStage {
+    IO,
+    Parse,
+    Convert,
+    Upload,
+    BlasBuild,
+};
+
+constexpr size_t LOAD_STAGE_COUNT = 5;
+
+string_view loadStageName(LoadStage stage);
+
+/// Accumulated cost of loading one asset.
+struct AssetLoadRecord {
+    string type;
+    Atom name;
+
+    std::array<Clock::duration, LOAD_STAGE_COUNT> stages = {};
+
+    /// Wall time of all loads, including stages recorded outside of them.
+    /// Assets loaded as part of another one are included in its time.
+    Clock::duration total = {};
+
+    size_t bytesRead = 0;
+    uint32_t loads = 0;
+
+    /// Scene load during which the asset was last loaded, see
+    /// LoadTelemetry::sceneLoaded.
+    uint64_t scene = 0;
+
+    Clock::duration stage(LoadStage s) const { return stages[(size_t)s]; }
+};
+
+struct CacheCounters {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+    double hitRate() const { return hits + misses > 0 ? (double)hits / (double)(hits + misses) : 0.0; }
+};
+
+/// Collects per asset load timings, bytes read and cache hit rates of the
+/// ResourceManager. All functions are thread-safe.
+///
+/// Loaders do not need to know which asset they work on: a Scope attributes
+/// everything recorded on its thread via LoadStageTimer, recordBytesRead
+/// and recordCacheAccess to its asset.
+class LoadTelemetry {
+  public:
+    /// Scopes nest, the innermost one receives the records. Types need to be
+    /// string literals. Scopes continuing a load, e.g. finalizing an
+    /// asynchronous one, do not count as a load of their own.
+    class Scope {
+      public:
+        Scope(LoadTelemetry& telemetry, string_view type, Atom name, bool continuation = false);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+      private:
+        friend class LoadTelemetry;
+        friend class LoadStageTimer;
+        friend void recordBytesRead(size_t bytes);
+        friend void recordCacheAccess(string_view type, bool hit);
+
+        LoadTelemetry& m_telemetry;
+        string_view m_type;
+        Atom m_name;
+        bool m_continuation;
+
+        Clock::time_point m_start = Clock::now();
+        std::array<Clock::duration, LOAD_STAGE_COUNT> m_stages = {};
+        size_t m_bytesRead = 0;
+
+        Scope* m_outer;
+    };
+
+    void recordCacheAccess(string_view type, bool hit);
+
+    /// For stages running outside of the load, e.g. uploads by the
+    /// TextureStreamer.
+    void record(string_view type, Atom name, LoadStage stage, Clock::duration duration);
+
+    CacheCounters cacheCounters(string_view type) const;
+
+    /// Slowest assets by total time, optionally only those loaded since the
+    /// last scene load.
+    std::vector<AssetLoadRecord> slowest(size_t count, bool currentScene) const;
+
+    /// Per type cache counters and per asset records.
+    json report() const;
+
+    /// Logs the slowest assets loaded for the scene and writes the report
+    /// (see the loadReport config options). Called after each scene load.
+    void sceneLoaded();
+
+    void doUI() const;
+
+  private:
+    struct TypeRecords {
+        CacheCounters cache;
+        std::unordered_map<Atom, AssetLoadRecord> assets;
+    };
+
+    TypeRecords& typeRecords(string_view type);
+
+    AssetLoadRecord& assetRecord(string_view type, Atom name);
+
+    void finish(const Scope& scope);
+
+    mutable std::mutex m_mutex;
+    std::map<string, TypeRecords, std::less<>> m_types;
+    uint64_t m_scene = 0;
+
+    /// Slowest assets of the last scene load, shown by doUI.
+    std::vector<AssetLoadRecord> m_lastScene;
+};
+
+/// Adds the lifetime of the timer to a stage of the asset loaded on this
+/// thread. Does nothing outside of a LoadTelemetry::Scope, so loaders can be
+/// instrumented unconditionally. Stages must not be nested.
+class LoadStageTimer {
+  public:
+    explicit LoadStageTimer(LoadStage stage) : m_stage(stage) {}
+    ~LoadStageTimer();
+
+    LoadStageTimer(const LoadStageTimer&) = delete;
+    LoadStageTimer& operator=(const LoadStageTimer&) = delete;
+
+  private:
+    LoadStage m_stage;
+    Clock::time_point m_start = Clock::now();
+};
+
+/// Adds to the bytes read for the asset loaded on this thread.
+void recordBytesRead(size_t bytes);
+
+/// Counts a lookup in a cache used while loading the asset on this thread,
+/// e.g. the mesh cache.
+void recordCacheAccess(string_view type, bool hit);
+
+} // namespace raygun
@@ -22,6 +22,7 @@
 
 #include "raygun/material.hpp"
 
+#include "raygun/load_telemetry.hpp"
 #include "raygun/logging.hpp"
 #include "raygun/physics/physics_utils.hpp"
 #include "raygun/raygun.hpp"
@@ -41,70 +42,174 @@ namespace {
         }
     }
 
-    void copyParameters(Material& dst, const Material& src)
+    using ParamSetter = void (*)(const json& value, MaterialParameters& parameters);
+
+    /// Maps the fields of a material definition to the parameters they set.
+    const std::unordered_map<string_view, ParamSetter>& paramSetters()
     {
-        dst.gpuMaterial = src.gpuMaterial;
+        static const std::unordered_map<string_view, ParamSetter> setters = {
+        // gpu::Material parameters:
+#define MAT_PARAM(_type, _name, _default, _min, _max) \
+    {#_name, [](const json& value, MaterialParameters& parameters) { loadMaterialParam(value, parameters.gpuMaterial._name); }},
+#define MAT_PARAM_PAD(_type, _name)
+#include "resources/shaders/gpu_material.def"
 
-        dst.physicsMaterial = physics::cloneMaterial(RG().physicsSystem().physics(), *src.physicsMaterial);
-        dst.physicsMaterial->userData = (void*)&dst;
+            // physics material parameters:
+            {"staticFriction", [](const json& value, MaterialParameters& parameters) { parameters.staticFriction = value; }},
+            {"dynamicFriction", [](const json& value, MaterialParameters& parameters) { parameters.dynamicFriction = value; }},
+            {"restitution", [](const json& value, MaterialParameters& parameters) { parameters.restitution = value; }},
+
+            // textures:
+            {"diffuseTexture",
+             [](const json& value, MaterialParameters& parameters) {
+                 if(!parameters.setDiffuseTexture(value.get<string>())) {
+                     RAYGUN_WARN("Texture name too long: {}", value.get<string>());
+                 }
+             }},
+        };
+
+        return setters;
     }
 
 } // namespace
 
-Material::Material() : physicsMaterial(RG().physicsSystem().physics().createMaterial(0.8f, 0.8f, 0.6f))
+bool MaterialParameters::applyDefinition(const json& data, const fs::path& path)
+{
+    if(!data.is_object() || data.value("type", "") != "Material") {
+        RAYGUN_ERROR("Not a material: {}", path);
+        return false;
+    }
+
+    const auto& setters = paramSetters();
+
+    for(const auto& [key, value]: data.items()) {
+        if(key == "type") continue;
+        if(key == "basedOn") continue;
+
+        const auto setter = setters.find(key);
+        if(setter == setters.cend()) {
+            RAYGUN_WARN("Unknown field '{}' in material: {}", key, path);
+            continue;
+        }
+
+        setter->second(value, *this);
+    }
+
+    return true;
+}
+
+bool MaterialParameters::setDiffuseTexture(string_view name)
+{
+    if(name.size() > MAX_TEXTURE_NAME_LENGTH) return false;
+
+    diffuseTexture = {};
+    std::copy(name.begin(), name.end(), diffuseTexture.begin());
+    return true;
+}
+
+Material::Material() : Material("default", MaterialParameters{}) {}
+
+Material::Material(string_view name, const fs::path& path) : Material(name, readDefinition(path), path) {}
+
+Material::Material(string_view name, const MaterialParameters& parameters, Atom basedOn)
+    : name(name)
+    , basedOn(basedOn)
+    , gpuMaterial(parameters.gpuMaterial)
+    , physicsMaterial(RG().physicsSystem().physics().createMaterial(parameters.staticFriction, parameters.dynamicFriction, parameters.restitution))
 {
     physicsMaterial->userData = static_cast<void*>(this);
+
+    setDiffuseTexture(parameters.diffuseTextureName());
 }
 
-Material::Material(string_view name, const fs::path& path) : Material()
+Material::Material(string_view name, const json& data, const fs::path& path) : Material()
 {
     this->name = name;
 
-    std::ifstream in(path);
-    if(!in) {
-        RAYGUN_ERROR("Unable to open: {}", path);
-        return;
-    }
-
-    json data;
-    in >> data;
+    if(data.is_null()) return;
 
-    if(data.at("type") != "Material") {
+    if(!data.is_object() || data.value("type", "") != "Material") {
         RAYGUN_ERROR("Not a material: {}", path);
         return;
     }
 
+    // Only definitions read at development time resolve their base here, the
+    // material table is compiled with inheritance already flattened.
+    MaterialParameters parameters;
     if(data.contains("basedOn")) {
         const string baseName = data.at("basedOn");
-        const auto baseMaterial = RG().resourceManager().loadMaterial(baseName);
-        copyParameters(*this, *baseMaterial);
+        parameters = RG().resourceManager().loadMaterial(baseName)->parameters();
+        basedOn = baseName;
     }
 
-    for(const auto& [key, value]: data.items()) {
-        if(key == "type") continue;
-        if(key == "basedOn") continue;
+    parameters.applyDefinition(data, path);
+    setParameters(parameters);
+}
 
-            // gpu::Material parameters:
-#define MAT_PARAM(_type, _name, _default, _min, _max) \
-    if(key == #_name) { \
-        loadMaterialParam(value, gpuMaterial._name); \
-        continue; \
-    }
-#define MAT_PARAM_PAD(_type, _name)
-#include "resources/shaders/gpu_material.def"
+json Material::readDefinition(const fs::path& path)
+{
+    LoadStageTimer timer(LoadStage::Parse);
 
-        // physics material parameters:
-        if(key == "staticFriction") {
-            physicsMaterial->setStaticFriction(value);
-            continue;
-        }
-        else if(key == "dynamicFriction") {
-            physicsMaterial->setDynamicFriction(value);
-            continue;
-        }
+    std::ifstream in(path);
+    if(!in) {
+        RAYGUN_ERROR("Unable to open: {}", path);
+        return {};
+    }
 
-        RAYGUN_WARN("Unknown field '{}' in material: {}", key, path);
+    json data;
+    try {
+        in >> data;
     }
+    catch(const json::parse_error& e) {
+        RAYGUN_ERROR("Unable to parse {}: {}", path, e.what());
+        return {};
+    }
+
+    return data;
+}
+
+bool Material::reload(const fs::path& path)
+{
+    const auto data = readDefinition(path);
+    if(data.is_null()) return false;
+
+    const Material reloaded(name, data, path);
+
+    basedOn = reloaded.basedOn;
+    setParameters(reloaded.parameters());
+
+    return true;
+}
+
+MaterialParameters Material::parameters() const
+{
+    MaterialParameters result;
+    result.gpuMaterial = gpuMaterial;
+    result.staticFriction = physicsMaterial->getStaticFriction();
+    result.dynamicFriction = physicsMaterial->getDynamicFriction();
+    result.restitution = physicsMaterial->getRestitution();
+
+    if(diffuseTexture) result.setDiffuseTexture(diffuseTexture->name);
+    result.gpuMaterial.diffuseTexture = 0;
+
+    return result;
+}
+
+void Material::setParameters(const MaterialParameters& parameters)
+{
+    gpuMaterial = parameters.gpuMaterial;
+
+    physicsMaterial->setStaticFriction(parameters.staticFriction);
+    physicsMaterial->setDynamicFriction(parameters.dynamicFriction);
+    physicsMaterial->setRestitution(parameters.restitution);
+
+    setDiffuseTexture(parameters.diffuseTextureName());
+}
+
+void Material::setDiffuseTexture(string_view textureName)
+{
+    diffuseTexture = textureName.empty() ? nullptr : RG().resourceManager().loadTexture(textureName);
+    gpuMaterial.diffuseTexture = diffuseTexture ? diffuseTexture->slot : 0;
 }
 
 std::vector<physx::PxMaterial*> collectPhysicsMaterials(const std::vector<std::shared_ptr<Material>>& materials)
@@ -22,21 +22,76 @@
 
 #pragma once
 
+#include "raygun/atom.hpp"
 #include "raygun/audio/sound.hpp"
 #include "raygun/gpu/gpu_material.hpp"
 #include "raygun/physics/physics_utils.hpp"
+#include "raygun/render/texture.hpp"
 
 namespace raygun {
 
+/// Parameters of a material with inheritance already resolved.
+struct MaterialParameters {
+    gpu::Material gpuMaterial = {};
+
+    float staticFriction = 0.8f;
+    float dynamicFriction = 0.8f;
+    float restitution = 0.6f;
+
+    static constexpr size_t MAX_TEXTURE_NAME_LENGTH = 63;
+
+    /// Name of the texture diffuse is multiplied with, see
+    /// ResourceManager::loadTexture. Stored inline to keep the parameters
+    /// trivially copyable for MaterialTable and the mesh cache.
+    std::array<char, MAX_TEXTURE_NAME_LENGTH + 1> diffuseTexture = {};
+
+    string_view diffuseTextureName() const { return diffuseTexture.data(); }
+
+    /// Returns false if name is longer than MAX_TEXTURE_NAME_LENGTH.
+    bool setDiffuseTexture(string_view name);
+
+    /// Applies the fields of a material definition on top of these
+    /// parameters, ignoring basedOn. Returns false if data is not a material,
+    /// path is only used for messages.
+    bool applyDefinition(const json& data, const fs::path& path);
+};
+
 struct Material {
     Material();
     Material(string_view name, const fs::path& path);
 
-    string name = "default";
+    /// Creates the material from precompiled parameters, see MaterialTable.
+    Material(string_view name, const MaterialParameters& parameters, Atom basedOn = {});
+
+    /// Creates the material from an already parsed definition, path is only
+    /// used for messages.
+    Material(string_view name, const json& data, const fs::path& path);
+
+    /// Reads the material definition at path, returns null on failure.
+    static json readDefinition(const fs::path& path);
+
+    /// Re-reads the definition at path in place, users of this material see
+    /// the new parameters. Returns false if the definition could not be read.
+    bool reload(const fs::path& path);
+
+    MaterialParameters parameters() const;
+
+    Atom name = "default";
+
+    /// Material this one inherits its parameters from, empty if none.
+    Atom basedOn;
 
     gpu::Material gpuMaterial;
 
+    /// gpuMaterial.diffuseTexture refers to the slot of this texture.
+    std::shared_ptr<render::Texture> diffuseTexture;
+
     physics::UniqueMaterial physicsMaterial;
+
+  private:
+    void setParameters(const MaterialParameters& parameters);
+
+    void setDiffuseTexture(string_view textureName);
 };
 
 std::vector<physx::PxMaterial*> collectPhysicsMaterials(const std::vector<std::shared_ptr<Material>>& materials);
@@ -0,0 +1,279 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "raygun/material_table.hpp"
+
+#include "raygun/logging.hpp"
+#include "raygun/utils/hash_utils.hpp"
+
+namespace raygun {
+
+namespace {
+
+    // File layout: Header, Record[count] sorted by name hash, then the name
+    // table holding the names of all materials, their bases and textures.
+
+    constexpr std::array<char, 8> MAGIC = {'R', 'G', 'M', 'T', 'L', '\0', '\0', '\0'};
+    constexpr uint32_t FORMAT_VERSION = 2;
+
+    constexpr string_view DEFINITION_EXTENSION = ".rgmat.json";
+
+    struct Header {
+        std::array<char, 8> magic = MAGIC;
+        uint32_t formatVersion = FORMAT_VERSION;
+        uint32_t count = 0;
+        uint32_t namesSize = 0;
+        uint32_t reserved[3] = {};
+    };
+
+    struct Record {
+        uint64_t nameHash = 0;
+        uint32_t nameOffset = 0;
+        uint32_t nameLength = 0;
+
+        /// Zero length if not based on another material.
+        uint32_t baseOffset = 0;
+        uint32_t baseLength = 0;
+
+        float staticFriction = 0.f;
+        float dynamicFriction = 0.f;
+        float restitution = 0.f;
+
+        /// Zero length if the material has no diffuse texture.
+        uint32_t textureOffset = 0;
+        uint32_t textureLength = 0;
+
+        gpu::Material gpuMaterial = {};
+
+        uint32_t reserved = 0;
+    };
+
+    static_assert(std::is_trivially_copyable_v<Header> && std::is_trivially_copyable_v<Record>);
+    static_assert(sizeof(Header) % alignof(Record) == 0);
+    static_assert(sizeof(Record) == 48 + sizeof(gpu::Material), "Record must not contain implicit padding");
+
+    const Record* records(const std::byte* data)
+    {
+        return reinterpret_cast<const Record*>(data + sizeof(Header));
+    }
+
+    struct Definition {
+        json data;
+        fs::path path;
+    };
+
+    /// Reads all definitions below materialsDir by material name.
+    std::map<string, Definition> readDefinitions(const fs::path& materialsDir)
+    {
+        std::map<string, Definition> result;
+
+        for(const auto& file: fs::recursive_directory_iterator(materialsDir)) {
+            if(!file.is_regular_file()) continue;
+
+            auto name = fs::relative(file.path(), materialsDir).generic_string();
+            if(name.size() <= DEFINITION_EXTENSION.size() || name.compare(name.size() - DEFINITION_EXTENSION.size(), string::npos, DEFINITION_EXTENSION) != 0) {
+                continue;
+            }
+
+            name.resize(name.size() - DEFINITION_EXTENSION.size());
+            std::replace(name.begin(), name.end(), '/', '_');
+
+            auto data = Material::readDefinition(file.path());
+            if(data.is_null()) throw std::runtime_error("Invalid material: " + file.path().string());
+
+            result.emplace(std::move(name), Definition{std::move(data), file.path()});
+        }
+
+        return result;
+    }
+
+    /// Resolves the inheritance of all definitions.
+    class InheritanceResolver {
+      public:
+        explicit InheritanceResolver(const std::map<string, Definition>& definitions) : m_definitions(definitions) {}
+
+        const MaterialParameters& resolve(const string& name)
+        {
+            if(const auto it = m_resolved.find(name); it != m_resolved.end()) return it->second;
+
+            // Like at runtime, missing bases fall back to the default material.
+            const auto definition = m_definitions.find(name);
+            if(definition == m_definitions.end()) {
+                RAYGUN_ERROR("Unable to find base material: {}", name);
+                return m_resolved[name];
+            }
+
+            if(!m_resolving.insert(name).second) {
+                throw std::runtime_error("Cyclic material inheritance: " + name);
+            }
+
+            const auto& [data, path] = definition->second;
+
+            MaterialParameters result;
+            if(data.contains("basedOn")) {
+                result = resolve(data.at("basedOn").get<string>());
+            }
+
+            if(!result.applyDefinition(data, path)) {
+                throw std::runtime_error("Not a material: " + path.string());
+            }
+
+            m_resolving.erase(name);
+
+            return m_resolved[name] = result;
+        }
+
+      private:
+        const std::map<string, Definition>& m_definitions;
+
+        std::map<string, MaterialParameters> m_resolved;
+        std::set<string> m_resolving;
+    };
+
+} // namespace
+
+MaterialTable::MaterialTable(const std::byte* data, size_t size)
+{
+    Header header;
+    if(size < sizeof(header)) return;
+
+    memcpy(&header, data, sizeof(header));
+    if(header.magic != MAGIC || header.formatVersion != FORMAT_VERSION) {
+        RAYGUN_ERROR("Invalid material table");
+        return;
+    }
+
+    const auto namesOffset = sizeof(Header) + (size_t)header.count * sizeof(Record);
+    if(size < namesOffset + header.namesSize) {
+        RAYGUN_ERROR("Truncated material table");
+        return;
+    }
+
+    if(reinterpret_cast<uintptr_t>(data) % alignof(Record) != 0) {
+        RAYGUN_ERROR("Misaligned material table");
+        return;
+    }
+
+    const auto* begin = records(data);
+    const auto inNames = [&](uint32_t offset, uint32_t length) { return (uint64_t)offset + length <= header.namesSize; };
+    const auto valid = std::all_of(begin, begin + header.count, [&](const Record& record) {
+        return inNames(record.nameOffset, record.nameLength) && inNames(record.baseOffset, record.baseLength)
+               && inNames(record.textureOffset, record.textureLength) && record.textureLength <= MaterialParameters::MAX_TEXTURE_NAME_LENGTH;
+    });
+    if(!valid) {
+        RAYGUN_ERROR("Corrupt material table");
+        return;
+    }
+
+    m_data = data;
+    m_count = header.count;
+}
+
+std::optional<MaterialTable::Entry> MaterialTable::find(string_view name) const
+{
+    if(!m_data) return {};
+
+    const auto hash = utils::fnv1a(name);
+    const auto* names = reinterpret_cast<const char*>(m_data + sizeof(Header) + (size_t)m_count * sizeof(Record));
+
+    const auto* begin = records(m_data);
+    const auto* end = begin + m_count;
+
+    auto it = std::lower_bound(begin, end, hash, [](const Record& record, uint64_t h) { return record.nameHash < h; });
+    for(; it != end && it->nameHash == hash; ++it) {
+        if(string_view(names + it->nameOffset, it->nameLength) != name) continue;
+
+        Entry result;
+        result.name = {names + it->nameOffset, it->nameLength};
+        result.basedOn = {names + it->baseOffset, it->baseLength};
+        result.parameters.gpuMaterial = it->gpuMaterial;
+        result.parameters.staticFriction = it->staticFriction;
+        result.parameters.dynamicFriction = it->dynamicFriction;
+        result.parameters.restitution = it->restitution;
+        result.parameters.setDiffuseTexture({names + it->textureOffset, it->textureLength});
+        return result;
+    }
+
+    return {};
+}
+
+std::vector<char> compileMaterialTable(const fs::path& materialsDir)
+{
+    const auto definitions = readDefinitions(materialsDir);
+
+    InheritanceResolver resolver(definitions);
+
+    string names;
+    std::unordered_map<string, uint32_t> nameOffsets;
+    const auto addName = [&](const string& name) {
+        const auto [it, inserted] = nameOffsets.try_emplace(name, (uint32_t)names.size());
+        if(inserted) names += name;
+        return it->second;
+    };
+
+    std::vector<Record> result;
+    result.reserve(definitions.size());
+
+    for(const auto& [name, definition]: definitions) {
+        const auto& parameters = resolver.resolve(name);
+
+        Record record;
+        record.nameHash = utils::fnv1a(name);
+        record.nameOffset = addName(name);
+        record.nameLength = (uint32_t)name.size();
+
+        if(definition.data.contains("basedOn")) {
+            const string baseName = definition.data.at("basedOn");
+            record.baseOffset = addName(baseName);
+            record.baseLength = (uint32_t)baseName.size();
+        }
+
+        record.staticFriction = parameters.staticFriction;
+        record.dynamicFriction = parameters.dynamicFriction;
+        record.restitution = parameters.restitution;
+        record.gpuMaterial = parameters.gpuMaterial;
+
+        const string texture{parameters.diffuseTextureName()};
+        if(!texture.empty()) {
+            record.textureOffset = addName(texture);
+            record.textureLength = (uint32_t)texture.size();
+        }
+
+        result.push_back(record);
+    }
+
+    // Definitions are ordered by name, which keeps equal hashes deterministic.
+    std::stable_sort(result.begin(), result.end(), [](const Record& a, const Record& b) { return a.nameHash < b.nameHash; });
+
+    Header header;
+    header.count = (uint32_t)result.size();
+    header.namesSize = (uint32_t)names.size();
+
+    std::vector<char> data(sizeof(Header) + result.size() * sizeof(Record) + names.size());
+    memcpy(data.data(), &header, sizeof(Header));
+    memcpy(data.data() + sizeof(Header), result.data(), result.size() * sizeof(Record));
+    memcpy(data.data() + sizeof(Header) + result.size() * sizeof(Record), names.data(), names.size());
+
+    return data;
+}
+
+} // namespace raygun
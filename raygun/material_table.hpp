@@ -0,0 +1,71 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#pragma once
+
+#include "raygun/material.hpp"
+
+namespace raygun {
+
+/// Compiled material definitions (.rgmtl), written by compileMaterialTable.
+///
+/// The table holds one fixed-size record per material with inheritance
+/// already flattened, sorted by name hash. It is used in place, e.g. directly
+/// from the resource archive, so looking up a material neither parses JSON
+/// nor loads its bases. All functions are thread-safe.
+class MaterialTable {
+  public:
+    /// Name of the table in the resource archive.
+    static constexpr string_view ARCHIVE_ENTRY = "materials.rgmtl";
+
+    struct Entry {
+        string_view name;
+
+        /// Empty if the material is not based on another one.
+        string_view basedOn;
+
+        MaterialParameters parameters;
+    };
+
+    /// data needs to stay valid as long as the table and be aligned to at
+    /// least 16 bytes. Evaluates to false if data is not a valid table.
+    MaterialTable(const std::byte* data, size_t size);
+
+    explicit operator bool() const { return m_data != nullptr; }
+
+    uint32_t size() const { return m_count; }
+
+    /// Returns std::nullopt if the table does not contain name.
+    std::optional<Entry> find(string_view name) const;
+
+  private:
+    const std::byte* m_data = nullptr;
+    uint32_t m_count = 0;
+};
+
+/// Compiles all material definitions below materialsDir into a
+/// MaterialTable. Materials in subdirectories are named like
+/// ResourceManager::loadMaterial expects, e.g. ui/button.rgmat.json becomes
+/// ui_button. Throws if a definition is invalid or inheritance is cyclic.
+std::vector<char> compileMaterialTable(const fs::path& materialsDir);
+
+} // namespace raygun
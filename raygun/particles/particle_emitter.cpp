@@ -0,0 +1,176 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#include "raygun/particles/particle_emitter.hpp"
+
+#include "raygun/assert.hpp"
+#include "raygun/physics/physics_utils.hpp"
+
+namespace raygun::particles {
+
+ParticleEmitter::ParticleEmitter(EntityHandle owner, const EmitterSettings& settings, std::shared_ptr<render::Model> model)
+    : settings(settings)
+    , m_owner(owner)
+    , m_output(std::make_shared<render::InstanceArray>(std::move(model)))
+    , m_random(std::random_device()())
+{
+}
+
+void ParticleEmitter::clear()
+{
+    for(auto stream: {&m_px, &m_py, &m_pz, &m_vx, &m_vy, &m_vz, &m_age, &m_lifetime}) {
+        stream->clear();
+    }
+
+    m_spawnAccumulator = 0.0f;
+}
+
+void ParticleEmitter::spawn(float timeDelta)
+{
+    m_spawnAccumulator += settings.rate * timeDelta;
+
+    const auto available = settings.maxParticles - std::min<size_t>(size(), settings.maxParticles);
+    const auto count = std::min<size_t>((size_t)m_spawnAccumulator, available);
+    m_spawnAccumulator -= std::floor(m_spawnAccumulator);
+
+    if(count == 0) return;
+
+    std::normal_distribution<float> direction;
+    std::uniform_real_distribution<float> unit;
+    std::uniform_real_distribution<float> lifetime(settings.minLifetime, std::max(settings.minLifetime, settings.maxLifetime));
+
+    const auto randomVector = [&](float length) {
+        const auto v = vec3{direction(m_random), direction(m_random), direction(m_random)};
+        const auto l = glm::length(v);
+        return l > 0.0f ? v * (length * unit(m_random) / l) : v;
+    };
+
+    for(size_t i = 0; i < count; ++i) {
+        const auto position = randomVector(settings.spawnRadius);
+        const auto velocity = settings.velocity + randomVector(settings.spread);
+
+        m_px.push_back(position.x);
+        m_py.push_back(position.y);
+        m_pz.push_back(position.z);
+
+        m_vx.push_back(velocity.x);
+        m_vy.push_back(velocity.y);
+        m_vz.push_back(velocity.z);
+
+        m_age.push_back(0.0f);
+        m_lifetime.push_back(lifetime(m_random));
+    }
+}
+
+ParticleStreams ParticleEmitter::streams(size_t begin, size_t end)
+{
+    RAYGUN_ASSERT(begin <= end && end <= size());
+
+    ParticleStreams result;
+    result.px = m_px.data() + begin;
+    result.py = m_py.data() + begin;
+    result.pz = m_pz.data() + begin;
+    result.vx = m_vx.data() + begin;
+    result.vy = m_vy.data() + begin;
+    result.vz = m_vz.data() + begin;
+    result.age = m_age.data() + begin;
+    result.count = end - begin;
+    return result;
+}
+
+void ParticleEmitter::collide(const physx::PxScene& scene, const Transform& ownerTransform, float timeDelta)
+{
+    using namespace physx;
+
+    const auto inverseRotation = glm::inverse(ownerTransform.rotation);
+    const PxQueryFilterData filter(PxQueryFlag::eSTATIC);
+
+    for(size_t i = 0; i < size(); ++i) {
+        const auto position = ownerTransform.position + glm::rotate(ownerTransform.rotation, ownerTransform.scaling * vec3{m_px[i], m_py[i], m_pz[i]});
+        const auto velocity = glm::rotate(ownerTransform.rotation, ownerTransform.scaling * vec3{m_vx[i], m_vy[i], m_vz[i]});
+
+        // Cast along the distance travelled during this step.
+        const auto distance = glm::length(velocity) * timeDelta;
+        if(distance <= 0.0f) continue;
+
+        const auto direction = velocity * (timeDelta / distance);
+        const auto start = position - direction * distance;
+
+        PxRaycastBuffer hit;
+        if(!scene.raycast(physics::toVec3(start), physics::toVec3(direction), distance, hit, PxHitFlag::ePOSITION | PxHitFlag::eNORMAL, filter)) {
+            continue;
+        }
+
+        const auto& normal = physics::toVec3(hit.block.normal);
+        const auto bounced = glm::reflect(velocity, normal) * settings.restitution;
+        const auto resting = physics::toVec3(hit.block.position) + normal * 0.001f;
+
+        const auto localPosition = glm::rotate(inverseRotation, resting - ownerTransform.position) / ownerTransform.scaling;
+        const auto localVelocity = glm::rotate(inverseRotation, bounced) / ownerTransform.scaling;
+
+        m_px[i] = localPosition.x;
+        m_py[i] = localPosition.y;
+        m_pz[i] = localPosition.z;
+
+        m_vx[i] = localVelocity.x;
+        m_vy[i] = localVelocity.y;
+        m_vz[i] = localVelocity.z;
+    }
+}
+
+void ParticleEmitter::compact()
+{
+    auto count = size();
+
+    for(size_t i = 0; i < count;) {
+        if(m_age[i] < m_lifetime[i]) {
+            ++i;
+            continue;
+        }
+
+        // Move the last particle into the expired slot.
+        --count;
+        for(auto stream: {&m_px, &m_py, &m_pz, &m_vx, &m_vy, &m_vz, &m_age, &m_lifetime}) {
+            (*stream)[i] = (*stream)[count];
+        }
+    }
+
+    for(auto stream: {&m_px, &m_py, &m_pz, &m_vx, &m_vy, &m_vz, &m_age, &m_lifetime}) {
+        stream->resize(count);
+    }
+}
+
+void ParticleEmitter::writeOutput()
+{
+    const auto count = size();
+    const auto scaling = vec3(settings.size);
+
+    auto* transforms = m_output->writeTransforms(count);
+    for(size_t i = 0; i < count; ++i) {
+        transforms[i].position = {m_px[i], m_py[i], m_pz[i]};
+        transforms[i].rotation = glm::identity<quat>();
+        transforms[i].scaling = scaling;
+    }
+}
+
+} // namespace raygun::particles
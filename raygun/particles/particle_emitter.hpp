@@ -0,0 +1,109 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "raygun/change_journal.hpp"
+#include "raygun/particles/particle_simulation.hpp"
+#include "raygun/render/instance_array.hpp"
+
+namespace raygun::particles {
+
+struct EmitterSettings {
+    /// Particles spawned per second.
+    float rate = 100.0f;
+    uint32_t maxParticles = 10000;
+
+    float minLifetime = 1.0f;
+    float maxLifetime = 2.0f;
+
+    /// Particles spawn within this radius around the emitter.
+    float spawnRadius = 0.0f;
+
+    /// Initial velocity, randomized by up to spread in every direction.
+    vec3 velocity = {0.0f, 2.0f, 0.0f};
+    float spread = 0.5f;
+
+    float size = 0.05f;
+
+    /// Given in world space.
+    vec3 gravity = {0.0f, -9.81f, 0.0f};
+    float drag = 0.1f;
+
+    float curlStrength = 0.0f;
+    float curlFrequency = 1.0f;
+
+    /// Collide particles with static physics geometry. Each particle casts
+    /// one ray per frame, only use for moderate particle counts.
+    bool collide = false;
+    float restitution = 0.3f;
+};
+
+/// Simulates particles in the local space of its entity and renders them as
+/// instances of a small shared model, see ParticleSystem::attachEmitter.
+class ParticleEmitter {
+  public:
+    ParticleEmitter(EntityHandle owner, const EmitterSettings& settings, std::shared_ptr<render::Model> model);
+
+    EntityHandle owner() const { return m_owner; }
+
+    /// Instance array the particles are rendered with, assigned to the
+    /// owning entity.
+    const render::InstanceArrayPtr& output() const { return m_output; }
+
+    size_t size() const { return m_age.size(); }
+
+    void clear();
+
+    EmitterSettings settings;
+
+  private:
+    friend class ParticleSystem;
+
+    void spawn(float timeDelta);
+
+    ParticleStreams streams(size_t begin, size_t end);
+
+    void collide(const physx::PxScene& scene, const Transform& ownerTransform, float timeDelta);
+
+    /// Removes expired particles.
+    void compact();
+
+    void writeOutput();
+
+    EntityHandle m_owner;
+
+    render::InstanceArrayPtr m_output;
+
+    std::vector<float> m_px, m_py, m_pz;
+    std::vector<float> m_vx, m_vy, m_vz;
+    std::vector<float> m_age, m_lifetime;
+
+    float m_spawnAccumulator = 0.0f;
+
+    std::mt19937 m_random;
+};
+
+using ParticleEmitterPtr = std::shared_ptr<ParticleEmitter>;
+
+} // namespace raygun::particles
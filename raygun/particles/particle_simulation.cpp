@@ -0,0 +1,157 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#include "raygun/particles/particle_simulation.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define RAYGUN_PARTICLES_SSE 1
+    #include <immintrin.h>
+#else
+    #define RAYGUN_PARTICLES_SSE 0
+#endif
+
+namespace raygun::particles {
+
+namespace {
+
+    constexpr float PI = 3.14159265f;
+    constexpr float TWO_PI = 2.0f * PI;
+    constexpr float INV_TWO_PI = 1.0f / TWO_PI;
+
+    // Parabolic sine approximation, max error ~0.001. Accurate enough for
+    // noise and cheap to vectorize.
+    constexpr float SIN_B = 4.0f / PI;
+    constexpr float SIN_C = -4.0f / (PI * PI);
+    constexpr float SIN_P = 0.225f;
+
+    inline float fastSin(float x)
+    {
+        x -= TWO_PI * std::nearbyint(x * INV_TWO_PI);
+
+        const auto y = SIN_B * x + SIN_C * x * std::abs(x);
+        return SIN_P * (y * std::abs(y) - y) + y;
+    }
+
+    // The curl noise acceleration is strength * (cos(f y + t), cos(f z + t),
+    // cos(f x + t)), the curl of the vector potential (sin(f z + t),
+    // sin(f x + t), sin(f y + t)) / f. Cosines are evaluated as sines shifted
+    // by a quarter turn.
+
+    void integrateScalar(const ParticleStreams& p, const IntegrationParams& params, size_t begin)
+    {
+        const auto dt = params.timeDelta;
+        const auto damping = std::max(0.0f, 1.0f - params.drag * dt);
+        const auto f = params.curlFrequency;
+        const auto t = params.time + 0.5f * PI;
+
+        for(auto i = begin; i < p.count; ++i) {
+            const auto ax = params.gravity.x + params.curlStrength * fastSin(f * p.py[i] + t);
+            const auto ay = params.gravity.y + params.curlStrength * fastSin(f * p.pz[i] + t);
+            const auto az = params.gravity.z + params.curlStrength * fastSin(f * p.px[i] + t);
+
+            p.vx[i] = (p.vx[i] + ax * dt) * damping;
+            p.vy[i] = (p.vy[i] + ay * dt) * damping;
+            p.vz[i] = (p.vz[i] + az * dt) * damping;
+
+            p.px[i] += p.vx[i] * dt;
+            p.py[i] += p.vy[i] * dt;
+            p.pz[i] += p.vz[i] * dt;
+
+            p.age[i] += dt;
+        }
+    }
+
+#if RAYGUN_PARTICLES_SSE
+    inline __m128 fastSin(__m128 x)
+    {
+        const auto signMask = _mm_set1_ps(-0.0f);
+
+        const auto turns = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(INV_TWO_PI))));
+        x = _mm_sub_ps(x, _mm_mul_ps(turns, _mm_set1_ps(TWO_PI)));
+
+        const auto absX = _mm_andnot_ps(signMask, x);
+        const auto y = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(SIN_B), x), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(SIN_C), x), absX));
+
+        const auto absY = _mm_andnot_ps(signMask, y);
+        return _mm_add_ps(_mm_mul_ps(_mm_set1_ps(SIN_P), _mm_sub_ps(_mm_mul_ps(y, absY), y)), y);
+    }
+
+    /// Processes particles in groups of four, returns the number processed.
+    size_t integrateSSE(const ParticleStreams& p, const IntegrationParams& params)
+    {
+        const auto dt = _mm_set1_ps(params.timeDelta);
+        const auto damping = _mm_set1_ps(std::max(0.0f, 1.0f - params.drag * params.timeDelta));
+        const auto f = _mm_set1_ps(params.curlFrequency);
+        const auto t = _mm_set1_ps(params.time + 0.5f * PI);
+        const auto strength = _mm_set1_ps(params.curlStrength);
+
+        const auto gx = _mm_set1_ps(params.gravity.x);
+        const auto gy = _mm_set1_ps(params.gravity.y);
+        const auto gz = _mm_set1_ps(params.gravity.z);
+
+        const auto end = p.count & ~size_t(3);
+
+        for(size_t i = 0; i < end; i += 4) {
+            auto px = _mm_loadu_ps(p.px + i);
+            auto py = _mm_loadu_ps(p.py + i);
+            auto pz = _mm_loadu_ps(p.pz + i);
+
+            const auto ax = _mm_add_ps(gx, _mm_mul_ps(strength, fastSin(_mm_add_ps(_mm_mul_ps(f, py), t))));
+            const auto ay = _mm_add_ps(gy, _mm_mul_ps(strength, fastSin(_mm_add_ps(_mm_mul_ps(f, pz), t))));
+            const auto az = _mm_add_ps(gz, _mm_mul_ps(strength, fastSin(_mm_add_ps(_mm_mul_ps(f, px), t))));
+
+            const auto vx = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(p.vx + i), _mm_mul_ps(ax, dt)), damping);
+            const auto vy = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(p.vy + i), _mm_mul_ps(ay, dt)), damping);
+            const auto vz = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(p.vz + i), _mm_mul_ps(az, dt)), damping);
+
+            _mm_storeu_ps(p.vx + i, vx);
+            _mm_storeu_ps(p.vy + i, vy);
+            _mm_storeu_ps(p.vz + i, vz);
+
+            _mm_storeu_ps(p.px + i, _mm_add_ps(px, _mm_mul_ps(vx, dt)));
+            _mm_storeu_ps(p.py + i, _mm_add_ps(py, _mm_mul_ps(vy, dt)));
+            _mm_storeu_ps(p.pz + i, _mm_add_ps(pz, _mm_mul_ps(vz, dt)));
+
+            _mm_storeu_ps(p.age + i, _mm_add_ps(_mm_loadu_ps(p.age + i), dt));
+        }
+
+        return end;
+    }
+#endif
+
+} // namespace
+
+void integrateParticles(const ParticleStreams& particles, const IntegrationParams& params, bool simd)
+{
+    size_t done = 0;
+
+#if RAYGUN_PARTICLES_SSE
+    if(simd) done = integrateSSE(particles, params);
+#else
+    (void)simd;
+#endif
+
+    integrateScalar(particles, params, done);
+}
+
+} // namespace raygun::particles
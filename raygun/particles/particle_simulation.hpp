@@ -0,0 +1,69 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#pragma once
+
+namespace raygun::particles {
+
+/// Structure of arrays view onto count particles. Positions and velocities
+/// are updated in place.
+struct ParticleStreams {
+    float* px = nullptr;
+    float* py = nullptr;
+    float* pz = nullptr;
+
+    float* vx = nullptr;
+    float* vy = nullptr;
+    float* vz = nullptr;
+
+    float* age = nullptr;
+
+    size_t count = 0;
+};
+
+struct IntegrationParams {
+    vec3 gravity = {};
+
+    /// Fraction of velocity lost per second.
+    float drag = 0.0f;
+
+    /// Strength and spatial frequency of the curl noise field. The field is
+    /// divergence free, particles swirl without bunching up.
+    float curlStrength = 0.0f;
+    float curlFrequency = 1.0f;
+
+    /// Animates the curl noise field.
+    float time = 0.0f;
+
+    float timeDelta = 0.0f;
+};
+
+/// Particles per task when integrating in parallel.
+constexpr size_t PARTICLE_CHUNK_SIZE = 1 << 16;
+
+/// Integrates velocity and position of all particles using semi-implicit
+/// Euler and advances their age. Uses SSE when available, unless simd is
+/// false, e.g. to compare against the scalar path.
+void integrateParticles(const ParticleStreams& particles, const IntegrationParams& params, bool simd = true);
+
+} // namespace raygun::particles
@@ -0,0 +1,115 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#include "raygun/particles/particle_system.hpp"
+
+#include "raygun/raygun.hpp"
+#include "raygun/utils/parallel_for.hpp"
+
+namespace raygun::particles {
+
+ParticleEmitterPtr ParticleSystem::attachEmitter(Entity& entity, const EmitterSettings& settings, std::shared_ptr<render::Model> model)
+{
+    auto emitter = std::make_shared<ParticleEmitter>(entity.handle(), settings, std::move(model));
+    entity.instances = emitter->output();
+
+    return m_emitters.emplace_back(std::move(emitter));
+}
+
+void ParticleSystem::update(double timeDelta)
+{
+    const auto start = Clock::now();
+
+    auto& scene = RG().scene();
+
+    m_time += timeDelta;
+
+    const auto detached = [](const ParticleEmitterPtr& emitter) {
+        const auto* entity = Entity::resolve(emitter->owner());
+        return !entity || entity->instances.get() != emitter->output().get();
+    };
+    m_emitters.erase(std::remove_if(m_emitters.begin(), m_emitters.end(), detached), m_emitters.end());
+
+    struct Active {
+        ParticleEmitter* emitter;
+        Transform ownerTransform;
+        IntegrationParams params;
+    };
+
+    std::vector<Active> active;
+
+    for(const auto& emitter: m_emitters) {
+        const auto& entity = *Entity::resolve(emitter->owner());
+        if(entity.journal() != &scene.journal) continue;
+
+        const auto ownerTransform = entity.globalTransform();
+        const auto& settings = emitter->settings;
+
+        // Particles live in the emitter's local space.
+        IntegrationParams params;
+        params.gravity = glm::rotate(glm::inverse(ownerTransform.rotation), settings.gravity) / ownerTransform.scaling;
+        params.drag = settings.drag;
+        params.curlStrength = settings.curlStrength;
+        params.curlFrequency = settings.curlFrequency;
+        params.time = (float)m_time;
+        params.timeDelta = (float)timeDelta;
+
+        emitter->spawn((float)timeDelta);
+
+        active.push_back({emitter.get(), ownerTransform, params});
+    }
+
+    std::vector<std::pair<size_t, size_t>> chunks;
+    for(size_t i = 0; i < active.size(); ++i) {
+        for(size_t begin = 0; begin < active[i].emitter->size(); begin += PARTICLE_CHUNK_SIZE) {
+            chunks.emplace_back(i, begin);
+        }
+    }
+
+    utils::parallelFor(chunks.size(), [&](size_t index) {
+        const auto [i, begin] = chunks[index];
+        auto& emitter = *active[i].emitter;
+
+        integrateParticles(emitter.streams(begin, std::min(begin + PARTICLE_CHUNK_SIZE, emitter.size())), active[i].params);
+    });
+
+    utils::parallelFor(active.size(), [&](size_t i) {
+        auto& emitter = *active[i].emitter;
+
+        if(emitter.settings.collide) {
+            emitter.collide(*scene.pxScene, active[i].ownerTransform, (float)timeDelta);
+        }
+
+        emitter.compact();
+        emitter.writeOutput();
+    });
+
+    m_particleCount = 0;
+    for(const auto& a: active) {
+        m_particleCount += a.emitter->size();
+    }
+
+    m_lastUpdateTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+} // namespace raygun::particles
@@ -0,0 +1,58 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "raygun/entity.hpp"
+#include "raygun/particles/particle_emitter.hpp"
+
+namespace raygun::particles {
+
+/// Updates all particle emitters of the active scene. Emitters are simulated
+/// in parallel, large emitters are additionally split into chunks.
+class ParticleSystem {
+  public:
+    /// Attaches a new emitter to entity, the particles are rendered as
+    /// instances of model via Entity::instances. The emitter is dropped once
+    /// the entity is destroyed or its instances are replaced.
+    ParticleEmitterPtr attachEmitter(Entity& entity, const EmitterSettings& settings, std::shared_ptr<render::Model> model);
+
+    void update(double timeDelta);
+
+    size_t particleCount() const { return m_particleCount; }
+
+    /// Duration of the last update in milliseconds.
+    double lastUpdateTime() const { return m_lastUpdateTime; }
+
+  private:
+    std::vector<ParticleEmitterPtr> m_emitters;
+
+    double m_time = 0.0;
+
+    size_t m_particleCount = 0;
+    double m_lastUpdateTime = 0.0;
+};
+
+using UniqueParticleSystem = std::unique_ptr<ParticleSystem>;
+
+} // namespace raygun::particles
@@ -69,6 +69,7 @@ UniqueScene PhysicsSystem::createScene()
     desc.cpuDispatcher = m_dispatcher.get();
     desc.filterShader = filterShader;
     desc.flags |= PxSceneFlag::eENABLE_ENHANCED_DETERMINISM;
+    desc.flags |= PxSceneFlag::eENABLE_ACTIVE_ACTORS;
 
     const auto scene = m_physics->createScene(desc);
 
@@ -87,6 +88,13 @@ UniqueScene PhysicsSystem::createScene()
 }
 
 namespace {
+    /// Mesh used for cooking collision shapes, see the physicsLod config option.
+    const render::Mesh& collisionMesh(const render::Model& model)
+    {
+        const auto level = (uint32_t)std::max(RG().config().physicsLod, 0);
+        return model.meshForLod(std::min(level, model.lodCount() - 1));
+    }
+
     void attachShape(PxRigidActor& actor, const Entity& entity, bool isTrigger, GeometryType geometryType, const PxMaterial& material)
     {
         auto flags = PxShapeFlag::eVISUALIZATION | PxShapeFlag::eSCENE_QUERY_SHAPE | PxShapeFlag::eSIMULATION_SHAPE;
@@ -112,13 +120,13 @@ namespace {
             break;
         }
         case GeometryType::ConvexMesh: {
-            const auto convexMesh = RG().physicsSystem().createConvexMesh(*entity.model->mesh);
+            const auto convexMesh = RG().physicsSystem().createConvexMesh(collisionMesh(*entity.model));
             PxConvexMeshGeometry geometry(convexMesh.get(), PxMeshScale(toVec3(entity.transform().scaling)));
             PxRigidActorExt::createExclusiveShape(actor, geometry, material, flags);
             break;
         }
         case GeometryType::TriangleMesh: {
-            const auto triangleMesh = RG().physicsSystem().createTriangleMesh(*entity.model->mesh);
+            const auto triangleMesh = RG().physicsSystem().createTriangleMesh(collisionMesh(*entity.model));
             const auto materials = collectPhysicsMaterials(entity.model->materials);
             PxTriangleMeshGeometry geometry(triangleMesh.get(), PxMeshScale(toVec3(entity.transform().scaling)));
             PxRigidActorExt::createExclusiveShape(actor, geometry, materials.data(), (PxU16)materials.size(), flags);
@@ -246,21 +254,53 @@ void PhysicsSystem::update(double timeDelta)
 
     simulate(*scene.pxScene, (float)timeDelta);
 
-    // Update transforms
-    scene.root->forEachEntity([&](Entity& entity) {
-        if(!entity.physicsActor) return;
+    // Update transforms, only actors which moved during the last simulation
+    // step are reported. Static entities are never written back.
+    PxU32 activeCount = 0;
+    const auto activeActors = scene.pxScene->getActiveActors(activeCount);
 
-        auto* actor = entity.physicsActor.get();
-        if (actor && actor->is<PxRigidDynamic>()) {
-            auto* rigidDynamic = static_cast<PxRigidDynamic*>(actor);
-            auto transform = physics::toTransform(rigidDynamic->getGlobalPose(), entity.transform().scaling);
-            entity.setTransform(entity.parentTransform().inverse() * transform);
-        }
-    });
+    for(PxU32 i = 0; i < activeCount; ++i) {
+        auto* rigidDynamic = activeActors[i]->is<PxRigidDynamic>();
+        if(!rigidDynamic) continue;
+
+        auto& entity = *static_cast<Entity*>(rigidDynamic->userData);
+        if(entity.mobility() == Mobility::Static) continue;
+
+        auto transform = physics::toTransform(rigidDynamic->getGlobalPose(), entity.transform().scaling);
+        entity.setTransform(entity.parentTransform().inverse() * transform);
+    }
 }
 
 void PhysicsSystem::connectActorsToScene(Scene& scene)
 {
+    const auto incremental = scene.journal.consume(m_journalCursor, [&](const ChangeRecord& record) {
+        switch(record.kind) {
+        case ChangeKind::Added:
+        case ChangeKind::Removed:
+        case ChangeKind::PhysicsAttached:
+            break;
+        default:
+            return;
+        }
+
+        // Actors of destroyed entities have already been released, which also
+        // removes them from the physics scene.
+        auto* entity = Entity::resolve(record.entity);
+        if(!entity || !entity->physicsActor) return;
+
+        auto& actor = *entity->physicsActor;
+        const auto inScene = entity->journal() == &scene.journal;
+
+        if(inScene && !actor.getScene()) {
+            scene.pxScene->addActor(actor);
+        }
+        else if(!inScene && actor.getScene() == scene.pxScene.get()) {
+            scene.pxScene->removeActor(actor);
+        }
+    });
+
+    if(incremental) return;
+
     auto actors = getActors(*scene.pxScene);
 
     // Ensure all entities with physics actors are connected with the physics
@@ -98,6 +98,8 @@ class PhysicsSystem {
 
     bool m_paused = false;
 
+    ChangeJournal::Cursor m_journalCursor;
+
     void connectActorsToScene(Scene& scene);
 };
 
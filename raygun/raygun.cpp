@@ -25,6 +25,7 @@
 #include "raygun/assert.hpp"
 #include "raygun/info.hpp"
 #include "raygun/logging.hpp"
+#include "raygun/render/static_batching.hpp"
 #include "raygun/ui/ui.hpp"
 
 namespace raygun {
@@ -68,6 +69,12 @@ Raygun::Raygun(string_view title, UniqueConfig config)
     m_audioSystem = std::make_unique<audio::AudioSystem>();
     m_audioSystem->setupDefaultSources();
 
+    m_particleSystem = std::make_unique<particles::ParticleSystem>();
+
+    if(m_config->hotReload) {
+        m_hotReload = std::make_unique<HotReload>();
+    }
+
     loadScene(std::make_unique<Scene>());
 
     RAYGUN_INFO(RAYGUN_NAME " initialized");
@@ -105,10 +112,16 @@ void Raygun::loop()
 
         m_profiler->startFrame();
 
+        m_resourceManager->update();
+
         if(m_nextScene) {
             finalizeLoadScene();
         }
 
+        if(m_hotReload) {
+            m_hotReload->update();
+        }
+
         m_renderSystem->preSimulation();
 
         m_scene->preSimulation();
@@ -127,9 +140,13 @@ void Raygun::loop()
 
         m_scene->update(timeDelta);
 
+        m_particleSystem->update(timeDelta);
+
         m_audioSystem->update();
 
         m_renderSystem->render(*m_scene);
+
+        m_scene->journal.compact();
     }
 
     RAYGUN_INFO("End main loop");
@@ -232,6 +249,15 @@ audio::AudioSystem& Raygun::audioSystem()
     return *m_audioSystem;
 }
 
+particles::ParticleSystem& Raygun::particleSystem()
+{
+    if(!m_particleSystem) {
+        RAYGUN_FATAL("Particle system not set");
+    }
+
+    return *m_particleSystem;
+}
+
 ResourceManager& Raygun::resourceManager()
 {
     if(!m_resourceManager) {
@@ -282,6 +308,12 @@ void Raygun::finalizeLoadScene()
     std::swap(m_scene, m_nextScene);
     m_nextScene.reset();
 
+    if(m_config->staticBatching) {
+        render::batchStaticGeometry(*m_scene);
+    }
+
+    m_scene->journal.setSceneLoaded();
+
     m_resourceManager->clearUnusedModelsAndMaterials();
 
     m_renderSystem->resetUniformBuffer();
@@ -289,6 +321,8 @@ void Raygun::finalizeLoadScene()
     m_renderSystem->setupModelBuffers();
     m_renderSystem->raytracer().setupBottomLevelAS();
 
+    m_resourceManager->telemetry().sceneLoaded();
+
     m_timestamp = Clock::now();
 
     m_scene->camera->updateProjection();
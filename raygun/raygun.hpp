@@ -25,8 +25,10 @@
 #include "raygun/audio/audio_system.hpp"
 #include "raygun/compute/compute_system.hpp"
 #include "raygun/config.hpp"
+#include "raygun/hot_reload.hpp"
 #include "raygun/info.hpp"
 #include "raygun/input/input_system.hpp"
+#include "raygun/particles/particle_system.hpp"
 #include "raygun/physics/physics_system.hpp"
 #include "raygun/profiler.hpp"
 #include "raygun/render/render_system.hpp"
@@ -73,6 +75,8 @@ class Raygun {
 
     audio::AudioSystem& audioSystem();
 
+    particles::ParticleSystem& particleSystem();
+
     ResourceManager& resourceManager();
 
     Scene& scene();
@@ -104,8 +108,12 @@ class Raygun {
 
     audio::UniqueAudioSystem m_audioSystem;
 
+    particles::UniqueParticleSystem m_particleSystem;
+
     UniqueResourceManager m_resourceManager;
 
+    UniqueHotReload m_hotReload;
+
     UniqueScene m_scene;
     UniqueScene m_nextScene;
 
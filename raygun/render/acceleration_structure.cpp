@@ -24,71 +24,35 @@
 
 #include "raygun/gpu/gpu_utils.hpp"
 #include "raygun/raygun.hpp"
-#include "raygun/render/model.hpp"
-#include "raygun/scene.hpp"
+#include "raygun/render/instance_table.hpp"
 
 namespace raygun::render {
 
-namespace {
-
-    vk::AccelerationStructureInstanceKHR instanceFromEntity(vk::Device device, const Entity& entity, uint32_t instanceId)
-    {
-        RAYGUN_ASSERT(entity.model->bottomLevelAS);
-
-        vk::AccelerationStructureInstanceKHR instance = {};
-        instance.setInstanceCustomIndex(instanceId);
-        instance.setMask(0xff);
-        instance.setFlags(vk::GeometryInstanceFlagBitsKHR::eTriangleCullDisable);
-
-        // 3x4 row-major affine transformation matrix.
-        const auto transform = glm::transpose(entity.globalTransform().toMat4());
-        instance.transform.matrix = *reinterpret_cast<const vk::ArrayWrapper2D<float, 3, 4>*>(&transform);
-
-        const auto blasAddress = device.getAccelerationStructureAddressKHR({vk::AccelerationStructureKHR(*entity.model->bottomLevelAS)});
-        instance.setAccelerationStructureReference(blasAddress);
-
-        return instance;
-    }
-
-} // namespace
-
-TopLevelAS::TopLevelAS(const vk::CommandBuffer& cmd, const Scene& scene)
+void TopLevelAS::build(const vk::CommandBuffer& cmd, const InstanceTable& instanceTable)
 {
     VulkanContext& vc = RG().vc();
 
-    std::vector<vk::AccelerationStructureInstanceKHR> instances;
-    std::vector<InstanceOffsetTableEntry> instanceOffsetTable;
-
-    // Grab instances from scene.
-    scene.root->forEachEntity([&](const Entity& entity) {
-        // if set to invisible, do not descend to children
-        if(!entity.isVisible()) return false;
-
-        if(entity.transform().isZeroVolume()) return false;
+    const auto entityCount = (uint32_t)instanceTable.instances().size();
+    const auto arrayCount = (uint32_t)instanceTable.arrayInstances().size();
+    const auto count = entityCount + arrayCount;
 
-        // if no model, then we skip this, but might still render children
-        if(!entity.model) return true;
+    // Freshly allocated buffers need a full upload.
+    const auto fullUpload = reserve(count);
 
-        const auto instance = instanceFromEntity(*vc.device, entity, (uint32_t)instances.size());
-        instances.push_back(instance);
+    auto* mappedInstances = static_cast<vk::AccelerationStructureInstanceKHR*>(m_instances->map());
+    auto* mappedOffsets = static_cast<InstanceOffsetTableEntry*>(m_instanceOffsetTable->map());
 
-        const auto& vertexBufferRef = entity.model->mesh->vertexBufferRef;
-        const auto& indexBufferRef = entity.model->mesh->indexBufferRef;
-        const auto& materialBufferRef = entity.model->materialBufferRef;
+    // Copies elements [first, end) of both tables to the given position.
+    const auto upload = [&](const auto& instances, const auto& offsetTable, uint32_t first, uint32_t position) {
+        const auto size = (uint32_t)instances.size();
+        if(first >= size) return;
 
-        auto& entry = instanceOffsetTable.emplace_back();
-        entry.vertexBufferOffset = vertexBufferRef.offsetInElements();
-        entry.indexBufferOffset = indexBufferRef.offsetInElements();
-        entry.materialBufferOffset = materialBufferRef.offsetInElements();
+        memcpy(mappedInstances + position + first, instances.data() + first, (size - first) * sizeof(instances[0]));
+        memcpy(mappedOffsets + position + first, offsetTable.data() + first, (size - first) * sizeof(offsetTable[0]));
+    };
 
-        return true;
-    });
-
-    m_instances = gpu::copyToBuffer(instances, vk::BufferUsageFlagBits::eShaderDeviceAddress);
-    m_instances->setName("TLAS Instances");
-
-    m_instanceOffsetTable = gpu::copyToBuffer(instanceOffsetTable, vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress);
-    m_instanceOffsetTable->setName("Instance Offset Table");
+    upload(instanceTable.instances(), instanceTable.offsetTable(), fullUpload ? 0u : instanceTable.firstDirty(), 0);
+    upload(instanceTable.arrayInstances(), instanceTable.arrayOffsetTable(), fullUpload ? 0u : instanceTable.arrayFirstDirty(), entityCount);
 
     vk::AccelerationStructureGeometryInstancesDataKHR instancesData = {};
     instancesData.setData(m_instances->address());
@@ -105,49 +69,78 @@ TopLevelAS::TopLevelAS(const vk::CommandBuffer& cmd, const Scene& scene)
     buildInfo.setGeometryCount(1);
     buildInfo.setType(vk::AccelerationStructureTypeKHR::eTopLevel);
 
-    const auto buildSize =
-        vc.device->getAccelerationStructureBuildSizesKHR(vk::AccelerationStructureBuildTypeKHR::eDevice, buildInfo, (uint32_t)instances.size());
+    const auto buildSize = vc.device->getAccelerationStructureBuildSizesKHR(vk::AccelerationStructureBuildTypeKHR::eDevice, buildInfo, count);
 
-    vk::AccelerationStructureCreateInfoKHR createInfo = {};
-    createInfo.setType(vk::AccelerationStructureTypeKHR::eTopLevel);
-    createInfo.setSize(buildSize.accelerationStructureSize);
+    // The structure is only recreated if it outgrew its memory.
+    if(!m_structure || buildSize.accelerationStructureSize > m_structureMemory->size()) {
+        vk::AccelerationStructureCreateInfoKHR createInfo = {};
+        createInfo.setType(vk::AccelerationStructureTypeKHR::eTopLevel);
+        createInfo.setSize(buildSize.accelerationStructureSize);
 
-    m_structureMemory = std::make_unique<gpu::Buffer>(buildSize.accelerationStructureSize,
-                                                      vk::BufferUsageFlagBits::eAccelerationStructureStorageKHR | vk::BufferUsageFlagBits::eShaderDeviceAddress,
-                                                      vk::MemoryPropertyFlagBits::eDeviceLocal);
-    m_structureMemory->setName("TLAS Structure Memory");
-    createInfo.setBuffer(*m_structureMemory);
+        m_structureMemory = std::make_unique<gpu::Buffer>(buildSize.accelerationStructureSize,
+                                                          vk::BufferUsageFlagBits::eAccelerationStructureStorageKHR | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                                                          vk::MemoryPropertyFlagBits::eDeviceLocal);
+        m_structureMemory->setName("TLAS Structure Memory");
+        createInfo.setBuffer(*m_structureMemory);
 
-    m_structure = vc.device->createAccelerationStructureKHRUnique(createInfo);
-    vc.setObjectName(*m_structure, "TLAS Structure");
+        m_structure = vc.device->createAccelerationStructureKHRUnique(createInfo);
+        vc.setObjectName(*m_structure, "TLAS Structure");
+
+        m_descriptorInfo.setAccelerationStructureCount(1);
+        m_descriptorInfo.setPAccelerationStructures(&*m_structure);
+    }
     buildInfo.setDstAccelerationStructure(*m_structure);
 
-    m_scratch =
-        std::make_unique<gpu::Buffer>(buildSize.buildScratchSize, vk::BufferUsageFlagBits::eShaderDeviceAddress | vk::BufferUsageFlagBits::eStorageBuffer,
-                                      vk::MemoryPropertyFlagBits::eDeviceLocal);
-    m_scratch->setName("TLAS Scratch");
+    if(!m_scratch || buildSize.buildScratchSize > m_scratch->size()) {
+        m_scratch =
+            std::make_unique<gpu::Buffer>(buildSize.buildScratchSize, vk::BufferUsageFlagBits::eShaderDeviceAddress | vk::BufferUsageFlagBits::eStorageBuffer,
+                                          vk::MemoryPropertyFlagBits::eDeviceLocal);
+        m_scratch->setName("TLAS Scratch");
+    }
     buildInfo.setScratchData(m_scratch->address());
 
     vk::AccelerationStructureBuildRangeInfoKHR offset = {};
-    offset.setPrimitiveCount((uint32_t)instances.size());
+    offset.setPrimitiveCount(count);
 
     cmd.buildAccelerationStructuresKHR(buildInfo, &offset);
+}
 
-    m_descriptorInfo.setAccelerationStructureCount(1);
-    m_descriptorInfo.setPAccelerationStructures(&*m_structure);
+bool TopLevelAS::reserve(uint32_t count)
+{
+    if(m_instances && count <= m_capacity) return false;
+
+    constexpr auto memoryProperties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+
+    m_capacity = std::max({count, m_capacity * 2, 64u});
+
+    m_instances = std::make_unique<gpu::Buffer>(m_capacity * sizeof(vk::AccelerationStructureInstanceKHR),
+                                                vk::BufferUsageFlagBits::eShaderDeviceAddress, memoryProperties);
+    m_instances->setName("TLAS Instances");
+
+    m_instanceOffsetTable = std::make_unique<gpu::Buffer>(m_capacity * sizeof(InstanceOffsetTableEntry),
+                                                          vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+                                                          memoryProperties);
+    m_instanceOffsetTable->setName("Instance Offset Table");
+
+    return true;
 }
 
 BottomLevelAS::BottomLevelAS(const vk::CommandBuffer& cmd, const Mesh& mesh)
 {
     VulkanContext& vc = RG().vc();
 
+    // Compressed positions are normalized to the mesh bounds, the transform
+    // maps them back to object space during the build.
+    const auto compressed = mesh.transformBufferRef.bufferAddress != 0;
+
     vk::AccelerationStructureGeometryTrianglesDataKHR triangles = {};
-    triangles.setVertexFormat(vk::Format::eR32G32B32Sfloat);
+    triangles.setVertexFormat(compressed ? vk::Format::eR16G16B16A16Snorm : vk::Format::eR32G32B32Sfloat);
     triangles.setVertexData(mesh.vertexBufferRef.bufferAddress);
     triangles.setVertexStride(mesh.vertexBufferRef.elementSize);
     triangles.setIndexType(vk::IndexType::eUint32);
     triangles.setIndexData(mesh.indexBufferRef.bufferAddress);
     triangles.setMaxVertex((uint32_t)mesh.vertices.size());
+    triangles.setTransformData(mesh.transformBufferRef.bufferAddress);
 
     vk::AccelerationStructureGeometryDataKHR geometryData = {};
     geometryData.setTriangles(triangles);
@@ -189,6 +182,7 @@ BottomLevelAS::BottomLevelAS(const vk::CommandBuffer& cmd, const Mesh& mesh)
     offset.setPrimitiveCount((uint32_t)mesh.numFaces());
     offset.setPrimitiveOffset(mesh.indexBufferRef.offsetInBytes);
     offset.setFirstVertex(mesh.vertexBufferRef.offsetInElements());
+    offset.setTransformOffset(mesh.transformBufferRef.offsetInBytes);
 
     cmd.buildAccelerationStructuresKHR(buildInfo, &offset);
 }
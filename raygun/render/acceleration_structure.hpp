@@ -25,15 +25,18 @@
 #include "raygun/gpu/gpu_buffer.hpp"
 #include "raygun/render/mesh.hpp"
 
-namespace raygun {
-struct Scene;
-}
-
 namespace raygun::render {
 
+class InstanceTable;
+
+/// Persistent top level AS. Instance buffers and structure memory are kept
+/// across builds and only grow, each build uploads just the dirty range of
+/// the instance table. Since static instances are kept at the front of the
+/// table, their region is not rewritten while only dynamic entities move.
 class TopLevelAS {
   public:
-    TopLevelAS(const vk::CommandBuffer& cmd, const Scene& scene);
+    /// Uploads the dirty range of instanceTable and rebuilds the structure.
+    void build(const vk::CommandBuffer& cmd, const InstanceTable& instanceTable);
 
     operator vk::AccelerationStructureKHR() const { return *m_structure; }
 
@@ -42,8 +45,14 @@ class TopLevelAS {
     const vk::WriteDescriptorSetAccelerationStructureKHR& descriptorInfo() const { return m_descriptorInfo; }
 
   private:
+    /// Reallocates the instance buffers if they cannot hold count instances.
+    /// Returns true if the buffers have been reallocated.
+    bool reserve(uint32_t count);
+
     vk::WriteDescriptorSetAccelerationStructureKHR m_descriptorInfo = {};
 
+    uint32_t m_capacity = 0;
+
     vk::UniqueAccelerationStructureKHR m_structure;
     gpu::UniqueBuffer m_structureMemory;
     gpu::UniqueBuffer m_instances;
@@ -64,6 +73,9 @@ class BottomLevelAS {
 
     operator vk::AccelerationStructureKHR() const { return *m_structure; }
 
+    /// Device memory held by structure and scratch buffer.
+    vk::DeviceSize memorySize() const { return m_structureMemory->size() + m_scratch->size(); }
+
   private:
     vk::UniqueAccelerationStructureKHR m_structure;
     gpu::UniqueBuffer m_structureMemory;
@@ -72,6 +84,9 @@ class BottomLevelAS {
 
 using UniqueBottomLevelAS = std::unique_ptr<BottomLevelAS>;
 
+/// Models sharing a mesh, e.g. text glyphs, share its structure.
+using SharedBottomLevelAS = std::shared_ptr<BottomLevelAS>;
+
 struct InstanceOffsetTableEntry {
     using uint = uint32_t;
 #include "resources/shaders/instance_offset_table.def"
@@ -0,0 +1,736 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "raygun/render/gltf_import.hpp"
+
+#include "raygun/logging.hpp"
+#include "raygun/utils/json_utils.hpp"
+#include "raygun/utils/mapped_file.hpp"
+#include "raygun/utils/parallel_for.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define RAYGUN_GLTF_SSE2 1
+    #include <emmintrin.h>
+#else
+    #define RAYGUN_GLTF_SSE2 0
+#endif
+
+namespace raygun::render {
+
+namespace {
+
+    constexpr uint32_t GLB_MAGIC = 0x46546C67; // "glTF"
+    constexpr uint32_t GLB_VERSION = 2;
+    constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+    constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+    constexpr uint32_t COMPONENT_UNSIGNED_BYTE = 5121;
+    constexpr uint32_t COMPONENT_UNSIGNED_SHORT = 5123;
+    constexpr uint32_t COMPONENT_UNSIGNED_INT = 5125;
+    constexpr uint32_t COMPONENT_FLOAT = 5126;
+
+    constexpr uint32_t MODE_TRIANGLES = 4;
+
+    /// Guards against malformed files with cyclic node hierarchies.
+    constexpr uint32_t MAX_NODE_DEPTH = 256;
+
+    struct ImportError : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    template<typename T>
+    T readAt(const std::byte* data, size_t offset)
+    {
+        T result;
+        memcpy(&result, data + offset, sizeof(T));
+        return result;
+    }
+
+    std::vector<std::byte> decodeBase64(string_view input)
+    {
+        const auto value = [](char c) -> int {
+            if(c >= 'A' && c <= 'Z') return c - 'A';
+            if(c >= 'a' && c <= 'z') return c - 'a' + 26;
+            if(c >= '0' && c <= '9') return c - '0' + 52;
+            if(c == '+') return 62;
+            if(c == '/') return 63;
+            return -1;
+        };
+
+        std::vector<std::byte> result;
+        result.reserve(input.size() / 4 * 3);
+
+        uint32_t bits = 0;
+        int bitCount = 0;
+        for(const auto c: input) {
+            if(c == '=') break;
+
+            const auto v = value(c);
+            if(v < 0) throw ImportError("Invalid base64 data");
+
+            bits = (bits << 6) | (uint32_t)v;
+            bitCount += 6;
+
+            if(bitCount >= 8) {
+                bitCount -= 8;
+                result.push_back(std::byte((bits >> bitCount) & 0xFF));
+            }
+        }
+
+        return result;
+    }
+
+    struct BufferData {
+        const std::byte* data = nullptr;
+        size_t size = 0;
+    };
+
+    /// Strided view of the elements of an accessor.
+    struct Accessor {
+        const std::byte* data = nullptr;
+        size_t count = 0;
+        size_t stride = 0;
+        uint32_t componentType = 0;
+        uint32_t components = 0;
+
+        template<typename T>
+        T get(size_t index, uint32_t component = 0) const
+        {
+            return readAt<T>(data, index * stride + component * sizeof(T));
+        }
+    };
+
+    uint32_t componentSize(uint32_t componentType)
+    {
+        switch(componentType) {
+        case 5120:
+        case COMPONENT_UNSIGNED_BYTE: return 1;
+        case 5122:
+        case COMPONENT_UNSIGNED_SHORT: return 2;
+        case COMPONENT_UNSIGNED_INT:
+        case COMPONENT_FLOAT: return 4;
+        default: throw ImportError(fmt::format("Invalid component type {}", componentType));
+        }
+    }
+
+    uint32_t componentCount(const string& type)
+    {
+        static const std::unordered_map<string, uint32_t> counts = {
+            {"SCALAR", 1}, {"VEC2", 2}, {"VEC3", 3}, {"VEC4", 4}, {"MAT2", 4}, {"MAT3", 9}, {"MAT4", 16},
+        };
+
+        const auto it = counts.find(type);
+        if(it == counts.end()) throw ImportError("Invalid accessor type " + type);
+        return it->second;
+    }
+
+    /// Parsed glTF document with all buffers mapped or decoded.
+    class Document {
+      public:
+        explicit Document(const fs::path& path) : m_file(std::make_unique<io::MappedFile>(path))
+        {
+            if(!*m_file) throw ImportError("Unable to open file");
+
+            const auto* data = m_file->data();
+            const auto size = m_file->size();
+
+            std::optional<BufferData> binChunk;
+
+            if(size >= 12 && readAt<uint32_t>(data, 0) == GLB_MAGIC) {
+                if(readAt<uint32_t>(data, 4) != GLB_VERSION) throw ImportError("Unsupported GLB version");
+
+                // Chunks: JSON first, then an optional binary chunk.
+                size_t offset = 12;
+                while(offset + 8 <= size) {
+                    const auto length = readAt<uint32_t>(data, offset);
+                    const auto type = readAt<uint32_t>(data, offset + 4);
+                    offset += 8;
+
+                    if(length > size - offset) throw ImportError("Truncated GLB chunk");
+
+                    const auto* chunk = reinterpret_cast<const char*>(data + offset);
+                    if(type == GLB_CHUNK_JSON && m_json.is_null()) {
+                        m_json = json::parse(chunk, chunk + length);
+                    }
+                    else if(type == GLB_CHUNK_BIN && !binChunk) {
+                        binChunk = {data + offset, length};
+                    }
+
+                    offset += length;
+                }
+
+                if(m_json.is_null()) throw ImportError("Missing JSON chunk");
+            }
+            else {
+                const auto* text = reinterpret_cast<const char*>(data);
+                m_json = json::parse(text, text + size);
+            }
+
+            const auto asset = m_json.value("asset", json::object());
+            if(asset.value("version", "").rfind("2.", 0) != 0) throw ImportError("Unsupported glTF version");
+
+            for(const auto& buffer: m_json.value("buffers", json::array())) {
+                const size_t byteLength = buffer.at("byteLength");
+
+                BufferData result;
+                if(!buffer.contains("uri")) {
+                    if(!binChunk || !m_buffers.empty()) throw ImportError("Buffer without data");
+                    result = {binChunk->data, binChunk->size};
+                }
+                else {
+                    const string uri = buffer.at("uri");
+                    if(uri.rfind("data:", 0) == 0) {
+                        const auto comma = uri.find(',');
+                        if(comma == string::npos) throw ImportError("Invalid data URI");
+
+                        const auto& decoded = m_decoded.emplace_back(decodeBase64(string_view(uri).substr(comma + 1)));
+                        result = {decoded.data(), decoded.size()};
+                    }
+                    else {
+                        const auto& file = m_externalFiles.emplace_back(std::make_unique<io::MappedFile>(path.parent_path() / uri));
+                        if(!*file) throw ImportError("Unable to open buffer " + uri);
+
+                        result = {file->data(), file->size()};
+                    }
+                }
+
+                if(result.size < byteLength) throw ImportError("Buffer smaller than declared");
+                result.size = byteLength;
+
+                m_buffers.push_back(result);
+            }
+        }
+
+        const json& root() const { return m_json; }
+
+        /// Throws if the accessor is out of bounds or sparse.
+        Accessor accessor(size_t index) const
+        {
+            const auto& accessor = m_json.at("accessors").at(index);
+            if(accessor.contains("sparse")) throw ImportError("Sparse accessors are not supported");
+            if(!accessor.contains("bufferView")) throw ImportError("Accessors without buffer view are not supported");
+
+            const auto& view = m_json.at("bufferViews").at(accessor.at("bufferView").get<size_t>());
+            const auto& buffer = m_buffers.at(view.at("buffer").get<size_t>());
+
+            const auto viewOffset = view.value("byteOffset", size_t{0});
+            const size_t viewLength = view.at("byteLength");
+            if(viewOffset > buffer.size || viewLength > buffer.size - viewOffset) throw ImportError("Buffer view out of bounds");
+
+            Accessor result;
+            result.componentType = accessor.at("componentType");
+            result.components = componentCount(accessor.at("type"));
+            result.count = accessor.at("count");
+
+            const auto elementSize = (size_t)componentSize(result.componentType) * result.components;
+            result.stride = view.value("byteStride", elementSize);
+
+            // Strides are limited to 252 bytes by the specification.
+            if(result.stride < elementSize || result.stride > 252) throw ImportError("Invalid buffer view stride");
+
+            // Ordered to avoid overflows with untrusted counts and offsets.
+            const auto offset = accessor.value("byteOffset", size_t{0});
+            if(result.count > 0) {
+                if(offset > viewLength || elementSize > viewLength - offset) throw ImportError("Accessor out of bounds");
+                if(result.count - 1 > (viewLength - offset - elementSize) / result.stride) throw ImportError("Accessor out of bounds");
+            }
+
+            result.data = buffer.data + viewOffset + offset;
+            return result;
+        }
+
+      private:
+        std::unique_ptr<io::MappedFile> m_file;
+        std::vector<std::unique_ptr<io::MappedFile>> m_externalFiles;
+        std::vector<std::vector<std::byte>> m_decoded;
+
+        json m_json;
+        std::vector<BufferData> m_buffers;
+    };
+
+    Accessor vec3Accessor(const Document& document, size_t index)
+    {
+        const auto result = document.accessor(index);
+        if(result.componentType != COMPONENT_FLOAT || result.components != 3) throw ImportError("Expected float vec3 attribute");
+        return result;
+    }
+
+    /// TEXCOORD_0 attribute, floats or normalized unsigned integers.
+    Accessor texCoordAccessor(const Document& document, size_t index)
+    {
+        const auto result = document.accessor(index);
+        const auto validType =
+            result.componentType == COMPONENT_FLOAT || result.componentType == COMPONENT_UNSIGNED_BYTE || result.componentType == COMPONENT_UNSIGNED_SHORT;
+        if(!validType || result.components != 2) throw ImportError("Expected vec2 texture coordinates");
+        return result;
+    }
+
+    /// Texture coordinates of element i packed as in Vertex::texCoord.
+    uint32_t readTexCoord(const Accessor& texCoords, size_t i)
+    {
+        vec2 result;
+        for(uint32_t c = 0; c < 2; ++c) {
+            switch(texCoords.componentType) {
+            case COMPONENT_UNSIGNED_BYTE: result[c] = texCoords.get<uint8_t>(i, c) / 255.0f; break;
+            case COMPONENT_UNSIGNED_SHORT: result[c] = texCoords.get<uint16_t>(i, c) / 65535.0f; break;
+            default: result[c] = texCoords.get<float>(i, c); break;
+            }
+        }
+        return glm::packHalf2x16(result);
+    }
+
+    /// Writes count vertices from positions and normals, which need to hold
+    /// at least count elements.
+    void convertVertices(const Accessor& positions, const Accessor& normals, uint32_t matIndex, size_t count, Vertex* out)
+    {
+        size_t i = 0;
+
+#if RAYGUN_GLTF_SSE2
+        // Loads four floats per vec3, the fourth belongs to the next element,
+        // so the last element is left to the scalar loop.
+        static_assert(sizeof(Vertex) == 32 && offsetof(Vertex, matIndex) == 12 && offsetof(Vertex, normal) == 16);
+
+        const auto xyzMask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+        const auto matIndexW = _mm_castsi128_ps(_mm_set_epi32((int)matIndex, 0, 0, 0));
+
+        for(; i + 1 < count; ++i) {
+            const auto position = _mm_loadu_ps(reinterpret_cast<const float*>(positions.data + i * positions.stride));
+            const auto normal = _mm_loadu_ps(reinterpret_cast<const float*>(normals.data + i * normals.stride));
+
+            auto* vertex = reinterpret_cast<float*>(out + i);
+            _mm_storeu_ps(vertex, _mm_or_ps(_mm_and_ps(position, xyzMask), matIndexW));
+            _mm_storeu_ps(vertex + 4, _mm_and_ps(normal, xyzMask));
+        }
+#endif
+
+        for(; i < count; ++i) {
+            auto& vertex = out[i];
+            vertex.position = {positions.get<float>(i, 0), positions.get<float>(i, 1), positions.get<float>(i, 2)};
+            vertex.matIndex = matIndex;
+            vertex.normal = {normals.get<float>(i, 0), normals.get<float>(i, 1), normals.get<float>(i, 2)};
+            vertex.texCoord = 0;
+        }
+    }
+
+    uint32_t readIndex(const Accessor& indices, size_t i)
+    {
+        switch(indices.componentType) {
+        case COMPONENT_UNSIGNED_BYTE: return indices.get<uint8_t>(i);
+        case COMPONENT_UNSIGNED_SHORT: return indices.get<uint16_t>(i);
+        default: return indices.get<uint32_t>(i);
+        }
+    }
+
+    /// Returns the indices of a primitive, generated if it has none.
+    std::optional<Accessor> indexAccessor(const Document& document, const json& primitive)
+    {
+        if(!primitive.contains("indices")) return {};
+
+        const auto result = document.accessor(primitive.at("indices"));
+        if(result.components != 1
+           || (result.componentType != COMPONENT_UNSIGNED_BYTE && result.componentType != COMPONENT_UNSIGNED_SHORT
+               && result.componentType != COMPONENT_UNSIGNED_INT)) {
+            throw ImportError("Invalid index accessor");
+        }
+
+        return result;
+    }
+
+    /// A primitive to be collapsed into a node mesh.
+    struct PrimitiveRef {
+        const json* primitive;
+
+        /// Relative to the root node.
+        mat4 transform;
+
+        /// Where the primitive is written to in the node mesh.
+        size_t firstVertex;
+        size_t firstIndex;
+    };
+
+    mat4 localTransform(const json& node)
+    {
+        if(node.contains("matrix")) {
+            const auto& values = node.at("matrix");
+
+            // Column-major, like glm.
+            mat4 result;
+            for(auto i = 0; i < 16; ++i) {
+                result[i / 4][i % 4] = values.at(i);
+            }
+            return result;
+        }
+
+        Transform result;
+
+        if(node.contains("translation")) {
+            result.position = toVec3(node.at("translation"));
+        }
+
+        if(node.contains("rotation")) {
+            const auto& r = node.at("rotation");
+            result.rotation = quat(r.at(3).get<float>(), r.at(0).get<float>(), r.at(1).get<float>(), r.at(2).get<float>());
+        }
+
+        if(node.contains("scale")) {
+            result.scaling = toVec3(node.at("scale"));
+        }
+
+        return result.toMat4();
+    }
+
+    class Importer {
+      public:
+        explicit Importer(const fs::path& path) : m_path(path), m_document(path) {}
+
+        ImportedModel run()
+        {
+            ImportedModel result;
+
+            importMaterials(result);
+
+            const auto roots = rootNodes();
+            const auto& nodes = m_document.root().at("nodes");
+
+            result.nodes.resize(roots.size());
+            utils::parallelFor(roots.size(), [&](size_t i) {
+                const auto& node = nodes.at(roots[i]);
+
+                auto& out = result.nodes[i];
+                out.name = node.value("name", fmt::format("node{}", roots[i]));
+                out.transform = Transform{localTransform(node)};
+                out.mesh = collapseNode(roots[i]);
+            });
+
+            if(m_defaultMaterial) {
+                result.materialNames.emplace_back("default");
+                result.embeddedMaterials.emplace_back();
+            }
+
+            return result;
+        }
+
+      private:
+        void importMaterials(ImportedModel& model)
+        {
+            const auto& materials = m_document.root().value("materials", json::array());
+
+            for(size_t i = 0; i < materials.size(); ++i) {
+                const auto& material = materials[i];
+
+                model.materialNames.push_back(material.value("name", fmt::format("{}_material{}", m_path.stem().string(), i)));
+                model.embeddedMaterials.push_back(materialParameters(material));
+            }
+
+            m_materialCount = (uint32_t)materials.size();
+        }
+
+        /// Maps the metallic-roughness model and common extensions onto the
+        /// parameters of gpu::Material.
+        MaterialParameters materialParameters(const json& material) const
+        {
+            MaterialParameters result;
+            auto& gpuMaterial = result.gpuMaterial;
+
+            const auto pbr = material.value("pbrMetallicRoughness", json::object());
+            const auto baseColor = pbr.value("baseColorFactor", std::vector<float>{1.0f, 1.0f, 1.0f, 1.0f});
+            const auto metallic = pbr.value("metallicFactor", 1.0f);
+
+            gpuMaterial.diffuse = {baseColor.at(0), baseColor.at(1), baseColor.at(2)};
+
+            if(pbr.contains("baseColorTexture")) {
+                const auto name = textureName(pbr.at("baseColorTexture").value("index", size_t{0}));
+                if(!name.empty() && !result.setDiffuseTexture(name)) {
+                    RAYGUN_WARN("Texture name too long: {}", name);
+                }
+            }
+            gpuMaterial.roughness = pbr.value("roughnessFactor", 1.0f);
+            gpuMaterial.reflectivity = metallic;
+
+            // Metals tint their reflections.
+            gpuMaterial.specular = glm::mix(vec3{1.0f}, gpuMaterial.diffuse, metallic);
+
+            if(material.value("alphaMode", "OPAQUE") == "BLEND") {
+                gpuMaterial.transparency = 1.0f - baseColor.at(3);
+            }
+
+            const auto extensions = material.value("extensions", json::object());
+
+            if(extensions.contains("KHR_materials_transmission")) {
+                const auto transmission = extensions.at("KHR_materials_transmission").value("transmissionFactor", 0.0f);
+                gpuMaterial.transparency = std::max(gpuMaterial.transparency, transmission);
+            }
+
+            if(extensions.contains("KHR_materials_ior")) {
+                gpuMaterial.ior = extensions.at("KHR_materials_ior").value("ior", 1.5f);
+            }
+
+            auto emissiveStrength = 1.0f;
+            if(extensions.contains("KHR_materials_emissive_strength")) {
+                emissiveStrength = extensions.at("KHR_materials_emissive_strength").value("emissiveStrength", 1.0f);
+            }
+
+            const auto emissive = material.value("emissiveFactor", std::vector<float>{0.0f, 0.0f, 0.0f});
+            gpuMaterial.emission = std::max({emissive.at(0), emissive.at(1), emissive.at(2)}) * emissiveStrength;
+
+            return result;
+        }
+
+        /// Textures are loaded by name from the textures directory, see
+        /// ResourceManager::loadTexture. The name is the file name of the
+        /// image without extension, images embedded in the file are not
+        /// supported.
+        string textureName(size_t textureIndex) const
+        {
+            const auto& root = m_document.root();
+
+            const auto& texture = root.at("textures").at(textureIndex);
+            if(!texture.contains("source")) return {};
+
+            const auto& image = root.at("images").at(texture.at("source").get<size_t>());
+            const string uri = image.value("uri", "");
+            if(uri.empty() || uri.rfind("data:", 0) == 0) {
+                RAYGUN_WARN("Embedded images are not supported, texture {} of {} is ignored", textureIndex, m_path);
+                return {};
+            }
+
+            return fs::path(uri).stem().string();
+        }
+
+        std::vector<size_t> rootNodes() const
+        {
+            const auto& root = m_document.root();
+
+            const auto scenes = root.value("scenes", json::array());
+            if(!scenes.empty()) {
+                const auto& scene = scenes.at(root.value("scene", size_t{0}));
+                return scene.value("nodes", std::vector<size_t>{});
+            }
+
+            // Without scenes, all nodes which are not children are roots.
+            const auto nodes = root.value("nodes", json::array());
+
+            std::vector<bool> isChild(nodes.size());
+            for(const auto& node: nodes) {
+                for(const auto& child: node.value("children", std::vector<size_t>{})) {
+                    isChild.at(child) = true;
+                }
+            }
+
+            std::vector<size_t> result;
+            for(size_t i = 0; i < nodes.size(); ++i) {
+                if(!isChild[i]) result.push_back(i);
+            }
+            return result;
+        }
+
+        void collectPrimitives(size_t nodeIndex, const mat4& transform, uint32_t depth, std::vector<PrimitiveRef>& out) const
+        {
+            if(depth > MAX_NODE_DEPTH) throw ImportError("Node hierarchy too deep");
+
+            const auto& root = m_document.root();
+            const auto& node = root.at("nodes").at(nodeIndex);
+
+            if(node.contains("mesh")) {
+                const auto& mesh = root.at("meshes").at(node.at("mesh").get<size_t>());
+                for(const auto& primitive: mesh.at("primitives")) {
+                    if(primitive.value("mode", MODE_TRIANGLES) != MODE_TRIANGLES) {
+                        RAYGUN_WARN("Skipping non-triangle primitive of mesh {} in {}", mesh.value("name", ""), m_path);
+                        continue;
+                    }
+
+                    out.push_back({&primitive, transform, 0, 0});
+                }
+            }
+
+            for(const auto& child: node.value("children", std::vector<size_t>{})) {
+                collectPrimitives(child, transform * localTransform(root.at("nodes").at(child)), depth + 1, out);
+            }
+        }
+
+        /// Collapses the meshes below a root node in two passes, sizes are
+        /// determined first so all primitives are written in place.
+        std::shared_ptr<Mesh> collapseNode(size_t nodeIndex)
+        {
+            std::vector<PrimitiveRef> primitives;
+            collectPrimitives(nodeIndex, glm::identity<mat4>(), 0, primitives);
+
+            size_t vertexCount = 0;
+            size_t indexCount = 0;
+            for(auto& ref: primitives) {
+                const auto& attributes = ref.primitive->at("attributes");
+                const auto positions = vec3Accessor(m_document, attributes.at("POSITION"));
+                const auto indices = indexAccessor(m_document, *ref.primitive);
+
+                const auto primitiveIndices = indices ? indices->count : positions.count;
+                if(primitiveIndices % 3 != 0) throw ImportError("Index count not a multiple of three");
+
+                ref.firstVertex = vertexCount;
+                ref.firstIndex = indexCount;
+
+                // Without normals, triangles are flat shaded and share no vertices.
+                vertexCount += attributes.contains("NORMAL") ? positions.count : primitiveIndices;
+                indexCount += primitiveIndices;
+            }
+
+            if(vertexCount > std::numeric_limits<uint32_t>::max()) throw ImportError("Too many vertices");
+
+            auto result = std::make_shared<Mesh>();
+            result->vertices.resize(vertexCount);
+            result->indices.resize(indexCount);
+
+            for(const auto& ref: primitives) {
+                decodePrimitive(ref, *result);
+            }
+
+            return result;
+        }
+
+        void decodePrimitive(const PrimitiveRef& ref, Mesh& mesh)
+        {
+            const auto& primitive = *ref.primitive;
+            const auto& attributes = primitive.at("attributes");
+
+            const auto positions = vec3Accessor(m_document, attributes.at("POSITION"));
+            const auto indices = indexAccessor(m_document, primitive);
+            const auto indexCount = indices ? indices->count : positions.count;
+
+            uint32_t matIndex;
+            if(primitive.contains("material")) {
+                matIndex = primitive.at("material");
+                if(matIndex >= m_materialCount) throw ImportError("Invalid material index");
+            }
+            else {
+                matIndex = m_materialCount;
+                m_defaultMaterial = true;
+            }
+
+            auto* vertices = mesh.vertices.data() + ref.firstVertex;
+            auto* out = mesh.indices.data() + ref.firstIndex;
+
+            const auto index = [&](size_t i) {
+                const auto result = indices ? readIndex(*indices, i) : (uint32_t)i;
+                if(result >= positions.count) throw ImportError("Vertex index out of bounds");
+                return result;
+            };
+
+            std::optional<Accessor> texCoords;
+            if(attributes.contains("TEXCOORD_0")) {
+                texCoords = texCoordAccessor(m_document, attributes.at("TEXCOORD_0"));
+                if(texCoords->count < positions.count) throw ImportError("Missing texture coordinates");
+            }
+
+            if(attributes.contains("NORMAL")) {
+                const auto normals = vec3Accessor(m_document, attributes.at("NORMAL"));
+                if(normals.count < positions.count) throw ImportError("Missing normals");
+
+                convertVertices(positions, normals, matIndex, positions.count, vertices);
+
+                if(texCoords) {
+                    for(size_t i = 0; i < positions.count; ++i) {
+                        vertices[i].texCoord = readTexCoord(*texCoords, i);
+                    }
+                }
+
+                const auto base = (uint32_t)ref.firstVertex;
+                for(size_t i = 0; i < indexCount; ++i) {
+                    out[i] = base + index(i);
+                }
+            }
+            else {
+                for(size_t i = 0; i < indexCount; i += 3) {
+                    const uint32_t corners[] = {index(i), index(i + 1), index(i + 2)};
+
+                    vec3 p[3];
+                    for(auto c = 0; c < 3; ++c) {
+                        p[c] = {positions.get<float>(corners[c], 0), positions.get<float>(corners[c], 1), positions.get<float>(corners[c], 2)};
+                    }
+
+                    const auto cross = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    const auto normal = glm::length(cross) > 0.0f ? glm::normalize(cross) : vec3{0.0f, 1.0f, 0.0f};
+
+                    for(auto c = 0; c < 3; ++c) {
+                        auto& vertex = vertices[i + c];
+                        vertex.position = p[c];
+                        vertex.matIndex = matIndex;
+                        vertex.normal = normal;
+                        vertex.texCoord = texCoords ? readTexCoord(*texCoords, corners[c]) : 0;
+
+                        out[i + c] = (uint32_t)(ref.firstVertex + i + c);
+                    }
+                }
+            }
+
+            const auto vertexCount = attributes.contains("NORMAL") ? positions.count : indexCount;
+            transformPrimitive(ref.transform, vertices, vertexCount, out, indexCount);
+        }
+
+        static void transformPrimitive(const mat4& transform, Vertex* vertices, size_t vertexCount, uint32_t* indices, size_t indexCount)
+        {
+            if(transform == glm::identity<mat4>()) return;
+
+            const auto normalTransform = glm::transpose(glm::inverse(mat3(transform)));
+            for(size_t i = 0; i < vertexCount; ++i) {
+                auto& vertex = vertices[i];
+                vertex.position = vec3(transform * vec4(vertex.position, 1.0f));
+                vertex.normal = glm::normalize(normalTransform * vertex.normal);
+            }
+
+            // Mirroring transforms flip the winding order.
+            if(glm::determinant(mat3(transform)) < 0.0f) {
+                for(size_t i = 0; i < indexCount; i += 3) {
+                    std::swap(indices[i + 1], indices[i + 2]);
+                }
+            }
+        }
+
+        fs::path m_path;
+        Document m_document;
+
+        uint32_t m_materialCount = 0;
+
+        /// Set if a primitive has no material, which then uses one appended
+        /// after those of the file.
+        std::atomic<bool> m_defaultMaterial = false;
+    };
+
+} // namespace
+
+bool isGltf(const fs::path& path)
+{
+    const auto extension = path.extension();
+    return extension == ".gltf" || extension == ".glb";
+}
+
+std::optional<ImportedModel> importGltf(const fs::path& path)
+{
+    try {
+        Importer importer(path);
+        return importer.run();
+    }
+    catch(const std::exception& e) {
+        RAYGUN_ERROR("Unable to load: {}: {}", path, e.what());
+        return {};
+    }
+}
+
+} // namespace raygun::render
@@ -0,0 +1,45 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#pragma once
+
+#include "raygun/render/mesh_cache.hpp"
+
+namespace raygun::render {
+
+/// True if path refers to a glTF 2.0 file (.gltf or .glb).
+bool isGltf(const fs::path& path);
+
+/// Imports a glTF 2.0 file without going through assimp. Binary data is
+/// memory mapped and read directly into vertex and index arrays.
+///
+/// Each root node of the default scene becomes a node of the result, the
+/// meshes of all its descendants are collapsed into one in the space of the
+/// root node. Meshes of different root nodes are decoded in parallel.
+/// Material parameters are converted to ImportedModel::embeddedMaterials.
+///
+/// Only triangle primitives with float positions and normals are supported,
+/// no post-processing happens, see importModel. Returns std::nullopt on
+/// failure.
+std::optional<ImportedModel> importGltf(const fs::path& path);
+
+} // namespace raygun::render
@@ -0,0 +1,115 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#include "raygun/render/instance_array.hpp"
+
+#include "raygun/assert.hpp"
+
+namespace raygun::render {
+
+InstanceArray::InstanceArray(std::shared_ptr<Model> model)
+{
+    RAYGUN_ASSERT(model);
+    m_variants.push_back(std::move(model));
+}
+
+InstanceArray::Variant InstanceArray::addVariant(std::shared_ptr<Model> variant)
+{
+    RAYGUN_ASSERT(variant && variant->mesh == model()->mesh);
+    RAYGUN_ASSERT(m_variants.size() <= std::numeric_limits<Variant>::max());
+
+    m_variants.push_back(std::move(variant));
+    ++m_version;
+
+    return (Variant)(m_variants.size() - 1);
+}
+
+void InstanceArray::reserve(size_t count)
+{
+    m_transforms.reserve(count);
+    m_variantIndices.reserve(count);
+}
+
+void InstanceArray::clear()
+{
+    m_transforms.clear();
+    m_variantIndices.clear();
+    ++m_version;
+}
+
+InstanceArray::Index InstanceArray::add(const Transform& transform, Variant variant)
+{
+    RAYGUN_ASSERT(variant < m_variants.size());
+
+    m_transforms.push_back(transform);
+    m_variantIndices.push_back(variant);
+    ++m_version;
+
+    return (Index)(m_transforms.size() - 1);
+}
+
+void InstanceArray::remove(Index index)
+{
+    RAYGUN_ASSERT(index < m_transforms.size());
+
+    m_transforms[index] = m_transforms.back();
+    m_transforms.pop_back();
+
+    m_variantIndices[index] = m_variantIndices.back();
+    m_variantIndices.pop_back();
+
+    ++m_version;
+}
+
+void InstanceArray::setTransform(Index index, const Transform& transform)
+{
+    m_transforms[index] = transform;
+    ++m_version;
+}
+
+void InstanceArray::setTransforms(Index first, const Transform* transforms, size_t count)
+{
+    RAYGUN_ASSERT(first + count <= m_transforms.size());
+
+    std::copy_n(transforms, count, m_transforms.begin() + first);
+    ++m_version;
+}
+
+Transform* InstanceArray::writeTransforms(size_t count)
+{
+    m_transforms.resize(count);
+    m_variantIndices.resize(count);
+    ++m_version;
+
+    return m_transforms.data();
+}
+
+void InstanceArray::setVariant(Index index, Variant variant)
+{
+    RAYGUN_ASSERT(variant < m_variants.size());
+
+    m_variantIndices[index] = variant;
+    ++m_version;
+}
+
+} // namespace raygun::render
@@ -0,0 +1,93 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "raygun/render/model.hpp"
+#include "raygun/transform.hpp"
+
+namespace raygun::render {
+
+/// Many copies of one model rendered by a single entity, see
+/// Entity::instances. Transforms are relative to the owning entity and are
+/// expanded directly into ray tracing instances, no entity is created per
+/// copy.
+class InstanceArray {
+  public:
+    using Index = uint32_t;
+
+    /// Selects the material set of an instance, 0 refers to model().
+    using Variant = uint16_t;
+
+    explicit InstanceArray(std::shared_ptr<Model> model);
+
+    const std::shared_ptr<Model>& model() const { return m_variants.front(); }
+
+    /// Adds an alternative material set. The variant must share the mesh of
+    /// model() and be registered with the ResourceManager.
+    Variant addVariant(std::shared_ptr<Model> variant);
+
+    const std::vector<std::shared_ptr<Model>>& variants() const { return m_variants; }
+
+    size_t size() const { return m_transforms.size(); }
+    bool empty() const { return m_transforms.empty(); }
+
+    void reserve(size_t count);
+    void clear();
+
+    Index add(const Transform& transform, Variant variant = 0);
+
+    /// Removes an instance by moving the last instance into its place.
+    void remove(Index index);
+
+    const Transform& transform(Index index) const { return m_transforms[index]; }
+    void setTransform(Index index, const Transform& transform);
+
+    /// Overwrites count transforms starting at first.
+    void setTransforms(Index first, const Transform* transforms, size_t count);
+
+    /// Resizes the array to count instances and returns their transforms for
+    /// writing. Added instances use variant 0.
+    Transform* writeTransforms(size_t count);
+
+    Variant variant(Index index) const { return m_variantIndices[index]; }
+    void setVariant(Index index, Variant variant);
+
+    const std::vector<Transform>& transforms() const { return m_transforms; }
+    const std::vector<Variant>& variantIndices() const { return m_variantIndices; }
+
+    /// Incremented on every modification.
+    uint64_t version() const { return m_version; }
+
+  private:
+    std::vector<std::shared_ptr<Model>> m_variants;
+
+    std::vector<Transform> m_transforms;
+    std::vector<Variant> m_variantIndices;
+
+    uint64_t m_version = 0;
+};
+
+using InstanceArrayPtr = std::shared_ptr<InstanceArray>;
+
+} // namespace raygun::render
@@ -0,0 +1,542 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#include "raygun/render/instance_table.hpp"
+
+#include "raygun/camera.hpp"
+#include "raygun/raygun.hpp"
+#include "raygun/scene.hpp"
+#include "raygun/utils/simd_transform.hpp"
+
+namespace raygun::render {
+
+namespace {
+
+    /// Switching to a coarser level requires its error to be this much below
+    /// the threshold, so instances near the boundary do not flicker between
+    /// levels.
+    constexpr float LOD_HYSTERESIS = 0.75f;
+
+    /// Camera movements below this distance (or relative change of the
+    /// projection) do not trigger a new sweep over all instances, hysteresis
+    /// absorbs them.
+    constexpr float LOD_CAMERA_TOLERANCE = 0.05f;
+    constexpr float LOD_PROJECTION_TOLERANCE = 0.01f;
+
+    /// A sweep over all instances is spread over this many frames.
+    constexpr uint32_t LOD_SWEEP_FRAMES = 8;
+
+    uint64_t blasAddress(vk::Device device, const Model& model, uint32_t lod)
+    {
+        return device.getAccelerationStructureAddressKHR({vk::AccelerationStructureKHR(model.bottomLevelASForLod(lod))});
+    }
+
+    /// Transform is filled in separately, see InstanceTable::flushTransforms.
+    vk::AccelerationStructureInstanceKHR instanceFromModel(vk::Device device, const Model& model, uint32_t instanceId, uint32_t lod = 0)
+    {
+        RAYGUN_ASSERT(model.bottomLevelAS);
+
+        vk::AccelerationStructureInstanceKHR instance = {};
+        instance.setInstanceCustomIndex(instanceId);
+        instance.setMask(0xff);
+        instance.setFlags(vk::GeometryInstanceFlagBitsKHR::eTriangleCullDisable);
+        instance.setAccelerationStructureReference(blasAddress(device, model, lod));
+
+        return instance;
+    }
+
+    /// Geometry is taken from model, materials from materialModel.
+    InstanceOffsetTableEntry offsetsFromModel(const Model& model, const Model& materialModel, uint32_t lod = 0)
+    {
+        const auto& mesh = model.meshForLod(lod);
+
+        InstanceOffsetTableEntry entry = {};
+        entry.vertexBufferOffset = mesh.vertexBufferRef.offsetInElements();
+        entry.indexBufferOffset = mesh.indexBufferRef.offsetInElements();
+        entry.materialBufferOffset = materialModel.materialBufferRef.offsetInElements();
+        return entry;
+    }
+
+    /// Returns the coarsest level whose error, projected with pixelsPerUnit,
+    /// stays below threshold. Starts from current to apply hysteresis.
+    uint32_t selectLod(const Model& model, uint32_t current, float pixelsPerUnit, float threshold)
+    {
+        auto level = std::min(current, model.lodCount() - 1);
+
+        while(level > 0 && model.errorForLod(level) * pixelsPerUnit > threshold) {
+            --level;
+        }
+
+        while(level + 1 < model.lodCount() && model.errorForLod(level + 1) * pixelsPerUnit < threshold * LOD_HYSTERESIS) {
+            ++level;
+        }
+
+        return level;
+    }
+
+    bool isRendered(const Entity& entity)
+    {
+        return entity.isVisible() && !entity.transform().isZeroVolume();
+    }
+
+    /// An entity is only rendered if it and all of its parents are rendered.
+    bool isRenderedWithParents(const Entity& entity)
+    {
+        for(auto current = &entity; current; current = current->parent()) {
+            if(!isRendered(*current)) return false;
+        }
+
+        return true;
+    }
+
+} // namespace
+
+bool InstanceTable::update(const Scene& scene)
+{
+    m_changed = false;
+
+    const auto incremental = scene.journal.consume(m_journalCursor, [&](const ChangeRecord& record) {
+        if(record.kind == ChangeKind::Removed) {
+            remove(record.entity);
+            return;
+        }
+
+        const auto* entity = Entity::resolve(record.entity);
+
+        // Entity has been removed from the scene after this record, its
+        // Removed record follows.
+        if(!entity || entity->journal() != &scene.journal) return;
+
+        switch(record.kind) {
+        case ChangeKind::Added:
+        case ChangeKind::Model:
+        case ChangeKind::InstanceArray:
+            refresh(*entity, isRenderedWithParents(*entity));
+            break;
+        case ChangeKind::Reparented:
+        case ChangeKind::Transform:
+        case ChangeKind::Visibility:
+        case ChangeKind::Mobility:
+            refreshSubtree(*entity);
+            break;
+        default:
+            break;
+        }
+    });
+
+    if(!incremental || m_invalidated) {
+        rebuild(scene);
+        m_invalidated = false;
+    }
+
+    flushTransforms();
+
+    if(scene.camera) {
+        selectLods(*scene.camera);
+    }
+    m_refreshedSlots.clear();
+
+    flushArrays();
+
+    return m_changed;
+}
+
+void InstanceTable::rebuild(const Scene& scene)
+{
+    m_instances.clear();
+    m_offsetTable.clear();
+    m_owners.clear();
+    m_models.clear();
+    m_lods.clear();
+    m_bounds.clear();
+    m_slots.clear();
+
+    m_staticCount = 0;
+    m_firstDirty = 0;
+
+    m_arrays.clear();
+    m_arraySlots.clear();
+    m_arrayLayoutChanged = true;
+
+    refreshRecursive(*scene.root, true);
+
+    m_changed = true;
+}
+
+void InstanceTable::refreshSubtree(const Entity& entity)
+{
+    const auto parentVisible = !entity.parent() || isRenderedWithParents(*entity.parent());
+    refreshRecursive(entity, parentVisible);
+}
+
+void InstanceTable::refreshRecursive(const Entity& entity, bool parentVisible)
+{
+    const auto visible = parentVisible && isRendered(entity);
+
+    refresh(entity, visible);
+
+    for(const auto& child: entity.children()) {
+        refreshRecursive(*child, visible);
+    }
+}
+
+void InstanceTable::refresh(const Entity& entity, bool visible)
+{
+    refreshArray(entity, visible);
+
+    if(!visible || !entity.model) {
+        remove(entity.handle());
+        return;
+    }
+
+    // Switching levels of detail would rewrite the static region.
+    const auto isStatic = entity.mobility() == Mobility::Static && entity.model->lods.empty();
+
+    auto it = m_slots.find(entity.handle());
+
+    // Mobility changed, move the instance to the other region.
+    if(it != m_slots.end() && (it->second < m_staticCount) != isStatic) {
+        remove(entity.handle());
+        it = m_slots.end();
+    }
+
+    const auto slot = it != m_slots.end() ? it->second : insert(entity.handle(), isStatic);
+
+    // The level is kept across refreshes, the model may have changed though.
+    m_models[slot] = entity.model;
+    m_lods[slot] = std::min(m_lods[slot], entity.model->lodCount() - 1);
+
+    m_instances[slot] = instanceFromModel(*RG().vc().device, *entity.model, slot, m_lods[slot]);
+    m_offsetTable[slot] = offsetsFromModel(*entity.model, *entity.model, m_lods[slot]);
+    markDirty(slot);
+
+    m_pendingEntities.push_back(entity.handle());
+    m_pendingTransforms.push_back(entity.globalTransform());
+
+    m_changed = true;
+}
+
+void InstanceTable::flushTransforms()
+{
+    if(m_pendingTransforms.empty()) return;
+
+    // Convert all transforms in one batch, then scatter them to their slots.
+    constexpr auto MATRIX_SIZE = 12;
+    m_matrices.resize(m_pendingTransforms.size() * MATRIX_SIZE);
+    utils::composeAffine3x4(m_pendingTransforms.data(), m_pendingTransforms.size(), m_matrices.data(), MATRIX_SIZE * sizeof(float));
+
+    for(size_t i = 0; i < m_pendingEntities.size(); ++i) {
+        // Instance may have been removed again in the meantime.
+        const auto it = m_slots.find(m_pendingEntities[i]);
+        if(it == m_slots.end()) continue;
+
+        const auto slot = it->second;
+        const auto matrix = &m_matrices[i * MATRIX_SIZE];
+
+        auto& transform = m_instances[slot].transform;
+        static_assert(sizeof(transform) == MATRIX_SIZE * sizeof(float));
+        memcpy(&transform, matrix, sizeof(transform));
+
+        const auto& model = *m_models[slot];
+        if(model.lods.empty()) continue;
+
+        // Matrices are 3x4 row-major.
+        const vec3 column0{matrix[0], matrix[4], matrix[8]};
+        const vec3 column1{matrix[1], matrix[5], matrix[9]};
+        const vec3 column2{matrix[2], matrix[6], matrix[10]};
+        const vec3 translation{matrix[3], matrix[7], matrix[11]};
+
+        const auto& sphere = model.boundingSphere;
+
+        auto& bounds = m_bounds[slot];
+        bounds.center = column0 * sphere.x + column1 * sphere.y + column2 * sphere.z + translation;
+        bounds.scale = std::max({glm::length(column0), glm::length(column1), glm::length(column2)});
+        bounds.radius = sphere.w * bounds.scale;
+
+        m_refreshedSlots.push_back(slot);
+    }
+
+    m_pendingEntities.clear();
+    m_pendingTransforms.clear();
+}
+
+void InstanceTable::selectLods(const Camera& camera)
+{
+    LodView view;
+    view.eye = camera.globalTransform().position;
+    view.projectionScale = camera.projectionScale();
+    view.threshold = (float)RG().config().lodPixelError;
+
+    for(const auto slot: m_refreshedSlots) {
+        updateLod(slot, view);
+    }
+
+    const auto moved = glm::distance(view.eye, m_lodView.eye) > LOD_CAMERA_TOLERANCE
+                       || std::abs(view.projectionScale - m_lodView.projectionScale) > LOD_PROJECTION_TOLERANCE * m_lodView.projectionScale
+                       || view.threshold != m_lodView.threshold;
+
+    // Restarting keeps the cursor, so instances are still visited round-robin
+    // while the camera keeps moving.
+    if(moved) {
+        m_lodView = view;
+        m_lodSweepRemaining = (uint32_t)m_instances.size();
+    }
+
+    const auto count = (uint32_t)m_instances.size();
+    const auto batch = std::min(m_lodSweepRemaining, (count + LOD_SWEEP_FRAMES - 1) / LOD_SWEEP_FRAMES);
+
+    for(uint32_t i = 0; i < batch; ++i) {
+        if(m_lodSweepCursor >= count) m_lodSweepCursor = 0;
+        updateLod(m_lodSweepCursor++, view);
+    }
+
+    m_lodSweepRemaining -= batch;
+}
+
+void InstanceTable::updateLod(uint32_t slot, const LodView& view)
+{
+    const auto& model = *m_models[slot];
+    if(model.lods.empty()) return;
+
+    const auto& bounds = m_bounds[slot];
+
+    // Distance to the bounding sphere, the camera may be inside.
+    const auto distance = std::max(glm::length(bounds.center - view.eye) - bounds.radius, 1e-3f);
+    const auto pixelsPerUnit = view.projectionScale * bounds.scale / distance;
+
+    // A threshold of zero disables levels of detail.
+    const auto level = view.threshold > 0.0f ? selectLod(model, m_lods[slot], pixelsPerUnit, view.threshold) : 0;
+    if(level == m_lods[slot]) return;
+
+    m_lods[slot] = level;
+    applyLod(slot);
+}
+
+void InstanceTable::applyLod(uint32_t slot)
+{
+    const auto& model = *m_models[slot];
+    const auto level = m_lods[slot];
+
+    m_instances[slot].setAccelerationStructureReference(blasAddress(*RG().vc().device, model, level));
+    m_offsetTable[slot] = offsetsFromModel(model, model, level);
+    markDirty(slot);
+
+    m_changed = true;
+}
+
+uint32_t InstanceTable::insert(EntityHandle entity, bool isStatic)
+{
+    const auto slot = (uint32_t)m_instances.size();
+
+    m_instances.emplace_back();
+    m_offsetTable.emplace_back();
+    m_owners.push_back(entity);
+    m_models.emplace_back();
+    m_lods.push_back(0);
+    m_bounds.emplace_back();
+
+    if(!isStatic || slot == m_staticCount) {
+        m_staticCount += isStatic;
+        m_slots[entity] = slot;
+        return slot;
+    }
+
+    // Make room at the end of the static region by moving the first dynamic
+    // instance to the end of the table.
+    const auto staticSlot = m_staticCount++;
+    moveSlot(staticSlot, slot);
+
+    m_owners[staticSlot] = entity;
+    m_lods[staticSlot] = 0;
+    m_slots[entity] = staticSlot;
+
+    return staticSlot;
+}
+
+void InstanceTable::remove(EntityHandle entity)
+{
+    const auto it = m_slots.find(entity);
+    if(it == m_slots.end()) return;
+
+    auto hole = it->second;
+    m_slots.erase(it);
+
+    // Keep both regions dense, a hole in the static region is filled with the
+    // last static instance, which moves the hole to the dynamic region.
+    if(hole < m_staticCount) {
+        const auto lastStatic = --m_staticCount;
+        if(hole != lastStatic) moveSlot(lastStatic, hole);
+        hole = lastStatic;
+    }
+
+    const auto last = (uint32_t)m_instances.size() - 1;
+    if(hole != last) moveSlot(last, hole);
+
+    m_instances.pop_back();
+    m_offsetTable.pop_back();
+    m_owners.pop_back();
+    m_models.pop_back();
+    m_lods.pop_back();
+    m_bounds.pop_back();
+
+    m_changed = true;
+}
+
+void InstanceTable::moveSlot(uint32_t from, uint32_t to)
+{
+    m_instances[to] = m_instances[from];
+    m_instances[to].setInstanceCustomIndex(to);
+    m_offsetTable[to] = m_offsetTable[from];
+    m_owners[to] = m_owners[from];
+    m_models[to] = m_models[from];
+    m_lods[to] = m_lods[from];
+    m_bounds[to] = m_bounds[from];
+    m_slots[m_owners[to]] = to;
+
+    markDirty(to);
+}
+
+void InstanceTable::refreshArray(const Entity& entity, bool visible)
+{
+    if(!visible || !entity.instances) {
+        removeArray(entity.handle());
+        return;
+    }
+
+    auto [it, inserted] = m_arraySlots.try_emplace(entity.handle(), (uint32_t)m_arrays.size());
+    if(inserted) {
+        m_arrays.emplace_back().owner = entity.handle();
+        m_arrayLayoutChanged = true;
+    }
+
+    auto& range = m_arrays[it->second];
+    range.array = entity.instances;
+    range.ownerTransform = entity.globalTransform();
+    range.stale = true;
+}
+
+void InstanceTable::removeArray(EntityHandle entity)
+{
+    const auto it = m_arraySlots.find(entity);
+    if(it == m_arraySlots.end()) return;
+
+    const auto index = it->second;
+    m_arraySlots.erase(it);
+
+    if(index != m_arrays.size() - 1) {
+        m_arrays[index] = std::move(m_arrays.back());
+        m_arraySlots[m_arrays[index].owner] = index;
+    }
+    m_arrays.pop_back();
+
+    m_arrayLayoutChanged = true;
+}
+
+void InstanceTable::flushArrays()
+{
+    for(auto& range: m_arrays) {
+        if(range.array->version() != range.version) {
+            range.stale = true;
+            m_arrayLayoutChanged |= range.array->size() != range.count;
+        }
+    }
+
+    if(m_arrayLayoutChanged) {
+        uint32_t first = 0;
+        for(auto& range: m_arrays) {
+            const auto count = (uint32_t)range.array->size();
+            range.stale |= range.first != first || range.count != count;
+            range.first = first;
+            range.count = count;
+
+            first += count;
+        }
+
+        m_arrayInstances.resize(first);
+        m_arrayOffsetTable.resize(first);
+        m_arrayFirstDirty = std::min(m_arrayFirstDirty, first);
+
+        m_arrayLayoutChanged = false;
+        m_changed = true;
+    }
+
+    // Custom indices of array instances follow the entity instances.
+    const auto base = (uint32_t)m_instances.size();
+    const auto baseChanged = base != m_arrayBase;
+    m_arrayBase = base;
+
+    for(auto& range: m_arrays) {
+        if(!range.stale && !baseChanged) continue;
+
+        expandArray(range);
+
+        range.version = range.array->version();
+        range.stale = false;
+
+        m_arrayFirstDirty = std::min(m_arrayFirstDirty, range.first);
+        m_changed = true;
+    }
+}
+
+void InstanceTable::expandArray(const ArrayRange& range)
+{
+    if(range.count == 0) return;
+
+    const auto& array = *range.array;
+    const auto& model = *array.model();
+
+    const auto prototype = instanceFromModel(*RG().vc().device, model, 0);
+
+    auto* instances = &m_arrayInstances[range.first];
+    for(uint32_t i = 0; i < range.count; ++i) {
+        instances[i] = prototype;
+        instances[i].setInstanceCustomIndex(m_arrayBase + range.first + i);
+    }
+
+    // Transforms are written straight into the instance records.
+    const Transform* transforms = array.transforms().data();
+    if(!range.ownerTransform.isIdentity()) {
+        m_arrayTransforms.resize(range.count);
+        for(uint32_t i = 0; i < range.count; ++i) {
+            m_arrayTransforms[i] = range.ownerTransform * transforms[i];
+        }
+        transforms = m_arrayTransforms.data();
+    }
+
+    utils::composeAffine3x4(transforms, range.count, reinterpret_cast<float*>(&instances[0].transform), sizeof(instances[0]));
+
+    const auto& variants = array.variants();
+    const auto& variantIndices = array.variantIndices();
+
+    m_arrayVariantOffsets.resize(variants.size());
+    for(size_t v = 0; v < variants.size(); ++v) {
+        m_arrayVariantOffsets[v] = offsetsFromModel(model, *variants[v]);
+    }
+
+    auto* offsets = &m_arrayOffsetTable[range.first];
+    for(uint32_t i = 0; i < range.count; ++i) {
+        offsets[i] = m_arrayVariantOffsets[variantIndices[i]];
+    }
+}
+
+} // namespace raygun::render
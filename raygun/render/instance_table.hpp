@@ -0,0 +1,204 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "raygun/change_journal.hpp"
+#include "raygun/render/acceleration_structure.hpp"
+#include "raygun/render/instance_array.hpp"
+
+namespace raygun {
+class Camera;
+class Entity;
+struct Scene;
+} // namespace raygun
+
+namespace raygun::render {
+
+/// Ray tracing instances of a scene, one per visible entity with a model. The
+/// table follows the scene's change journal so only entities which actually
+/// changed are revisited each frame.
+///
+/// Instances of static entities are kept at the front of the table, followed
+/// by all others. Together with the dirty range this allows the static region
+/// to be uploaded once and left untouched while dynamic entities move. Static
+/// entities with levels of detail are kept in the dynamic region, as level
+/// switches would rewrite the static one.
+///
+/// Instance arrays are expanded into a separate region which follows the
+/// entity instances, arrays are re-expanded when their version changes.
+///
+/// Entity instances of models with levels of detail use the coarsest level
+/// whose error projected to the screen stays below the lodPixelError config
+/// option. Levels are chosen when an instance changes; once the camera
+/// moves, all instances are revisited spread over several frames.
+class InstanceTable {
+  public:
+    /// Brings the table up to date with the given scene. Returns true if any
+    /// instance changed.
+    bool update(const Scene& scene);
+
+    const std::vector<vk::AccelerationStructureInstanceKHR>& instances() const { return m_instances; }
+
+    const std::vector<InstanceOffsetTableEntry>& offsetTable() const { return m_offsetTable; }
+
+    /// Number of instances in the static region at the front of the table.
+    uint32_t staticCount() const { return m_staticCount; }
+
+    /// Instances from this index to the end of the table have been modified
+    /// since the last call to clearDirty.
+    uint32_t firstDirty() const { return std::min(m_firstDirty, (uint32_t)m_instances.size()); }
+
+    /// Instances expanded from instance arrays, their custom indices start
+    /// after the entity instances.
+    const std::vector<vk::AccelerationStructureInstanceKHR>& arrayInstances() const { return m_arrayInstances; }
+
+    const std::vector<InstanceOffsetTableEntry>& arrayOffsetTable() const { return m_arrayOffsetTable; }
+
+    /// Like firstDirty, relative to the start of the array region.
+    uint32_t arrayFirstDirty() const { return std::min(m_arrayFirstDirty, (uint32_t)m_arrayInstances.size()); }
+
+    void clearDirty()
+    {
+        m_firstDirty = std::numeric_limits<uint32_t>::max();
+        m_arrayFirstDirty = std::numeric_limits<uint32_t>::max();
+    }
+
+    /// Rebuilds all instances on the next update, required once geometry
+    /// buffer offsets or bottom level AS changed.
+    void invalidate() { m_invalidated = true; }
+
+  private:
+    void rebuild(const Scene& scene);
+
+    void refreshSubtree(const Entity& entity);
+    void refreshRecursive(const Entity& entity, bool parentVisible);
+    void refresh(const Entity& entity, bool visible);
+
+    /// Appends a new slot for entity in the static or dynamic region.
+    uint32_t insert(EntityHandle entity, bool isStatic);
+    void remove(EntityHandle entity);
+
+    /// Moves the instance in slot from to slot to, overwriting it.
+    void moveSlot(uint32_t from, uint32_t to);
+
+    void markDirty(uint32_t slot) { m_firstDirty = std::min(m_firstDirty, slot); }
+
+    /// Switches instances to the level of detail appropriate for their
+    /// distance to camera, see class description.
+    void selectLods(const Camera& camera);
+
+    /// Camera state levels are selected for.
+    struct LodView {
+        vec3 eye{0.0f};
+        float projectionScale = 0.0f;
+        float threshold = -1.0f;
+    };
+
+    void updateLod(uint32_t slot, const LodView& view);
+
+    /// Points the instance in slot to the geometry of its current level.
+    void applyLod(uint32_t slot);
+
+    /// Computes the instance transforms of all refreshed entities.
+    void flushTransforms();
+
+    void refreshArray(const Entity& entity, bool visible);
+    void removeArray(EntityHandle entity);
+
+    /// Expands all instance arrays which changed since the last update.
+    void flushArrays();
+
+    struct ArrayRange {
+        EntityHandle owner;
+        std::shared_ptr<const InstanceArray> array;
+        Transform ownerTransform;
+
+        /// Position within the array region.
+        uint32_t first = 0;
+        uint32_t count = 0;
+
+        uint64_t version = 0;
+        bool stale = true;
+    };
+
+    void expandArray(const ArrayRange& range);
+
+    ChangeJournal::Cursor m_journalCursor;
+
+    // Custom index of each instance equals its position, which is also used
+    // to index the offset table in shaders.
+    std::vector<vk::AccelerationStructureInstanceKHR> m_instances;
+    std::vector<InstanceOffsetTableEntry> m_offsetTable;
+    std::vector<EntityHandle> m_owners;
+    std::vector<std::shared_ptr<const Model>> m_models;
+    std::vector<uint32_t> m_lods;
+
+    /// World space bounding sphere of each instance, computed by
+    /// flushTransforms for models with levels of detail only.
+    struct WorldBounds {
+        vec3 center{0.0f};
+        float radius = 0.0f;
+
+        /// Largest scale of the instance transform.
+        float scale = 1.0f;
+    };
+
+    std::vector<WorldBounds> m_bounds;
+
+    /// Slots with levels of detail whose transform or model changed during
+    /// this update.
+    std::vector<uint32_t> m_refreshedSlots;
+
+    /// View at the start of the current sweep over all instances.
+    LodView m_lodView;
+    uint32_t m_lodSweepCursor = 0;
+    uint32_t m_lodSweepRemaining = 0;
+
+    std::unordered_map<EntityHandle, uint32_t> m_slots;
+
+    uint32_t m_staticCount = 0;
+    uint32_t m_firstDirty = 0;
+
+    std::vector<EntityHandle> m_pendingEntities;
+    std::vector<Transform> m_pendingTransforms;
+    std::vector<float> m_matrices;
+
+    std::vector<ArrayRange> m_arrays;
+    std::unordered_map<EntityHandle, uint32_t> m_arraySlots;
+    bool m_arrayLayoutChanged = false;
+
+    std::vector<vk::AccelerationStructureInstanceKHR> m_arrayInstances;
+    std::vector<InstanceOffsetTableEntry> m_arrayOffsetTable;
+    std::vector<Transform> m_arrayTransforms;
+    std::vector<InstanceOffsetTableEntry> m_arrayVariantOffsets;
+
+    /// Number of entity instances the array region has been expanded for.
+    uint32_t m_arrayBase = 0;
+    uint32_t m_arrayFirstDirty = 0;
+
+    bool m_changed = false;
+    bool m_invalidated = false;
+};
+
+} // namespace raygun::render
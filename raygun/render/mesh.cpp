@@ -22,6 +22,8 @@
 
 #include "raygun/render/model.hpp"
 
+#include "raygun/utils/hash_utils.hpp"
+
 namespace raygun::render {
 
 vec3 Mesh::center() const
@@ -55,8 +57,11 @@ void Mesh::merge(const Mesh& other)
     const auto indexOffset = (uint32_t)vertices.size();
     const auto updateIndex = [=](auto index) { return index + indexOffset; };
 
-    indices.reserve(indices.size() + other.indices.size());
-    std::transform(other.indices.begin(), other.indices.end(), std::back_inserter(indices), updateIndex);
+    // Not reserving the exact size keeps the growth geometric when merging
+    // repeatedly.
+    const auto firstIndex = indices.size();
+    indices.resize(firstIndex + other.indices.size());
+    std::transform(other.indices.begin(), other.indices.end(), indices.begin() + firstIndex, updateIndex);
 
     vertices.insert(vertices.end(), other.vertices.begin(), other.vertices.end());
 }
@@ -72,4 +77,40 @@ void Mesh::forEachFace(std::function<void(const Vertex&, const Vertex&, const Ve
     }
 }
 
+void Mesh::canonicalize()
+{
+    // -0.0f == 0.0f, the assignment drops the sign.
+    const auto canonical = [](vec3& v) {
+        for(auto i = 0; i < 3; ++i) {
+            if(v[i] == 0.0f) v[i] = 0.0f;
+        }
+    };
+
+    // Same for both halves of the texture coordinates.
+    const auto canonicalHalves = [](uint32_t& packed) {
+        if((packed & 0x7fffu) == 0) packed &= 0xffff0000u;
+        if((packed & 0x7fff0000u) == 0) packed &= 0x0000ffffu;
+    };
+
+    for(auto& vertex: vertices) {
+        canonical(vertex.position);
+        canonical(vertex.normal);
+        canonicalHalves(vertex.texCoord);
+    }
+}
+
+uint64_t Mesh::contentHash() const
+{
+    const auto hash = utils::fnv1a(vertices.data(), vertices.size() * sizeof(Vertex));
+    return utils::fnv1a(indices.data(), indices.size() * sizeof(uint32_t), hash);
+}
+
+bool Mesh::sameContent(const Mesh& other) const
+{
+    static_assert(sizeof(Vertex) == 8 * sizeof(float), "Vertex must not contain implicit padding");
+
+    return vertices.size() == other.vertices.size() && indices == other.indices
+           && memcmp(vertices.data(), other.vertices.data(), vertices.size() * sizeof(Vertex)) == 0;
+}
+
 } // namespace raygun::render
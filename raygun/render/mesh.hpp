@@ -34,6 +34,10 @@ struct Mesh {
     gpu::BufferRef vertexBufferRef;
     gpu::BufferRef indexBufferRef;
 
+    /// Maps compressed vertex positions back to object space, only set when
+    /// the vertex buffer holds compressed vertices.
+    gpu::BufferRef transformBufferRef;
+
     size_t numFaces() const { return indices.size() / 3; }
 
     vec3 center() const;
@@ -49,6 +53,26 @@ struct Mesh {
     void merge(const Mesh& other);
 
     void forEachFace(std::function<void(const Vertex&, const Vertex&, const Vertex&)>) const;
+
+    /// Normalizes representations that do not affect the geometry, i.e.
+    /// negative zeros and padding, so equal geometry has equal bytes.
+    void canonicalize();
+
+    /// Hash over vertices and indices, see MeshRegistry.
+    uint64_t contentHash() const;
+
+    /// True if both meshes hold the same vertices and indices.
+    bool sameContent(const Mesh& other) const;
+
+    size_t sizeInBytes() const { return vertices.size() * sizeof(Vertex) + indices.size() * sizeof(uint32_t); }
+};
+
+/// Simplified version of a mesh.
+struct MeshLod {
+    std::shared_ptr<Mesh> mesh;
+
+    /// Approximate deviation from the full detail mesh, in object space.
+    float error = 0.0f;
 };
 
 } // namespace raygun::render
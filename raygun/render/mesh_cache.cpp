@@ -0,0 +1,375 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#include "raygun/render/mesh_cache.hpp"
+
+#include "raygun/config.hpp"
+#include "raygun/load_telemetry.hpp"
+#include "raygun/logging.hpp"
+#include "raygun/utils/file_stamp.hpp"
+#include "raygun/utils/hash_utils.hpp"
+#include "raygun/utils/mapped_file.hpp"
+#include "raygun/utils/memory_utils.hpp"
+
+namespace raygun::render {
+
+namespace {
+
+    // File layout: Header, NodeEntry[nodeCount], LodEntry[lodCount],
+    // StringRef[materialCount], MaterialParameters[embeddedMaterialCount],
+    // string table, then the vertex and index arrays
+    // of all nodes followed by those of all levels of detail, each aligned to
+    // DATA_ALIGNMENT bytes.
+
+    constexpr std::array<char, 8> MAGIC = {'R', 'G', 'M', 'E', 'S', 'H', '\0', '\0'};
+    constexpr uint32_t FORMAT_VERSION = 4;
+    constexpr size_t DATA_ALIGNMENT = 16;
+
+    struct Header {
+        std::array<char, 8> magic = MAGIC;
+        uint32_t formatVersion = FORMAT_VERSION;
+        uint32_t importerVersion = 0;
+        uint32_t vertexSize = sizeof(Vertex);
+        uint32_t nodeCount = 0;
+        uint32_t lodCount = 0;
+        uint32_t materialCount = 0;
+        uint32_t embeddedMaterialCount = 0;
+        uint32_t stringsSize = 0;
+        uint32_t reserved = 0;
+        uint64_t sourceSize = 0;
+        int64_t sourceTime = 0;
+        uint64_t sourceHash = 0;
+    };
+
+    /// Refers to a range in the string table.
+    struct StringRef {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+    };
+
+    /// Refers to the vertex and index arrays of a mesh.
+    struct MeshRef {
+        uint32_t vertexCount = 0;
+        uint32_t indexCount = 0;
+        uint64_t vertexOffset = 0;
+        uint64_t indexOffset = 0;
+    };
+
+    struct NodeEntry {
+        StringRef name;
+        vec3 position;
+        quat rotation;
+        vec3 scaling;
+        MeshRef mesh;
+
+        /// Range in the LodEntry array.
+        uint32_t firstLod = 0;
+        uint32_t lodCount = 0;
+    };
+
+    struct LodEntry {
+        MeshRef mesh;
+        float error = 0.0f;
+    };
+
+    static_assert(std::is_trivially_copyable_v<Header> && std::is_trivially_copyable_v<NodeEntry> && std::is_trivially_copyable_v<LodEntry>);
+    static_assert(std::is_trivially_copyable_v<MaterialParameters>);
+
+    template<typename T>
+    T readAt(const std::byte* data, size_t offset)
+    {
+        T result;
+        memcpy(&result, data + offset, sizeof(T));
+        return result;
+    }
+
+    MeshRef meshRefOf(const Mesh& mesh)
+    {
+        MeshRef ref;
+        ref.vertexCount = (uint32_t)mesh.vertices.size();
+        ref.indexCount = (uint32_t)mesh.indices.size();
+        return ref;
+    }
+
+    /// Assigns offsets to the arrays of ref starting at offset, returns the
+    /// end of the arrays.
+    uint64_t placeMesh(MeshRef& ref, uint64_t offset)
+    {
+        ref.vertexOffset = offset;
+        offset = utils::alignUp(offset + ref.vertexCount * sizeof(Vertex), DATA_ALIGNMENT);
+
+        ref.indexOffset = offset;
+        return utils::alignUp(offset + ref.indexCount * sizeof(uint32_t), DATA_ALIGNMENT);
+    }
+
+    std::vector<char> serialize(const ImportedModel& model, uint32_t importerVersion, const io::FileStamp& source)
+    {
+        Header header;
+        header.importerVersion = importerVersion;
+        header.nodeCount = (uint32_t)model.nodes.size();
+        header.materialCount = (uint32_t)model.materialNames.size();
+        header.embeddedMaterialCount = (uint32_t)model.embeddedMaterials.size();
+        header.sourceSize = source.size;
+        header.sourceTime = source.time;
+        header.sourceHash = source.hash;
+
+        string strings;
+        const auto addString = [&](const string& str) {
+            const StringRef ref{(uint32_t)strings.size(), (uint32_t)str.size()};
+            strings += str;
+            return ref;
+        };
+
+        std::vector<StringRef> materials;
+        for(const auto& name: model.materialNames) {
+            materials.push_back(addString(name));
+        }
+
+        std::vector<NodeEntry> nodes;
+        std::vector<LodEntry> lods;
+        for(const auto& node: model.nodes) {
+            auto& entry = nodes.emplace_back();
+            entry.name = addString(node.name);
+            entry.position = node.transform.position;
+            entry.rotation = node.transform.rotation;
+            entry.scaling = node.transform.scaling;
+            entry.mesh = meshRefOf(*node.mesh);
+            entry.firstLod = (uint32_t)lods.size();
+            entry.lodCount = (uint32_t)node.lods.size();
+
+            for(const auto& lod: node.lods) {
+                lods.push_back({meshRefOf(*lod.mesh), lod.error});
+            }
+        }
+
+        header.lodCount = (uint32_t)lods.size();
+        header.stringsSize = (uint32_t)strings.size();
+
+        uint64_t offset = utils::alignUp(sizeof(Header) + nodes.size() * sizeof(NodeEntry) + lods.size() * sizeof(LodEntry)
+                                             + materials.size() * sizeof(StringRef) + model.embeddedMaterials.size() * sizeof(MaterialParameters)
+                                             + strings.size(),
+                                         DATA_ALIGNMENT);
+        for(auto& entry: nodes) {
+            offset = placeMesh(entry.mesh, offset);
+        }
+        for(auto& entry: lods) {
+            offset = placeMesh(entry.mesh, offset);
+        }
+
+        std::vector<char> result;
+        result.reserve(offset);
+
+        const auto write = [&](const void* bytes, size_t size) {
+            const auto begin = static_cast<const char*>(bytes);
+            result.insert(result.end(), begin, begin + size);
+        };
+        const auto pad = [&] { result.resize(utils::alignUp(result.size(), DATA_ALIGNMENT)); };
+
+        write(&header, sizeof(header));
+        write(nodes.data(), nodes.size() * sizeof(NodeEntry));
+        write(lods.data(), lods.size() * sizeof(LodEntry));
+        write(materials.data(), materials.size() * sizeof(StringRef));
+        write(model.embeddedMaterials.data(), model.embeddedMaterials.size() * sizeof(MaterialParameters));
+        write(strings.data(), strings.size());
+
+        const auto writeMesh = [&](const Mesh& mesh) {
+            pad();
+            write(mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex));
+            pad();
+            write(mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+        };
+
+        for(const auto& node: model.nodes) {
+            writeMesh(*node.mesh);
+        }
+        for(const auto& node: model.nodes) {
+            for(const auto& lod: node.lods) {
+                writeMesh(*lod.mesh);
+            }
+        }
+
+        return result;
+    }
+
+} // namespace
+
+fs::path meshCachePath(const fs::path& sourcePath)
+{
+    // Different sources with the same name must not share a cache file.
+    const auto pathHash = utils::fnv1a(fs::absolute(sourcePath).generic_string());
+
+    return cacheDirectory() / "meshes" / fmt::format("{}-{:016x}.rgmesh", sourcePath.stem().string(), pathHash);
+}
+
+std::optional<ImportedModel> readMeshCache(const fs::path& cachePath, const fs::path& sourcePath, uint32_t importerVersion)
+{
+    const io::MappedFile file(cachePath, io::Access::Sequential);
+    if(!file || file.size() < sizeof(Header)) return {};
+
+    recordBytesRead(file.size());
+
+    const auto header = readAt<Header>(file.data(), 0);
+    if(header.magic != MAGIC || header.formatVersion != FORMAT_VERSION || header.importerVersion != importerVersion) {
+        RAYGUN_DEBUG("Mesh cache {} is outdated", cachePath);
+        return {};
+    }
+
+    if(!io::matchesStamp(sourcePath, {header.sourceSize, header.sourceTime, header.sourceHash})) {
+        RAYGUN_DEBUG("Mesh cache {} is outdated", cachePath);
+        return {};
+    }
+
+    auto result = readCookedModel(file.data(), file.size());
+    if(!result) RAYGUN_DEBUG("Mesh cache {} is outdated", cachePath);
+
+    return result;
+}
+
+void writeMeshCache(const fs::path& cachePath, const fs::path& sourcePath, uint32_t importerVersion, const ImportedModel& model)
+{
+    const auto source = io::fileStamp(sourcePath);
+    if(!source) return;
+
+    const auto data = serialize(model, importerVersion, *source);
+
+    std::error_code err;
+    fs::create_directories(cachePath.parent_path(), err);
+
+    // Write to a temporary file first, readers never see partial caches.
+    auto tempPath = cachePath;
+    tempPath += ".tmp";
+
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), (std::streamsize)data.size());
+
+        if(!out) {
+            RAYGUN_WARN("Unable to write mesh cache {}", tempPath);
+            return;
+        }
+    }
+
+    fs::rename(tempPath, cachePath, err);
+    if(err) {
+        RAYGUN_WARN("Unable to write mesh cache {}: {}", cachePath, err.message());
+        fs::remove(tempPath, err);
+    }
+}
+
+std::vector<char> cookModel(const ImportedModel& model, uint32_t importerVersion)
+{
+    return serialize(model, importerVersion, {});
+}
+
+std::optional<ImportedModel> readCookedModel(const std::byte* data, size_t size)
+{
+    if(size < sizeof(Header)) return {};
+
+    const auto header = readAt<Header>(data, 0);
+    if(header.magic != MAGIC || header.formatVersion != FORMAT_VERSION || header.vertexSize != sizeof(Vertex)) return {};
+
+    const uint64_t nodesOffset = sizeof(Header);
+    const uint64_t lodsOffset = nodesOffset + (uint64_t)header.nodeCount * sizeof(NodeEntry);
+    const uint64_t materialsOffset = lodsOffset + (uint64_t)header.lodCount * sizeof(LodEntry);
+    const uint64_t embeddedOffset = materialsOffset + (uint64_t)header.materialCount * sizeof(StringRef);
+    const uint64_t stringsOffset = embeddedOffset + (uint64_t)header.embeddedMaterialCount * sizeof(MaterialParameters);
+
+    if(stringsOffset + header.stringsSize > size) return {};
+
+    const auto strings = reinterpret_cast<const char*>(data + stringsOffset);
+    const auto readString = [&](StringRef ref) -> std::optional<string> {
+        if((uint64_t)ref.offset + ref.length > header.stringsSize) return {};
+        return string{strings + ref.offset, ref.length};
+    };
+
+    const auto inData = [&](uint64_t offset, uint64_t length) { return offset <= size && length <= size - offset; };
+
+    // Meshes are modified after loading (e.g. glyphs are shifted), the arrays
+    // are copied out of the mapping in one go.
+    const auto readMesh = [&](const MeshRef& ref) -> std::shared_ptr<Mesh> {
+        const auto vertexSize = (uint64_t)ref.vertexCount * sizeof(Vertex);
+        const auto indexSize = (uint64_t)ref.indexCount * sizeof(uint32_t);
+        if(!inData(ref.vertexOffset, vertexSize) || !inData(ref.indexOffset, indexSize)) return nullptr;
+
+        auto mesh = std::make_shared<Mesh>();
+        mesh->vertices.resize(ref.vertexCount);
+        memcpy(mesh->vertices.data(), data + ref.vertexOffset, vertexSize);
+        mesh->indices.resize(ref.indexCount);
+        memcpy(mesh->indices.data(), data + ref.indexOffset, indexSize);
+
+        // Indices end up in acceleration structures, shaders and PhysX.
+        for(const auto index: mesh->indices) {
+            if(index >= ref.vertexCount) return nullptr;
+        }
+
+        return mesh;
+    };
+
+    ImportedModel result;
+
+    result.materialNames.reserve(header.materialCount);
+    for(auto i = 0u; i < header.materialCount; ++i) {
+        auto name = readString(readAt<StringRef>(data, materialsOffset + i * sizeof(StringRef)));
+        if(!name) return {};
+
+        result.materialNames.push_back(std::move(*name));
+    }
+
+    result.embeddedMaterials.resize(header.embeddedMaterialCount);
+    memcpy(result.embeddedMaterials.data(), data + embeddedOffset, header.embeddedMaterialCount * sizeof(MaterialParameters));
+
+    // Texture names are read as C strings.
+    for(const auto& material: result.embeddedMaterials) {
+        if(material.diffuseTexture.back() != '\0') return {};
+    }
+
+    result.nodes.reserve(header.nodeCount);
+    for(auto i = 0u; i < header.nodeCount; ++i) {
+        const auto entry = readAt<NodeEntry>(data, nodesOffset + i * sizeof(NodeEntry));
+
+        auto name = readString(entry.name);
+        if(!name || (uint64_t)entry.firstLod + entry.lodCount > header.lodCount) return {};
+
+        auto& node = result.nodes.emplace_back();
+        node.name = std::move(*name);
+        node.transform.position = entry.position;
+        node.transform.rotation = entry.rotation;
+        node.transform.scaling = entry.scaling;
+
+        node.mesh = readMesh(entry.mesh);
+        if(!node.mesh) return {};
+
+        for(auto l = entry.firstLod; l < entry.firstLod + entry.lodCount; ++l) {
+            const auto lodEntry = readAt<LodEntry>(data, lodsOffset + l * sizeof(LodEntry));
+
+            auto& lod = node.lods.emplace_back();
+            lod.error = lodEntry.error;
+            lod.mesh = readMesh(lodEntry.mesh);
+            if(!lod.mesh) return {};
+        }
+    }
+
+    return result;
+}
+
+} // namespace raygun::render
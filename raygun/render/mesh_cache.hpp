@@ -0,0 +1,76 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "raygun/material.hpp"
+#include "raygun/render/mesh.hpp"
+#include "raygun/transform.hpp"
+
+namespace raygun::render {
+
+/// Converted contents of a model file: one collapsed mesh per top-level node
+/// plus the names of the materials referenced by the meshes.
+struct ImportedModel {
+    struct Node {
+        string name;
+        Transform transform;
+        std::shared_ptr<Mesh> mesh;
+
+        /// Simplified versions of mesh, ordered from fine to coarse.
+        std::vector<MeshLod> lods;
+    };
+
+    std::vector<string> materialNames;
+
+    /// Parameters of the materials as defined in the model file, parallel to
+    /// materialNames. Used for materials without a definition of their own,
+    /// empty for formats without material parameters (e.g. Collada).
+    std::vector<MaterialParameters> embeddedMaterials;
+
+    std::vector<Node> nodes;
+
+    /// Absolute path of the imported file, not stored in the cache.
+    fs::path sourcePath;
+};
+
+/// Location of the cache file for the given source file.
+fs::path meshCachePath(const fs::path& sourcePath);
+
+/// Loads a cached model by memory mapping cachePath. Returns std::nullopt if
+/// there is no cache file or it is outdated, i.e. it was written by a
+/// different importer version or for different source content. The source
+/// is only hashed if its size or modification time changed.
+std::optional<ImportedModel> readMeshCache(const fs::path& cachePath, const fs::path& sourcePath, uint32_t importerVersion);
+
+void writeMeshCache(const fs::path& cachePath, const fs::path& sourcePath, uint32_t importerVersion, const ImportedModel& model);
+
+/// Serializes model in the mesh cache format without source information,
+/// e.g. for resource archives.
+std::vector<char> cookModel(const ImportedModel& model, uint32_t importerVersion);
+
+/// Parses a model serialized by cookModel. Returns std::nullopt if data is
+/// malformed or was written by a different format version.
+std::optional<ImportedModel> readCookedModel(const std::byte* data, size_t size);
+
+} // namespace raygun::render
@@ -0,0 +1,313 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#include "raygun/render/mesh_optimizer.hpp"
+
+namespace raygun::render {
+
+namespace {
+    constexpr uint32_t NO_VERTEX = std::numeric_limits<uint32_t>::max();
+
+    using Cell = glm::vec<3, int64_t>;
+
+    /// Computed in double and int64, a tolerance of 1e-5 spans more cells
+    /// than an int can count a few thousand units from the origin.
+    int64_t cellCoordinate(float position, float cellSize)
+    {
+        constexpr double limit = double(1ll << 62);
+
+        // Non-finite positions end up in the outermost cells.
+        const auto cell = std::floor(double(position) / cellSize);
+        if(!(cell > -limit)) return -(1ll << 62);
+        if(!(cell < limit)) return 1ll << 62;
+
+        return (int64_t)cell;
+    }
+
+    Cell cellOf(const vec3& position, float cellSize)
+    {
+        return {cellCoordinate(position.x, cellSize), cellCoordinate(position.y, cellSize), cellCoordinate(position.z, cellSize)};
+    }
+
+    /// Distinct cells may share a key, that only adds candidates which fail
+    /// the distance test.
+    uint64_t cellKey(const Cell& cell)
+    {
+        auto key = (uint64_t)cell.x;
+        key = (key ^ (key >> 31)) * 0x9e3779b97f4a7c15ull + (uint64_t)cell.y;
+        key = (key ^ (key >> 31)) * 0x9e3779b97f4a7c15ull + (uint64_t)cell.z;
+        return (key ^ (key >> 31)) * 0x9e3779b97f4a7c15ull;
+    }
+
+    /// Merges vertices within tolerance into the first one encountered.
+    /// Candidates are looked up in a uniform grid with cells the size of the
+    /// position tolerance, so only neighbouring cells need to be searched.
+    void weldVertices(Mesh& mesh, const MeshOptimizationSettings& settings)
+    {
+        const auto cellSize = std::max(settings.positionTolerance, std::numeric_limits<float>::epsilon());
+        const auto maxDistance2 = settings.positionTolerance * settings.positionTolerance;
+
+        std::vector<Vertex> welded;
+        welded.reserve(mesh.vertices.size());
+
+        std::vector<uint32_t> remap(mesh.vertices.size());
+        std::unordered_map<uint64_t, std::vector<uint32_t>> grid;
+
+        for(size_t i = 0; i < mesh.vertices.size(); ++i) {
+            const auto& vertex = mesh.vertices[i];
+            const auto cell = cellOf(vertex.position, cellSize);
+
+            auto match = NO_VERTEX;
+            for(int dz = -1; dz <= 1 && match == NO_VERTEX; ++dz) {
+                for(int dy = -1; dy <= 1 && match == NO_VERTEX; ++dy) {
+                    for(int dx = -1; dx <= 1 && match == NO_VERTEX; ++dx) {
+                        const auto it = grid.find(cellKey(cell + Cell{dx, dy, dz}));
+                        if(it == grid.cend()) continue;
+
+                        for(const auto candidate: it->second) {
+                            const auto& other = welded[candidate];
+                            const auto delta = other.position - vertex.position;
+                            if(other.matIndex == vertex.matIndex && other.texCoord == vertex.texCoord && glm::dot(delta, delta) <= maxDistance2
+                               && glm::dot(other.normal, vertex.normal) >= settings.normalTolerance) {
+                                match = candidate;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+
+            if(match == NO_VERTEX) {
+                match = (uint32_t)welded.size();
+                welded.push_back(vertex);
+                grid[cellKey(cell)].push_back(match);
+            }
+
+            remap[i] = match;
+        }
+
+        for(auto& index: mesh.indices) {
+            index = remap[index];
+        }
+
+        mesh.vertices = std::move(welded);
+    }
+
+    void removeDegenerateTriangles(Mesh& mesh)
+    {
+        auto& indices = mesh.indices;
+
+        size_t kept = 0;
+        for(size_t i = 0; i + 2 < indices.size(); i += 3) {
+            const auto a = indices[i + 0];
+            const auto b = indices[i + 1];
+            const auto c = indices[i + 2];
+
+            if(a == b || b == c || c == a) continue;
+
+            const auto& pa = mesh.vertices[a].position;
+            const auto& pb = mesh.vertices[b].position;
+            const auto& pc = mesh.vertices[c].position;
+            const auto normal = glm::cross(pb - pa, pc - pa);
+            if(glm::dot(normal, normal) == 0.0f) continue;
+
+            indices[kept++] = a;
+            indices[kept++] = b;
+            indices[kept++] = c;
+        }
+
+        indices.resize(kept);
+    }
+
+    /// Tipsify, see Sander et al.: Fast Triangle Reordering for Vertex
+    /// Locality and Reduced Overdraw.
+    void reorderTriangles(Mesh& mesh, uint32_t cacheSize)
+    {
+        const auto& indices = mesh.indices;
+        const auto numVertices = (uint32_t)mesh.vertices.size();
+        const auto numTriangles = (uint32_t)(indices.size() / 3);
+
+        // Triangles adjacent to each vertex, stored as offsets into a single
+        // array.
+        std::vector<uint32_t> liveTriangles(numVertices, 0);
+        for(const auto index: indices) {
+            ++liveTriangles[index];
+        }
+
+        std::vector<uint32_t> adjacencyOffsets(numVertices + 1, 0);
+        for(uint32_t v = 0; v < numVertices; ++v) {
+            adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+        }
+
+        std::vector<uint32_t> adjacency(indices.size());
+        {
+            auto fill = adjacencyOffsets;
+            for(size_t i = 0; i < indices.size(); ++i) {
+                adjacency[fill[indices[i]]++] = (uint32_t)(i / 3);
+            }
+        }
+
+        std::vector<uint32_t> cacheTime(numVertices, 0);
+        std::vector<bool> emitted(numTriangles, false);
+        std::vector<uint32_t> deadEnds;
+        std::vector<uint32_t> candidates;
+
+        std::vector<uint32_t> result;
+        result.reserve(indices.size());
+
+        uint32_t time = cacheSize + 1;
+        uint32_t cursor = 0;
+
+        const auto skipDeadEnd = [&]() {
+            while(!deadEnds.empty()) {
+                const auto v = deadEnds.back();
+                deadEnds.pop_back();
+                if(liveTriangles[v] > 0) return v;
+            }
+
+            for(; cursor < numVertices; ++cursor) {
+                if(liveTriangles[cursor] > 0) return cursor;
+            }
+
+            return NO_VERTEX;
+        };
+
+        for(auto fanning = skipDeadEnd(); fanning != NO_VERTEX;) {
+            candidates.clear();
+
+            for(auto a = adjacencyOffsets[fanning]; a < adjacencyOffsets[fanning + 1]; ++a) {
+                const auto t = adjacency[a];
+                if(emitted[t]) continue;
+
+                for(auto k = 0u; k < 3; ++k) {
+                    const auto v = indices[t * 3 + k];
+                    result.push_back(v);
+                    deadEnds.push_back(v);
+                    candidates.push_back(v);
+
+                    --liveTriangles[v];
+                    if(time - cacheTime[v] > cacheSize) {
+                        cacheTime[v] = time++;
+                    }
+                }
+
+                emitted[t] = true;
+            }
+
+            // Prefer the candidate that stays longest in the cache, unless its
+            // remaining triangles would push it out.
+            auto next = NO_VERTEX;
+            int64_t bestPriority = -1;
+            for(const auto v: candidates) {
+                if(liveTriangles[v] == 0) continue;
+
+                int64_t priority = 0;
+                if(time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize) {
+                    priority = time - cacheTime[v];
+                }
+
+                if(priority > bestPriority) {
+                    bestPriority = priority;
+                    next = v;
+                }
+            }
+
+            fanning = next != NO_VERTEX ? next : skipDeadEnd();
+        }
+
+        mesh.indices = std::move(result);
+    }
+
+    /// Orders vertices by first use, unreferenced vertices are dropped.
+    void reorderVertices(Mesh& mesh)
+    {
+        std::vector<uint32_t> remap(mesh.vertices.size(), NO_VERTEX);
+
+        std::vector<Vertex> reordered;
+        reordered.reserve(mesh.vertices.size());
+
+        for(auto& index: mesh.indices) {
+            if(remap[index] == NO_VERTEX) {
+                remap[index] = (uint32_t)reordered.size();
+                reordered.push_back(mesh.vertices[index]);
+            }
+
+            index = remap[index];
+        }
+
+        mesh.vertices = std::move(reordered);
+    }
+} // namespace
+
+MeshOptimizationStats& MeshOptimizationStats::operator+=(const MeshOptimizationStats& other)
+{
+    verticesBefore += other.verticesBefore;
+    verticesAfter += other.verticesAfter;
+    trianglesBefore += other.trianglesBefore;
+    trianglesAfter += other.trianglesAfter;
+    cacheMissesBefore += other.cacheMissesBefore;
+    cacheMissesAfter += other.cacheMissesAfter;
+
+    return *this;
+}
+
+MeshOptimizationStats optimizeMesh(Mesh& mesh, const MeshOptimizationSettings& settings)
+{
+    MeshOptimizationStats stats;
+    stats.verticesBefore = mesh.vertices.size();
+    stats.trianglesBefore = mesh.numFaces();
+    stats.cacheMissesBefore = simulateVertexCache(mesh.indices, settings.cacheSize);
+
+    weldVertices(mesh, settings);
+    removeDegenerateTriangles(mesh);
+    reorderTriangles(mesh, settings.cacheSize);
+    reorderVertices(mesh);
+
+    stats.verticesAfter = mesh.vertices.size();
+    stats.trianglesAfter = mesh.numFaces();
+    stats.cacheMissesAfter = simulateVertexCache(mesh.indices, settings.cacheSize);
+
+    return stats;
+}
+
+size_t simulateVertexCache(const std::vector<uint32_t>& indices, uint32_t cacheSize)
+{
+    if(indices.empty()) return 0;
+
+    // A vertex is still cached if fewer than cacheSize vertices have been
+    // inserted since its own insertion.
+    const auto maxIndex = *std::max_element(indices.begin(), indices.end());
+    std::vector<size_t> insertedAt(maxIndex + 1, std::numeric_limits<size_t>::max());
+
+    size_t misses = 0;
+    for(const auto index: indices) {
+        const auto inserted = insertedAt[index];
+        if(inserted != std::numeric_limits<size_t>::max() && misses - inserted < cacheSize) continue;
+
+        insertedAt[index] = misses++;
+    }
+
+    return misses;
+}
+
+} // namespace raygun::render
@@ -0,0 +1,72 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "raygun/render/mesh.hpp"
+
+namespace raygun::render {
+
+struct MeshOptimizationSettings {
+    /// Vertices closer than this are welded.
+    float positionTolerance = 1e-5f;
+
+    /// Minimum cosine between normals of welded vertices.
+    float normalTolerance = 0.999f;
+
+    /// Size of the post-transform vertex cache triangles are ordered for.
+    uint32_t cacheSize = 16;
+};
+
+struct MeshOptimizationStats {
+    size_t verticesBefore = 0;
+    size_t verticesAfter = 0;
+
+    size_t trianglesBefore = 0;
+    size_t trianglesAfter = 0;
+
+    /// Simulated vertex cache misses.
+    size_t cacheMissesBefore = 0;
+    size_t cacheMissesAfter = 0;
+
+    /// Average cache miss ratio, i.e. vertices transformed per triangle.
+    float acmrBefore() const { return trianglesBefore ? (float)cacheMissesBefore / trianglesBefore : 0.0f; }
+    float acmrAfter() const { return trianglesAfter ? (float)cacheMissesAfter / trianglesAfter : 0.0f; }
+
+    MeshOptimizationStats& operator+=(const MeshOptimizationStats& other);
+};
+
+/// Optimizes the given mesh in place for rendering and acceleration
+/// structure builds:
+///
+/// - welds vertices with equal material index and texture coordinates and
+///   similar position and normal,
+/// - removes degenerate triangles,
+/// - reorders triangles for vertex cache locality (Tipsify),
+/// - reorders vertices by first use and drops unreferenced ones.
+MeshOptimizationStats optimizeMesh(Mesh& mesh, const MeshOptimizationSettings& settings = {});
+
+/// Returns the number of misses of a FIFO vertex cache of the given size.
+size_t simulateVertexCache(const std::vector<uint32_t>& indices, uint32_t cacheSize);
+
+} // namespace raygun::render
@@ -0,0 +1,97 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "raygun/render/mesh_registry.hpp"
+
+#include "raygun/logging.hpp"
+
+namespace raygun::render {
+
+std::shared_ptr<Mesh> MeshRegistry::intern(const std::shared_ptr<Mesh>& mesh)
+{
+    if(!mesh) return mesh;
+
+    {
+        std::lock_guard lock(m_mutex);
+
+        // The address may have been reused by a new mesh after the registered
+        // one died.
+        const auto it = m_registered.find(mesh.get());
+        if(it != m_registered.end() && it->second.lock() == mesh) return mesh;
+    }
+
+    // Hashing large meshes takes a while, do it outside the lock.
+    const auto hash = mesh->contentHash();
+
+    std::lock_guard lock(m_mutex);
+
+    const auto [begin, end] = m_meshes.equal_range(hash);
+    for(auto it = begin; it != end; ++it) {
+        auto registered = it->second.lock();
+        if(!registered || registered == mesh) continue;
+
+        if(registered->sameContent(*mesh)) {
+            ++m_duplicates;
+            m_bytesSaved += mesh->sizeInBytes();
+
+            RAYGUN_DEBUG("Deduplicated mesh: {} vertices, {} indices", mesh->vertices.size(), mesh->indices.size());
+
+            return registered;
+        }
+    }
+
+    m_meshes.emplace(hash, mesh);
+    m_registered[mesh.get()] = mesh;
+
+    // Amortizes pruning over the growth of the registry.
+    if(m_meshes.size() >= std::max<size_t>(2 * m_prunedSize, 64)) {
+        prune();
+    }
+
+    return mesh;
+}
+
+MeshRegistry::Stats MeshRegistry::stats() const
+{
+    std::lock_guard lock(m_mutex);
+
+    Stats result;
+    result.meshes = std::count_if(m_meshes.begin(), m_meshes.end(), [](const auto& entry) { return !entry.second.expired(); });
+    result.duplicates = m_duplicates;
+    result.bytesSaved = m_bytesSaved;
+    return result;
+}
+
+void MeshRegistry::prune()
+{
+    for(auto it = m_meshes.begin(); it != m_meshes.end();) {
+        it = it->second.expired() ? m_meshes.erase(it) : std::next(it);
+    }
+
+    for(auto it = m_registered.begin(); it != m_registered.end();) {
+        it = it->second.expired() ? m_registered.erase(it) : std::next(it);
+    }
+
+    m_prunedSize = m_meshes.size();
+}
+
+} // namespace raygun::render
@@ -0,0 +1,73 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#pragma once
+
+#include "raygun/render/mesh.hpp"
+
+namespace raygun::render {
+
+/// Deduplicates meshes by content.
+///
+/// Identical geometry imported from different files or nodes ends up in
+/// separate Mesh objects. Interning them here makes models with equal
+/// geometry share one Mesh, and thereby one range of the vertex and index
+/// buffers and one bottom level acceleration structure. Meshes are held
+/// weakly, an entry disappears with the last model using it. All functions
+/// are thread-safe.
+class MeshRegistry {
+  public:
+    struct Stats {
+        /// Distinct meshes currently alive.
+        size_t meshes = 0;
+
+        /// Meshes replaced by an already registered one, since creation.
+        size_t duplicates = 0;
+        size_t bytesSaved = 0;
+    };
+
+    /// Returns the registered mesh with the same content, or registers and
+    /// returns mesh itself if there is none. Meshes must not be modified
+    /// once registered.
+    std::shared_ptr<Mesh> intern(const std::shared_ptr<Mesh>& mesh);
+
+    Stats stats() const;
+
+  private:
+    /// Drops entries of meshes no longer alive, requires m_mutex.
+    void prune();
+
+    mutable std::mutex m_mutex;
+
+    std::unordered_multimap<uint64_t, std::weak_ptr<Mesh>> m_meshes;
+
+    /// Registered meshes by address, to skip hashing meshes interned before.
+    std::unordered_map<const Mesh*, std::weak_ptr<Mesh>> m_registered;
+
+    /// Size of m_meshes after the last prune.
+    size_t m_prunedSize = 0;
+
+    size_t m_duplicates = 0;
+    size_t m_bytesSaved = 0;
+};
+
+} // namespace raygun::render
@@ -0,0 +1,424 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#include "raygun/render/mesh_simplifier.hpp"
+
+namespace raygun::render {
+
+namespace {
+    constexpr uint32_t NO_VERTEX = std::numeric_limits<uint32_t>::max();
+
+    /// Sum of squared distances to a set of planes, stored as the symmetric
+    /// matrix A, the vector b and the scalar c of p^T A p + 2 b^T p + c.
+    struct Quadric {
+        double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+        double b0 = 0, b1 = 0, b2 = 0;
+        double c = 0;
+
+        static Quadric fromPlane(const glm::dvec3& n, double d)
+        {
+            Quadric q;
+            q.a00 = n.x * n.x;
+            q.a01 = n.x * n.y;
+            q.a02 = n.x * n.z;
+            q.a11 = n.y * n.y;
+            q.a12 = n.y * n.z;
+            q.a22 = n.z * n.z;
+            q.b0 = d * n.x;
+            q.b1 = d * n.y;
+            q.b2 = d * n.z;
+            q.c = d * d;
+            return q;
+        }
+
+        Quadric& operator+=(const Quadric& other)
+        {
+            a00 += other.a00;
+            a01 += other.a01;
+            a02 += other.a02;
+            a11 += other.a11;
+            a12 += other.a12;
+            a22 += other.a22;
+            b0 += other.b0;
+            b1 += other.b1;
+            b2 += other.b2;
+            c += other.c;
+            return *this;
+        }
+
+        double error(const vec3& p) const
+        {
+            const double x = p.x, y = p.y, z = p.z;
+            const auto result = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + a11 * y * y + 2 * a12 * y * z + a22 * z * z
+                                + 2 * (b0 * x + b1 * y + b2 * z) + c;
+
+            // Rounding may push the error of points on all planes below 0.
+            return std::max(result, 0.0);
+        }
+    };
+
+    /// Weight of the squared edge length added to the cost of a collapse.
+    /// Breaks ties on flat regions in favour of short edges, which keeps
+    /// triangles well shaped and vertex valences low.
+    constexpr double EDGE_LENGTH_WEIGHT = 1e-4;
+
+    struct Collapse {
+        float cost;
+
+        /// Quadric error without the edge length term.
+        float error;
+
+        uint32_t from;
+        uint32_t to;
+
+        /// Version of from when queued, the collapse is outdated if it or
+        /// its neighbourhood changed since.
+        uint32_t version;
+
+        bool operator>(const Collapse& other) const { return cost > other.cost; }
+    };
+
+    class Simplifier {
+      public:
+        explicit Simplifier(const Mesh& mesh)
+            : m_vertices(mesh.vertices)
+            , m_indices(mesh.indices)
+            , m_triangleRemoved(mesh.numFaces(), false)
+            , m_liveTriangles(mesh.numFaces())
+            , m_quadrics(mesh.vertices.size())
+            , m_adjacency(mesh.vertices.size())
+            , m_locked(mesh.vertices.size(), false)
+            , m_versions(mesh.vertices.size(), 0)
+        {
+            for(uint32_t t = 0; t < m_liveTriangles; ++t) {
+                const auto [a, b, c] = triangle(t);
+                m_adjacency[a].push_back(t);
+                m_adjacency[b].push_back(t);
+                m_adjacency[c].push_back(t);
+
+                const glm::dvec3 pa = m_vertices[a].position;
+                const glm::dvec3 pb = m_vertices[b].position;
+                const glm::dvec3 pc = m_vertices[c].position;
+
+                const auto normal = glm::cross(pb - pa, pc - pa);
+                const auto length = glm::length(normal);
+                if(length == 0.0) continue;
+
+                const auto n = normal / length;
+                const auto plane = Quadric::fromPlane(n, -glm::dot(n, pa));
+                m_quadrics[a] += plane;
+                m_quadrics[b] += plane;
+                m_quadrics[c] += plane;
+            }
+
+            lockOpenEdges();
+
+            for(uint32_t v = 0; v < m_vertices.size(); ++v) {
+                queueCheapestCollapse(v);
+            }
+        }
+
+        size_t liveTriangles() const { return m_liveTriangles; }
+
+        /// Distance like error of the collapses performed so far.
+        float error() const { return (float)std::sqrt(m_maxError); }
+
+        /// Collapses edges until at most targetTriangles remain. Returns false
+        /// if no further collapse is possible within maxError.
+        bool simplify(size_t targetTriangles, double maxError)
+        {
+            while(m_liveTriangles > targetTriangles) {
+                if(m_queue.empty()) return false;
+
+                const auto collapse = m_queue.top();
+                m_queue.pop();
+
+                if(collapse.version != m_versions[collapse.from]) continue;
+
+                // The vertex is reconsidered once its neighbourhood changes.
+                if(!canCollapse(collapse.from, collapse.to)) continue;
+
+                // The queue is ordered by cost, which includes the edge
+                // length, so later collapses may still be within the error.
+                if(collapse.error > maxError) continue;
+
+                perform(collapse.from, collapse.to);
+                m_maxError = std::max(m_maxError, (double)collapse.error);
+            }
+
+            return true;
+        }
+
+        /// Returns the current state as a new mesh containing only referenced
+        /// vertices, ordered by first use.
+        std::shared_ptr<Mesh> extract() const
+        {
+            auto result = std::make_shared<Mesh>();
+            result->indices.reserve(m_liveTriangles * 3);
+
+            std::vector<uint32_t> remap(m_vertices.size(), NO_VERTEX);
+
+            for(uint32_t t = 0; t < m_triangleRemoved.size(); ++t) {
+                if(m_triangleRemoved[t]) continue;
+
+                for(auto k = 0u; k < 3; ++k) {
+                    const auto index = m_indices[t * 3 + k];
+                    if(remap[index] == NO_VERTEX) {
+                        remap[index] = (uint32_t)result->vertices.size();
+                        result->vertices.push_back(m_vertices[index]);
+                    }
+
+                    result->indices.push_back(remap[index]);
+                }
+            }
+
+            return result;
+        }
+
+      private:
+        std::array<uint32_t, 3> triangle(uint32_t t) const { return {m_indices[t * 3 + 0], m_indices[t * 3 + 1], m_indices[t * 3 + 2]}; }
+
+        /// Edges with only one adjacent triangle are on the border of the
+        /// surface, edges with more are non-manifold. Neither may move.
+        void lockOpenEdges()
+        {
+            std::unordered_map<uint64_t, uint32_t> edgeTriangles;
+            edgeTriangles.reserve(m_indices.size());
+
+            const auto edgeKey = [](uint32_t a, uint32_t b) { return ((uint64_t)std::min(a, b) << 32) | std::max(a, b); };
+
+            for(uint32_t t = 0; t < m_liveTriangles; ++t) {
+                const auto [a, b, c] = triangle(t);
+                ++edgeTriangles[edgeKey(a, b)];
+                ++edgeTriangles[edgeKey(b, c)];
+                ++edgeTriangles[edgeKey(c, a)];
+            }
+
+            for(const auto& [key, count]: edgeTriangles) {
+                if(count == 2) continue;
+
+                m_locked[key >> 32] = true;
+                m_locked[key & 0xffffffff] = true;
+            }
+        }
+
+        /// Each vertex has at most one queued collapse, onto the neighbour
+        /// with the lowest cost. Collapses previously queued for vertex are
+        /// invalidated.
+        void queueCheapestCollapse(uint32_t vertex)
+        {
+            const auto version = ++m_versions[vertex];
+            if(m_locked[vertex]) return;
+
+            Collapse best = {std::numeric_limits<float>::max(), 0.0f, vertex, NO_VERTEX, version};
+            const auto& position = m_vertices[vertex].position;
+
+            forEachLiveTriangle(vertex, [&](uint32_t t) {
+                for(const auto to: triangle(t)) {
+                    if(to == vertex || m_vertices[to].matIndex != m_vertices[vertex].matIndex) continue;
+
+                    auto quadric = m_quadrics[vertex];
+                    quadric += m_quadrics[to];
+
+                    const auto error = quadric.error(m_vertices[to].position);
+                    const auto edge = m_vertices[to].position - position;
+                    const auto cost = (float)(error + EDGE_LENGTH_WEIGHT * glm::dot(edge, edge));
+
+                    if(cost < best.cost) {
+                        best.cost = cost;
+                        best.error = (float)error;
+                        best.to = to;
+                    }
+                }
+            });
+
+            if(best.to != NO_VERTEX) {
+                m_queue.push(best);
+            }
+        }
+
+        template<typename Fun>
+        void forEachLiveTriangle(uint32_t vertex, Fun f) const
+        {
+            for(const auto t: m_adjacency[vertex]) {
+                if(!m_triangleRemoved[t]) f(t);
+            }
+        }
+
+        bool canCollapse(uint32_t from, uint32_t to)
+        {
+            // Link condition: vertices adjacent to both ends must be exactly
+            // the opposite corners of the triangles sharing the edge.
+            // Otherwise the collapse pinches the surface.
+            auto& fromNeighbours = m_scratchNeighbours;
+            fromNeighbours.clear();
+
+            uint32_t sharedTriangles = 0;
+
+            bool valid = true;
+            forEachLiveTriangle(from, [&](uint32_t t) {
+                const auto corners = triangle(t);
+                const auto hasTo = std::find(corners.begin(), corners.end(), to) != corners.end();
+                sharedTriangles += hasTo;
+
+                for(const auto v: corners) {
+                    if(v != from && v != to) fromNeighbours.push_back(v);
+                }
+
+                if(hasTo) return;
+
+                // Moving from onto to must not flip or degenerate the triangle.
+                std::array<vec3, 3> before, after;
+                for(auto k = 0u; k < 3; ++k) {
+                    before[k] = m_vertices[corners[k]].position;
+                    after[k] = corners[k] == from ? m_vertices[to].position : before[k];
+                }
+
+                const auto normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+                const auto normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+
+                const auto lengths = glm::length(normalBefore) * glm::length(normalAfter);
+                if(lengths == 0.0f || glm::dot(normalBefore, normalAfter) < 0.2f * lengths) {
+                    valid = false;
+                }
+            });
+
+            if(!valid) return false;
+
+            std::sort(fromNeighbours.begin(), fromNeighbours.end());
+            fromNeighbours.erase(std::unique(fromNeighbours.begin(), fromNeighbours.end()), fromNeighbours.end());
+
+            auto& shared = m_scratchShared;
+            shared.clear();
+
+            forEachLiveTriangle(to, [&](uint32_t t) {
+                for(const auto v: triangle(t)) {
+                    if(v != to && v != from && std::binary_search(fromNeighbours.begin(), fromNeighbours.end(), v)) {
+                        shared.push_back(v);
+                    }
+                }
+            });
+
+            std::sort(shared.begin(), shared.end());
+            shared.erase(std::unique(shared.begin(), shared.end()), shared.end());
+
+            return shared.size() == sharedTriangles;
+        }
+
+        void perform(uint32_t from, uint32_t to)
+        {
+            for(const auto t: m_adjacency[from]) {
+                if(m_triangleRemoved[t]) continue;
+
+                auto* corners = &m_indices[t * 3];
+                if(corners[0] == to || corners[1] == to || corners[2] == to) {
+                    m_triangleRemoved[t] = true;
+                    --m_liveTriangles;
+                    continue;
+                }
+
+                for(auto k = 0u; k < 3; ++k) {
+                    if(corners[k] == from) corners[k] = to;
+                }
+
+                m_adjacency[to].push_back(t);
+            }
+
+            m_adjacency[from].clear();
+            m_adjacency[from].shrink_to_fit();
+
+            auto& adjacency = m_adjacency[to];
+            adjacency.erase(std::remove_if(adjacency.begin(), adjacency.end(), [&](uint32_t t) { return m_triangleRemoved[t]; }), adjacency.end());
+
+            m_quadrics[to] += m_quadrics[from];
+            ++m_versions[from];
+
+            // Costs of all collapses onto or from to changed.
+            auto& neighbours = m_scratchNeighbours;
+            neighbours.clear();
+            for(const auto t: adjacency) {
+                const auto corners = triangle(t);
+                neighbours.insert(neighbours.end(), corners.begin(), corners.end());
+            }
+
+            std::sort(neighbours.begin(), neighbours.end());
+            neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+
+            for(const auto v: neighbours) {
+                queueCheapestCollapse(v);
+            }
+        }
+
+        std::vector<Vertex> m_vertices;
+        std::vector<uint32_t> m_indices;
+        std::vector<bool> m_triangleRemoved;
+        size_t m_liveTriangles;
+
+        std::vector<Quadric> m_quadrics;
+        std::vector<std::vector<uint32_t>> m_adjacency;
+        std::vector<bool> m_locked;
+        std::vector<uint32_t> m_versions;
+
+        std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> m_queue;
+        double m_maxError = 0.0;
+
+        std::vector<uint32_t> m_scratchNeighbours;
+        std::vector<uint32_t> m_scratchShared;
+    };
+} // namespace
+
+std::vector<MeshLod> generateLods(const Mesh& mesh, const MeshSimplificationSettings& settings)
+{
+    std::vector<MeshLod> result;
+
+    if(mesh.numFaces() / 2 < settings.minTriangles) return result;
+
+    const auto [lower, upper] = mesh.bounds();
+    const auto maxError = (double)glm::length(upper - lower) * settings.maxRelativeError;
+
+    Simplifier simplifier(mesh);
+
+    // All levels come from a single sequence of collapses, each level is a
+    // snapshot along the way.
+    auto previousTriangles = mesh.numFaces();
+    while(result.size() < settings.maxLevels) {
+        const auto target = (size_t)((float)previousTriangles * settings.reduction);
+        if(target < settings.minTriangles) break;
+
+        const auto reachedTarget = simplifier.simplify(target, maxError * maxError);
+
+        // Levels which barely differ from the previous one are not worth a
+        // separate acceleration structure.
+        const auto triangles = simplifier.liveTriangles();
+        if((float)triangles > (float)previousTriangles * (1.0f + settings.reduction) / 2.0f) break;
+
+        result.push_back({simplifier.extract(), simplifier.error()});
+        previousTriangles = triangles;
+
+        if(!reachedTarget) break;
+    }
+
+    return result;
+}
+
+} // namespace raygun::render
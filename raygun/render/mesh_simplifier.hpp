@@ -0,0 +1,59 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "raygun/render/mesh.hpp"
+
+namespace raygun::render {
+
+struct MeshSimplificationSettings {
+    /// Each level keeps at most this fraction of the triangles of the previous
+    /// level.
+    float reduction = 0.5f;
+
+    /// Levels with fewer triangles are not generated.
+    size_t minTriangles = 64;
+
+    uint32_t maxLevels = 4;
+
+    /// Simplification stops once the error exceeds this fraction of the
+    /// mesh's bounding box diagonal.
+    float maxRelativeError = 0.05f;
+};
+
+/// Generates a chain of simplified meshes, ordered from fine to coarse, by
+/// quadric error metric edge collapses (Garland and Heckbert: Surface
+/// Simplification Using Quadric Error Metrics).
+///
+/// Vertices keep their attributes, collapses only move a vertex onto one of
+/// its neighbours with the same material index. Vertices on open edges,
+/// which includes normal and material seams, are never moved so seams do not
+/// crack. Collapses which flip triangles or make the surface non-manifold are
+/// rejected.
+///
+/// Returns fewer levels (possibly none) if the mesh cannot be reduced
+/// further without exceeding the error limit.
+std::vector<MeshLod> generateLods(const Mesh& mesh, const MeshSimplificationSettings& settings = {});
+
+} // namespace raygun::render
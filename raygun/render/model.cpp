@@ -28,13 +28,32 @@
 
 namespace raygun::render {
 
+void Model::setLods(std::vector<MeshLod> levels)
+{
+    lods = std::move(levels);
+    lodBottomLevelAS.clear();
+
+    const auto [lower, upper] = mesh->bounds();
+    boundingSphere = vec4((lower + upper) / 2.0f, glm::length(upper - lower) / 2.0f);
+}
+
 void Model::merge(const Model& other)
 {
     if(!std::equal(materials.cbegin(), materials.cend(), other.materials.begin(), other.materials.end())) {
         RAYGUN_FATAL("Merging with different materials not supported, yet");
     }
 
-    mesh->merge(*other.mesh);
+    // The mesh may be shared with other models, see MeshRegistry.
+    auto merged = std::make_shared<Mesh>(*mesh);
+    merged->merge(*other.mesh);
+    mesh = merged;
+    bottomLevelAS.reset();
+
+    // Levels of detail no longer match the merged mesh.
+    lods.clear();
+    lodBottomLevelAS.clear();
+
+    sourcePath.clear();
 }
 
 } // namespace raygun::render
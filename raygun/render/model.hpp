@@ -36,7 +36,29 @@ struct Model {
     std::vector<std::shared_ptr<Material>> materials;
     gpu::BufferRef materialBufferRef;
 
-    UniqueBottomLevelAS bottomLevelAS;
+    SharedBottomLevelAS bottomLevelAS;
+
+    /// Simplified versions of mesh ordered from fine to coarse, level 0 is
+    /// mesh itself. Use setLods to assign.
+    std::vector<MeshLod> lods;
+    std::vector<SharedBottomLevelAS> lodBottomLevelAS;
+
+    /// Object space bounding sphere (center, radius) of mesh, used to select
+    /// the level of detail.
+    vec4 boundingSphere = {};
+
+    /// File and top-level node this model was imported from, used to reload
+    /// it when the file changes. Empty for generated or merged models.
+    fs::path sourcePath;
+    uint32_t sourceNode = 0;
+
+    uint32_t lodCount() const { return 1 + (uint32_t)lods.size(); }
+
+    const Mesh& meshForLod(uint32_t level) const { return level == 0 ? *mesh : *lods[level - 1].mesh; }
+    const BottomLevelAS& bottomLevelASForLod(uint32_t level) const { return level == 0 ? *bottomLevelAS : *lodBottomLevelAS[level - 1]; }
+    float errorForLod(uint32_t level) const { return level == 0 ? 0.0f : lods[level - 1].error; }
+
+    void setLods(std::vector<MeshLod> levels);
 
     void merge(const Model& other);
 };
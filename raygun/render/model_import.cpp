@@ -0,0 +1,293 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#include "raygun/render/model_import.hpp"
+
+#include "raygun/load_telemetry.hpp"
+#include "raygun/logging.hpp"
+#include "raygun/raygun.hpp"
+#include "raygun/render/gltf_import.hpp"
+#include "raygun/render/mesh_optimizer.hpp"
+#include "raygun/render/mesh_simplifier.hpp"
+#include "raygun/utils/assimp_utils.hpp"
+#include "raygun/utils/hash_utils.hpp"
+#include "raygun/utils/parallel_for.hpp"
+
+#include <assimp/version.h>
+
+namespace raygun::render {
+
+namespace {
+    /// Location of an aiMesh within the collapsed mesh of a node.
+    struct MeshSlice {
+        const aiMesh* aimesh = nullptr;
+        Mesh* target = nullptr;
+        size_t firstVertex = 0;
+        size_t firstIndex = 0;
+    };
+
+    size_t triangleCount(const aiMesh& aimesh)
+    {
+        if(aimesh.mPrimitiveTypes == aiPrimitiveType_TRIANGLE) return aimesh.mNumFaces;
+
+        return std::count_if(aimesh.mFaces, aimesh.mFaces + aimesh.mNumFaces, [](const aiFace& face) { return face.mNumIndices == 3; });
+    }
+
+    /// Collapses the meshes of ainode and all its descendants into target.
+    /// Only computes the layout: target is sized once and a slice per aiMesh
+    /// is appended, see writeSlice. Meshes are ordered depth first, as if
+    /// merged recursively.
+    void layoutCollapsedMesh(const aiScene* aiscene, const aiNode* ainode, Mesh& target, std::vector<MeshSlice>& slices)
+    {
+        size_t vertexCount = 0;
+        size_t indexCount = 0;
+
+        // Iterative, exported hierarchies can be very deep.
+        std::vector<const aiNode*> stack = {ainode};
+        while(!stack.empty()) {
+            const auto node = stack.back();
+            stack.pop_back();
+
+            for(auto i = 0u; i < node->mNumMeshes; ++i) {
+                const auto aimesh = aiscene->mMeshes[node->mMeshes[i]];
+                slices.push_back({aimesh, &target, vertexCount, indexCount});
+
+                vertexCount += aimesh->mNumVertices;
+                indexCount += triangleCount(*aimesh) * 3;
+            }
+
+            // Reversed so children are visited in order.
+            for(auto i = node->mNumChildren; i-- > 0;) {
+                stack.push_back(node->mChildren[i]);
+            }
+        }
+
+        target.vertices.resize(vertexCount);
+        target.indices.resize(indexCount);
+    }
+
+    /// Writes the vertices and indices of a slice in place, slices do not
+    /// overlap and may be written concurrently.
+    void writeSlice(const MeshSlice& slice)
+    {
+        const auto& aimesh = *slice.aimesh;
+
+        auto vertex = slice.target->vertices.begin() + slice.firstVertex;
+        for(auto i = 0u; i < aimesh.mNumVertices; ++i, ++vertex) {
+            const auto& position = aimesh.mVertices[i];
+            const auto& normal = aimesh.mNormals[i];
+
+            vertex->position = {position.x, position.y, position.z};
+            vertex->normal = {normal.x, normal.y, normal.z};
+            vertex->matIndex = aimesh.mMaterialIndex;
+            vertex->texCoord = 0;
+
+            if(aimesh.HasTextureCoords(0)) {
+                const auto& texCoord = aimesh.mTextureCoords[0][i];
+                vertex->texCoord = glm::packHalf2x16({texCoord.x, texCoord.y});
+            }
+        }
+
+        // Indices are relative to the collapsed mesh.
+        const auto indexOffset = (uint32_t)slice.firstVertex;
+
+        auto index = slice.target->indices.begin() + slice.firstIndex;
+        for(auto i = 0u; i < aimesh.mNumFaces; ++i) {
+            const auto& face = aimesh.mFaces[i];
+
+            if(face.mNumIndices != 3) {
+                RAYGUN_WARN("Face {} of mesh {} has {} vertices, skipping", i, aimesh.mName.C_Str(), face.mNumIndices);
+                continue;
+            }
+
+            *index++ = face.mIndices[0] + indexOffset;
+            *index++ = face.mIndices[1] + indexOffset;
+            *index++ = face.mIndices[2] + indexOffset;
+        }
+
+        RAYGUN_DEBUG("Loaded Mesh: {}: {} vertices", aimesh.mName.C_Str(), aimesh.mNumVertices);
+    }
+
+    /// Bump whenever the import pipeline changes its output, invalidates
+    /// cached meshes.
+    constexpr uint32_t PIPELINE_REVISION = 4;
+
+    std::optional<ImportedModel> importWithAssimp(const fs::path& path)
+    {
+        Assimp::Importer importer;
+
+        // Texture coordinates with the origin at the top left, as in glTF.
+        const auto aiscene = importer.ReadFile(path.string(), aiProcess_Triangulate | aiProcess_FlipUVs);
+        if(!aiscene) {
+            RAYGUN_ERROR("Unable to load: {}: {}", path, importer.GetErrorString());
+            return {};
+        }
+
+        ImportedModel result;
+
+        for(auto i = 0u; i < aiscene->mNumMaterials; ++i) {
+            aiString matName;
+            aiscene->mMaterials[i]->Get(AI_MATKEY_NAME, matName);
+            result.materialNames.emplace_back(matName.C_Str());
+        }
+
+        // Each child of the root becomes a node with all meshes below it
+        // collapsed. The collapsed meshes are laid out first so every vertex
+        // is copied exactly once, then all aiMeshes are written in parallel.
+        std::vector<MeshSlice> slices;
+
+        result.nodes.reserve(aiscene->mRootNode->mNumChildren);
+        for(auto i = 0u; i < aiscene->mRootNode->mNumChildren; ++i) {
+            const auto ainode = aiscene->mRootNode->mChildren[i];
+
+            auto& node = result.nodes.emplace_back();
+            node.name = ainode->mName.C_Str();
+            node.transform = utils::toTransform(ainode->mTransformation);
+            node.mesh = std::make_shared<Mesh>();
+
+            layoutCollapsedMesh(aiscene, ainode, *node.mesh, slices);
+        }
+
+        utils::parallelFor(slices.size(), [&](size_t i) { writeSlice(slices[i]); });
+
+        return result;
+    }
+
+    /// Optimizes the collapsed node meshes and generates their levels of
+    /// detail, the same for all source formats.
+    void postProcess(ImportedModel& model, const fs::path& path, const ImportSettings& settings)
+    {
+        const auto optimize = settings.meshOptimization;
+        MeshOptimizationStats stats;
+
+        const auto generateLevels = settings.meshLods;
+        size_t lodCount = 0;
+
+        for(auto& node: model.nodes) {
+            if(optimize) {
+                stats += optimizeMesh(*node.mesh);
+            }
+
+            if(generateLevels) {
+                node.lods = generateLods(*node.mesh);
+                lodCount += node.lods.size();
+            }
+
+            // Equal geometry needs equal bytes to be deduplicated, see MeshRegistry.
+            node.mesh->canonicalize();
+            for(auto& lod: node.lods) {
+                lod.mesh->canonicalize();
+            }
+        }
+
+        if(optimize) {
+            RAYGUN_INFO("Optimized {}: {} -> {} vertices, {} -> {} triangles, ACMR {:.2f} -> {:.2f}", path.filename(), stats.verticesBefore,
+                        stats.verticesAfter, stats.trianglesBefore, stats.trianglesAfter, stats.acmrBefore(), stats.acmrAfter());
+        }
+
+        if(lodCount > 0) {
+            RAYGUN_INFO("Generated {} levels of detail for {}", lodCount, path.filename());
+        }
+    }
+
+    std::optional<ImportedModel> importSource(const fs::path& path, const ImportSettings& settings)
+    {
+        std::optional<ImportedModel> result;
+        {
+            LoadStageTimer timer(LoadStage::Parse);
+
+            // External glTF buffers are not counted.
+            std::error_code err;
+            if(const auto size = fs::file_size(path, err); !err) recordBytesRead(size);
+
+            result = isGltf(path) ? importGltf(path) : importWithAssimp(path);
+        }
+
+        if(result) {
+            LoadStageTimer timer(LoadStage::Convert);
+            postProcess(*result, path, settings);
+        }
+
+        return result;
+    }
+
+    std::optional<ImportedModel> importCached(const fs::path& path, const ImportSettings& settings)
+    {
+        if(!settings.meshCache) {
+            return importSource(path, settings);
+        }
+
+        const auto cachePath = meshCachePath(path);
+        const auto version = importerVersion(settings);
+
+        std::optional<ImportedModel> cached;
+        {
+            LoadStageTimer timer(LoadStage::Parse);
+            cached = readMeshCache(cachePath, path, version);
+        }
+
+        recordCacheAccess("MeshCache", cached.has_value());
+
+        if(cached) {
+            RAYGUN_DEBUG("Loaded {} from mesh cache", path);
+            return cached;
+        }
+
+        auto result = importSource(path, settings);
+        if(result) {
+            writeMeshCache(cachePath, path, version, *result);
+        }
+
+        return result;
+    }
+
+} // namespace
+
+ImportSettings ImportSettings::fromConfig()
+{
+    const auto& config = RG().config();
+    return {config.meshCache, config.meshOptimization, config.meshLods};
+}
+
+uint32_t importerVersion(const ImportSettings& settings)
+{
+    const uint32_t parts[] = {aiGetVersionMajor(), aiGetVersionMinor(), aiGetVersionRevision(), PIPELINE_REVISION, settings.meshOptimization, settings.meshLods};
+    return (uint32_t)utils::fnv1a(parts, sizeof(parts));
+}
+
+std::optional<ImportedModel> importModel(const fs::path& path)
+{
+    return importModel(path, ImportSettings::fromConfig());
+}
+
+std::optional<ImportedModel> importModel(const fs::path& path, const ImportSettings& settings)
+{
+    auto result = importCached(path, settings);
+    if(result) {
+        result->sourcePath = fs::absolute(path).lexically_normal();
+    }
+
+    return result;
+}
+
+} // namespace raygun::render
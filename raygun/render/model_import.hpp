@@ -0,0 +1,53 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "raygun/render/mesh_cache.hpp"
+
+namespace raygun::render {
+
+/// Options of the import pipeline, see the config options of the same name.
+struct ImportSettings {
+    bool meshCache = true;
+    bool meshOptimization = true;
+    bool meshLods = true;
+
+    /// Requires a running Raygun instance.
+    static ImportSettings fromConfig();
+};
+
+/// Imports the given model file, each top-level node is collapsed into a
+/// single mesh. glTF files are read natively (see importGltf), other formats
+/// through assimp. Converted models are kept in the mesh cache, later imports of
+/// an unchanged file skip parsing. Returns std::nullopt on failure.
+std::optional<ImportedModel> importModel(const fs::path& path);
+
+/// Same as above, but does not depend on a running Raygun instance.
+std::optional<ImportedModel> importModel(const fs::path& path, const ImportSettings& settings);
+
+/// Identifies the output of the import pipeline, changes whenever the
+/// pipeline or its settings change.
+uint32_t importerVersion(const ImportSettings& settings);
+
+} // namespace raygun::render
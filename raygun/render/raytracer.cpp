@@ -59,27 +59,79 @@ void Raytracer::setupBottomLevelAS()
     auto fence = vc.device->createFenceUnique({});
     vc.setObjectName(*fence, "BLAS");
 
+    const auto start = Clock::now();
+
     cmd->begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
 
     auto models = RG().resourceManager().models();
+
+    // Structures are built once per mesh and shared by all models using it,
+    // e.g. every text generator creates its own models for the same glyphs.
+    std::unordered_map<const Mesh*, SharedBottomLevelAS> structures;
+    for(const auto& model: models) {
+        if(model->bottomLevelAS) structures.emplace(model->mesh.get(), model->bottomLevelAS);
+
+        for(size_t i = 0; i < model->lodBottomLevelAS.size() && i < model->lods.size(); ++i) {
+            if(model->lodBottomLevelAS[i]) structures.emplace(model->lods[i].mesh.get(), model->lodBottomLevelAS[i]);
+        }
+    }
+
+    // All structures are built by a single submission, its time is split
+    // among the model files by the number of faces built for them.
+    std::unordered_map<Atom, size_t> builtFaces;
+    size_t totalFaces = 0;
+
+    const auto structureFor = [&](const Mesh& mesh, const Model& model) {
+        auto& structure = structures[&mesh];
+        if(!structure) {
+            structure = std::make_shared<BottomLevelAS>(*cmd, mesh);
+
+            if(!model.sourcePath.empty()) {
+                builtFaces[model.sourcePath.stem().string()] += mesh.numFaces();
+                totalFaces += mesh.numFaces();
+            }
+        }
+        return structure;
+    };
+
     for(auto& model: models) {
         if(!model->bottomLevelAS) {
-            model->bottomLevelAS = std::make_unique<BottomLevelAS>(*cmd, *model->mesh);
+            model->bottomLevelAS = structureFor(*model->mesh, *model);
+        }
+
+        model->lodBottomLevelAS.resize(model->lods.size());
+        for(size_t i = 0; i < model->lods.size(); ++i) {
+            if(!model->lodBottomLevelAS[i]) {
+                model->lodBottomLevelAS[i] = structureFor(*model->lods[i].mesh, *model);
+            }
         }
     }
 
     cmd->end();
     vc.computeQueue->submit(*cmd, *fence);
     vc.waitForFence(*fence);
+
+    // Entities loaded by the resource manager are named after their model
+    // file.
+    const auto duration = Clock::now() - start;
+    for(const auto& [name, faces]: builtFaces) {
+        if(faces > 0) RG().resourceManager().telemetry().record("Entity", name, LoadStage::BlasBuild, duration * faces / totalFaces);
+    }
 }
 
 void Raytracer::setupTopLevelAS(vk::CommandBuffer& cmd, const Scene& scene)
 {
     RG().profiler().writeTimestamp(cmd, TimestampQueryID::ASBuildStart);
 
-    m_topLevelAS = std::make_unique<TopLevelAS>(cmd, scene);
+    // The top level AS is only rebuilt if instances actually changed.
+    if(m_instanceTable.update(scene) || !m_topLevelAS) {
+        if(!m_topLevelAS) m_topLevelAS = std::make_unique<TopLevelAS>();
 
-    accelerationStructureBarrier(cmd);
+        m_topLevelAS->build(cmd, m_instanceTable);
+        m_instanceTable.clearDirty();
+
+        accelerationStructureBarrier(cmd);
+    }
 
     RG().profiler().writeTimestamp(cmd, TimestampQueryID::ASBuildEnd);
 }
@@ -147,7 +199,7 @@ const gpu::Image& Raytracer::doRaytracing(vk::CommandBuffer& cmd)
 }
 
 void Raytracer::updateRenderTarget(const gpu::Buffer& uniformBuffer, const gpu::Buffer& vertexBuffer, const gpu::Buffer& indexBuffer,
-                                   const gpu::Buffer& materialBuffer)
+                                   const gpu::Buffer& materialBuffer, const gpu::Buffer& primitiveMaterialBuffer, const TextureStreamer& textureStreamer)
 {
     // Bind acceleration structure
     m_descriptorSet.bind(RAYGUN_RAYTRACER_BINDING_ACCELERATION_STRUCTURE, *m_topLevelAS);
@@ -162,8 +214,20 @@ void Raytracer::updateRenderTarget(const gpu::Buffer& uniformBuffer, const gpu::
     m_descriptorSet.bind(RAYGUN_RAYTRACER_BINDING_VERTEX_BUFFER, vertexBuffer);
     m_descriptorSet.bind(RAYGUN_RAYTRACER_BINDING_INDEX_BUFFER, indexBuffer);
     m_descriptorSet.bind(RAYGUN_RAYTRACER_BINDING_MATERIAL_BUFFER, materialBuffer);
+    m_descriptorSet.bind(RAYGUN_RAYTRACER_BINDING_PRIMITIVE_MATERIAL_BUFFER, primitiveMaterialBuffer);
     m_descriptorSet.bind(RAYGUN_RAYTRACER_BINDING_INSTANCE_OFFSET_TABLE, m_topLevelAS->instanceOffsetTable());
 
+    // Bind textures, all slots are written so partially bound descriptors are
+    // not required.
+    if(textureStreamer.generation() != m_textureGeneration) {
+        auto write = m_descriptorSet.writeFromBinding(RAYGUN_RAYTRACER_BINDING_TEXTURES);
+        write.setPImageInfo(textureStreamer.descriptorInfos().data());
+        RAYGUN_ASSERT(write.descriptorCount == textureStreamer.descriptorInfos().size());
+
+        m_descriptorSet.bind(write);
+        m_textureGeneration = textureStreamer.generation();
+    }
+
     m_descriptorSet.update();
 
     RG().computeSystem().updateDescriptors(
@@ -210,9 +274,14 @@ void Raytracer::setupRaytracingDescriptorSet()
     m_descriptorSet.addBinding(RAYGUN_RAYTRACER_BINDING_VERTEX_BUFFER, 1, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eClosestHitKHR);
     m_descriptorSet.addBinding(RAYGUN_RAYTRACER_BINDING_INDEX_BUFFER, 1, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eClosestHitKHR);
     m_descriptorSet.addBinding(RAYGUN_RAYTRACER_BINDING_MATERIAL_BUFFER, 1, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eClosestHitKHR);
+    m_descriptorSet.addBinding(RAYGUN_RAYTRACER_BINDING_PRIMITIVE_MATERIAL_BUFFER, 1, vk::DescriptorType::eStorageBuffer,
+                               vk::ShaderStageFlagBits::eClosestHitKHR);
 
     m_descriptorSet.addBinding(RAYGUN_RAYTRACER_BINDING_INSTANCE_OFFSET_TABLE, 1, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eClosestHitKHR);
 
+    m_descriptorSet.addBinding(RAYGUN_RAYTRACER_BINDING_TEXTURES, RAYGUN_RAYTRACER_MAX_TEXTURES, vk::DescriptorType::eCombinedImageSampler,
+                               vk::ShaderStageFlagBits::eClosestHitKHR);
+
     m_descriptorSet.generate();
 }
 
@@ -256,12 +325,19 @@ void Raytracer::setupRaytracingPipeline()
         RG().resourceManager().loadShader("closesthit.rchit"),
     };
 
+    m_pipelineShaders.clear();
+
     const auto groupSize = utils::alignUp(m_properties.shaderGroupHandleSize, m_properties.shaderGroupBaseAlignment);
     const auto groupStride = groupSize;
 
     std::vector<vk::PipelineShaderStageCreateInfo> stages;
     std::vector<vk::RayTracingShaderGroupCreateInfoKHR> groups;
 
+    // Selects the vertex layout read by the closest hit shader.
+    const vk::Bool32 compressedVertices = RG().config().compressedVertices;
+    const vk::SpecializationMapEntry compressedVerticesEntry = {RAYGUN_RAYTRACER_CONSTANT_COMPRESSED_VERTICES, 0, sizeof(compressedVertices)};
+    const vk::SpecializationInfo closestHitSpecialization = {1, &compressedVerticesEntry, sizeof(compressedVertices), &compressedVertices};
+
     // The device address fields of the shader binding table data structures
     // will be filled with the offset for now since we have not allocated the
     // shader binding table, yet. The device address field will be rewritten in
@@ -272,6 +348,7 @@ void Raytracer::setupRaytracingPipeline()
         m_raygenSbt.setDeviceAddress(groups.size() * groupSize);
         for(const auto& raygenShader: raygenShaders) {
             stages.push_back(raygenShader->shaderStageInfo(vk::ShaderStageFlagBits::eRaygenKHR));
+            m_pipelineShaders.push_back(raygenShader->name);
             groups.push_back(generalShaderGroupInfo((uint32_t)groups.size()));
         }
         m_raygenSbt.setStride(groupStride).setSize(raygenShaders.size() * groupSize);
@@ -282,6 +359,7 @@ void Raytracer::setupRaytracingPipeline()
         m_missSbt.setDeviceAddress(groups.size() * groupSize);
         for(const auto& missShader: missShaders) {
             stages.push_back(missShader->shaderStageInfo(vk::ShaderStageFlagBits::eMissKHR));
+            m_pipelineShaders.push_back(missShader->name);
             groups.push_back(generalShaderGroupInfo((uint32_t)groups.size()));
         }
         m_missSbt.setStride(groupStride).setSize(missShaders.size() * groupSize);
@@ -292,6 +370,8 @@ void Raytracer::setupRaytracingPipeline()
         m_hitSbt.setDeviceAddress(groups.size() * groupSize);
         for(const auto& closestHitShader: closestHitShaders) {
             stages.push_back(closestHitShader->shaderStageInfo(vk::ShaderStageFlagBits::eClosestHitKHR));
+            stages.back().setPSpecializationInfo(&closestHitSpecialization);
+            m_pipelineShaders.push_back(closestHitShader->name);
             groups.push_back(closestHitShaderGroupInfo((uint32_t)groups.size()));
         }
         m_hitSbt.setStride(groupStride).setSize(closestHitShaders.size() * groupSize);
@@ -364,6 +444,26 @@ void Raytracer::setupRaytracingPipeline()
     }
 }
 
+void Raytracer::reloadShaders(const std::vector<Atom>& shaderNames)
+{
+    const auto changed = [&](Atom name) { return std::find(shaderNames.begin(), shaderNames.end(), name) != shaderNames.end(); };
+
+    if(std::any_of(m_pipelineShaders.begin(), m_pipelineShaders.end(), changed)) {
+        setupRaytracingPipeline();
+        RAYGUN_INFO("Ray tracing pipeline reloaded");
+    }
+
+    auto& cs = RG().computeSystem();
+
+    for(auto pass: {&m_roughPrepare, &m_roughBlurH, &m_roughBlurV, &m_postprocess, &m_fxaa}) {
+        const auto name = (*pass)->shaderName();
+        if(changed(name)) {
+            *pass = cs.createComputePass(name);
+            RAYGUN_INFO("Compute pass {} reloaded", name);
+        }
+    }
+}
+
 void Raytracer::setupPostprocessing()
 {
     auto& cs = RG().computeSystem();
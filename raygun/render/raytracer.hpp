@@ -27,6 +27,8 @@
 #include "raygun/gpu/gpu_buffer.hpp"
 #include "raygun/gpu/image.hpp"
 #include "raygun/render/acceleration_structure.hpp"
+#include "raygun/render/instance_table.hpp"
+#include "raygun/render/texture_streamer.hpp"
 #include "raygun/scene.hpp"
 #include "raygun/vulkan_context.hpp"
 
@@ -36,14 +38,21 @@ namespace raygun::render {
 struct Raytracer {
     Raytracer();
 
+    /// Builds the bottom level AS of all registered models which have none.
     void setupBottomLevelAS();
 
+    /// Rebuilds the pipelines using any of the given shaders.
+    void reloadShaders(const std::vector<Atom>& shaderNames);
+
+    /// See InstanceTable::invalidate.
+    void invalidateInstances() { m_instanceTable.invalidate(); }
+
     void setupTopLevelAS(vk::CommandBuffer& cmd, const Scene& scene);
 
     const gpu::Image& doRaytracing(vk::CommandBuffer& cmd);
 
     void updateRenderTarget(const gpu::Buffer& uniformBuffer, const gpu::Buffer& vertexBuffer, const gpu::Buffer& indexBuffer,
-                            const gpu::Buffer& materialBuffer);
+                            const gpu::Buffer& materialBuffer, const gpu::Buffer& primitiveMaterialBuffer, const TextureStreamer& textureStreamer);
 
   private:
     void setupRaytracingImages();
@@ -63,10 +72,14 @@ struct Raytracer {
 
     vk::PhysicalDeviceRayTracingPipelinePropertiesKHR m_properties = {};
 
+    InstanceTable m_instanceTable;
     UniqueTopLevelAS m_topLevelAS;
 
     gpu::DescriptorSet m_descriptorSet;
 
+    /// Generation of the texture array last written to m_descriptorSet.
+    uint64_t m_textureGeneration = std::numeric_limits<uint64_t>::max();
+
     vk::StridedDeviceAddressRegionKHR m_raygenSbt = {};
     vk::StridedDeviceAddressRegionKHR m_missSbt = {};
     vk::StridedDeviceAddressRegionKHR m_hitSbt = {};
@@ -75,6 +88,9 @@ struct Raytracer {
     vk::UniquePipeline m_pipeline;
     vk::UniquePipelineLayout m_pipelineLayout;
 
+    /// Shaders m_pipeline has been created from.
+    std::vector<Atom> m_pipelineShaders;
+
     gpu::UniqueBuffer m_sbtBuffer;
 
     bool m_useFXAA = true;
@@ -27,6 +27,8 @@
 #include "raygun/logging.hpp"
 #include "raygun/profiler.hpp"
 #include "raygun/raygun.hpp"
+#include "raygun/render/vertex_compression.hpp"
+#include "raygun/utils/memory_utils.hpp"
 
 namespace raygun::render {
 
@@ -47,6 +49,8 @@ RenderSystem::RenderSystem() : vc(RG().vc())
 
     m_raytracer = std::make_unique<Raytracer>();
 
+    m_textureStreamer = std::make_unique<TextureStreamer>();
+
     m_imGuiRenderer = std::make_unique<ImGuiRenderer>(*this);
 
     m_imageAcquiredSemaphore = vc.device->createSemaphoreUnique({});
@@ -93,9 +97,13 @@ void RenderSystem::render(Scene& scene)
 
         updateUniformBuffer(*scene.camera);
 
+        // The previous frame has finished, textures can be replaced.
+        m_textureStreamer->update(scene);
+
         m_raytracer->setupTopLevelAS(*m_commandBuffer, scene);
 
-        m_raytracer->updateRenderTarget(*m_uniformBuffer, *m_vertexBuffer, *m_indexBuffer, *m_materialBuffer);
+        m_raytracer->updateRenderTarget(*m_uniformBuffer, *m_vertexBuffer, *m_indexBuffer, *m_materialBuffer, *m_primitiveMaterialBuffer,
+                                        *m_textureStreamer);
 
         const auto& raytracerResultImage = m_raytracer->doRaytracing(*m_commandBuffer);
 
@@ -146,6 +154,7 @@ void RenderSystem::render(Scene& scene)
         beginRenderPass();
         {
             RG().profiler().doUI();
+            RG().resourceManager().telemetry().doUI();
             gpu::materialEditor();
 
             m_imGuiRenderer->render(*m_commandBuffer);
@@ -181,10 +190,17 @@ namespace {
         return ret;
     }
 
+    /// Meshes of all models including their levels of detail.
     std::set<Mesh*> distinctMeshes(const std::vector<Model*>& models)
     {
         std::set<Mesh*> result;
-        std::transform(models.begin(), models.end(), std::inserter(result, result.end()), [](auto model) { return model->mesh.get(); });
+        for(const auto& model: models) {
+            result.insert(model->mesh.get());
+
+            for(const auto& lod: model->lods) {
+                result.insert(lod.mesh.get());
+            }
+        }
         return result;
     }
 } // namespace
@@ -194,11 +210,16 @@ void RenderSystem::setupModelBuffers()
     auto models = RG().resourceManager().models();
     auto meshes = distinctMeshes(models);
 
-    RAYGUN_INFO("Setting up Model buffers: {} models", models.size());
+    const auto dedup = RG().resourceManager().meshRegistry().stats();
+    RAYGUN_INFO("Setting up Model buffers: {} models, {} meshes ({} duplicates merged, {:.1f} MB saved)", models.size(), meshes.size(), dedup.duplicates,
+                dedup.bytesSaved / (1024.0 * 1024.0));
 
     auto [vertexCount, indexCount, materialCount] = getCounts(models, meshes);
 
-    m_vertexBuffer = std::make_unique<gpu::Buffer>(vertexCount * sizeof(Vertex),
+    const auto compressed = RG().config().compressedVertices;
+    const auto vertexSize = compressed ? sizeof(CompressedVertex) : sizeof(Vertex);
+
+    m_vertexBuffer = std::make_unique<gpu::Buffer>(vertexCount * vertexSize,
                                                    vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eStorageBuffer
                                                        | vk::BufferUsageFlagBits::eShaderDeviceAddress
                                                        | vk::BufferUsageFlagBits::eAccelerationStructureBuildInputReadOnlyKHR,
@@ -217,6 +238,20 @@ void RenderSystem::setupModelBuffers()
                                                      vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
     m_materialBuffer->setName("Material Buffer");
 
+    // Both buffers need to exist for binding, even when unused.
+    const auto primitiveCount = compressed ? indexCount / 3 : 0;
+    m_primitiveMaterialBuffer = std::make_unique<gpu::Buffer>(std::max(utils::alignUp(primitiveCount * sizeof(uint16_t), 4), sizeof(uint32_t)),
+                                                              vk::BufferUsageFlagBits::eStorageBuffer,
+                                                              vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+    m_primitiveMaterialBuffer->setName("Primitive Material Buffer");
+
+    const auto transformCount = compressed ? std::max(meshes.size(), size_t{1}) : 1;
+    m_vertexTransformBuffer = std::make_unique<gpu::Buffer>(transformCount * sizeof(vk::TransformMatrixKHR),
+                                                            vk::BufferUsageFlagBits::eShaderDeviceAddress
+                                                                | vk::BufferUsageFlagBits::eAccelerationStructureBuildInputReadOnlyKHR,
+                                                            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+    m_vertexTransformBuffer->setName("Vertex Transform Buffer");
+
     updateVertexAndIndexBuffer(meshes);
 
     updateMaterialBuffer(models);
@@ -232,6 +267,68 @@ void RenderSystem::updateModelBuffers()
     updateMaterialBuffer(models);
 }
 
+void RenderSystem::updateMaterial(const Material& material)
+{
+    const auto materialStart = static_cast<uint8_t*>(m_materialBuffer->map());
+
+    for(const auto& model: RG().resourceManager().models()) {
+        const auto& materials = model->materials;
+
+        // Models registered after the buffer has been set up have no slots.
+        if(model->materialBufferRef.sizeInBytes != materials.size() * sizeof(gpu::Material)) continue;
+
+        for(size_t i = 0; i < materials.size(); ++i) {
+            if(materials[i].get() != &material) continue;
+
+            const auto offset = model->materialBufferRef.offsetInBytes + i * sizeof(gpu::Material);
+            memcpy(materialStart + offset, &material.gpuMaterial, sizeof(gpu::Material));
+        }
+    }
+
+    m_materialBuffer->unmap();
+}
+
+void RenderSystem::updateGeometry()
+{
+    vc.waitIdle();
+
+    auto models = RG().resourceManager().models();
+    auto meshes = distinctMeshes(models);
+
+    const auto [vertexCount, indexCount, materialCount] = getCounts(models, meshes);
+
+    const auto compressed = RG().config().compressedVertices;
+    const auto vertexSize = compressed ? sizeof(CompressedVertex) : sizeof(Vertex);
+
+    auto fits = vertexCount * vertexSize <= m_vertexBuffer->size() && indexCount * sizeof(uint32_t) <= m_indexBuffer->size()
+                && materialCount * sizeof(gpu::Material) <= m_materialBuffer->size();
+
+    if(compressed) {
+        fits = fits && indexCount / 3 * sizeof(uint16_t) <= m_primitiveMaterialBuffer->size()
+               && meshes.size() * sizeof(vk::TransformMatrixKHR) <= m_vertexTransformBuffer->size();
+    }
+
+    if(fits) {
+        updateVertexAndIndexBuffer(meshes);
+        updateMaterialBuffer(models);
+    }
+    else {
+        setupModelBuffers();
+    }
+
+    m_raytracer->setupBottomLevelAS();
+
+    // Buffer offsets of all meshes may have changed.
+    m_raytracer->invalidateInstances();
+}
+
+void RenderSystem::reloadShaders(const std::vector<Atom>& shaderNames)
+{
+    vc.waitIdle();
+
+    m_raytracer->reloadShaders(shaderNames);
+}
+
 void RenderSystem::resetUniformBuffer()
 {
     auto& ubo = *static_cast<gpu::UniformBufferObject*>(m_uniformBuffer->map());
@@ -269,15 +366,23 @@ void RenderSystem::updateUniformBuffer(const Camera& camera)
 
 void RenderSystem::updateVertexAndIndexBuffer(std::set<Mesh*>& meshes)
 {
+    const auto compressed = RG().config().compressedVertices;
+    const auto vertexElementSize = (uint32_t)(compressed ? sizeof(CompressedVertex) : sizeof(Vertex));
+
     const auto vertexStart = static_cast<uint8_t*>(m_vertexBuffer->map());
     uint32_t vertexOffset = 0;
 
     const auto indexStart = static_cast<uint8_t*>(m_indexBuffer->map());
     uint32_t indexOffset = 0;
 
+    const auto primitiveMaterialStart = static_cast<uint16_t*>(m_primitiveMaterialBuffer->map());
+
+    const auto transformStart = static_cast<uint8_t*>(m_vertexTransformBuffer->map());
+    uint32_t transformOffset = 0;
+
     for(const auto& mesh: meshes) {
         const auto& vertices = mesh->vertices;
-        const auto vertexSize = (uint32_t)(vertices.size() * sizeof(vertices[0]));
+        const auto vertexSize = (uint32_t)vertices.size() * vertexElementSize;
 
         const auto& indices = mesh->indices;
         const auto indexSize = (uint32_t)(indices.size() * sizeof(indices[0]));
@@ -285,14 +390,36 @@ void RenderSystem::updateVertexAndIndexBuffer(std::set<Mesh*>& meshes)
         mesh->vertexBufferRef.bufferAddress = m_vertexBuffer->address();
         mesh->vertexBufferRef.offsetInBytes = vertexOffset;
         mesh->vertexBufferRef.sizeInBytes = vertexSize;
-        mesh->vertexBufferRef.elementSize = sizeof(vertices[0]);
+        mesh->vertexBufferRef.elementSize = vertexElementSize;
 
         mesh->indexBufferRef.bufferAddress = m_indexBuffer->address();
         mesh->indexBufferRef.offsetInBytes = indexOffset;
         mesh->indexBufferRef.sizeInBytes = indexSize;
         mesh->indexBufferRef.elementSize = sizeof(indices[0]);
 
-        memcpy(vertexStart + vertexOffset, vertices.data(), vertexSize);
+        if(compressed) {
+            const auto bounds = QuantizationBounds::of(*mesh);
+            compressVertices(*mesh, bounds, reinterpret_cast<CompressedVertex*>(vertexStart + vertexOffset));
+
+            // Primitives are laid out parallel to the index buffer.
+            writePrimitiveMaterials(*mesh, primitiveMaterialStart + indexOffset / sizeof(indices[0]) / 3);
+
+            const auto matrix = bounds.dequantizationMatrix();
+            static_assert(sizeof(matrix) == sizeof(vk::TransformMatrixKHR));
+            memcpy(transformStart + transformOffset, matrix.data(), sizeof(matrix));
+
+            mesh->transformBufferRef.bufferAddress = m_vertexTransformBuffer->address();
+            mesh->transformBufferRef.offsetInBytes = transformOffset;
+            mesh->transformBufferRef.sizeInBytes = sizeof(matrix);
+            mesh->transformBufferRef.elementSize = sizeof(matrix);
+
+            transformOffset += sizeof(matrix);
+        }
+        else {
+            memcpy(vertexStart + vertexOffset, vertices.data(), vertexSize);
+            mesh->transformBufferRef = {};
+        }
+
         memcpy(indexStart + indexOffset, indices.data(), indexSize);
 
         vertexOffset += vertexSize;
@@ -301,6 +428,8 @@ void RenderSystem::updateVertexAndIndexBuffer(std::set<Mesh*>& meshes)
 
     m_vertexBuffer->unmap();
     m_indexBuffer->unmap();
+    m_primitiveMaterialBuffer->unmap();
+    m_vertexTransformBuffer->unmap();
 }
 
 void RenderSystem::updateMaterialBuffer(std::vector<Model*>& models)
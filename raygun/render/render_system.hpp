@@ -32,6 +32,7 @@
 #include "raygun/render/imgui_renderer.hpp"
 #include "raygun/render/raytracer.hpp"
 #include "raygun/render/swapchain.hpp"
+#include "raygun/render/texture_streamer.hpp"
 #include "raygun/scene.hpp"
 #include "raygun/vulkan_context.hpp"
 #include "raygun/window.hpp"
@@ -54,12 +55,25 @@ class RenderSystem {
     void setupModelBuffers();
     void updateModelBuffers();
 
+    /// Rewrites only the material buffer slots referring to material.
+    void updateMaterial(const Material& material);
+
+    /// Uploads the geometry of all models again, the buffers are only
+    /// recreated if it no longer fits. The bottom level AS of models whose
+    /// meshes were replaced are rebuilt.
+    void updateGeometry();
+
+    /// Rebuilds the pipelines using any of the given shaders.
+    void reloadShaders(const std::vector<Atom>& shaderNames);
+
     vk::RenderPass& renderPass() { return *m_renderPass; }
 
     Swapchain& swapchain() { return *m_swapchain; }
 
     Raytracer& raytracer() { return *m_raytracer; }
 
+    TextureStreamer& textureStreamer() { return *m_textureStreamer; }
+
     void resetUniformBuffer();
 
     template<class F, typename... Args>
@@ -82,6 +96,8 @@ class RenderSystem {
 
     UniqueRaytracer m_raytracer;
 
+    UniqueTextureStreamer m_textureStreamer;
+
     UniqueImGuiRenderer m_imGuiRenderer;
 
     gpu::UniqueBuffer m_uniformBuffer;
@@ -89,6 +105,10 @@ class RenderSystem {
     gpu::UniqueBuffer m_indexBuffer;
     gpu::UniqueBuffer m_materialBuffer;
 
+    // Only used with compressed vertices, see vertex_compression.hpp.
+    gpu::UniqueBuffer m_primitiveMaterialBuffer;
+    gpu::UniqueBuffer m_vertexTransformBuffer;
+
     uint32_t m_framebufferIndex = 0;
 
     vk::UniqueSemaphore m_imageAcquiredSemaphore;
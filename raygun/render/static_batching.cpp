@@ -0,0 +1,137 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#include "raygun/render/static_batching.hpp"
+
+#include "raygun/logging.hpp"
+#include "raygun/raygun.hpp"
+#include "raygun/scene.hpp"
+
+namespace raygun::render {
+
+namespace {
+
+    bool isBatchable(const Entity& entity)
+    {
+        if(entity.mobility() != Mobility::Static) return false;
+
+        if(!entity.model || entity.model->mesh->indices.empty()) return false;
+
+        // Dynamic bodies move no matter what.
+        if(entity.physicsActor && entity.physicsActor->is<physx::PxRigidDynamic>()) return false;
+
+        return true;
+    }
+
+    void appendInWorldSpace(Mesh& target, const Entity& entity)
+    {
+        const auto& mesh = *entity.model->mesh;
+
+        const auto transform = entity.globalTransform().toMat4();
+
+        // Same normal transformation as done in the closest hit shader.
+        const auto normalTransform = mat3(transform);
+
+        const auto firstVertex = target.vertices.size();
+        target.merge(mesh);
+
+        for(auto i = firstVertex; i < target.vertices.size(); ++i) {
+            auto& vertex = target.vertices[i];
+            vertex.position = vec3(transform * vec4(vertex.position, 1.0f));
+            vertex.normal = glm::normalize(normalTransform * vertex.normal);
+        }
+    }
+
+    struct Batch {
+        std::vector<std::shared_ptr<Material>> materials;
+        std::vector<Entity*> entities;
+    };
+
+} // namespace
+
+void batchStaticGeometry(Scene& scene)
+{
+    std::vector<Batch> batches;
+
+    scene.root->forEachEntity([&](Entity& entity) {
+        // Entities hidden at load time may be shown later on, leave them as is.
+        if(!entity.isVisible()) return false;
+        if(entity.transform().isZeroVolume()) return false;
+
+        if(!isBatchable(entity)) return true;
+
+        const auto& materials = entity.model->materials;
+
+        auto it = std::find_if(batches.begin(), batches.end(), [&](const Batch& batch) { return batch.materials == materials; });
+        if(it == batches.end()) {
+            it = batches.insert(batches.end(), Batch{materials, {}});
+        }
+
+        it->entities.push_back(&entity);
+
+        return true;
+    });
+
+    auto batchedEntities = 0u;
+    auto batchedModels = 0u;
+
+    for(const auto& batch: batches) {
+        // Nothing to gain from merging a single entity.
+        if(batch.entities.size() < 2) continue;
+
+        auto model = std::make_shared<Model>();
+        model->mesh = std::make_shared<Mesh>();
+        model->materials = batch.materials;
+
+        size_t vertexCount = 0;
+        size_t indexCount = 0;
+        for(auto entity: batch.entities) {
+            vertexCount += entity->model->mesh->vertices.size();
+            indexCount += entity->model->mesh->indices.size();
+        }
+
+        model->mesh->vertices.reserve(vertexCount);
+        model->mesh->indices.reserve(indexCount);
+
+        for(auto entity: batch.entities) {
+            appendInWorldSpace(*model->mesh, *entity);
+            entity->model.reset();
+        }
+
+        RG().resourceManager().registerModel(model);
+
+        auto batchEntity = makeEntity("static_batch");
+        batchEntity->model = model;
+        batchEntity->setMobility(Mobility::Static);
+        scene.root->addChild(batchEntity);
+
+        batchedEntities += (uint32_t)batch.entities.size();
+        ++batchedModels;
+    }
+
+    if(batchedModels > 0) {
+        RAYGUN_INFO("Static batching: merged {} entities into {} models", batchedEntities, batchedModels);
+    }
+}
+
+} // namespace raygun::render
@@ -0,0 +1,52 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#pragma once
+
+#include "raygun/atom.hpp"
+#include "raygun/render/texture_data.hpp"
+
+namespace raygun::render {
+
+/// Textures named *_normal are normal maps, they are stored linear and
+/// compressed to BC5.
+inline bool isNormalMap(string_view textureName)
+{
+    constexpr string_view suffix = "_normal";
+    return textureName.size() >= suffix.size() && textureName.substr(textureName.size() - suffix.size()) == suffix;
+}
+
+/// Texture as cached by the ResourceManager, with all mips on the CPU. The
+/// TextureStreamer decides which of them are resident on the GPU.
+struct Texture {
+    Texture(Atom name, TextureData data) : name(name), data(std::move(data)) {}
+
+    Atom name;
+
+    TextureData data;
+
+    /// Index into the bindless texture array of the ray tracer, assigned by
+    /// TextureStreamer::add. Slot 0 is reserved for "no texture".
+    uint32_t slot = 0;
+};
+
+} // namespace raygun::render
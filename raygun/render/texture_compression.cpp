@@ -0,0 +1,461 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "raygun/render/texture_compression.hpp"
+
+#include "raygun/assert.hpp"
+#include "raygun/utils/parallel_for.hpp"
+
+namespace raygun::render {
+
+namespace {
+
+    constexpr uint32_t BLOCK_TEXELS = 16;
+
+    constexpr uint32_t POWER_ITERATIONS = 8;
+
+    /// Fraction of the first endpoint per BC1 index.
+    constexpr std::array<float, 4> BC1_WEIGHTS = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+
+    /// Interpolation weights of 4 bit BC7 indices, out of 64.
+    constexpr std::array<uint32_t, 16> BC7_WEIGHTS = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    /// Writes bits LSB-first, as laid out by all BC formats.
+    class BitWriter {
+      public:
+        explicit BitWriter(uint8_t* out, size_t size) : m_out(out) { memset(out, 0, size); }
+
+        void write(uint32_t value, uint32_t count)
+        {
+            for(uint32_t i = 0; i < count; ++i, ++m_pos) {
+                m_out[m_pos / 8] |= (uint8_t)(((value >> i) & 1) << (m_pos % 8));
+            }
+        }
+
+      private:
+        uint8_t* m_out;
+        uint32_t m_pos = 0;
+    };
+
+    /// Endpoints along the principal axis of the texels, the first one at
+    /// the end the axis points to.
+    template<typename Vec>
+    std::pair<Vec, Vec> principalEndpoints(const std::array<Vec, BLOCK_TEXELS>& texels)
+    {
+        Vec mean(0.0f);
+        for(const auto& texel: texels) mean += texel;
+        mean /= (float)BLOCK_TEXELS;
+
+        using Mat = glm::mat<Vec::length(), Vec::length(), float, glm::defaultp>;
+
+        Mat covariance(0.0f);
+        for(const auto& texel: texels) {
+            covariance += glm::outerProduct(texel - mean, texel - mean);
+        }
+
+        Vec axis(1.0f);
+        for(uint32_t i = 0; i < POWER_ITERATIONS; ++i) {
+            const auto next = covariance * axis;
+            const auto length = glm::length(next);
+            if(length < 1e-6f) break;
+            axis = next / length;
+        }
+
+        auto minT = 0.0f, maxT = 0.0f;
+        for(const auto& texel: texels) {
+            const auto t = glm::dot(texel - mean, axis);
+            minT = std::min(minT, t);
+            maxT = std::max(maxT, t);
+        }
+
+        const auto clampTexel = [](const Vec& v) { return glm::clamp(v, Vec(0.0f), Vec(255.0f)); };
+        return {clampTexel(mean + axis * maxT), clampTexel(mean + axis * minT)};
+    }
+
+    /// Least squares fit of the endpoints to the texels for the given
+    /// indices, weights[i] being the fraction of the first endpoint. Returns
+    /// false if the system is degenerate, e.g. all texels use one index.
+    template<typename Vec, typename Weights>
+    bool refitEndpoints(const std::array<Vec, BLOCK_TEXELS>& texels, const std::array<uint8_t, BLOCK_TEXELS>& indices, const Weights& weights,
+                        std::pair<Vec, Vec>& endpoints)
+    {
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        Vec ax(0.0f), bx(0.0f);
+
+        for(uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+            const auto a = weights[indices[i]];
+            const auto b = 1.0f - a;
+
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            ax += a * texels[i];
+            bx += b * texels[i];
+        }
+
+        const auto det = aa * bb - ab * ab;
+        if(std::abs(det) < 1e-6f) return false;
+
+        endpoints.first = glm::clamp((ax * bb - bx * ab) / det, Vec(0.0f), Vec(255.0f));
+        endpoints.second = glm::clamp((bx * aa - ax * ab) / det, Vec(0.0f), Vec(255.0f));
+        return true;
+    }
+
+    template<typename Vec>
+    float distance2(const Vec& a, const Vec& b)
+    {
+        const auto d = a - b;
+        return glm::dot(d, d);
+    }
+
+    /// Picks the nearest palette entry for each texel, returns the total
+    /// squared error.
+    template<typename Vec, size_t N>
+    float assignIndices(const std::array<Vec, BLOCK_TEXELS>& texels, const std::array<Vec, N>& palette, std::array<uint8_t, BLOCK_TEXELS>& indices)
+    {
+        auto total = 0.0f;
+        for(uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+            auto best = std::numeric_limits<float>::max();
+            for(uint32_t p = 0; p < N; ++p) {
+                const auto error = distance2(texels[i], palette[p]);
+                if(error < best) {
+                    best = error;
+                    indices[i] = (uint8_t)p;
+                }
+            }
+            total += best;
+        }
+        return total;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // BC1
+
+    uint16_t packRgb565(const vec3& color)
+    {
+        const auto r = (uint32_t)std::lround(color.r * 31.0f / 255.0f);
+        const auto g = (uint32_t)std::lround(color.g * 63.0f / 255.0f);
+        const auto b = (uint32_t)std::lround(color.b * 31.0f / 255.0f);
+        return (uint16_t)(r << 11 | g << 5 | b);
+    }
+
+    vec3 unpackRgb565(uint16_t packed)
+    {
+        const auto r = (packed >> 11) & 31;
+        const auto g = (packed >> 5) & 63;
+        const auto b = packed & 31;
+        return {(float)(r << 3 | r >> 2), (float)(g << 2 | g >> 4), (float)(b << 3 | b >> 2)};
+    }
+
+    struct BC1Candidate {
+        uint16_t color0 = 0;
+        uint16_t color1 = 0;
+        std::array<uint8_t, BLOCK_TEXELS> indices = {};
+        float error = std::numeric_limits<float>::max();
+    };
+
+    BC1Candidate evaluateBC1(const std::array<vec3, BLOCK_TEXELS>& texels, const std::pair<vec3, vec3>& endpoints)
+    {
+        BC1Candidate result;
+        result.color0 = packRgb565(endpoints.first);
+        result.color1 = packRgb565(endpoints.second);
+
+        // Four color mode requires color0 > color1.
+        if(result.color0 < result.color1) std::swap(result.color0, result.color1);
+
+        if(result.color0 == result.color1) {
+            const auto color = unpackRgb565(result.color0);
+
+            result.error = 0.0f;
+            for(const auto& texel: texels) result.error += distance2(texel, color);
+            return result;
+        }
+
+        const auto c0 = unpackRgb565(result.color0);
+        const auto c1 = unpackRgb565(result.color1);
+
+        std::array<vec3, 4> palette;
+        for(uint32_t i = 0; i < palette.size(); ++i) {
+            palette[i] = glm::mix(c1, c0, BC1_WEIGHTS[i]);
+        }
+
+        result.error = assignIndices(texels, palette, result.indices);
+        return result;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // BC4 / BC5
+
+    void encodeBC4(const std::array<uint8_t, BLOCK_TEXELS>& values, uint8_t* out)
+    {
+        const auto [minIt, maxIt] = std::minmax_element(values.begin(), values.end());
+        const auto max = *maxIt, min = *minIt;
+
+        out[0] = max;
+        out[1] = min;
+
+        // With max > min the palette holds 8 interpolated values, otherwise
+        // all indices are 0 and refer to max.
+        uint64_t bits = 0;
+        if(max > min) {
+            std::array<float, 8> palette = {(float)max, (float)min};
+            for(uint32_t i = 2; i < palette.size(); ++i) {
+                palette[i] = ((8 - i) * (float)max + (i - 1) * (float)min) / 7.0f;
+            }
+
+            for(uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+                uint32_t best = 0;
+                for(uint32_t p = 1; p < palette.size(); ++p) {
+                    if(std::abs(values[i] - palette[p]) < std::abs(values[i] - palette[best])) best = p;
+                }
+                bits |= (uint64_t)best << (3 * i);
+            }
+        }
+
+        for(uint32_t i = 0; i < 6; ++i) {
+            out[2 + i] = (uint8_t)(bits >> (8 * i));
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // BC7
+
+    /// Endpoint quantized to 7 bits per channel plus a p-bit shared by all
+    /// channels.
+    struct BC7Endpoint {
+        glm::uvec4 color;
+        uint32_t pBit = 0;
+
+        vec4 expand() const { return vec4((color << 1u) | glm::uvec4(pBit)); }
+    };
+
+    BC7Endpoint quantizeBC7(const vec4& value, uint32_t pBit)
+    {
+        BC7Endpoint result;
+        result.pBit = pBit;
+        result.color = glm::uvec4(glm::clamp(glm::round((value - (float)pBit) / 2.0f), vec4(0.0f), vec4(127.0f)));
+        return result;
+    }
+
+    struct BC7Candidate {
+        BC7Endpoint endpoint0, endpoint1;
+        std::array<uint8_t, BLOCK_TEXELS> indices = {};
+        float error = std::numeric_limits<float>::max();
+    };
+
+    /// Tries all p-bit combinations, endpoints.first is used for index 0.
+    BC7Candidate evaluateBC7(const std::array<vec4, BLOCK_TEXELS>& texels, const std::pair<vec4, vec4>& endpoints)
+    {
+        BC7Candidate best;
+
+        for(uint32_t pBits = 0; pBits < 4; ++pBits) {
+            BC7Candidate candidate;
+            candidate.endpoint0 = quantizeBC7(endpoints.first, pBits & 1);
+            candidate.endpoint1 = quantizeBC7(endpoints.second, pBits >> 1);
+
+            const auto e0 = candidate.endpoint0.expand();
+            const auto e1 = candidate.endpoint1.expand();
+
+            std::array<vec4, BC7_WEIGHTS.size()> palette;
+            for(uint32_t i = 0; i < palette.size(); ++i) {
+                palette[i] = glm::floor((e0 * (64.0f - BC7_WEIGHTS[i]) + e1 * (float)BC7_WEIGHTS[i] + 32.0f) / 64.0f);
+            }
+
+            candidate.error = assignIndices(texels, palette, candidate.indices);
+            if(candidate.error < best.error) best = candidate;
+        }
+
+        return best;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+
+    /// Copies the 4x4 block at (blockX, blockY) of mip, edge texels are
+    /// repeated for partial blocks.
+    void gatherBlock(const TextureData& texture, uint32_t mip, uint32_t blockX, uint32_t blockY, uint8_t* out)
+    {
+        const auto& level = texture.mips[mip];
+        const auto* texels = texture.mipData(mip);
+
+        for(uint32_t y = 0; y < 4; ++y) {
+            const auto sy = std::min(blockY * 4 + y, level.height - 1);
+            for(uint32_t x = 0; x < 4; ++x) {
+                const auto sx = std::min(blockX * 4 + x, level.width - 1);
+                memcpy(out + 4 * (4 * y + x), texels + 4 * ((size_t)sy * level.width + sx), 4);
+            }
+        }
+    }
+
+} // namespace
+
+TextureFormat compressedFormatFor(const TextureData& texture, bool normalMap)
+{
+    if(normalMap) return TextureFormat::BC5Unorm;
+
+    const auto srgb = isSrgb(texture.format);
+    if(texture.hasAlpha()) return srgb ? TextureFormat::BC7Srgb : TextureFormat::BC7Unorm;
+
+    return srgb ? TextureFormat::BC1Srgb : TextureFormat::BC1Unorm;
+}
+
+TextureData compressTexture(const TextureData& texture, TextureFormat format)
+{
+    RAYGUN_ASSERT(!isBlockCompressed(texture.format) && isBlockCompressed(format));
+    RAYGUN_ASSERT(format == TextureFormat::BC5Unorm || isSrgb(texture.format) == isSrgb(format));
+
+    TextureData result(format, texture.width(), texture.height(), texture.mipCount());
+
+    const auto blockSize = format == TextureFormat::BC1Unorm || format == TextureFormat::BC1Srgb ? 8u : 16u;
+
+    const auto encode = [&](const uint8_t* texels, uint8_t* out) {
+        switch(format) {
+        case TextureFormat::BC1Unorm:
+        case TextureFormat::BC1Srgb:
+            encodeBC1(texels, out);
+            break;
+        case TextureFormat::BC5Unorm:
+            encodeBC5(texels, out);
+            break;
+        default:
+            encodeBC7(texels, out);
+            break;
+        }
+    };
+
+    // One task per row of blocks over all mips, small mips are grouped with
+    // others instead of being split.
+    struct Task {
+        uint32_t mip;
+        uint32_t blockRow;
+    };
+
+    std::vector<Task> tasks;
+    for(uint32_t mip = 0; mip < texture.mipCount(); ++mip) {
+        for(uint32_t row = 0; row < (texture.mips[mip].height + 3) / 4; ++row) {
+            tasks.push_back({mip, row});
+        }
+    }
+
+    utils::parallelFor(tasks.size(), [&](size_t i) {
+        const auto [mip, row] = tasks[i];
+        const auto blocksPerRow = (texture.mips[mip].width + 3) / 4;
+
+        auto* out = result.mipData(mip) + (size_t)row * blocksPerRow * blockSize;
+
+        std::array<uint8_t, 4 * BLOCK_TEXELS> texels;
+        for(uint32_t x = 0; x < blocksPerRow; ++x, out += blockSize) {
+            gatherBlock(texture, mip, x, row, texels.data());
+            encode(texels.data(), out);
+        }
+    });
+
+    return result;
+}
+
+void encodeBC1(const uint8_t* texels, uint8_t* out)
+{
+    std::array<vec3, BLOCK_TEXELS> colors;
+    for(uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+        colors[i] = {texels[4 * i], texels[4 * i + 1], texels[4 * i + 2]};
+    }
+
+    auto endpoints = principalEndpoints(colors);
+    auto best = evaluateBC1(colors, endpoints);
+
+    // Endpoint order may have been swapped by evaluateBC1.
+    const auto c0 = unpackRgb565(best.color0);
+    const auto c1 = unpackRgb565(best.color1);
+    std::pair<vec3, vec3> refined = {c0, c1};
+    if(best.color0 != best.color1 && refitEndpoints(colors, best.indices, BC1_WEIGHTS, refined)) {
+        const auto candidate = evaluateBC1(colors, refined);
+        if(candidate.error < best.error) best = candidate;
+    }
+
+    out[0] = (uint8_t)best.color0;
+    out[1] = (uint8_t)(best.color0 >> 8);
+    out[2] = (uint8_t)best.color1;
+    out[3] = (uint8_t)(best.color1 >> 8);
+
+    uint32_t bits = 0;
+    for(uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+        bits |= (uint32_t)best.indices[i] << (2 * i);
+    }
+    memcpy(out + 4, &bits, sizeof(bits));
+}
+
+void encodeBC5(const uint8_t* texels, uint8_t* out)
+{
+    for(uint32_t channel = 0; channel < 2; ++channel) {
+        std::array<uint8_t, BLOCK_TEXELS> values;
+        for(uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+            values[i] = texels[4 * i + channel];
+        }
+
+        encodeBC4(values, out + 8 * channel);
+    }
+}
+
+void encodeBC7(const uint8_t* texels, uint8_t* out)
+{
+    std::array<vec4, BLOCK_TEXELS> colors;
+    for(uint32_t i = 0; i < BLOCK_TEXELS; ++i) {
+        colors[i] = {texels[4 * i], texels[4 * i + 1], texels[4 * i + 2], texels[4 * i + 3]};
+    }
+
+    const auto endpoints = principalEndpoints(colors);
+    auto best = evaluateBC7(colors, endpoints);
+
+    std::array<float, BC7_WEIGHTS.size()> weights;
+    for(uint32_t i = 0; i < weights.size(); ++i) {
+        weights[i] = 1.0f - BC7_WEIGHTS[i] / 64.0f;
+    }
+
+    std::pair<vec4, vec4> refined;
+    if(refitEndpoints(colors, best.indices, weights, refined)) {
+        const auto candidate = evaluateBC7(colors, refined);
+        if(candidate.error < best.error) best = candidate;
+    }
+
+    // The most significant bit of the first index is implicitly zero.
+    if(best.indices[0] >= 8) {
+        std::swap(best.endpoint0, best.endpoint1);
+        for(auto& index: best.indices) index = (uint8_t)(15 - index);
+    }
+
+    BitWriter bits(out, 16);
+    bits.write(1u << 6, 7);
+
+    for(int channel = 0; channel < 4; ++channel) {
+        bits.write(best.endpoint0.color[channel], 7);
+        bits.write(best.endpoint1.color[channel], 7);
+    }
+
+    bits.write(best.endpoint0.pBit, 1);
+    bits.write(best.endpoint1.pBit, 1);
+
+    bits.write(best.indices[0], 3);
+    for(uint32_t i = 1; i < BLOCK_TEXELS; ++i) {
+        bits.write(best.indices[i], 4);
+    }
+}
+
+} // namespace raygun::render
@@ -0,0 +1,48 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#pragma once
+
+#include "raygun/render/texture_data.hpp"
+
+namespace raygun::render {
+
+/// Block compressed format used when cooking texture: BC5 for normal maps,
+/// BC7 for color with alpha and BC1 for opaque color.
+TextureFormat compressedFormatFor(const TextureData& texture, bool normalMap);
+
+/// Compresses all mips of an RGBA8 texture into format, which needs to be
+/// block compressed. sRGB textures need an sRGB target format and vice versa,
+/// BC5 keeps red and green. Blocks are encoded on all cores.
+TextureData compressTexture(const TextureData& texture, TextureFormat format);
+
+// Single block encoders, texels are a 4x4 block of RGBA8 texels in row
+// order.
+
+/// Alpha is ignored.
+void encodeBC1(const uint8_t* texels, uint8_t* out);
+void encodeBC5(const uint8_t* texels, uint8_t* out);
+
+/// Uses mode 6 only: one RGBA endpoint pair with 4 bit indices.
+void encodeBC7(const uint8_t* texels, uint8_t* out);
+
+} // namespace raygun::render
@@ -0,0 +1,304 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "raygun/render/texture_data.hpp"
+
+#include "raygun/assert.hpp"
+#include "raygun/utils/parallel_for.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define RAYGUN_TEXTURE_SSE2 1
+    #include <emmintrin.h>
+#else
+    #define RAYGUN_TEXTURE_SSE2 0
+#endif
+
+namespace raygun::render {
+
+namespace {
+
+    /// Levels with fewer texels are generated on the calling thread only.
+    constexpr size_t PARALLEL_MIN_TEXELS = 128 * 128;
+
+    constexpr uint32_t ROWS_PER_TASK = 16;
+
+    /// Resolution of the tables mapping averaged values back to 8 bit.
+    constexpr uint32_t ENCODE_STEPS = 4096;
+
+    struct ConversionTables {
+        /// Per texel value: sRGB decoded color, alpha is linear.
+        std::array<float, 256> srgbToLinear;
+        std::array<float, 256> unormToLinear;
+
+        /// Indexed by the averaged value in [0, 1] times ENCODE_STEPS - 1.
+        std::array<uint8_t, ENCODE_STEPS> linearToSrgb;
+        std::array<uint8_t, ENCODE_STEPS> linearToUnorm;
+    };
+
+    const ConversionTables& conversionTables()
+    {
+        static const auto tables = [] {
+            ConversionTables result;
+
+            for(uint32_t i = 0; i < 256; ++i) {
+                const auto c = (float)i / 255.0f;
+                result.srgbToLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+                result.unormToLinear[i] = c;
+            }
+
+            for(uint32_t i = 0; i < ENCODE_STEPS; ++i) {
+                const auto l = (float)i / (ENCODE_STEPS - 1);
+                const auto s = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+                result.linearToSrgb[i] = (uint8_t)std::lround(std::clamp(s, 0.0f, 1.0f) * 255.0f);
+                result.linearToUnorm[i] = (uint8_t)std::lround(l * 255.0f);
+            }
+
+            return result;
+        }();
+
+        return tables;
+    }
+
+    /// Source texels of a destination row, clamped for odd sizes.
+    struct SourceRows {
+        const uint8_t* top;
+        const uint8_t* bottom;
+        uint32_t width;
+    };
+
+    void downsampleRowUnorm(const SourceRows& src, uint8_t* dst, uint32_t dstWidth)
+    {
+        uint32_t x = 0;
+
+#if RAYGUN_TEXTURE_SSE2
+        // Two destination texels from 4x2 source texels per iteration.
+        const auto zero = _mm_setzero_si128();
+        const auto rounding = _mm_set1_epi16(2);
+
+        for(; 2 * x + 3 < src.width && x + 1 < dstWidth; x += 2) {
+            const auto top = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.top + 8 * x));
+            const auto bottom = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.bottom + 8 * x));
+
+            // Vertical sums of texel 0, 1 and 2, 3 as 16 bit.
+            const auto left = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+            const auto right = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+
+            // Horizontal sums: (0 + 1, 2 + 3).
+            auto sum = _mm_add_epi16(_mm_unpacklo_epi64(left, right), _mm_unpackhi_epi64(left, right));
+            sum = _mm_srli_epi16(_mm_add_epi16(sum, rounding), 2);
+
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 4 * x), _mm_packus_epi16(sum, sum));
+        }
+#endif
+
+        for(; x < dstWidth; ++x) {
+            const auto x0 = std::min(2 * x, src.width - 1);
+            const auto x1 = std::min(2 * x + 1, src.width - 1);
+
+            for(uint32_t c = 0; c < 4; ++c) {
+                const uint32_t sum = src.top[4 * x0 + c] + src.top[4 * x1 + c] + src.bottom[4 * x0 + c] + src.bottom[4 * x1 + c];
+                dst[4 * x + c] = (uint8_t)((sum + 2) >> 2);
+            }
+        }
+    }
+
+    void downsampleRowSrgb(const SourceRows& src, uint8_t* dst, uint32_t dstWidth)
+    {
+        const auto& tables = conversionTables();
+
+        for(uint32_t x = 0; x < dstWidth; ++x) {
+            const auto x0 = std::min(2 * x, src.width - 1);
+            const auto x1 = std::min(2 * x + 1, src.width - 1);
+
+            std::array<int32_t, 4> index;
+
+#if RAYGUN_TEXTURE_SSE2
+            const auto load = [&](const uint8_t* texel) {
+                return _mm_set_ps(tables.unormToLinear[texel[3]], tables.srgbToLinear[texel[2]], tables.srgbToLinear[texel[1]], tables.srgbToLinear[texel[0]]);
+            };
+
+            const auto sum = _mm_add_ps(_mm_add_ps(load(src.top + 4 * x0), load(src.top + 4 * x1)),
+                                        _mm_add_ps(load(src.bottom + 4 * x0), load(src.bottom + 4 * x1)));
+
+            const auto scaled = _mm_mul_ps(sum, _mm_set1_ps((ENCODE_STEPS - 1) / 4.0f));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(index.data()), _mm_cvtps_epi32(scaled));
+#else
+            for(uint32_t c = 0; c < 4; ++c) {
+                const auto& toLinear = c < 3 ? tables.srgbToLinear : tables.unormToLinear;
+                const auto sum = toLinear[src.top[4 * x0 + c]] + toLinear[src.top[4 * x1 + c]] + toLinear[src.bottom[4 * x0 + c]]
+                                 + toLinear[src.bottom[4 * x1 + c]];
+                index[c] = (int32_t)std::lround(sum * ((ENCODE_STEPS - 1) / 4.0f));
+            }
+#endif
+
+            for(uint32_t c = 0; c < 3; ++c) {
+                dst[4 * x + c] = tables.linearToSrgb[index[c]];
+            }
+            dst[4 * x + 3] = tables.linearToUnorm[index[3]];
+        }
+    }
+
+    void downsample(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst, uint32_t dstWidth, uint32_t dstHeight, bool srgb)
+    {
+        const auto rows = [&](uint32_t begin, uint32_t end) {
+            for(auto y = begin; y < end; ++y) {
+                const auto y0 = std::min(2 * y, srcHeight - 1);
+                const auto y1 = std::min(2 * y + 1, srcHeight - 1);
+
+                const SourceRows source = {src + (size_t)y0 * srcWidth * 4, src + (size_t)y1 * srcWidth * 4, srcWidth};
+                auto* out = dst + (size_t)y * dstWidth * 4;
+
+                if(srgb) {
+                    downsampleRowSrgb(source, out, dstWidth);
+                }
+                else {
+                    downsampleRowUnorm(source, out, dstWidth);
+                }
+            }
+        };
+
+        if((size_t)dstWidth * dstHeight < PARALLEL_MIN_TEXELS) {
+            rows(0, dstHeight);
+            return;
+        }
+
+        const auto tasks = (dstHeight + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+        utils::parallelFor(tasks, [&](size_t task) {
+            const auto begin = (uint32_t)task * ROWS_PER_TASK;
+            rows(begin, std::min(begin + ROWS_PER_TASK, dstHeight));
+        });
+    }
+
+} // namespace
+
+bool isKnownTextureFormat(uint32_t format)
+{
+    switch((TextureFormat)format) {
+    case TextureFormat::RGBA8Unorm:
+    case TextureFormat::RGBA8Srgb:
+    case TextureFormat::BC1Unorm:
+    case TextureFormat::BC1Srgb:
+    case TextureFormat::BC5Unorm:
+    case TextureFormat::BC7Unorm:
+    case TextureFormat::BC7Srgb:
+        return true;
+    }
+
+    return false;
+}
+
+bool isBlockCompressed(TextureFormat format)
+{
+    return format != TextureFormat::RGBA8Unorm && format != TextureFormat::RGBA8Srgb;
+}
+
+bool isSrgb(TextureFormat format)
+{
+    return format == TextureFormat::RGBA8Srgb || format == TextureFormat::BC1Srgb || format == TextureFormat::BC7Srgb;
+}
+
+size_t mipSize(TextureFormat format, uint32_t width, uint32_t height)
+{
+    switch(format) {
+    case TextureFormat::RGBA8Unorm:
+    case TextureFormat::RGBA8Srgb:
+        return (size_t)width * height * 4;
+    case TextureFormat::BC1Unorm:
+    case TextureFormat::BC1Srgb:
+        return (size_t)((width + 3) / 4) * ((height + 3) / 4) * 8;
+    case TextureFormat::BC5Unorm:
+    case TextureFormat::BC7Unorm:
+    case TextureFormat::BC7Srgb:
+        return (size_t)((width + 3) / 4) * ((height + 3) / 4) * 16;
+    }
+
+    RAYGUN_FATAL("Unknown texture format: {}", (uint32_t)format);
+}
+
+uint32_t fullMipCount(uint32_t width, uint32_t height)
+{
+    uint32_t result = 1;
+    for(auto size = std::max(width, height); size > 1; size /= 2) {
+        ++result;
+    }
+    return result;
+}
+
+TextureData::TextureData(TextureFormat format, uint32_t width, uint32_t height, uint32_t mipCount) : format(format)
+{
+    RAYGUN_ASSERT(width > 0 && height > 0 && mipCount > 0);
+
+    size_t offset = 0;
+    for(uint32_t i = 0; i < mipCount; ++i) {
+        Mip mip;
+        mip.width = std::max(width >> i, 1u);
+        mip.height = std::max(height >> i, 1u);
+        mip.offset = offset;
+        mip.size = mipSize(format, mip.width, mip.height);
+
+        offset += mip.size;
+        mips.push_back(mip);
+    }
+
+    data.resize(offset);
+}
+
+size_t TextureData::sizeInBytes(uint32_t firstMip) const
+{
+    size_t result = 0;
+    for(auto i = firstMip; i < mips.size(); ++i) {
+        result += mips[i].size;
+    }
+    return result;
+}
+
+bool TextureData::hasAlpha() const
+{
+    RAYGUN_ASSERT(!isBlockCompressed(format));
+
+    const auto* texels = mipData(0);
+    for(size_t i = 3; i < mips[0].size; i += 4) {
+        if(texels[i] != 255) return true;
+    }
+    return false;
+}
+
+void generateMips(TextureData& texture)
+{
+    RAYGUN_ASSERT(!isBlockCompressed(texture.format));
+
+    TextureData result(texture.format, texture.width(), texture.height(), fullMipCount(texture.width(), texture.height()));
+    memcpy(result.mipData(0), texture.mipData(0), result.mips[0].size);
+
+    const auto srgb = isSrgb(texture.format);
+
+    for(uint32_t i = 1; i < result.mipCount(); ++i) {
+        const auto& src = result.mips[i - 1];
+        const auto& dst = result.mips[i];
+
+        downsample(result.mipData(i - 1), src.width, src.height, result.mipData(i), dst.width, dst.height, srgb);
+    }
+
+    texture = std::move(result);
+}
+
+} // namespace raygun::render
@@ -0,0 +1,95 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#pragma once
+
+namespace raygun::render {
+
+/// Pixel formats of textures. Values match the corresponding VkFormat, which
+/// is also how KTX2 files store them.
+enum class TextureFormat : uint32_t {
+    RGBA8Unorm = 37,
+    RGBA8Srgb = 43,
+
+    /// Opaque color, 8 bytes per 4x4 block.
+    BC1Unorm = 131,
+    BC1Srgb = 132,
+
+    /// Two independent channels, e.g. normal maps, 16 bytes per block.
+    BC5Unorm = 141,
+
+    /// Color with alpha, 16 bytes per block.
+    BC7Unorm = 145,
+    BC7Srgb = 146,
+};
+
+bool isKnownTextureFormat(uint32_t format);
+
+bool isBlockCompressed(TextureFormat format);
+bool isSrgb(TextureFormat format);
+
+/// Size of a mip level in bytes, block compressed formats round up to whole
+/// 4x4 blocks.
+size_t mipSize(TextureFormat format, uint32_t width, uint32_t height);
+
+/// Number of mip levels of a full chain down to 1x1.
+uint32_t fullMipCount(uint32_t width, uint32_t height);
+
+/// Texture in system memory, all mip levels stored consecutively, the
+/// largest one first.
+struct TextureData {
+    struct Mip {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        size_t offset = 0;
+        size_t size = 0;
+    };
+
+    TextureFormat format = TextureFormat::RGBA8Srgb;
+    std::vector<Mip> mips;
+    std::vector<uint8_t> data;
+
+    /// Allocates a texture with the given number of mips, contents are zero.
+    TextureData(TextureFormat format, uint32_t width, uint32_t height, uint32_t mipCount = 1);
+
+    TextureData() = default;
+
+    uint32_t width() const { return mips.empty() ? 0 : mips[0].width; }
+    uint32_t height() const { return mips.empty() ? 0 : mips[0].height; }
+    uint32_t mipCount() const { return (uint32_t)mips.size(); }
+
+    uint8_t* mipData(uint32_t mip) { return data.data() + mips[mip].offset; }
+    const uint8_t* mipData(uint32_t mip) const { return data.data() + mips[mip].offset; }
+
+    /// Size of the given mip and all smaller ones.
+    size_t sizeInBytes(uint32_t firstMip = 0) const;
+
+    /// True if any texel of an uncompressed texture is not fully opaque.
+    bool hasAlpha() const;
+};
+
+/// Replaces the mips of an uncompressed texture by a full chain generated
+/// from mip 0 with a box filter. sRGB textures are filtered in linear space.
+/// Large levels are split across all cores.
+void generateMips(TextureData& texture);
+
+} // namespace raygun::render
@@ -0,0 +1,539 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "raygun/render/texture_io.hpp"
+
+#include "raygun/logging.hpp"
+#include "raygun/utils/inflate.hpp"
+
+namespace raygun::render {
+
+namespace {
+
+    //////////////////////////////////////////////////////////////////////////
+    // PNG
+
+    constexpr std::array<uint8_t, 8> PNG_SIGNATURE = {137, 80, 78, 71, 13, 10, 26, 10};
+
+    /// Guards against allocating huge amounts of memory for corrupt headers.
+    constexpr uint32_t MAX_DIMENSION = 16384;
+
+    enum PngColorType : uint8_t {
+        Gray = 0,
+        Rgb = 2,
+        Palette = 3,
+        GrayAlpha = 4,
+        Rgba = 6,
+    };
+
+    uint32_t readBigEndian32(const uint8_t* bytes)
+    {
+        return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 | bytes[3];
+    }
+
+    uint32_t readBigEndian16(const uint8_t* bytes)
+    {
+        return (uint32_t)bytes[0] << 8 | bytes[1];
+    }
+
+    uint32_t channelCount(uint8_t colorType)
+    {
+        switch(colorType) {
+        case Gray:
+        case Palette:
+            return 1;
+        case GrayAlpha:
+            return 2;
+        case Rgb:
+            return 3;
+        case Rgba:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+
+    bool isValidBitDepth(uint8_t colorType, uint8_t bitDepth)
+    {
+        switch(colorType) {
+        case Gray:
+            return bitDepth == 1 || bitDepth == 2 || bitDepth == 4 || bitDepth == 8 || bitDepth == 16;
+        case Palette:
+            return bitDepth == 1 || bitDepth == 2 || bitDepth == 4 || bitDepth == 8;
+        default:
+            return bitDepth == 8 || bitDepth == 16;
+        }
+    }
+
+    uint8_t paeth(uint8_t a, uint8_t b, uint8_t c)
+    {
+        const auto p = (int32_t)a + b - c;
+        const auto pa = std::abs(p - a);
+        const auto pb = std::abs(p - b);
+        const auto pc = std::abs(p - c);
+
+        if(pa <= pb && pa <= pc) return a;
+        if(pb <= pc) return b;
+        return c;
+    }
+
+    /// Reverses the filter of row in place. previous is the already
+    /// unfiltered row above, bpp the filter distance in bytes.
+    bool unfilter(uint8_t filter, uint8_t* row, const uint8_t* previous, size_t stride, size_t bpp)
+    {
+        switch(filter) {
+        case 0:
+            return true;
+        case 1:
+            for(size_t i = bpp; i < stride; ++i) row[i] += row[i - bpp];
+            return true;
+        case 2:
+            for(size_t i = 0; i < stride; ++i) row[i] += previous[i];
+            return true;
+        case 3:
+            for(size_t i = 0; i < stride; ++i) {
+                const uint32_t left = i >= bpp ? row[i - bpp] : 0;
+                row[i] += (uint8_t)((left + previous[i]) / 2);
+            }
+            return true;
+        case 4:
+            for(size_t i = 0; i < stride; ++i) {
+                const uint8_t left = i >= bpp ? row[i - bpp] : 0;
+                const uint8_t upperLeft = i >= bpp ? previous[i - bpp] : 0;
+                row[i] += paeth(left, previous[i], upperLeft);
+            }
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /// Raw value of sample index of a row.
+    uint32_t readSample(const uint8_t* row, size_t index, uint32_t bitDepth)
+    {
+        if(bitDepth == 8) return row[index];
+        if(bitDepth == 16) return readBigEndian16(row + 2 * index);
+
+        const auto bit = index * bitDepth;
+        return (row[bit / 8] >> (8 - bitDepth - bit % 8)) & ((1u << bitDepth) - 1);
+    }
+
+    uint8_t toUnorm8(uint32_t value, uint32_t bitDepth)
+    {
+        if(bitDepth == 16) return (uint8_t)(value >> 8);
+        if(bitDepth == 8) return (uint8_t)value;
+
+        return (uint8_t)(value * 255 / ((1u << bitDepth) - 1));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // KTX2
+
+    constexpr std::array<uint8_t, 12> KTX2_IDENTIFIER = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+    struct Ktx2Header {
+        std::array<uint8_t, 12> identifier = KTX2_IDENTIFIER;
+        uint32_t vkFormat = 0;
+        uint32_t typeSize = 1;
+        uint32_t pixelWidth = 0;
+        uint32_t pixelHeight = 0;
+        uint32_t pixelDepth = 0;
+        uint32_t layerCount = 0;
+        uint32_t faceCount = 1;
+        uint32_t levelCount = 0;
+        uint32_t supercompressionScheme = 0;
+
+        uint32_t dfdByteOffset = 0;
+        uint32_t dfdByteLength = 0;
+        uint32_t kvdByteOffset = 0;
+        uint32_t kvdByteLength = 0;
+        uint64_t sgdByteOffset = 0;
+        uint64_t sgdByteLength = 0;
+    };
+
+    struct Ktx2Level {
+        uint64_t byteOffset = 0;
+        uint64_t byteLength = 0;
+        uint64_t uncompressedByteLength = 0;
+    };
+
+    static_assert(sizeof(Ktx2Header) == 80 && sizeof(Ktx2Level) == 24);
+
+    /// Level data is aligned to 16 bytes, which satisfies the alignment
+    /// required for all of our formats.
+    constexpr size_t KTX2_LEVEL_ALIGNMENT = 16;
+
+    // Data format descriptor constants, see the Khronos Data Format
+    // Specification.
+    constexpr uint32_t KHR_DF_MODEL_RGBSDA = 1;
+    constexpr uint32_t KHR_DF_MODEL_BC1A = 128;
+    constexpr uint32_t KHR_DF_MODEL_BC5 = 131;
+    constexpr uint32_t KHR_DF_MODEL_BC7 = 133;
+    constexpr uint32_t KHR_DF_PRIMARIES_BT709 = 1;
+    constexpr uint32_t KHR_DF_TRANSFER_LINEAR = 1;
+    constexpr uint32_t KHR_DF_TRANSFER_SRGB = 2;
+    constexpr uint32_t KHR_DF_CHANNEL_ALPHA = 15;
+    constexpr uint32_t KHR_DF_SAMPLE_LINEAR = 1 << 4;
+
+    /// Basic data format descriptor of format, including the leading total
+    /// size.
+    std::vector<uint32_t> dataFormatDescriptor(TextureFormat format)
+    {
+        struct Sample {
+            uint32_t channel;
+            uint32_t bitOffset;
+            uint32_t bitLength;
+            uint32_t upper;
+        };
+
+        struct Layout {
+            uint32_t model;
+            uint32_t blockDimension;
+            uint32_t bytesPerBlock;
+            std::vector<Sample> samples;
+        };
+
+        const auto layout = [format]() -> Layout {
+            switch(format) {
+            case TextureFormat::BC1Unorm:
+            case TextureFormat::BC1Srgb:
+                return {KHR_DF_MODEL_BC1A, 3, 8, {{0, 0, 64, ~0u}}};
+            case TextureFormat::BC5Unorm:
+                return {KHR_DF_MODEL_BC5, 3, 16, {{0, 0, 64, ~0u}, {1, 64, 64, ~0u}}};
+            case TextureFormat::BC7Unorm:
+            case TextureFormat::BC7Srgb:
+                return {KHR_DF_MODEL_BC7, 3, 16, {{0, 0, 128, ~0u}}};
+            default:
+                return {KHR_DF_MODEL_RGBSDA, 0, 4, {{0, 0, 8, 255}, {1, 8, 8, 255}, {2, 16, 8, 255}, {KHR_DF_CHANNEL_ALPHA, 24, 8, 255}}};
+            }
+        }();
+
+        const auto transfer = isSrgb(format) ? KHR_DF_TRANSFER_SRGB : KHR_DF_TRANSFER_LINEAR;
+        const auto blockSize = (uint32_t)(24 + 16 * layout.samples.size());
+
+        std::vector<uint32_t> result;
+        result.push_back(4 + blockSize);
+
+        // Vendor and descriptor type (Khronos, basic), version and size.
+        result.push_back(0);
+        result.push_back(2 | blockSize << 16);
+        result.push_back(layout.model | KHR_DF_PRIMARIES_BT709 << 8 | transfer << 16);
+        result.push_back(layout.blockDimension | layout.blockDimension << 8);
+        result.push_back(layout.bytesPerBlock);
+        result.push_back(0);
+
+        for(const auto& sample: layout.samples) {
+            // Alpha is never sRGB encoded.
+            const auto qualifiers = isSrgb(format) && sample.channel == KHR_DF_CHANNEL_ALPHA ? KHR_DF_SAMPLE_LINEAR : 0;
+
+            result.push_back(sample.bitOffset | (sample.bitLength - 1) << 16 | (sample.channel | qualifiers) << 24);
+            result.push_back(0);
+            result.push_back(0);
+            result.push_back(sample.upper);
+        }
+
+        return result;
+    }
+
+    size_t alignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+} // namespace
+
+std::optional<TextureData> decodePng(const std::byte* data, size_t size, bool srgb)
+{
+    const auto* bytes = reinterpret_cast<const uint8_t*>(data);
+
+    if(size < PNG_SIGNATURE.size() || !std::equal(PNG_SIGNATURE.begin(), PNG_SIGNATURE.end(), bytes)) {
+        RAYGUN_ERROR("Not a PNG image");
+        return {};
+    }
+
+    uint32_t width = 0, height = 0;
+    uint8_t bitDepth = 0, colorType = 0, interlace = 0;
+    bool headerValid = false;
+
+    const uint8_t* palette = nullptr;
+    uint32_t paletteSize = 0;
+
+    const uint8_t* transparency = nullptr;
+    uint32_t transparencySize = 0;
+
+    std::vector<uint8_t> compressed;
+
+    for(size_t pos = PNG_SIGNATURE.size(); pos + 12 <= size;) {
+        const auto length = readBigEndian32(bytes + pos);
+        const auto* type = bytes + pos + 4;
+        const auto* chunk = bytes + pos + 8;
+
+        if(length > size - pos - 12) {
+            RAYGUN_ERROR("Truncated PNG image");
+            return {};
+        }
+
+        if(memcmp(type, "IHDR", 4) == 0 && length == 13) {
+            width = readBigEndian32(chunk);
+            height = readBigEndian32(chunk + 4);
+            bitDepth = chunk[8];
+            colorType = chunk[9];
+            interlace = chunk[12];
+
+            // Compression and filter method, only 0 is defined.
+            headerValid = chunk[10] == 0 && chunk[11] == 0;
+        }
+        else if(memcmp(type, "PLTE", 4) == 0 && length % 3 == 0 && length <= 3 * 256) {
+            palette = chunk;
+            paletteSize = length / 3;
+        }
+        else if(memcmp(type, "tRNS", 4) == 0) {
+            transparency = chunk;
+            transparencySize = length;
+        }
+        else if(memcmp(type, "IDAT", 4) == 0) {
+            compressed.insert(compressed.end(), chunk, chunk + length);
+        }
+        else if(memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+
+        pos += 12 + (size_t)length;
+    }
+
+    if(!headerValid || width == 0 || height == 0 || width > MAX_DIMENSION || height > MAX_DIMENSION || channelCount(colorType) == 0
+       || !isValidBitDepth(colorType, bitDepth)) {
+        RAYGUN_ERROR("Invalid PNG header");
+        return {};
+    }
+
+    if(interlace != 0) {
+        RAYGUN_ERROR("Interlaced PNG images are not supported");
+        return {};
+    }
+
+    if(colorType == Palette && !palette) {
+        RAYGUN_ERROR("PNG image without palette");
+        return {};
+    }
+
+    const auto bitsPerPixel = channelCount(colorType) * bitDepth;
+    const auto stride = ((size_t)width * bitsPerPixel + 7) / 8;
+    const auto filterDistance = std::max<size_t>(bitsPerPixel / 8, 1);
+
+    auto raw = utils::zlibDecompress(compressed.data(), compressed.size(), (stride + 1) * height);
+    if(!raw || raw->size() < (stride + 1) * height) {
+        RAYGUN_ERROR("Corrupt PNG image data");
+        return {};
+    }
+
+    // Transparent color key of gray and RGB images, at the image bit depth.
+    std::array<uint32_t, 3> colorKey = {};
+    bool hasColorKey = false;
+    if(transparency && (colorType == Gray || colorType == Rgb) && transparencySize >= 2 * channelCount(colorType)) {
+        for(uint32_t c = 0; c < channelCount(colorType); ++c) {
+            colorKey[c] = readBigEndian16(transparency + 2 * c);
+        }
+        hasColorKey = true;
+    }
+
+    TextureData result(srgb ? TextureFormat::RGBA8Srgb : TextureFormat::RGBA8Unorm, width, height);
+
+    const std::vector<uint8_t> zeroRow(stride, 0);
+    const uint8_t* previous = zeroRow.data();
+
+    for(uint32_t y = 0; y < height; ++y) {
+        auto* row = raw->data() + y * (stride + 1);
+        const auto filter = *row++;
+
+        if(!unfilter(filter, row, previous, stride, filterDistance)) {
+            RAYGUN_ERROR("Corrupt PNG image data");
+            return {};
+        }
+        previous = row;
+
+        auto* out = result.mipData(0) + (size_t)y * width * 4;
+
+        // Fast paths for the common 8 bit color images.
+        if(bitDepth == 8 && colorType == Rgba) {
+            memcpy(out, row, stride);
+            continue;
+        }
+
+        if(bitDepth == 8 && colorType == Rgb && !hasColorKey) {
+            for(uint32_t x = 0; x < width; ++x, out += 4, row += 3) {
+                out[0] = row[0];
+                out[1] = row[1];
+                out[2] = row[2];
+                out[3] = 255;
+            }
+            continue;
+        }
+
+        for(uint32_t x = 0; x < width; ++x, out += 4) {
+            switch(colorType) {
+            case Gray: {
+                const auto gray = readSample(row, x, bitDepth);
+                out[0] = out[1] = out[2] = toUnorm8(gray, bitDepth);
+                out[3] = hasColorKey && gray == colorKey[0] ? 0 : 255;
+                break;
+            }
+            case GrayAlpha:
+                out[0] = out[1] = out[2] = toUnorm8(readSample(row, 2 * x, bitDepth), bitDepth);
+                out[3] = toUnorm8(readSample(row, 2 * x + 1, bitDepth), bitDepth);
+                break;
+            case Rgb: {
+                bool keyed = hasColorKey;
+                for(uint32_t c = 0; c < 3; ++c) {
+                    const auto value = readSample(row, 3 * x + c, bitDepth);
+                    keyed = keyed && value == colorKey[c];
+                    out[c] = toUnorm8(value, bitDepth);
+                }
+                out[3] = keyed ? 0 : 255;
+                break;
+            }
+            case Rgba:
+                for(uint32_t c = 0; c < 4; ++c) {
+                    out[c] = toUnorm8(readSample(row, 4 * x + c, bitDepth), bitDepth);
+                }
+                break;
+            case Palette: {
+                const auto index = readSample(row, x, bitDepth);
+                if(index >= paletteSize) {
+                    RAYGUN_ERROR("Invalid PNG palette index");
+                    return {};
+                }
+                memcpy(out, palette + 3 * index, 3);
+                out[3] = transparency && index < transparencySize ? transparency[index] : 255;
+                break;
+            }
+            }
+        }
+    }
+
+    return result;
+}
+
+std::optional<TextureData> readKtx2(const std::byte* data, size_t size)
+{
+    Ktx2Header header;
+    if(size < sizeof(header)) {
+        RAYGUN_ERROR("Not a KTX2 texture");
+        return {};
+    }
+
+    memcpy(&header, data, sizeof(header));
+    if(header.identifier != KTX2_IDENTIFIER) {
+        RAYGUN_ERROR("Not a KTX2 texture");
+        return {};
+    }
+
+    if(!isKnownTextureFormat(header.vkFormat)) {
+        RAYGUN_ERROR("Unsupported KTX2 format: {}", header.vkFormat);
+        return {};
+    }
+
+    if(header.supercompressionScheme != 0) {
+        RAYGUN_ERROR("Supercompressed KTX2 textures are not supported");
+        return {};
+    }
+
+    if(header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1) {
+        RAYGUN_ERROR("Only 2D KTX2 textures are supported");
+        return {};
+    }
+
+    const auto width = header.pixelWidth;
+    const auto height = std::max(header.pixelHeight, 1u);
+    if(width == 0 || width > MAX_DIMENSION || height > MAX_DIMENSION) {
+        RAYGUN_ERROR("Invalid KTX2 texture size");
+        return {};
+    }
+
+    // A level count of 0 asks the loader to generate mips.
+    const auto mipCount = std::max(header.levelCount, 1u);
+    if(mipCount > fullMipCount(width, height) || size < sizeof(header) + mipCount * sizeof(Ktx2Level)) {
+        RAYGUN_ERROR("Invalid KTX2 level index");
+        return {};
+    }
+
+    TextureData result((TextureFormat)header.vkFormat, width, height, mipCount);
+
+    const auto* bytes = reinterpret_cast<const uint8_t*>(data);
+    for(uint32_t i = 0; i < mipCount; ++i) {
+        Ktx2Level level;
+        memcpy(&level, bytes + sizeof(header) + i * sizeof(level), sizeof(level));
+
+        if(level.byteLength != result.mips[i].size || level.byteOffset > size || level.byteLength > size - level.byteOffset) {
+            RAYGUN_ERROR("Invalid KTX2 level {}", i);
+            return {};
+        }
+
+        memcpy(result.mipData(i), bytes + level.byteOffset, level.byteLength);
+    }
+
+    if(header.levelCount == 0 && !isBlockCompressed(result.format)) {
+        generateMips(result);
+    }
+
+    return result;
+}
+
+std::vector<char> writeKtx2(const TextureData& texture)
+{
+    const auto descriptor = dataFormatDescriptor(texture.format);
+
+    Ktx2Header header;
+    header.vkFormat = (uint32_t)texture.format;
+    header.pixelWidth = texture.width();
+    header.pixelHeight = texture.height();
+    header.levelCount = texture.mipCount();
+    header.dfdByteOffset = (uint32_t)(sizeof(header) + texture.mipCount() * sizeof(Ktx2Level));
+    header.dfdByteLength = (uint32_t)(descriptor.size() * sizeof(uint32_t));
+
+    std::vector<Ktx2Level> levels(texture.mipCount());
+
+    // Smallest level first.
+    auto offset = (size_t)header.dfdByteOffset + header.dfdByteLength;
+    for(auto i = texture.mipCount(); i-- > 0;) {
+        offset = alignUp(offset, KTX2_LEVEL_ALIGNMENT);
+
+        levels[i].byteOffset = offset;
+        levels[i].byteLength = texture.mips[i].size;
+        levels[i].uncompressedByteLength = texture.mips[i].size;
+
+        offset += texture.mips[i].size;
+    }
+
+    std::vector<char> result(offset, 0);
+    memcpy(result.data(), &header, sizeof(header));
+    memcpy(result.data() + sizeof(header), levels.data(), levels.size() * sizeof(Ktx2Level));
+    memcpy(result.data() + header.dfdByteOffset, descriptor.data(), header.dfdByteLength);
+
+    for(uint32_t i = 0; i < texture.mipCount(); ++i) {
+        memcpy(result.data() + levels[i].byteOffset, texture.mipData(i), texture.mips[i].size);
+    }
+
+    return result;
+}
+
+} // namespace raygun::render
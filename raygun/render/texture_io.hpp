@@ -0,0 +1,44 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#pragma once
+
+#include "raygun/render/texture_data.hpp"
+
+namespace raygun::render {
+
+/// Decodes a PNG image of any color type and bit depth into a single RGBA8
+/// mip, 16 bit channels are reduced to 8 bit. Interlaced images are not
+/// supported. Color is tagged as sRGB unless srgb is false, e.g. for normal
+/// maps. Returns std::nullopt on failure.
+std::optional<TextureData> decodePng(const std::byte* data, size_t size, bool srgb = true);
+
+/// Reads a 2D KTX2 texture in one of the formats of TextureFormat. Files
+/// using supercompression, arrays, cube maps or 3D textures are rejected.
+/// Returns std::nullopt on failure.
+std::optional<TextureData> readKtx2(const std::byte* data, size_t size);
+
+/// Writes texture as KTX2, mip levels are stored smallest first so a
+/// streaming reader can stop early.
+std::vector<char> writeKtx2(const TextureData& texture);
+
+} // namespace raygun::render
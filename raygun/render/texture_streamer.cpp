@@ -0,0 +1,284 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "raygun/render/texture_streamer.hpp"
+
+#include "raygun/raygun.hpp"
+#include "resources/shaders/raytracer_bindings.h"
+
+namespace raygun::render {
+
+namespace {
+
+    /// Mip selection only needs to follow the camera loosely.
+    constexpr uint64_t SELECTION_INTERVAL = 8;
+
+    /// Uploads of more detailed mips per frame, dropping mips is not limited.
+    constexpr size_t MAX_UPLOADS_PER_FRAME = 4;
+
+} // namespace
+
+TextureStreamer::TextureStreamer() : vc(RG().vc())
+{
+    vk::SamplerCreateInfo samplerInfo;
+    samplerInfo.setAddressModeU(vk::SamplerAddressMode::eRepeat);
+    samplerInfo.setAddressModeV(vk::SamplerAddressMode::eRepeat);
+    samplerInfo.setAddressModeW(vk::SamplerAddressMode::eRepeat);
+    samplerInfo.setMagFilter(vk::Filter::eLinear);
+    samplerInfo.setMinFilter(vk::Filter::eLinear);
+    samplerInfo.setMipmapMode(vk::SamplerMipmapMode::eLinear);
+    samplerInfo.setMaxLod(VK_LOD_CLAMP_NONE);
+    m_sampler = vc.device->createSamplerUnique(samplerInfo);
+    vc.setObjectName(*m_sampler, "Texture Sampler");
+
+    TextureData white(TextureFormat::RGBA8Unorm, 1, 1);
+    std::fill(white.data.begin(), white.data.end(), uint8_t(255));
+
+    m_fallback = std::make_unique<gpu::TextureImage>(white);
+    m_fallback->setName("Fallback Texture");
+
+    m_descriptorInfos.resize(RAYGUN_RAYTRACER_MAX_TEXTURES, {*m_sampler, m_fallback->imageView(), vk::ImageLayout::eShaderReadOnlyOptimal});
+
+    // Slot 0 stands for no texture.
+    m_entries.resize(1);
+}
+
+void TextureStreamer::add(const std::shared_ptr<Texture>& texture)
+{
+    RAYGUN_ASSERT(texture->data.mipCount() > 0);
+
+    std::lock_guard lock(m_mutex);
+
+    uint32_t slot;
+    if(!m_freeSlots.empty()) {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else if(m_entries.size() < RAYGUN_RAYTRACER_MAX_TEXTURES) {
+        slot = (uint32_t)m_entries.size();
+        m_entries.emplace_back();
+    }
+    else {
+        RAYGUN_WARN("Too many textures, {} is not used", texture->name);
+        return;
+    }
+
+    auto& entry = m_entries[slot];
+    entry.texture = texture;
+    entry.wantedMip = texture->data.mipCount() - 1;
+    entry.distance = std::numeric_limits<float>::max();
+    entry.used = true;
+
+    texture->slot = slot;
+}
+
+void TextureStreamer::update(const Scene& scene)
+{
+    std::lock_guard lock(m_mutex);
+
+    for(uint32_t slot = 1; slot < m_entries.size(); ++slot) {
+        auto& entry = m_entries[slot];
+        if(entry.used && entry.texture.expired()) {
+            release(slot);
+        }
+    }
+
+    if(m_frame++ % SELECTION_INTERVAL == 0) {
+        measureDistances(scene);
+        selectMips();
+    }
+
+    std::vector<std::pair<float, uint32_t>> increases;
+
+    for(uint32_t slot = 1; slot < m_entries.size(); ++slot) {
+        auto& entry = m_entries[slot];
+
+        const auto texture = entry.texture.lock();
+        if(!texture) continue;
+
+        // Textures without an image count as having none of their mips.
+        const auto residentMip = entry.image ? entry.image->firstMip() : texture->data.mipCount();
+        if(residentMip == entry.wantedMip) continue;
+
+        if(residentMip > entry.wantedMip && entry.image) {
+            increases.push_back({entry.distance, slot});
+        }
+        else {
+            // Dropping mips and the initial upload of the smallest mip are
+            // cheap.
+            upload(slot, *texture, entry.wantedMip);
+        }
+    }
+
+    std::sort(increases.begin(), increases.end());
+    if(increases.size() > MAX_UPLOADS_PER_FRAME) {
+        increases.resize(MAX_UPLOADS_PER_FRAME);
+    }
+
+    for(const auto& [distance, slot]: increases) {
+        if(const auto texture = m_entries[slot].texture.lock()) {
+            upload(slot, *texture, m_entries[slot].wantedMip);
+        }
+    }
+}
+
+void TextureStreamer::measureDistances(const Scene& scene)
+{
+    for(auto& entry: m_entries) {
+        entry.distance = std::numeric_limits<float>::max();
+    }
+
+    const auto eye = scene.camera->globalTransform().position;
+
+    const auto visit = [&](const Model& model, const Transform& transform) {
+        const auto center = transform * Transform(vec3(model.boundingSphere));
+        const auto scale = std::max({transform.scaling.x, transform.scaling.y, transform.scaling.z});
+        if(scale <= 0.0f) return;
+
+        // Distance to the bounding sphere relative to the model's scale, the
+        // camera may be inside.
+        const auto distance = std::max(glm::length(center.position - eye) - model.boundingSphere.w * scale, 0.0f) / scale;
+
+        for(const auto& material: model.materials) {
+            if(!material || !material->diffuseTexture) continue;
+
+            const auto slot = material->diffuseTexture->slot;
+            if(slot == 0 || slot >= m_entries.size()) continue;
+
+            auto& entry = m_entries[slot];
+            entry.distance = std::min(entry.distance, distance);
+        }
+    };
+
+    scene.root->forEachEntity([&](Entity& entity) {
+        if(!entity.isVisible()) return false;
+
+        if(!entity.model && !entity.instances) return true;
+
+        const auto transform = entity.globalTransform();
+
+        if(entity.model) {
+            visit(*entity.model, transform);
+        }
+
+        if(entity.instances) {
+            const auto& array = *entity.instances;
+            for(size_t i = 0; i < array.size(); ++i) {
+                visit(*array.variants()[array.variant((InstanceArray::Index)i)], transform * array.transform((InstanceArray::Index)i));
+            }
+        }
+
+        return true;
+    });
+}
+
+void TextureStreamer::selectMips()
+{
+    const auto referenceDistance = std::max((float)RG().config().textureStreamingDistance, 1e-3f);
+
+    std::vector<std::pair<float, uint32_t>> byDistance;
+    size_t totalBytes = 0;
+
+    for(uint32_t slot = 1; slot < m_entries.size(); ++slot) {
+        auto& entry = m_entries[slot];
+
+        const auto texture = entry.texture.lock();
+        if(!texture) continue;
+
+        const auto lastMip = texture->data.mipCount() - 1;
+
+        if(entry.distance == std::numeric_limits<float>::max()) {
+            entry.wantedMip = lastMip;
+        }
+        else if(entry.distance <= referenceDistance) {
+            entry.wantedMip = 0;
+        }
+        else {
+            const auto level = std::ceil(std::log2(entry.distance / referenceDistance));
+            entry.wantedMip = (uint32_t)std::min(level, (float)lastMip);
+        }
+
+        totalBytes += texture->data.sizeInBytes(entry.wantedMip);
+        byDistance.push_back({entry.distance, slot});
+    }
+
+    const auto budget = (size_t)std::max(RG().config().textureStreamingBudgetMB, 0) * 1024 * 1024;
+    if(totalBytes <= budget) return;
+
+    // Farthest first, one mip at a time so that near textures keep as much
+    // detail as possible.
+    std::sort(byDistance.begin(), byDistance.end(), std::greater<>());
+
+    auto reduced = true;
+    while(totalBytes > budget && reduced) {
+        reduced = false;
+
+        for(const auto& [distance, slot]: byDistance) {
+            if(totalBytes <= budget) break;
+
+            auto& entry = m_entries[slot];
+            const auto texture = entry.texture.lock();
+            if(!texture || entry.wantedMip + 1 >= texture->data.mipCount()) continue;
+
+            totalBytes -= texture->data.sizeInBytes(entry.wantedMip) - texture->data.sizeInBytes(entry.wantedMip + 1);
+            ++entry.wantedMip;
+            reduced = true;
+        }
+    }
+}
+
+void TextureStreamer::release(uint32_t slot)
+{
+    auto& entry = m_entries[slot];
+
+    if(entry.image) {
+        m_gpuBytes -= entry.image->memorySize();
+    }
+
+    entry = {};
+    m_freeSlots.push_back(slot);
+
+    m_descriptorInfos[slot].setImageView(m_fallback->imageView());
+    ++m_generation;
+}
+
+void TextureStreamer::upload(uint32_t slot, const Texture& texture, uint32_t firstMip)
+{
+    auto& entry = m_entries[slot];
+
+    if(entry.image) {
+        m_gpuBytes -= entry.image->memorySize();
+    }
+
+    const auto start = Clock::now();
+
+    entry.image = std::make_unique<gpu::TextureImage>(texture.data, firstMip);
+    entry.image->setName(fmt::format("Texture {}", texture.name));
+
+    RG().resourceManager().telemetry().record("Texture", texture.name, LoadStage::Upload, Clock::now() - start);
+    m_gpuBytes += entry.image->memorySize();
+
+    m_descriptorInfos[slot].setImageView(entry.image->imageView());
+    ++m_generation;
+}
+
+} // namespace raygun::render
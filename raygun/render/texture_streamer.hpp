@@ -0,0 +1,110 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#pragma once
+
+#include "raygun/gpu/texture_image.hpp"
+#include "raygun/render/texture.hpp"
+#include "raygun/scene.hpp"
+#include "raygun/vulkan_context.hpp"
+
+namespace raygun::render {
+
+/// Keeps the mips of all loaded textures resident on the GPU which are
+/// needed at the current camera distance, within the
+/// textureStreamingBudgetMB config option.
+///
+/// Textures render at full resolution up to textureStreamingDistance, each
+/// doubling of the distance beyond drops one mip. If the budget is exceeded,
+/// the farthest textures are reduced further. Textures not visible keep only
+/// their smallest mip.
+///
+/// Every texture occupies one slot of the bindless texture array of the ray
+/// tracer, unused slots and textures not uploaded yet refer to a white
+/// fallback texture.
+class TextureStreamer {
+  public:
+    TextureStreamer();
+
+    /// Assigns texture its slot, its smallest mip is uploaded on the next
+    /// update. May be called from any thread.
+    void add(const std::shared_ptr<Texture>& texture);
+
+    /// Re-evaluates the required mips and uploads a few textures per frame,
+    /// nearest first. Slots of textures no longer referenced are released.
+    /// Must only be called while the GPU does not use the texture array.
+    void update(const Scene& scene);
+
+    /// One entry per slot of the texture array.
+    const std::vector<vk::DescriptorImageInfo>& descriptorInfos() const { return m_descriptorInfos; }
+
+    /// Incremented whenever descriptorInfos changed.
+    uint64_t generation() const { return m_generation; }
+
+    /// Device memory used by resident mips.
+    vk::DeviceSize gpuBytes() const { return m_gpuBytes; }
+
+  private:
+    struct Entry {
+        std::weak_ptr<Texture> texture;
+        gpu::UniqueTextureImage image;
+
+        /// Most detailed mip to be resident.
+        uint32_t wantedMip = 0;
+
+        float distance = std::numeric_limits<float>::max();
+
+        /// Slot is assigned, the texture may have expired since.
+        bool used = false;
+    };
+
+    /// Determines the distance of each texture to the camera.
+    void measureDistances(const Scene& scene);
+
+    void selectMips();
+
+    void release(uint32_t slot);
+    void upload(uint32_t slot, const Texture& texture, uint32_t firstMip);
+
+    // Guards m_entries and m_freeSlots, the GPU state is only touched by
+    // update.
+    std::mutex m_mutex;
+
+    std::vector<Entry> m_entries;
+    std::vector<uint32_t> m_freeSlots;
+
+    gpu::UniqueTextureImage m_fallback;
+    vk::UniqueSampler m_sampler;
+
+    std::vector<vk::DescriptorImageInfo> m_descriptorInfos;
+    uint64_t m_generation = 0;
+
+    vk::DeviceSize m_gpuBytes = 0;
+
+    uint64_t m_frame = 0;
+
+    VulkanContext& vc;
+};
+
+using UniqueTextureStreamer = std::unique_ptr<TextureStreamer>;
+
+} // namespace raygun::render
@@ -28,4 +28,12 @@ struct Vertex {
 #include "resources/shaders/vertex.def"
 };
 
+/// Compact vertex layout used with the compressedVertices option, see
+/// vertex_compression.hpp.
+struct CompressedVertex {
+#include "resources/shaders/compressed_vertex.def"
+};
+
+static_assert(sizeof(CompressedVertex) == 16);
+
 } // namespace raygun::render
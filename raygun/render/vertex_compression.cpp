@@ -0,0 +1,129 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#include "raygun/render/vertex_compression.hpp"
+
+#include "raygun/assert.hpp"
+
+namespace raygun::render {
+
+namespace {
+    float signNotZero(float v)
+    {
+        return v >= 0.0f ? 1.0f : -1.0f;
+    }
+} // namespace
+
+QuantizationBounds QuantizationBounds::of(const Mesh& mesh)
+{
+    if(mesh.vertices.empty()) return {};
+
+    const auto [lower, upper] = mesh.bounds();
+
+    QuantizationBounds result;
+    result.center = (lower + upper) * 0.5f;
+
+    // Flat meshes still need an invertible mapping.
+    result.halfExtent = glm::max((upper - lower) * 0.5f, vec3{std::numeric_limits<float>::min()});
+
+    return result;
+}
+
+std::array<float, 12> QuantizationBounds::dequantizationMatrix() const
+{
+    return {
+        halfExtent.x, 0.0f, 0.0f, center.x, //
+        0.0f, halfExtent.y, 0.0f, center.y, //
+        0.0f, 0.0f, halfExtent.z, center.z, //
+    };
+}
+
+uint32_t encodeOctahedral(vec3 normal)
+{
+    normal /= std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+
+    vec2 e{normal.x, normal.y};
+    if(normal.z < 0.0f) {
+        e = {(1.0f - std::abs(normal.y)) * signNotZero(normal.x), (1.0f - std::abs(normal.x)) * signNotZero(normal.y)};
+    }
+
+    return glm::packSnorm2x16(e);
+}
+
+vec3 decodeOctahedral(uint32_t packed)
+{
+    const auto e = glm::unpackSnorm2x16(packed);
+    vec3 n{e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y)};
+
+    const auto t = std::max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+
+    return glm::normalize(n);
+}
+
+CompressedVertex compressVertex(const Vertex& vertex, const QuantizationBounds& bounds)
+{
+    const auto p = (vertex.position - bounds.center) / bounds.halfExtent;
+
+    CompressedVertex result;
+    result.positionXY = glm::packSnorm2x16({p.x, p.y});
+    result.positionZW = glm::packSnorm2x16({p.z, 0.0f});
+    result.normal = encodeOctahedral(vertex.normal);
+    result.texCoord = vertex.texCoord;
+
+    return result;
+}
+
+Vertex decompressVertex(const CompressedVertex& vertex, const QuantizationBounds& bounds, uint32_t matIndex)
+{
+    const auto xy = glm::unpackSnorm2x16(vertex.positionXY);
+    const auto zw = glm::unpackSnorm2x16(vertex.positionZW);
+
+    Vertex result = {};
+    result.position = bounds.center + vec3{xy, zw.x} * bounds.halfExtent;
+    result.normal = decodeOctahedral(vertex.normal);
+    result.texCoord = vertex.texCoord;
+    result.matIndex = matIndex;
+
+    return result;
+}
+
+void compressVertices(const Mesh& mesh, const QuantizationBounds& bounds, CompressedVertex* out)
+{
+    for(const auto& vertex: mesh.vertices) {
+        *out++ = compressVertex(vertex, bounds);
+    }
+}
+
+void writePrimitiveMaterials(const Mesh& mesh, uint16_t* out)
+{
+    for(size_t i = 0; i < mesh.indices.size(); i += 3) {
+        const auto matIndex = mesh.vertices[mesh.indices[i]].matIndex;
+        RAYGUN_ASSERT(matIndex <= std::numeric_limits<uint16_t>::max());
+
+        *out++ = (uint16_t)matIndex;
+    }
+}
+
+} // namespace raygun::render
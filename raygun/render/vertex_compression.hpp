@@ -0,0 +1,57 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "raygun/render/mesh.hpp"
+
+namespace raygun::render {
+
+/// Maps quantized positions in [-1, 1] back to the bounds of their mesh.
+struct QuantizationBounds {
+    vec3 center{0.0f};
+    vec3 halfExtent{1.0f};
+
+    static QuantizationBounds of(const Mesh& mesh);
+
+    /// Row-major 3x4 matrix, as expected by acceleration structure builds.
+    std::array<float, 12> dequantizationMatrix() const;
+};
+
+uint32_t encodeOctahedral(vec3 normal);
+vec3 decodeOctahedral(uint32_t packed);
+
+CompressedVertex compressVertex(const Vertex& vertex, const QuantizationBounds& bounds);
+
+/// The material index is not part of the compressed vertex and taken as is.
+Vertex decompressVertex(const CompressedVertex& vertex, const QuantizationBounds& bounds, uint32_t matIndex);
+
+/// Writes the compressed vertices of mesh to out, which needs room for all
+/// vertices.
+void compressVertices(const Mesh& mesh, const QuantizationBounds& bounds, CompressedVertex* out);
+
+/// Writes one 16 bit material index per triangle to out, taken from the first
+/// vertex of each triangle.
+void writePrimitiveMaterials(const Mesh& mesh, uint16_t* out);
+
+} // namespace raygun::render
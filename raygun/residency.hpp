@@ -0,0 +1,238 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#pragma once
+
+#include "raygun/atom.hpp"
+
+namespace raygun {
+
+enum class ResourceType {
+    Material,
+    Shader,
+    Font,
+    Sound,
+    Model,
+    Texture,
+};
+
+struct MemoryUsage {
+    size_t cpuBytes = 0;
+    size_t gpuBytes = 0;
+
+    size_t total() const { return cpuBytes + gpuBytes; }
+
+    MemoryUsage& operator+=(const MemoryUsage& other)
+    {
+        cpuBytes += other.cpuBytes;
+        gpuBytes += other.gpuBytes;
+        return *this;
+    }
+
+    MemoryUsage& operator-=(const MemoryUsage& other)
+    {
+        cpuBytes -= other.cpuBytes;
+        gpuBytes -= other.gpuBytes;
+        return *this;
+    }
+};
+
+/// Tracks memory usage and last use of the cached resources of one type and
+/// selects the least recently used ones for eviction once a budget is
+/// exceeded.
+///
+/// Resources are observed through weak pointers, a resource counts as used
+/// while anyone besides its cache holds a reference. Pinned resources are
+/// never selected, pins nest. All functions are thread-safe.
+template<typename T>
+class ResidencyTracker {
+  public:
+    using Measure = std::function<MemoryUsage(const T&)>;
+
+    struct Candidate {
+        Atom name;
+
+        /// Only used for identification, not to be dereferenced.
+        const T* resource;
+    };
+
+    explicit ResidencyTracker(Measure measure) : m_measure(std::move(measure)) {}
+
+    void track(Atom name, const std::shared_ptr<T>& resource)
+    {
+        const auto usage = m_measure(*resource);
+
+        std::lock_guard lock(m_mutex);
+
+        auto [it, inserted] = m_entries.try_emplace(resource.get());
+        if(!inserted) return;
+
+        auto& entry = it->second;
+        entry.name = name;
+        entry.resource = resource;
+        entry.usage = usage;
+        entry.lastUsed = m_frame;
+
+        m_usage += usage;
+    }
+
+    void untrack(const T* resource)
+    {
+        std::lock_guard lock(m_mutex);
+
+        const auto it = m_entries.find(resource);
+        if(it == m_entries.end()) return;
+
+        m_usage -= it->second.usage;
+        m_entries.erase(it);
+    }
+
+    /// Pins by name apply to all resources of that name, also ones loaded
+    /// later.
+    void pin(Atom name)
+    {
+        std::lock_guard lock(m_mutex);
+        ++m_pinnedNames[name];
+    }
+
+    void unpin(Atom name)
+    {
+        std::lock_guard lock(m_mutex);
+        release(m_pinnedNames, name);
+    }
+
+    void pin(const T* resource)
+    {
+        std::lock_guard lock(m_mutex);
+        ++m_pinnedResources[resource];
+    }
+
+    void unpin(const T* resource)
+    {
+        std::lock_guard lock(m_mutex);
+        release(m_pinnedResources, resource);
+    }
+
+    bool isPinned(Atom name, const T* resource) const
+    {
+        std::lock_guard lock(m_mutex);
+        return isPinnedUnlocked(name, resource);
+    }
+
+    /// Usage of all tracked resources as of the last update.
+    MemoryUsage usage() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_usage;
+    }
+
+    /// Refreshes memory usage and last use of all resources. If usage
+    /// exceeds budget, returns up to maxEvictions unused resources, least
+    /// recently used first, whose removal brings usage back within budget.
+    /// Resources need to be unused for minIdleFrames before being selected.
+    std::vector<Candidate> update(uint64_t frame, size_t budget, size_t maxEvictions, uint64_t minIdleFrames)
+    {
+        std::lock_guard lock(m_mutex);
+
+        m_frame = frame;
+        m_usage = {};
+
+        std::vector<std::pair<uint64_t, Candidate>> unused;
+
+        for(auto it = m_entries.begin(); it != m_entries.end();) {
+            auto& entry = it->second;
+
+            const auto references = entry.resource.use_count();
+            if(references == 0) {
+                it = m_entries.erase(it);
+                continue;
+            }
+
+            // Beyond the reference held by the cache.
+            if(references > 1) {
+                entry.lastUsed = frame;
+            }
+
+            // Sizes change after loading, e.g. once GPU buffers are created.
+            if(const auto resource = entry.resource.lock()) {
+                entry.usage = m_measure(*resource);
+            }
+            m_usage += entry.usage;
+
+            if(entry.lastUsed + minIdleFrames <= frame && !isPinnedUnlocked(entry.name, it->first)) {
+                unused.push_back({entry.lastUsed, {entry.name, it->first}});
+            }
+
+            ++it;
+        }
+
+        std::vector<Candidate> result;
+        if(m_usage.total() <= budget) return result;
+
+        std::sort(unused.begin(), unused.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        auto remaining = m_usage.total();
+        for(const auto& [lastUsed, candidate]: unused) {
+            if(remaining <= budget || result.size() >= maxEvictions) break;
+
+            result.push_back(candidate);
+            remaining -= m_entries[candidate.resource].usage.total();
+        }
+
+        return result;
+    }
+
+  private:
+    struct Entry {
+        Atom name;
+        std::weak_ptr<T> resource;
+        MemoryUsage usage;
+        uint64_t lastUsed = 0;
+    };
+
+    template<typename Map, typename Key>
+    static void release(Map& pins, const Key& key)
+    {
+        const auto it = pins.find(key);
+        if(it == pins.end()) return;
+
+        if(--it->second == 0) pins.erase(it);
+    }
+
+    bool isPinnedUnlocked(Atom name, const T* resource) const
+    {
+        return m_pinnedNames.count(name) > 0 || m_pinnedResources.count(resource) > 0;
+    }
+
+    Measure m_measure;
+
+    mutable std::mutex m_mutex;
+
+    std::unordered_map<const T*, Entry> m_entries;
+    std::unordered_map<Atom, uint32_t> m_pinnedNames;
+    std::unordered_map<const T*, uint32_t> m_pinnedResources;
+
+    MemoryUsage m_usage;
+    uint64_t m_frame = 0;
+};
+
+} // namespace raygun
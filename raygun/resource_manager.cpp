@@ -22,56 +22,266 @@
 
 #include "raygun/resource_manager.hpp"
 
+#include "raygun/gpu/gpu_material.hpp"
 #include "raygun/logging.hpp"
+#include "raygun/raygun.hpp"
+#include "raygun/render/model_import.hpp"
+#include "raygun/render/texture_io.hpp"
 #include "raygun/utils/assimp_utils.hpp"
+#include "raygun/utils/pak_archive.hpp"
 
 namespace raygun {
 
 const fs::path RESOURCES_DIR = "resources";
+const fs::path RESOURCES_ARCHIVE = "resources.rgpak";
 
 namespace {
-    template<typename T>
-    std::shared_ptr<T> loadFromFileSystemCached(string_view resourceType, const string& name, const fs::path& path, std::map<string, std::shared_ptr<T>>& cache)
+    /// Bounds the work done by a single update.
+    constexpr size_t MAX_EVICTIONS_PER_FRAME = 8;
+
+    /// Resources released by the CPU may still be used by frames in flight.
+    constexpr uint64_t MIN_IDLE_FRAMES = 3;
+
+    constexpr size_t MEGABYTE = 1024 * 1024;
+
+    size_t meshSize(const render::Mesh& mesh)
     {
-        const auto it = cache.find(name);
-        if(it != cache.cend()) return it->second;
+        return mesh.vertices.size() * sizeof(mesh.vertices[0]) + mesh.indices.size() * sizeof(mesh.indices[0]);
+    }
 
-        RAYGUN_INFO("Loading {}: {}", resourceType, name);
+    size_t meshBufferSize(const render::Mesh& mesh)
+    {
+        return (size_t)mesh.vertexBufferRef.sizeInBytes + mesh.indexBufferRef.sizeInBytes + mesh.transformBufferRef.sizeInBytes;
+    }
 
-        // search in alternative path if not found directly
-        // allow e.g. materials/ui_button.rgmat.json ==> materials/ui/button.rgmat.json
-        fs::path altPath = path;
-        if(!fs::exists(RESOURCES_DIR / path)) {
-            string ps = path.string();
-            auto underscorePos = ps.find_first_of("_");
-            if(underscorePos != ps.npos) {
-                altPath = fs::path(ps.substr(0, underscorePos)) / ps.substr(underscorePos + 1);
-            }
+    MemoryUsage materialUsage(const Material&)
+    {
+        return {sizeof(Material), sizeof(gpu::Material)};
+    }
+
+    MemoryUsage shaderUsage(const gpu::Shader& shader)
+    {
+        return {sizeof(gpu::Shader), shader.codeSize};
+    }
+
+    MemoryUsage fontUsage(const ui::Font& font)
+    {
+        MemoryUsage result = {sizeof(ui::Font), 0};
+        for(const auto& mesh: font.charMap) {
+            if(mesh) result.cpuBytes += meshSize(*mesh);
+        }
+        return result;
+    }
+
+    MemoryUsage soundUsage(const audio::Sound& sound)
+    {
+        // OpenAL keeps the samples in system memory.
+        return {sizeof(audio::Sound) + sound.sizeInBytes(), 0};
+    }
+
+    MemoryUsage textureUsage(const render::Texture& texture)
+    {
+        // Resident mips are accounted by the TextureStreamer.
+        return {sizeof(render::Texture) + texture.data.data.size(), 0};
+    }
+
+    MemoryUsage modelUsage(const render::Model& model)
+    {
+        MemoryUsage result = {sizeof(render::Model), model.materials.size() * sizeof(gpu::Material)};
+
+        // Shared meshes and structures are split between the models using
+        // them, see MeshRegistry.
+        const auto addMesh = [&](const std::shared_ptr<render::Mesh>& mesh) {
+            const auto users = (size_t)std::max(mesh.use_count(), 1L);
+            result.cpuBytes += meshSize(*mesh) / users;
+            result.gpuBytes += meshBufferSize(*mesh) / users;
+        };
+
+        addMesh(model.mesh);
+        for(const auto& lod: model.lods) {
+            addMesh(lod.mesh);
         }
 
-        auto result = std::make_shared<T>(name, RESOURCES_DIR / altPath);
+        const auto structureSize = [](const render::SharedBottomLevelAS& blas) -> size_t {
+            return blas ? blas->memorySize() / blas.use_count() : 0;
+        };
 
-        cache[name] = result;
+        result.gpuBytes += structureSize(model.bottomLevelAS);
+        for(const auto& blas: model.lodBottomLevelAS) {
+            result.gpuBytes += structureSize(blas);
+        }
 
         return result;
     }
+
+    /// Alternative location of resources not found directly, allows e.g.
+    /// materials/ui_button.rgmat.json ==> materials/ui/button.rgmat.json
+    std::optional<fs::path> alternativePath(const fs::path& path)
+    {
+        string ps = path.string();
+        auto underscorePos = ps.find_first_of("_");
+        if(underscorePos == ps.npos) return {};
+
+        return fs::path(ps.substr(0, underscorePos)) / ps.substr(underscorePos + 1);
+    }
+
+    fs::path resolveResourcePath(const fs::path& path)
+    {
+        if(!fs::exists(RESOURCES_DIR / path)) {
+            if(const auto altPath = alternativePath(path)) return RESOURCES_DIR / *altPath;
+        }
+
+        return RESOURCES_DIR / path;
+    }
+
+    template<typename T>
+    bool allReady(const std::unordered_map<Atom, AsyncResource<T>>& resources)
+    {
+        return std::all_of(resources.begin(), resources.end(), [](const auto& pair) { return pair.second.ready(); });
+    }
+
+    template<typename T>
+    void finalizeAll(const std::unordered_map<Atom, AsyncResource<T>>& resources)
+    {
+        for(const auto& [name, resource]: resources) {
+            resource.get();
+        }
+    }
 } // namespace
 
+ResourceManager::ResourceManager()
+    : m_modelResidency(modelUsage)
+    , m_materials(materialUsage)
+    , m_shaders(shaderUsage)
+    , m_fonts(fontUsage)
+    , m_sounds(soundUsage)
+    , m_textures(textureUsage)
+{
+    if(!RG().config().resourceArchive) return;
+
+    m_archive = std::make_unique<io::PakArchive>(RESOURCES_ARCHIVE);
+    if(!*m_archive) {
+        m_archive.reset();
+        return;
+    }
+
+    RAYGUN_INFO("Using resource archive {}: {} entries", RESOURCES_ARCHIVE, m_archive->entryCount());
+
+    if(const auto table = m_archive->view(MaterialTable::ARCHIVE_ENTRY)) {
+        m_materialTable = std::make_unique<MaterialTable>(table->data, table->size);
+        if(!*m_materialTable) m_materialTable.reset();
+    }
+}
+
+bool ResourceBatch::ready() const
+{
+    return allReady(materials) && allReady(shaders) && allReady(fonts) && allReady(sounds) && allReady(textures) && allReady(entities);
+}
+
+void ResourceBatch::wait() const
+{
+    finalizeAll(materials);
+    finalizeAll(shaders);
+    finalizeAll(fonts);
+    finalizeAll(sounds);
+    finalizeAll(textures);
+    finalizeAll(entities);
+}
+
+template<typename T>
+std::shared_ptr<T> ResourceManager::loadCached(string_view resourceType, Atom name, Store<T>& store, const std::function<std::shared_ptr<T>()>& load)
+{
+    if(auto result = store.cache.find(name)) {
+        m_telemetry.recordCacheAccess(resourceType, true);
+        return result;
+    }
+
+    // Complete a pending asynchronous load instead of loading twice, its
+    // finalizer inserts the resource into the cache.
+    AsyncResource<T> asyncLoad;
+    {
+        std::lock_guard lock(m_pendingMutex);
+
+        const auto it = store.pending.find(name);
+        if(it != store.pending.cend()) asyncLoad = it->second;
+    }
+
+    if(asyncLoad.valid()) {
+        m_telemetry.recordCacheAccess(resourceType, true);
+        return asyncLoad.get();
+    }
+
+    auto loaded = false;
+    auto result = store.cache.getOrLoad(name, [&] {
+        RAYGUN_INFO("Loading {}: {}", resourceType, name);
+        LoadTelemetry::Scope scope(m_telemetry, resourceType, name);
+
+        auto result = load();
+        store.residency.track(name, result);
+        loaded = true;
+        return result;
+    });
+
+    // Another thread may have loaded it meanwhile.
+    m_telemetry.recordCacheAccess(resourceType, !loaded);
+
+    return result;
+}
+
 std::shared_ptr<Material> ResourceManager::loadMaterial(string_view nameView)
 {
-    const auto name = string{nameView};
-    return loadFromFileSystemCached("Material", name, fs::path{"materials"} / (name + ".rgmat.json"), m_materialCache);
+    const Atom name = nameView;
+    return loadCached<Material>("Material", name, m_materials, [this, name] { return createMaterial(name, nullptr); });
+}
+
+std::shared_ptr<Material> ResourceManager::loadMaterial(string_view nameView, const MaterialParameters& fallback)
+{
+    const Atom name = nameView;
+    return loadCached<Material>("Material", name, m_materials, [this, name, &fallback] { return createMaterial(name, &fallback); });
+}
+
+std::vector<std::shared_ptr<Material>> ResourceManager::loadMaterials(const render::ImportedModel& model)
+{
+    std::vector<std::shared_ptr<Material>> result;
+    result.reserve(model.materialNames.size());
+
+    for(size_t i = 0; i < model.materialNames.size(); ++i) {
+        if(i < model.embeddedMaterials.size()) {
+            result.push_back(loadMaterial(model.materialNames[i], model.embeddedMaterials[i]));
+        }
+        else {
+            result.push_back(loadMaterial(model.materialNames[i]));
+        }
+    }
+
+    return result;
 }
 
 void ResourceManager::registerModel(std::shared_ptr<render::Model> model)
 {
+    internMeshes(*model);
+
+    m_modelResidency.track({}, model);
+
+    std::lock_guard lock(m_modelsMutex);
     m_loadedModels.insert(model);
 }
 
+void ResourceManager::internMeshes(render::Model& model)
+{
+    model.mesh = m_meshRegistry.intern(model.mesh);
+
+    for(auto& lod: model.lods) {
+        lod.mesh = m_meshRegistry.intern(lod.mesh);
+    }
+}
+
 std::vector<render::Model*> ResourceManager::models()
 {
     constexpr auto raw = [](auto sptr) { return sptr.get(); };
 
+    std::lock_guard lock(m_modelsMutex);
+
     std::vector<render::Model*> result(m_loadedModels.size());
     std::transform(m_loadedModels.begin(), m_loadedModels.end(), result.begin(), raw);
     return result;
@@ -79,70 +289,766 @@ std::vector<render::Model*> ResourceManager::models()
 
 void ResourceManager::clearUnusedModelsAndMaterials()
 {
-    std::experimental::erase_if(m_loadedModels, [](const auto& sptr) { return sptr.use_count() <= 1; });
+    {
+        std::lock_guard lock(m_modelsMutex);
+        std::experimental::erase_if(m_loadedModels, [this](const auto& sptr) {
+            const auto unused = sptr.use_count() <= 1 && !m_modelResidency.isPinned({}, sptr.get());
+            if(unused) m_modelResidency.untrack(sptr.get());
+            return unused;
+        });
+    }
 
-    std::experimental::erase_if(m_materialCache, [](const auto& pair) { return pair.second.use_count() <= 1; });
+    m_materials.cache.eraseIf([this](Atom name, const auto& material) {
+        const auto unused = material.use_count() <= 1 && !m_materials.residency.isPinned(name, material.get());
+        if(unused) m_materials.residency.untrack(material.get());
+        return unused;
+    });
 }
 
 std::vector<Material*> ResourceManager::materials()
 {
-    constexpr auto snd = [](auto pair) { return &*pair.second; };
+    constexpr auto raw = [](auto sptr) { return sptr.get(); };
+
+    // Materials stay alive until cleared from the cache on the main thread.
+    const auto cached = m_materials.cache.values();
+
+    std::vector<Material*> result(cached.size());
+    std::transform(cached.begin(), cached.end(), result.begin(), raw);
+
+    // The cache is unordered, keep listings stable.
+    std::sort(result.begin(), result.end(), [](const Material* a, const Material* b) { return a->name.str() < b->name.str(); });
 
-    std::vector<Material*> result(m_materialCache.size());
-    std::transform(m_materialCache.begin(), m_materialCache.end(), result.begin(), snd);
     return result;
 }
 
 std::shared_ptr<gpu::Shader> ResourceManager::loadShader(string_view nameView)
 {
-    const auto name = string{nameView};
-    return loadFromFileSystemCached("Shader", name, fs::path{"shaders"} / (name + ".spv"), m_shaderCache);
+    const Atom name = nameView;
+    return loadCached<gpu::Shader>("Shader", name, m_shaders, [this, name] {
+        const auto path = fs::path{"shaders"} / (name.str() + ".spv");
+        return std::make_shared<gpu::Shader>(name, readResource(path), RESOURCES_DIR / path);
+    });
 }
 
 void ResourceManager::clearShaderCache()
 {
-    m_shaderCache.clear();
+    m_shaders.cache.eraseIf([this](Atom, const auto& shader) {
+        m_shaders.residency.untrack(shader.get());
+        return true;
+    });
 }
 
 std::shared_ptr<ui::Font> ResourceManager::loadFont(string_view nameView)
 {
-    const auto name = string{nameView};
+    const Atom name = nameView;
+    return loadCached<ui::Font>("Font", name, m_fonts, [this, name] { return std::make_shared<ui::Font>(readFont(name)); });
+}
+
+ui::Font ResourceManager::readFont(Atom name) const
+{
+    // Cooked fonts are compiled already, see tools/cooker.
+    if(const auto entry = archiveEntry(fs::path{"fonts"} / (name.str() + ".rgfont"))) {
+        std::optional<ui::Font> result;
+        if(const auto data = readArchiveEntry(*entry)) {
+            LoadStageTimer timer(LoadStage::Parse);
+            result = ui::readFont(name, data->data(), data->size());
+        }
+
+        if(result) return std::move(*result);
+
+        RAYGUN_WARN("Archive entry {} is outdated", *entry);
+    }
+
+    return ui::importFont(name, RESOURCES_DIR / "fonts" / (name.str() + ".obj"), render::ImportSettings::fromConfig());
+}
+
+std::shared_ptr<audio::Sound> ResourceManager::loadSound(string_view nameView)
+{
+    const Atom name = nameView;
+    return loadCached<audio::Sound>("Sound", name, m_sounds, [this, name] {
+        return std::make_shared<audio::Sound>(name, decodeSound(name, fs::path{"sounds"} / (name.str() + ".opus")));
+    });
+}
+
+std::shared_ptr<render::Texture> ResourceManager::loadTexture(string_view nameView)
+{
+    const Atom name = nameView;
+    return loadCached<render::Texture>("Texture", name, m_textures, [this, name] {
+        auto texture = std::make_shared<render::Texture>(name, readTexture(name));
+        RG().renderSystem().textureStreamer().add(texture);
+        return texture;
+    });
+}
+
+fs::path ResourceManager::entityLoadPath(string_view name) const
+{
+    return RESOURCES_DIR / entityResourcePath(name);
+}
+
+render::ImportedModel ResourceManager::importEntity(string_view name) const
+{
+    return importResource(entityResourcePath(name)).value_or(render::ImportedModel{});
+}
+
+fs::path ResourceManager::entityResourcePath(string_view name) const
+{
+    for(const auto extension: {".glb", ".gltf"}) {
+        auto path = fs::path{"models"} / (string{name} + extension);
+        if(archiveEntry(path) || fs::exists(resolveResourcePath(path))) return path;
+    }
+
+    return fs::path{"models"} / (string{name} + ".dae");
+}
+
+std::optional<string> ResourceManager::archiveEntry(const fs::path& path) const
+{
+    if(!m_archive) return {};
+
+    auto entry = path.generic_string();
+    if(m_archive->contains(entry)) return entry;
+
+    if(const auto altPath = alternativePath(path)) {
+        entry = altPath->generic_string();
+        if(m_archive->contains(entry)) return entry;
+    }
+
+    return {};
+}
+
+io::FileData ResourceManager::readResource(const fs::path& path) const
+{
+    const auto entry = archiveEntry(path);
+    if(!entry) return readLooseResource(path);
+
+    auto result = readArchiveEntry(*entry);
+    if(!result) {
+        throw std::runtime_error("Unable to read archive entry: " + *entry);
+    }
+
+    return std::move(*result);
+}
+
+io::FileData ResourceManager::readLooseResource(const fs::path& path) const
+{
+    LoadStageTimer timer(LoadStage::IO);
+
+    auto result = io::mapFile(resolveResourcePath(path), io::Access::Sequential);
+    recordBytesRead(result.size());
+    return result;
+}
+
+std::optional<io::FileData> ResourceManager::readArchiveEntry(const string& entry) const
+{
+    LoadStageTimer timer(LoadStage::IO);
+
+    // The archive outlives all resources read from it.
+    if(const auto view = m_archive->view(entry)) {
+        recordBytesRead(view->size);
+        return io::FileData(view->data, view->size);
+    }
+
+    auto data = m_archive->read(entry);
+    if(!data) return {};
+
+    recordBytesRead(data->size());
+    return io::FileData(std::move(*data));
+}
+
+void ResourceManager::prefetchResource(const fs::path& path)
+{
+    if(const auto entry = archiveEntry(path)) {
+        m_archive->prefetch(*entry);
+        return;
+    }
+
+    const auto resolved = resolveResourcePath(path);
+    if(fs::exists(resolved)) {
+        m_prefetcher.prefetch(resolved);
+    }
+}
+
+std::shared_ptr<Material> ResourceManager::createMaterial(Atom name, const MaterialParameters* fallback) const
+{
+    if(auto material = compiledMaterial(name)) return material;
+
+    const auto path = resolveResourcePath(fs::path{"materials"} / (name.str() + ".rgmat.json"));
+    if(fallback && !fs::exists(path)) {
+        return std::make_shared<Material>(name, *fallback);
+    }
+
+    return std::make_shared<Material>(name, Material::readDefinition(path), path);
+}
+
+std::shared_ptr<Material> ResourceManager::compiledMaterial(Atom name) const
+{
+    if(!m_materialTable) return nullptr;
+
+    const auto entry = m_materialTable->find(name.str());
+    if(!entry) return nullptr;
+
+    return std::make_shared<Material>(name, entry->parameters, Atom{entry->basedOn});
+}
+
+audio::DecodedSound ResourceManager::decodeSound(Atom name, const fs::path& path) const
+{
+    // Opus files are stored uncompressed and decoded straight from the
+    // mapping.
+    const auto data = readResource(path);
+
+    LoadStageTimer timer(LoadStage::Parse);
+    return audio::decodeSound(name, data.data(), data.size());
+}
+
+render::TextureData ResourceManager::readTexture(Atom name) const
+{
+    const auto ktx2Path = fs::path{"textures"} / (name.str() + ".ktx2");
+
+    // Cooked textures are compressed already, see tools/cooker.
+    if(const auto entry = archiveEntry(ktx2Path)) {
+        std::optional<render::TextureData> result;
+        if(const auto data = readArchiveEntry(*entry)) {
+            LoadStageTimer timer(LoadStage::Parse);
+            result = render::readKtx2(data->data(), data->size());
+        }
+
+        if(result) return std::move(*result);
+
+        RAYGUN_WARN("Archive entry {} is outdated", *entry);
+    }
+
+    try {
+        std::optional<render::TextureData> result;
+
+        if(fs::exists(resolveResourcePath(ktx2Path))) {
+            const auto data = readLooseResource(ktx2Path);
+
+            LoadStageTimer timer(LoadStage::Parse);
+            result = render::readKtx2(data.data(), data.size());
+        }
+        else {
+            const auto data = readLooseResource(fs::path{"textures"} / (name.str() + ".png"));
+            {
+                LoadStageTimer timer(LoadStage::Parse);
+                result = render::decodePng(data.data(), data.size(), !render::isNormalMap(name));
+            }
+
+            if(result) {
+                LoadStageTimer timer(LoadStage::Convert);
+                render::generateMips(*result);
+            }
+        }
+
+        if(result) return std::move(*result);
+
+        RAYGUN_ERROR("Unable to decode Texture: {}", name);
+    }
+    catch(const std::exception& e) {
+        RAYGUN_ERROR("Unable to read Texture {}: {}", name, e.what());
+    }
+
+    render::TextureData magenta(render::TextureFormat::RGBA8Unorm, 1, 1);
+    magenta.data = {255, 0, 255, 255};
+    return magenta;
+}
+
+std::optional<render::ImportedModel> ResourceManager::importResource(const fs::path& path) const
+{
+    const auto entry = archiveEntry(path);
+    if(!entry) return render::importModel(RESOURCES_DIR / path);
+
+    std::optional<render::ImportedModel> result;
+    if(const auto data = readArchiveEntry(*entry)) {
+        LoadStageTimer timer(LoadStage::Parse);
+        result = render::readCookedModel(data->data(), data->size());
+    }
+
+    if(!result) {
+        RAYGUN_WARN("Archive entry {} is outdated, importing {}", *entry, RESOURCES_DIR / path);
+        return render::importModel(RESOURCES_DIR / path);
+    }
+
+    // Allows hot reloading from the loose file, see ImportedModel::sourcePath.
+    result->sourcePath = fs::absolute(RESOURCES_DIR / path).lexically_normal();
+
+    return result;
+}
+
+template<typename T>
+AsyncResource<T> ResourceManager::loadAsyncCached(string_view resourceType, Atom name, Store<T>& store,
+                                                  std::function<typename AsyncResource<T>::Finalizer()> decode)
+{
+    using Finalizer = typename AsyncResource<T>::Finalizer;
+
+    if(auto cached = store.cache.find(name)) {
+        m_telemetry.recordCacheAccess(resourceType, true);
+        return AsyncResource<T>{cached};
+    }
+
+    std::lock_guard lock(m_pendingMutex);
+
+    const auto inFlight = store.pending.find(name);
+    if(inFlight != store.pending.cend()) {
+        m_telemetry.recordCacheAccess(resourceType, true);
+        return inFlight->second;
+    }
+
+    RAYGUN_INFO("Loading {} asynchronously: {}", resourceType, name);
+    m_telemetry.recordCacheAccess(resourceType, false);
+
+    // A synchronous load of the same resource may have started meanwhile,
+    // finalizing through the cache keeps a single instance.
+    auto decoded = m_workers.submit([this, resourceType, name, &store, decode = std::move(decode)]() -> Finalizer {
+        LoadTelemetry::Scope scope(m_telemetry, resourceType, name);
+
+        auto finalize = decode();
+        return [this, resourceType, name, &store, finalize = std::move(finalize)] {
+            return store.cache.getOrLoad(name, [&] {
+                LoadTelemetry::Scope scope(m_telemetry, resourceType, name, true);
 
-    const auto it = m_fontCache.find(name);
-    if(it != m_fontCache.cend()) return it->second;
+                auto result = finalize();
+                store.residency.track(name, result);
+                return result;
+            });
+        };
+    });
 
-    auto result = std::make_shared<ui::Font>();
-    result->name = name;
+    AsyncResource<T> result{decoded.share()};
+    store.pending.emplace(name, result);
 
-    auto entity = std::make_shared<Entity>(name, RESOURCES_DIR / "fonts" / (name + ".obj"), false);
+    return result;
+}
 
-    for(const auto& glyph: entity->children()) {
-        const auto index = std::stoul(glyph->name);
-        if(index >= result->charMap.size()) continue;
+AsyncResource<Material> ResourceManager::loadMaterialAsync(string_view nameView)
+{
+    const Atom name = nameView;
 
-        const auto& mesh = glyph->model->mesh;
-        auto bounds = mesh->bounds();
-        for(auto& v: mesh->vertices) {
-            v.position.x -= bounds.lower.x;
+    return loadAsyncCached<Material>("Material", name, m_materials, [this, name]() -> AsyncResource<Material>::Finalizer {
+        if(m_materialTable) {
+            if(const auto entry = m_materialTable->find(name.str())) {
+                return [name, entry = *entry] { return std::make_shared<Material>(name, entry.parameters, Atom{entry.basedOn}); };
+            }
         }
-        result->charMap[index] = mesh;
-        result->charWidth[index] = mesh->width();
+
+        const auto path = resolveResourcePath(fs::path{"materials"} / (name.str() + ".rgmat.json"));
+        auto data = Material::readDefinition(path);
+        return [name, path, data = std::move(data)] { return std::make_shared<Material>(name, data, path); };
+    });
+}
+
+AsyncResource<gpu::Shader> ResourceManager::loadShaderAsync(string_view nameView)
+{
+    const Atom name = nameView;
+    const auto path = fs::path{"shaders"} / (name.str() + ".spv");
+
+    return loadAsyncCached<gpu::Shader>("Shader", name, m_shaders, [this, name, path]() -> AsyncResource<gpu::Shader>::Finalizer {
+        auto code = readResource(path);
+        return [name, path, code = std::move(code)] { return std::make_shared<gpu::Shader>(name, code, RESOURCES_DIR / path); };
+    });
+}
+
+AsyncResource<ui::Font> ResourceManager::loadFontAsync(string_view nameView)
+{
+    const Atom name = nameView;
+    return loadAsyncCached<ui::Font>("Font", name, m_fonts, [this, name]() -> AsyncResource<ui::Font>::Finalizer {
+        auto font = std::make_shared<ui::Font>(readFont(name));
+        return [font] { return font; };
+    });
+}
+
+AsyncResource<audio::Sound> ResourceManager::loadSoundAsync(string_view nameView)
+{
+    const Atom name = nameView;
+    const auto path = fs::path{"sounds"} / (name.str() + ".opus");
+
+    return loadAsyncCached<audio::Sound>("Sound", name, m_sounds, [this, name, path]() -> AsyncResource<audio::Sound>::Finalizer {
+        auto decoded = decodeSound(name, path);
+        return [name, decoded = std::move(decoded)] { return std::make_shared<audio::Sound>(name, decoded); };
+    });
+}
+
+AsyncResource<render::Texture> ResourceManager::loadTextureAsync(string_view nameView)
+{
+    const Atom name = nameView;
+    return loadAsyncCached<render::Texture>("Texture", name, m_textures, [this, name]() -> AsyncResource<render::Texture>::Finalizer {
+        auto texture = std::make_shared<render::Texture>(name, readTexture(name));
+        return [texture] {
+            RG().renderSystem().textureStreamer().add(texture);
+            return texture;
+        };
+    });
+}
+
+AsyncResource<Entity> ResourceManager::loadEntityAsync(string_view nameView)
+{
+    using Finalizer = AsyncResource<Entity>::Finalizer;
+
+    const Atom name = nameView;
+
+    std::lock_guard lock(m_pendingMutex);
+
+    auto it = m_pendingImports.find(name);
+    m_telemetry.recordCacheAccess("Entity", it != m_pendingImports.end());
+
+    if(it == m_pendingImports.end()) {
+        RAYGUN_INFO("Loading Entity asynchronously: {}", name);
+
+        auto decoded = m_workers.submit([this, name]() -> Finalizer {
+            LoadTelemetry::Scope scope(m_telemetry, "Entity", name);
+
+            auto imported = std::make_shared<const render::ImportedModel>(importEntity(name));
+
+            // Invoked once per handle, each creating its own entity.
+            return [this, name, imported]() -> EntityPtr<> {
+                LoadTelemetry::Scope scope(m_telemetry, "Entity", name, true);
+                LoadStageTimer timer(LoadStage::Convert);
+                return makeEntity(name, *imported);
+            };
+        });
+
+        it = m_pendingImports.emplace(name, decoded.share()).first;
     }
 
-    m_fontCache[name] = result;
+    return AsyncResource<Entity>{it->second};
+}
+
+void ResourceManager::prefetch(const ResourceManifest& manifest)
+{
+    if(!RG().config().resourcePrefetch) return;
+
+    const auto cached = [](auto& store, const string& name) { return store.cache.find(Atom{name}) != nullptr; };
+
+    for(const auto& name: manifest.materials) {
+        // Compiled materials are looked up in the mapped table.
+        if(cached(m_materials, name) || (m_materialTable && m_materialTable->find(name))) continue;
+        prefetchResource(fs::path{"materials"} / (name + ".rgmat.json"));
+    }
+
+    for(const auto& name: manifest.shaders) {
+        if(!cached(m_shaders, name)) prefetchResource(fs::path{"shaders"} / (name + ".spv"));
+    }
+
+    for(const auto& name: manifest.fonts) {
+        if(cached(m_fonts, name)) continue;
+
+        const auto compiled = fs::path{"fonts"} / (name + ".rgfont");
+        prefetchResource(archiveEntry(compiled) ? compiled : fs::path{"fonts"} / (name + ".obj"));
+    }
+
+    for(const auto& name: manifest.sounds) {
+        if(!cached(m_sounds, name)) prefetchResource(fs::path{"sounds"} / (name + ".opus"));
+    }
+
+    for(const auto& name: manifest.textures) {
+        if(cached(m_textures, name)) continue;
+
+        const auto cooked = fs::path{"textures"} / (name + ".ktx2");
+        const auto isCooked = archiveEntry(cooked) || fs::exists(resolveResourcePath(cooked));
+        prefetchResource(isCooked ? cooked : fs::path{"textures"} / (name + ".png"));
+    }
+
+    for(const auto& name: manifest.entities) {
+        const auto path = entityResourcePath(name);
+
+        // Loose models are read from the mesh cache if it is up to date.
+        const auto cachePath = render::meshCachePath(RESOURCES_DIR / path);
+        if(!archiveEntry(path) && RG().config().meshCache && fs::exists(cachePath)) {
+            m_prefetcher.prefetch(cachePath);
+        }
+        else {
+            prefetchResource(path);
+        }
+    }
+}
+
+ResourceBatch ResourceManager::loadAll(const ResourceManifest& manifest)
+{
+    prefetch(manifest);
+
+    ResourceBatch batch;
+
+    for(const auto& name: manifest.materials) {
+        batch.materials.emplace(name, loadMaterialAsync(name));
+    }
+
+    for(const auto& name: manifest.shaders) {
+        batch.shaders.emplace(name, loadShaderAsync(name));
+    }
+
+    for(const auto& name: manifest.fonts) {
+        batch.fonts.emplace(name, loadFontAsync(name));
+    }
+
+    for(const auto& name: manifest.sounds) {
+        batch.sounds.emplace(name, loadSoundAsync(name));
+    }
+
+    for(const auto& name: manifest.textures) {
+        batch.textures.emplace(name, loadTextureAsync(name));
+    }
+
+    for(const auto& name: manifest.entities) {
+        batch.entities.emplace(name, loadEntityAsync(name));
+    }
+
+    return batch;
+}
+
+template<typename T>
+void ResourceManager::finalizeReady(Store<T>& store)
+{
+    auto& pending = store.pending;
+
+    std::vector<AsyncResource<T>> ready;
+
+    {
+        std::lock_guard lock(m_pendingMutex);
 
+        for(auto it = pending.begin(); it != pending.end();) {
+            if(it->second.ready()) {
+                ready.push_back(it->second);
+                it = pending.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    // Finalize without holding the lock, finalizers may load further resources.
+    for(const auto& resource: ready) {
+        resource.get();
+    }
+}
+
+void ResourceManager::update()
+{
+    ++m_frame;
+
+    finalizeReady(m_materials);
+    finalizeReady(m_shaders);
+    finalizeReady(m_fonts);
+    finalizeReady(m_sounds);
+    finalizeReady(m_textures);
+
+    {
+        // Entities are not cached, finished imports are simply released.
+        std::lock_guard lock(m_pendingMutex);
+        for(auto it = m_pendingImports.begin(); it != m_pendingImports.end();) {
+            const auto done = it->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+            it = done ? m_pendingImports.erase(it) : std::next(it);
+        }
+    }
+
+    const auto& config = RG().config();
+
+    evictUnused("Material", m_materials, config.materialBudgetMB);
+    evictUnused("Shader", m_shaders, config.shaderBudgetMB);
+    evictUnused("Font", m_fonts, config.fontBudgetMB);
+    evictUnused("Sound", m_sounds, config.soundBudgetMB);
+    evictUnused("Texture", m_textures, config.textureBudgetMB);
+    evictUnusedModels();
+}
+
+template<typename T>
+void ResourceManager::evictUnused(string_view resourceType, Store<T>& store, int budgetMB)
+{
+    const auto budget = budgetMB > 0 ? (size_t)budgetMB * MEGABYTE : std::numeric_limits<size_t>::max();
+
+    for(const auto& candidate: store.residency.update(m_frame, budget, MAX_EVICTIONS_PER_FRAME, MIN_IDLE_FRAMES)) {
+        // The resource may have been picked up again since the update.
+        const auto evicted = store.cache.eraseIf(candidate.name, [&](const auto& value) {
+            return value.get() == candidate.resource && value.use_count() <= 1 && !store.residency.isPinned(candidate.name, candidate.resource);
+        });
+
+        if(evicted) {
+            store.residency.untrack(candidate.resource);
+            RAYGUN_DEBUG("Evicted {}: {}", resourceType, candidate.name);
+        }
+    }
+}
+
+void ResourceManager::evictUnusedModels()
+{
+    const auto budgetMB = RG().config().modelBudgetMB;
+    const auto budget = budgetMB > 0 ? (size_t)budgetMB * MEGABYTE : std::numeric_limits<size_t>::max();
+
+    const auto candidates = m_modelResidency.update(m_frame, budget, MAX_EVICTIONS_PER_FRAME, MIN_IDLE_FRAMES);
+    if(candidates.empty()) return;
+
+    std::lock_guard lock(m_modelsMutex);
+
+    for(const auto& candidate: candidates) {
+        const auto it = std::find_if(m_loadedModels.begin(), m_loadedModels.end(), [&](const auto& model) { return model.get() == candidate.resource; });
+        if(it == m_loadedModels.end() || it->use_count() > 1 || m_modelResidency.isPinned({}, candidate.resource)) continue;
+
+        m_modelResidency.untrack(candidate.resource);
+        m_loadedModels.erase(it);
+        RAYGUN_DEBUG("Evicted Model");
+    }
+}
+
+template<typename Fun>
+void ResourceManager::withStore(ResourceType type, Fun f)
+{
+    switch(type) {
+    case ResourceType::Material:
+        f(m_materials);
+        break;
+    case ResourceType::Shader:
+        f(m_shaders);
+        break;
+    case ResourceType::Font:
+        f(m_fonts);
+        break;
+    case ResourceType::Sound:
+        f(m_sounds);
+        break;
+    case ResourceType::Texture:
+        f(m_textures);
+        break;
+    case ResourceType::Model:
+        RAYGUN_WARN("Models are not named, pin them by instance");
+        break;
+    }
+}
+
+void ResourceManager::pin(ResourceType type, string_view name)
+{
+    withStore(type, [name](auto& store) { store.residency.pin(Atom{name}); });
+}
+
+void ResourceManager::unpin(ResourceType type, string_view name)
+{
+    withStore(type, [name](auto& store) { store.residency.unpin(Atom{name}); });
+}
+
+void ResourceManager::pin(const render::Model& model)
+{
+    m_modelResidency.pin(&model);
+}
+
+void ResourceManager::unpin(const render::Model& model)
+{
+    m_modelResidency.unpin(&model);
+}
+
+bool ResourceManager::isResident(ResourceType type, string_view name)
+{
+    bool result = false;
+    withStore(type, [&](auto& store) { result = store.cache.find(Atom{name}) != nullptr; });
     return result;
 }
 
-std::shared_ptr<audio::Sound> ResourceManager::loadSound(string_view nameView)
+MemoryUsage ResourceManager::memoryUsage(ResourceType type)
 {
-    const auto name = string{nameView};
-    return loadFromFileSystemCached("Sound", name, fs::path{"sounds"} / (name + ".opus"), m_soundCache);
+    if(type == ResourceType::Model) return m_modelResidency.usage();
+
+    MemoryUsage result;
+    withStore(type, [&](auto& store) { result = store.residency.usage(); });
+    return result;
 }
 
-fs::path ResourceManager::entityLoadPath(string_view name)
+std::vector<Material*> ResourceManager::reloadMaterial(string_view nameView)
 {
-    return RESOURCES_DIR / "models" / (string{name} + ".dae");
+    std::vector<Material*> result;
+
+    // Derived materials copied their parameters on load and are reloaded
+    // after their base. Each material is visited once, basedOn may form
+    // cycles.
+    std::vector<Atom> queue = {Atom{nameView}};
+    std::unordered_set<Atom> visited = {queue.front()};
+
+    for(size_t i = 0; i < queue.size(); ++i) {
+        const auto name = queue[i];
+
+        const auto material = m_materials.cache.find(name);
+        if(!material) continue;
+
+        RAYGUN_INFO("Reloading Material: {}", name);
+
+        if(!material->reload(resolveResourcePath(fs::path{"materials"} / (name.str() + ".rgmat.json")))) continue;
+
+        result.push_back(material.get());
+
+        for(const auto& derived: m_materials.cache.values()) {
+            if(derived->basedOn == name && visited.insert(derived->name).second) queue.push_back(derived->name);
+        }
+    }
+
+    return result;
+}
+
+void ResourceManager::reloadShader(string_view nameView)
+{
+    const Atom name = nameView;
+
+    const auto shader = m_shaders.cache.find(name);
+    if(!shader) return;
+
+    m_shaders.cache.eraseIf(name, [&](const auto& value) { return value == shader; });
+    m_shaders.residency.untrack(shader.get());
+}
+
+std::vector<render::Model*> ResourceManager::modelsImportedFrom(const fs::path& path)
+{
+    // See ImportedModel::sourcePath.
+    const auto sourcePath = fs::absolute(path).lexically_normal();
+
+    std::lock_guard lock(m_modelsMutex);
+
+    std::vector<render::Model*> result;
+    for(const auto& model: m_loadedModels) {
+        if(model->sourcePath == sourcePath) result.push_back(model.get());
+    }
+
+    return result;
+}
+
+void ResourceManager::reloadModels(const fs::path& path)
+{
+    if(modelsImportedFrom(path).empty()) return;
+
+    RAYGUN_INFO("Reloading Model: {}", path);
+
+    m_modelReloads.push({path, m_workers.submit([path] { return render::importModel(path); })});
+}
+
+std::vector<render::Model*> ResourceManager::applyModelReloads()
+{
+    std::vector<render::Model*> result;
+
+    // Strictly in order, a file may have changed again while it was imported.
+    while(!m_modelReloads.empty() && m_modelReloads.front().imported.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        const auto path = std::move(m_modelReloads.front().path);
+        const auto imported = m_modelReloads.front().imported.get();
+        m_modelReloads.pop();
+
+        if(!imported) continue;
+
+        const auto materials = loadMaterials(*imported);
+
+        // Models loaded or released during the import are taken into account.
+        for(auto model: modelsImportedFrom(path)) {
+            if(model->sourceNode >= imported->nodes.size()) {
+                RAYGUN_WARN("Node {} no longer exists in {}", model->sourceNode, path);
+                continue;
+            }
+
+            const auto& node = imported->nodes[model->sourceNode];
+
+            model->mesh = node.mesh;
+            model->bottomLevelAS.reset();
+            model->setLods(node.lods);
+            internMeshes(*model);
+
+            // Models created without materials, e.g. font glyphs, stay that way.
+            if(!model->materials.empty()) model->materials = materials;
+
+            result.push_back(model);
+        }
+    }
+
+    return result;
 }
 
 } // namespace raygun
@@ -22,28 +22,99 @@
 
 #pragma once
 
+#include "raygun/async_resource.hpp"
 #include "raygun/audio/sound.hpp"
 #include "raygun/entity.hpp"
+#include "raygun/load_telemetry.hpp"
 #include "raygun/gpu/shader.hpp"
 #include "raygun/material.hpp"
+#include "raygun/material_table.hpp"
+#include "raygun/render/mesh_cache.hpp"
+#include "raygun/render/mesh_registry.hpp"
 #include "raygun/render/model.hpp"
+#include "raygun/render/texture.hpp"
+#include "raygun/residency.hpp"
 #include "raygun/ui/text.hpp"
+#include "raygun/utils/concurrent_cache.hpp"
+#include "raygun/utils/pak_archive.hpp"
+#include "raygun/utils/prefetcher.hpp"
+#include "raygun/utils/thread_pool.hpp"
 
 namespace raygun {
 
+/// Root directory of all resource files.
+extern const fs::path RESOURCES_DIR;
+
+/// Cooked resource files, see tools/cooker. Used instead of the files in
+/// RESOURCES_DIR if present.
+extern const fs::path RESOURCES_ARCHIVE;
+
+/// Names of resources to load together, see ResourceManager::loadAll.
+struct ResourceManifest {
+    std::vector<string> materials;
+    std::vector<string> shaders;
+    std::vector<string> fonts;
+    std::vector<string> sounds;
+    std::vector<string> textures;
+    std::vector<string> entities;
+};
+
+/// Handles to the resources requested by a ResourceManifest.
+struct ResourceBatch {
+    std::unordered_map<Atom, AsyncResource<Material>> materials;
+    std::unordered_map<Atom, AsyncResource<gpu::Shader>> shaders;
+    std::unordered_map<Atom, AsyncResource<ui::Font>> fonts;
+    std::unordered_map<Atom, AsyncResource<audio::Sound>> sounds;
+    std::unordered_map<Atom, AsyncResource<render::Texture>> textures;
+    std::unordered_map<Atom, AsyncResource<Entity>> entities;
+
+    /// True once all resources have been decoded.
+    bool ready() const;
+
+    /// Waits for all resources and finalizes them.
+    void wait() const;
+};
+
 /// A resource manager that caches resources on load.
+///
+/// Resources can also be loaded asynchronously, file access and decoding then
+/// happen on worker threads. Concurrent requests for the same resource share
+/// a single load. All load functions and registerModel may be called from any
+/// thread.
+///
+/// Memory used by cached resources is accounted per resource type. Once a
+/// type exceeds its budget (see the xxxBudgetMB config options), update
+/// evicts the least recently used resources nobody else references, a few
+/// per frame. Pinned resources are never evicted.
+///
+/// If RESOURCES_ARCHIVE exists (and the resourceArchive config option is
+/// set), resources are read from it, falling back to RESOURCES_DIR for
+/// resources not contained in the archive.
 class ResourceManager {
   public:
+    ResourceManager();
+
     /// Convenience function for loading entities.
     template<typename T = Entity>
-    std::shared_ptr<T> loadEntity(string_view name)
+    EntityPtr<T> loadEntity(string_view name)
     {
-        return std::make_shared<T>(name, entityLoadPath(name));
+        LoadTelemetry::Scope scope(m_telemetry, "Entity", name);
+        m_telemetry.recordCacheAccess("Entity", false);
+
+        const auto imported = importEntity(name);
+
+        LoadStageTimer timer(LoadStage::Convert);
+        return makeEntity<T>(name, imported);
     }
 
+    /// Imports the model of the named entity, empty on failure.
+    render::ImportedModel importEntity(string_view name) const;
+
     /// All models not obtained via the resource manager must be registered,
     /// otherwise they will not be added to the GPU vertex buffer for rendering
-    /// on scene load.
+    /// on scene load. Meshes of registered models are deduplicated, i.e.
+    /// model->mesh may be replaced by an identical mesh and must not be
+    /// modified afterwards.
     void registerModel(std::shared_ptr<render::Model> model);
 
     /// Returns a list of all registered models.
@@ -53,6 +124,14 @@ class ResourceManager {
 
     std::shared_ptr<Material> loadMaterial(string_view name);
 
+    /// Same as above, but materials without a definition of their own are
+    /// created from fallback instead of the default parameters, e.g. for
+    /// materials embedded in glTF files.
+    std::shared_ptr<Material> loadMaterial(string_view name, const MaterialParameters& fallback);
+
+    /// Loads the materials referenced by an imported model.
+    std::vector<std::shared_ptr<Material>> loadMaterials(const render::ImportedModel& model);
+
     /// Returns a list of all loaded materials.
     std::vector<Material*> materials();
 
@@ -64,18 +143,200 @@ class ResourceManager {
 
     std::shared_ptr<audio::Sound> loadSound(string_view name);
 
-    fs::path entityLoadPath(string_view name);
+    /// Loads textures/<name>.ktx2, or textures/<name>.png with mips generated
+    /// on load. Failures yield a magenta texture. The texture is registered
+    /// with the TextureStreamer.
+    std::shared_ptr<render::Texture> loadTexture(string_view name);
+
+    fs::path entityLoadPath(string_view name) const;
+
+    AsyncResource<Material> loadMaterialAsync(string_view name);
+    AsyncResource<gpu::Shader> loadShaderAsync(string_view name);
+    AsyncResource<ui::Font> loadFontAsync(string_view name);
+    AsyncResource<audio::Sound> loadSoundAsync(string_view name);
+    AsyncResource<render::Texture> loadTextureAsync(string_view name);
+
+    /// Every call yields a new entity, only the import is shared.
+    AsyncResource<Entity> loadEntityAsync(string_view name);
+
+    /// Starts loading all resources of the manifest in parallel. Their files
+    /// are prefetched first, so that loads waiting for a worker find them in
+    /// memory.
+    ResourceBatch loadAll(const ResourceManifest& manifest);
+
+    /// Reads the files of all resources of the manifest into memory in the
+    /// background without loading them, e.g. for the next scene. Resources
+    /// already cached are skipped.
+    void prefetch(const ResourceManifest& manifest);
+
+    const io::Prefetcher& prefetcher() const { return m_prefetcher; }
+
+    /// Timings, bytes read and cache hits of all loads.
+    LoadTelemetry& telemetry() { return m_telemetry; }
+
+    /// Finalizes asynchronous loads which finished decoding and evicts
+    /// resources exceeding their budget, called once per frame.
+    void update();
+
+    /// Pinned resources are neither evicted nor cleared by
+    /// clearUnusedModelsAndMaterials. Pins nest and may be placed before the
+    /// resource is loaded. Models are pinned by instance, see below.
+    void pin(ResourceType type, string_view name);
+    void unpin(ResourceType type, string_view name);
+
+    void pin(const render::Model& model);
+    void unpin(const render::Model& model);
+
+    /// True if the named resource is loaded and cached.
+    bool isResident(ResourceType type, string_view name);
+
+    /// Memory used by the cached resources of type, as of the last update.
+    MemoryUsage memoryUsage(ResourceType type);
+
+    const render::MeshRegistry& meshRegistry() const { return m_meshRegistry; }
+
+    /// Re-reads the named material in place if it is loaded, together with
+    /// all materials based on it. Returns the updated materials.
+    std::vector<Material*> reloadMaterial(string_view name);
+
+    /// Drops the named shader from the cache, pipelines created afterwards
+    /// load the new code.
+    void reloadShader(string_view name);
+
+    /// Re-imports the given model file on a worker thread if models were
+    /// imported from it, see applyModelReloads.
+    void reloadModels(const fs::path& path);
+
+    /// Replaces the meshes of all models whose file finished re-importing
+    /// since the last call. Their bottom level AS need to be rebuilt. Returns
+    /// the updated models, called once per frame.
+    std::vector<render::Model*> applyModelReloads();
 
   private:
+    template<typename T>
+    using Cache = utils::ConcurrentCache<Atom, T>;
+
+    template<typename T>
+    using Pending = std::unordered_map<Atom, AsyncResource<T>>;
+
+    /// Cached resources of one type, together with their pending
+    /// asynchronous loads and residency.
+    template<typename T>
+    struct Store {
+        explicit Store(typename ResidencyTracker<T>::Measure measure) : residency(std::move(measure)) {}
+
+        Cache<T> cache;
+
+        // Guarded by m_pendingMutex.
+        Pending<T> pending;
+
+        ResidencyTracker<T> residency;
+    };
+
+    template<typename T>
+    std::shared_ptr<T> loadCached(string_view resourceType, Atom name, Store<T>& store, const std::function<std::shared_ptr<T>()>& load);
+
+    template<typename T>
+    AsyncResource<T> loadAsyncCached(string_view resourceType, Atom name, Store<T>& store, std::function<typename AsyncResource<T>::Finalizer()> decode);
+
+    template<typename T>
+    void finalizeReady(Store<T>& store);
+
+    template<typename T>
+    void evictUnused(string_view resourceType, Store<T>& store, int budgetMB);
+
+    void evictUnusedModels();
+
+    /// Calls f with the store of type, which must not be ResourceType::Model.
+    template<typename Fun>
+    void withStore(ResourceType type, Fun f);
+
+    /// Path of the model file of the named entity, the first existing one of
+    /// models/<name>.glb, .gltf and .dae.
+    fs::path entityResourcePath(string_view name) const;
+
+    // The following take paths relative to RESOURCES_DIR and read from the
+    // archive if it contains them.
+
+    /// Name of the archive entry for path, with the same fallback as for
+    /// loose files.
+    std::optional<string> archiveEntry(const fs::path& path) const;
+
+    /// Throws if the file does not exist. Loose files and uncompressed
+    /// archive entries are mapped, not copied.
+    io::FileData readResource(const fs::path& path) const;
+
+    /// Same as above, ignoring the archive.
+    io::FileData readLooseResource(const fs::path& path) const;
+
+    /// Maps or reads an entry of m_archive, std::nullopt if it cannot be
+    /// read.
+    std::optional<io::FileData> readArchiveEntry(const string& entry) const;
+
+    /// Prefetches the file of path, or its archive entry.
+    void prefetchResource(const fs::path& path);
+
+    /// Creates the material from the compiled material table, returns
+    /// nullptr if there is no table or it does not contain name.
+    std::shared_ptr<Material> compiledMaterial(Atom name) const;
+
+    std::shared_ptr<Material> createMaterial(Atom name, const MaterialParameters* fallback) const;
+
+    ui::Font readFont(Atom name) const;
+
+    audio::DecodedSound decodeSound(Atom name, const fs::path& path) const;
+
+    render::TextureData readTexture(Atom name) const;
+
+    std::optional<render::ImportedModel> importResource(const fs::path& path) const;
+
+    /// Replaces the meshes of model by registered ones of equal content.
+    void internMeshes(render::Model& model);
+
+    /// Loaded models imported from the model file at path.
+    std::vector<render::Model*> modelsImportedFrom(const fs::path& path);
+
+    std::unique_ptr<io::PakArchive> m_archive;
+
+    io::Prefetcher m_prefetcher;
+
+    LoadTelemetry m_telemetry;
+
+    /// Maps into m_archive.
+    std::unique_ptr<MaterialTable> m_materialTable;
+
+    std::mutex m_modelsMutex;
     std::set<std::shared_ptr<render::Model>> m_loadedModels;
 
-    std::map<string, std::shared_ptr<Material>> m_materialCache;
+    ResidencyTracker<render::Model> m_modelResidency;
+
+    render::MeshRegistry m_meshRegistry;
+
+    Store<Material> m_materials;
+    Store<gpu::Shader> m_shaders;
+    Store<ui::Font> m_fonts;
+    Store<audio::Sound> m_sounds;
+    Store<render::Texture> m_textures;
+
+    /// Incremented by update, used to determine the least recently used
+    /// resources.
+    uint64_t m_frame = 0;
+
+    // Guards the pending loads.
+    std::mutex m_pendingMutex;
+
+    std::unordered_map<Atom, std::shared_future<AsyncResource<Entity>::Finalizer>> m_pendingImports;
 
-    std::map<string, std::shared_ptr<gpu::Shader>> m_shaderCache;
+    struct ModelReload {
+        fs::path path;
+        std::future<std::optional<render::ImportedModel>> imported;
+    };
 
-    std::map<string, std::shared_ptr<ui::Font>> m_fontCache;
+    /// In the order the files changed, only used on the main thread.
+    std::queue<ModelReload> m_modelReloads;
 
-    std::map<string, std::shared_ptr<audio::Sound>> m_soundCache;
+    // Declared last, workers must stop before the state above is destroyed.
+    utils::ThreadPool m_workers;
 };
 
 using UniqueResourceManager = std::unique_ptr<ResourceManager>;
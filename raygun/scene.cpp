@@ -28,8 +28,19 @@ namespace raygun {
 
 Scene::Scene() : pxScene(RG().physicsSystem().createScene())
 {
-    camera = std::make_shared<Camera>();
+    root->setJournal(&journal);
+
+    // Children may only raise their mobility, the root must not constrain them.
+    root->setMobility(Mobility::Static);
+
+    camera = makeEntity<Camera>();
     root->addChild(camera);
 }
 
+Scene::~Scene()
+{
+    // Entities may outlive the scene.
+    root->setJournal(nullptr);
+}
+
 } // namespace raygun
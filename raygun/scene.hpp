@@ -35,11 +35,15 @@ class Raygun;
 
 struct Scene {
     Scene();
-    virtual ~Scene() {}
+    virtual ~Scene();
 
-    std::shared_ptr<Camera> camera;
+    /// Records changes to entities attached to root, systems use it to update
+    /// their state incrementally.
+    ChangeJournal journal;
 
-    std::shared_ptr<Entity> root = std::make_shared<Entity>("root");
+    EntityPtr<Camera> camera;
+
+    EntityPtr<> root = makeEntity("root");
 
     physics::UniqueScene pxScene;
 
@@ -0,0 +1,314 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "raygun/ui/font.hpp"
+
+#include "raygun/config.hpp"
+#include "raygun/logging.hpp"
+#include "raygun/utils/file_stamp.hpp"
+#include "raygun/utils/hash_utils.hpp"
+#include "raygun/utils/mapped_file.hpp"
+#include "raygun/utils/memory_utils.hpp"
+
+namespace raygun::ui {
+
+namespace {
+
+    // File layout: Header, GlyphEntry[glyphCount], KerningEntry[kerningCount],
+    // then the vertices and indices of all glyphs, each array aligned to
+    // DATA_ALIGNMENT bytes. Indices are relative to the glyph's first vertex.
+
+    constexpr std::array<char, 8> MAGIC = {'R', 'G', 'F', 'O', 'N', 'T', '\0', '\0'};
+    constexpr uint32_t FORMAT_VERSION = 1;
+    constexpr size_t DATA_ALIGNMENT = 16;
+
+    struct Header {
+        std::array<char, 8> magic = MAGIC;
+        uint32_t formatVersion = FORMAT_VERSION;
+        uint32_t importerVersion = 0;
+        uint32_t vertexSize = sizeof(render::Vertex);
+        uint32_t glyphCount = 0;
+        uint32_t kerningCount = 0;
+        uint32_t vertexCount = 0;
+        uint32_t indexCount = 0;
+        uint32_t reserved = 0;
+        uint64_t sourceSize = 0;
+        int64_t sourceTime = 0;
+        uint64_t sourceHash = 0;
+    };
+
+    struct GlyphEntry {
+        uint32_t code = 0;
+        float advance = 0.0f;
+        uint32_t firstVertex = 0;
+        uint32_t vertexCount = 0;
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+    };
+
+    struct KerningEntry {
+        uint16_t key = 0;
+        uint16_t reserved = 0;
+        float adjustment = 0.0f;
+    };
+
+    static_assert(std::is_trivially_copyable_v<Header> && std::is_trivially_copyable_v<GlyphEntry> && std::is_trivially_copyable_v<KerningEntry>);
+
+    template<typename T>
+    T readAt(const std::byte* data, size_t offset)
+    {
+        T result;
+        memcpy(&result, data + offset, sizeof(T));
+        return result;
+    }
+
+    struct Layout {
+        uint64_t glyphsOffset;
+        uint64_t kerningOffset;
+        uint64_t verticesOffset;
+        uint64_t indicesOffset;
+        uint64_t end;
+    };
+
+    Layout layoutOf(const Header& header)
+    {
+        Layout result;
+        result.glyphsOffset = sizeof(Header);
+        result.kerningOffset = result.glyphsOffset + (uint64_t)header.glyphCount * sizeof(GlyphEntry);
+        result.verticesOffset = utils::alignUp(result.kerningOffset + (uint64_t)header.kerningCount * sizeof(KerningEntry), DATA_ALIGNMENT);
+        result.indicesOffset = utils::alignUp(result.verticesOffset + (uint64_t)header.vertexCount * sizeof(render::Vertex), DATA_ALIGNMENT);
+        result.end = result.indicesOffset + (uint64_t)header.indexCount * sizeof(uint32_t);
+        return result;
+    }
+
+    std::vector<char> serialize(const Font& font, uint32_t importerVersion, const io::FileStamp& source)
+    {
+        Header header;
+        header.importerVersion = importerVersion;
+        header.sourceSize = source.size;
+        header.sourceTime = source.time;
+        header.sourceHash = source.hash;
+
+        std::vector<GlyphEntry> glyphs;
+        for(uint32_t code = 0; code < Font::GLYPH_COUNT; ++code) {
+            const auto& mesh = font.charMap[code];
+            if(!mesh) continue;
+
+            auto& entry = glyphs.emplace_back();
+            entry.code = code;
+            entry.advance = font.charWidth[code];
+            entry.firstVertex = header.vertexCount;
+            entry.vertexCount = (uint32_t)mesh->vertices.size();
+            entry.firstIndex = header.indexCount;
+            entry.indexCount = (uint32_t)mesh->indices.size();
+
+            header.vertexCount += entry.vertexCount;
+            header.indexCount += entry.indexCount;
+        }
+
+        std::vector<KerningEntry> kerning;
+        for(const auto& [key, adjustment]: font.kerning) {
+            kerning.push_back({key, 0, adjustment});
+        }
+
+        // Keeps files reproducible.
+        std::sort(kerning.begin(), kerning.end(), [](const auto& a, const auto& b) { return a.key < b.key; });
+
+        header.glyphCount = (uint32_t)glyphs.size();
+        header.kerningCount = (uint32_t)kerning.size();
+
+        const auto layout = layoutOf(header);
+
+        std::vector<char> result(layout.end);
+        // Empty arrays may have no storage, memcpy must not be passed nullptr.
+        const auto write = [&](uint64_t offset, const void* bytes, size_t size) {
+            if(size > 0) memcpy(result.data() + offset, bytes, size);
+        };
+
+        write(0, &header, sizeof(header));
+        write(layout.glyphsOffset, glyphs.data(), glyphs.size() * sizeof(GlyphEntry));
+        write(layout.kerningOffset, kerning.data(), kerning.size() * sizeof(KerningEntry));
+
+        for(const auto& glyph: glyphs) {
+            const auto& mesh = *font.charMap[glyph.code];
+            write(layout.verticesOffset + (uint64_t)glyph.firstVertex * sizeof(render::Vertex), mesh.vertices.data(),
+                  mesh.vertices.size() * sizeof(render::Vertex));
+            write(layout.indicesOffset + (uint64_t)glyph.firstIndex * sizeof(uint32_t), mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+        }
+
+        return result;
+    }
+
+    fs::path fontCachePath(const fs::path& sourcePath)
+    {
+        const auto pathHash = utils::fnv1a(fs::absolute(sourcePath).generic_string());
+
+        return cacheDirectory() / "fonts" / fmt::format("{}-{:016x}.rgfont", sourcePath.stem().string(), pathHash);
+    }
+
+    std::optional<Font> readFontCache(Atom name, const fs::path& cachePath, const fs::path& sourcePath, uint32_t importerVersion)
+    {
+        const io::MappedFile file(cachePath, io::Access::Sequential);
+        if(!file || file.size() < sizeof(Header)) return {};
+
+        const auto header = readAt<Header>(file.data(), 0);
+        if(header.importerVersion != importerVersion || !io::matchesStamp(sourcePath, {header.sourceSize, header.sourceTime, header.sourceHash})) {
+            RAYGUN_DEBUG("Font cache {} is outdated", cachePath);
+            return {};
+        }
+
+        return readFont(name, file.data(), file.size());
+    }
+
+    void writeFontCache(const fs::path& cachePath, const fs::path& sourcePath, uint32_t importerVersion, const Font& font)
+    {
+        const auto source = io::fileStamp(sourcePath);
+        if(!source) return;
+
+        const auto data = serialize(font, importerVersion, *source);
+
+        std::error_code err;
+        fs::create_directories(cachePath.parent_path(), err);
+
+        // Write to a temporary file first, readers never see partial caches.
+        auto tempPath = cachePath;
+        tempPath += ".tmp";
+
+        {
+            std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+            out.write(data.data(), (std::streamsize)data.size());
+
+            if(!out) {
+                RAYGUN_WARN("Unable to write font cache {}", tempPath);
+                return;
+            }
+        }
+
+        fs::rename(tempPath, cachePath, err);
+        if(err) {
+            RAYGUN_WARN("Unable to write font cache {}: {}", cachePath, err.message());
+            fs::remove(tempPath, err);
+        }
+    }
+
+} // namespace
+
+Font compileFont(Atom name, const render::ImportedModel& imported)
+{
+    Font result;
+    result.name = name;
+
+    for(const auto& node: imported.nodes) {
+        char* end = nullptr;
+        const auto code = std::strtoul(node.name.c_str(), &end, 10);
+        if(node.name.empty() || *end != '\0' || code >= Font::GLYPH_COUNT) continue;
+
+        auto mesh = std::make_shared<render::Mesh>();
+        mesh->vertices = node.mesh->vertices;
+        mesh->indices = node.mesh->indices;
+
+        const auto bounds = mesh->bounds();
+        for(auto& v: mesh->vertices) {
+            v.position.x -= bounds.lower.x;
+        }
+
+        result.charMap[code] = mesh;
+        result.charWidth[code] = bounds.upper.x - bounds.lower.x;
+    }
+
+    return result;
+}
+
+std::vector<char> serializeFont(const Font& font)
+{
+    return serialize(font, 0, {});
+}
+
+std::optional<Font> readFont(Atom name, const std::byte* data, size_t size)
+{
+    if(size < sizeof(Header)) return {};
+
+    const auto header = readAt<Header>(data, 0);
+    if(header.magic != MAGIC || header.formatVersion != FORMAT_VERSION || header.vertexSize != sizeof(render::Vertex)) return {};
+
+    const auto layout = layoutOf(header);
+    if(layout.end > size) return {};
+
+    Font result;
+    result.name = name;
+
+    for(auto i = 0u; i < header.glyphCount; ++i) {
+        const auto glyph = readAt<GlyphEntry>(data, layout.glyphsOffset + i * sizeof(GlyphEntry));
+        if(glyph.code >= Font::GLYPH_COUNT || (uint64_t)glyph.firstVertex + glyph.vertexCount > header.vertexCount
+           || (uint64_t)glyph.firstIndex + glyph.indexCount > header.indexCount) {
+            return {};
+        }
+
+        auto mesh = std::make_shared<render::Mesh>();
+        mesh->vertices.resize(glyph.vertexCount);
+        memcpy(mesh->vertices.data(), data + layout.verticesOffset + (uint64_t)glyph.firstVertex * sizeof(render::Vertex),
+               glyph.vertexCount * sizeof(render::Vertex));
+        mesh->indices.resize(glyph.indexCount);
+        memcpy(mesh->indices.data(), data + layout.indicesOffset + (uint64_t)glyph.firstIndex * sizeof(uint32_t), glyph.indexCount * sizeof(uint32_t));
+
+        // Indices are relative to the first vertex of the glyph.
+        for(const auto index: mesh->indices) {
+            if(index >= glyph.vertexCount) return {};
+        }
+
+        result.charMap[glyph.code] = std::move(mesh);
+        result.charWidth[glyph.code] = glyph.advance;
+    }
+
+    for(auto i = 0u; i < header.kerningCount; ++i) {
+        const auto entry = readAt<KerningEntry>(data, layout.kerningOffset + i * sizeof(KerningEntry));
+        result.kerning[entry.key] = entry.adjustment;
+    }
+
+    return result;
+}
+
+Font importFont(Atom name, const fs::path& path, const render::ImportSettings& settings)
+{
+    const auto cachePath = fontCachePath(path);
+    const auto version = render::importerVersion(settings);
+
+    if(settings.meshCache) {
+        if(auto cached = readFontCache(name, cachePath, path, version)) {
+            RAYGUN_DEBUG("Loaded {} from font cache", path);
+            return std::move(*cached);
+        }
+    }
+
+    const auto imported = render::importModel(path, settings);
+    if(!imported) return compileFont(name, {});
+
+    auto result = compileFont(name, *imported);
+
+    if(settings.meshCache) {
+        writeFontCache(cachePath, path, version, result);
+    }
+
+    return result;
+}
+
+} // namespace raygun::ui
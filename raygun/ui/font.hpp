@@ -0,0 +1,72 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#pragma once
+
+#include "raygun/atom.hpp"
+#include "raygun/render/mesh.hpp"
+#include "raygun/render/model_import.hpp"
+
+namespace raygun::ui {
+
+/// Glyph meshes of the first 128 character codes, each shifted to start at
+/// x = 0.
+struct Font {
+    static constexpr size_t GLYPH_COUNT = 128;
+
+    Atom name;
+
+    std::array<std::shared_ptr<render::Mesh>, GLYPH_COUNT> charMap = {};
+
+    std::array<float, GLYPH_COUNT> charWidth = {};
+
+    /// Added to the advance between two characters, see kerningKey.
+    std::unordered_map<uint16_t, float> kerning;
+
+    static uint16_t kerningKey(char left, char right) { return (uint16_t)(((uint8_t)left << 8) | (uint8_t)right); }
+
+    float kerningBetween(char left, char right) const
+    {
+        const auto it = kerning.find(kerningKey(left, right));
+        return it != kerning.cend() ? it->second : 0.0f;
+    }
+};
+
+/// Builds a font from a model with one top-level node per glyph, named by
+/// its character code (see resources/fonts/blender_fontgen.py).
+Font compileFont(Atom name, const render::ImportedModel& imported);
+
+/// Serializes font in the compiled font format (.rgfont): a glyph table with
+/// advance widths, all glyph meshes packed into one vertex and one index
+/// array, and the kerning pairs.
+std::vector<char> serializeFont(const Font& font);
+
+/// Parses a compiled font. Returns std::nullopt if data is malformed or was
+/// written by a different format version.
+std::optional<Font> readFont(Atom name, const std::byte* data, size_t size);
+
+/// Loads the font compiled from the given model file from the cache,
+/// compiling (and caching) it if the file changed. Returns an empty font if
+/// the file cannot be imported.
+Font importFont(Atom name, const fs::path& path, const render::ImportSettings& settings);
+
+} // namespace raygun::ui
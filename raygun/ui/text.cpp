@@ -30,6 +30,7 @@ namespace raygun::ui {
 
 TextGenerator::TextGenerator(const Font& font, std::shared_ptr<Material> material, float letterPadding, float lineSpacing)
     : m_charWidth(font.charWidth)
+    , m_kerning(font.kerning)
     , letterPadding(letterPadding)
     , lineSpacing(lineSpacing)
 {
@@ -51,12 +52,12 @@ TextGenerator::TextGenerator(const Font& font, std::shared_ptr<Material> materia
     std::transform(font.charMap.begin(), font.charMap.end(), m_charMap.begin(), meshToModel);
 }
 
-std::shared_ptr<raygun::Entity> TextGenerator::text(string_view input, Alignment align) const
+raygun::EntityPtr<> TextGenerator::text(string_view input, Alignment align) const
 {
     return textWithBounds(input, align).first;
 }
 
-std::pair<std::shared_ptr<Entity>, render::Mesh::Bounds> TextGenerator::textWithBounds(string_view input, Alignment align) const
+std::pair<EntityPtr<>, render::Mesh::Bounds> TextGenerator::textWithBounds(string_view input, Alignment align) const
 {
     auto [textEnt, bounds] = textInternal(input);
 
@@ -95,7 +96,7 @@ std::pair<std::shared_ptr<Entity>, render::Mesh::Bounds> TextGenerator::textWith
     bounds.upper += offset;
     bounds.lower += offset;
 
-    auto result = std::make_shared<Entity>("string_" + string(input));
+    auto result = makeEntity("string");
     result->addChild(textEnt);
     return {result, bounds};
 }
@@ -105,12 +106,13 @@ std::shared_ptr<render::Model> TextGenerator::letter(char c) const
     return m_charMap.at(c);
 }
 
-std::pair<std::shared_ptr<Entity>, render::Mesh::Bounds> TextGenerator::textInternal(string_view input) const
+std::pair<EntityPtr<>, render::Mesh::Bounds> TextGenerator::textInternal(string_view input) const
 {
-    auto result = std::make_shared<Entity>("char_group_" + string(input));
+    auto result = makeEntity("char_group");
     render::Mesh::Bounds bounds;
 
     vec2 offset = {0.0f, 0.0f};
+    char previous = '\0';
     for(const auto& c: input) {
         if(c == ' ') {
             offset.x += 5 * letterPadding;
@@ -118,9 +120,14 @@ std::pair<std::shared_ptr<Entity>, render::Mesh::Bounds> TextGenerator::textInte
         else if(c == '\n') {
             offset.x = 0;
             offset.y -= lineSpacing;
+            previous = '\0';
             continue;
         }
 
+        const auto kerning = m_kerning.find(Font::kerningKey(previous, c));
+        if(kerning != m_kerning.cend()) offset.x += kerning->second;
+        previous = c;
+
         const auto model = letter(c);
         if(!model) continue;
 
@@ -25,17 +25,10 @@
 #include "raygun/entity.hpp"
 #include "raygun/material.hpp"
 #include "raygun/render/model.hpp"
+#include "raygun/ui/font.hpp"
 
 namespace raygun::ui {
 
-struct Font {
-    string name;
-
-    std::array<std::shared_ptr<render::Mesh>, 128> charMap = {};
-
-    std::array<float, 128> charWidth = {};
-};
-
 enum class Alignment {
     TopLeft,
     TopCenter,
@@ -52,17 +45,18 @@ class TextGenerator {
   public:
     TextGenerator(const Font& font, std::shared_ptr<Material> material, float letterPadding = 0.1f, float lineSpacing = 1.f);
 
-    std::shared_ptr<Entity> text(string_view input, Alignment align = Alignment::TopLeft) const;
-    std::pair<std::shared_ptr<Entity>, render::Mesh::Bounds> textWithBounds(string_view input, Alignment align = Alignment::TopLeft) const;
+    EntityPtr<> text(string_view input, Alignment align = Alignment::TopLeft) const;
+    std::pair<EntityPtr<>, render::Mesh::Bounds> textWithBounds(string_view input, Alignment align = Alignment::TopLeft) const;
 
   private:
-    std::array<std::shared_ptr<render::Model>, 128> m_charMap = {};
-    std::array<float, 128> m_charWidth = {};
+    std::array<std::shared_ptr<render::Model>, Font::GLYPH_COUNT> m_charMap = {};
+    std::array<float, Font::GLYPH_COUNT> m_charWidth = {};
+    std::unordered_map<uint16_t, float> m_kerning;
 
     float letterPadding, lineSpacing;
 
     std::shared_ptr<render::Model> letter(char c) const;
-    std::pair<std::shared_ptr<Entity>, render::Mesh::Bounds> textInternal(string_view input) const;
+    std::pair<EntityPtr<>, render::Mesh::Bounds> textInternal(string_view input) const;
 };
 
 using UniqueTextGenerator = std::unique_ptr<TextGenerator>;
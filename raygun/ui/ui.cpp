@@ -131,7 +131,8 @@ void Layout::applyOffset(vec2 off)
 Factory::Factory(std::shared_ptr<Font> font) : font(font)
 {
     auto uiEntity = RG().resourceManager().loadEntity("ui");
-    for(const auto& mn: MESH_NAMES) {
+    for(const auto& meshName: MESH_NAMES) {
+        const Atom mn = meshName;
         uiEntity->forEachEntity([&](Entity& e) {
             if(e.name == mn) {
                 models[mn] = e.model;
@@ -146,49 +147,49 @@ Factory::Factory(std::shared_ptr<Font> font) : font(font)
     m_textGen = std::make_unique<TextGenerator>(*font, RG().resourceManager().loadMaterial("ui_text"));
 }
 
-std::shared_ptr<Window> Factory::window(string_view name, string_view title, float headerScale) const
+EntityPtr<Window> Factory::window(string_view name, string_view title, float headerScale) const
 {
-    std::shared_ptr<Window> window(new Window(*this, name, title, headerScale));
+    EntityPtr<Window> window(new Window(*this, name, title, headerScale));
     if(currentLayout) currentLayout->place(*window);
     if(currentContainer) currentContainer->addChild(window);
     return window;
 }
 
-std::shared_ptr<Window> Factory::window(string_view name) const
+EntityPtr<Window> Factory::window(string_view name) const
 {
-    std::shared_ptr<Window> window(new Window(*this, name, "", 0.f, false));
+    EntityPtr<Window> window(new Window(*this, name, "", 0.f, false));
     if(currentLayout) currentLayout->place(*window);
     if(currentContainer) currentContainer->addChild(window);
     return window;
 }
 
-std::shared_ptr<Text> Factory::text(string_view text, Alignment align) const
+EntityPtr<Text> Factory::text(string_view text, Alignment align) const
 {
-    std::shared_ptr<Text> ret(new Text(*this, text, align));
+    EntityPtr<Text> ret(new Text(*this, text, align));
     if(currentLayout) currentLayout->place(*ret);
     if(currentContainer) currentContainer->addChild(ret);
     return ret;
 }
 
-std::shared_ptr<Button> Factory::button(string_view caption, const std::function<void()>& action, float minWidth) const
+EntityPtr<Button> Factory::button(string_view caption, const std::function<void()>& action, float minWidth) const
 {
-    std::shared_ptr<Button> button(new Button(*this, caption, action, minWidth));
+    EntityPtr<Button> button(new Button(*this, caption, action, minWidth));
     if(currentLayout) currentLayout->place(*button);
     if(currentContainer) currentContainer->addChild(button);
     return button;
 }
 
-std::shared_ptr<raygun::ui::CheckBox> Factory::checkbox(string_view caption, float minWidth) const
+EntityPtr<CheckBox> Factory::checkbox(string_view caption, float minWidth) const
 {
-    std::shared_ptr<CheckBox> checkbox(new CheckBox(*this, caption, minWidth));
+    EntityPtr<CheckBox> checkbox(new CheckBox(*this, caption, minWidth));
     if(currentLayout) currentLayout->place(*checkbox);
     if(currentContainer) currentContainer->addChild(checkbox);
     return checkbox;
 }
 
-std::shared_ptr<raygun::ui::Slider> Factory::slider(float width, double& value, double min, double max, double step) const
+EntityPtr<Slider> Factory::slider(float width, double& value, double min, double max, double step) const
 {
-    std::shared_ptr<Slider> slider(new Slider(*this, width, value, min, max, step));
+    EntityPtr<Slider> slider(new Slider(*this, width, value, min, max, step));
     if(currentLayout) currentLayout->place(*slider);
     if(currentContainer) currentContainer->addChild(slider);
     return slider;
@@ -228,28 +229,28 @@ void Factory::applyOffset(vec2 offset)
 
 Window::Window(const Factory& factory, string_view name, string_view title, float headerScale, bool includeDecorations) : AnimatableEntity(name), title(title)
 {
-    std::shared_ptr<Entity> wnd = std::make_shared<Entity>(string(name) + "_wnd");
+    EntityPtr<> wnd = makeEntity(string(name) + "_wnd");
     wnd->model = factory.getModel(mesh_names::WND);
     addChild(wnd);
 
     // header + footer + title
     if(includeDecorations) {
-        std::shared_ptr<Entity> header = std::make_shared<Entity>(string(name) + "_header_bg");
+        EntityPtr<> header = makeEntity(string(name) + "_header_bg");
         header->model = factory.getModel(mesh_names::HEADER_BG);
         header->scale(vec3(1, headerScale, 1));
         header->moveTo(vec3(0, WND_HDR_START_Y, 0));
         addChild(header);
 
-        std::shared_ptr<Entity> headerTop = std::make_shared<Entity>(string(name) + "_header_top");
+        EntityPtr<> headerTop = makeEntity(string(name) + "_header_top");
         headerTop->model = factory.getModel(mesh_names::HEADER_TOP);
         addChild(headerTop);
 
-        std::shared_ptr<Entity> headerBot = std::make_shared<Entity>(string(name) + "_header_bot");
+        EntityPtr<> headerBot = makeEntity(string(name) + "_header_bot");
         headerBot->model = factory.getModel(mesh_names::HEADER_BOT);
         headerBot->moveTo(vec3(0, WND_HDR_START_Y - WND_HDR_HEIGHT * headerScale, 0));
         addChild(headerBot);
 
-        std::shared_ptr<Entity> footer = std::make_shared<Entity>(string(name) + "_footer");
+        EntityPtr<> footer = makeEntity(string(name) + "_footer");
         footer->model = factory.getModel(mesh_names::FOOTER);
         addChild(footer);
 
@@ -396,24 +397,24 @@ namespace {
     void buildHorizontalElement(Entity& base, const Factory& factory, float halfWidth, float baseWidth, const char* leftModel, const char* centerModel,
                                 const char* rightModel)
     {
-        std::shared_ptr<Entity> center = std::make_shared<Entity>(base.name + "_center");
+        EntityPtr<> center = makeEntity(base.name.str() + "_center");
         center->model = factory.getModel(centerModel);
         center->scale(vec3(halfWidth / baseWidth, 1, 1));
         base.addChild(center);
 
-        std::shared_ptr<Entity> left = std::make_shared<Entity>(base.name + "_left");
+        EntityPtr<> left = makeEntity(base.name.str() + "_left");
         left->model = factory.getModel(leftModel);
         left->moveTo(vec3(baseWidth - halfWidth, 0, 0));
         base.addChild(left);
 
-        std::shared_ptr<Entity> right = std::make_shared<Entity>(base.name + "_right");
+        EntityPtr<> right = makeEntity(base.name.str() + "_right");
         right->model = factory.getModel(rightModel);
         right->rotate(glm::radians(180.f), vec3(0, 0, 1));
         right->moveTo(vec3(-baseWidth + halfWidth, 0, 0));
         base.addChild(right);
     }
 
-    float buildWidgetWithCaption(Entity& base, const Factory& factory, string_view caption, float minWidth, std::shared_ptr<Entity>& marker, bool isCheckbox)
+    float buildWidgetWithCaption(Entity& base, const Factory& factory, string_view caption, float minWidth, EntityPtr<>& marker, bool isCheckbox)
     {
         float halfWidth = minWidth / 2;
 
@@ -430,17 +431,17 @@ namespace {
         buildHorizontalElement(base, factory, halfWidth, BTN_BASE_WIDTH, leftModel, mesh_names::BTN_CENTER, mesh_names::BTN_SIDE);
 
         {
-            marker = base.emplaceChild(base.name + "_marker");
+            marker = base.emplaceChild(base.name.str() + "_marker");
             marker->hide();
 
             if(!isCheckbox) {
-                std::shared_ptr<Entity> markLeft = std::make_shared<Entity>(base.name + "_marker_left");
+                EntityPtr<> markLeft = makeEntity(base.name.str() + "_marker_left");
                 markLeft->model = factory.getModel(mesh_names::BTN_MARKER);
                 markLeft->moveTo(vec3(BTN_BASE_WIDTH - halfWidth, 0, 0));
                 marker->addChild(markLeft);
             }
 
-            std::shared_ptr<Entity> markRight = std::make_shared<Entity>(base.name + "_marker_right");
+            EntityPtr<> markRight = makeEntity(base.name.str() + "_marker_right");
             markRight->model = factory.getModel(mesh_names::BTN_MARKER);
             markRight->rotate(glm::radians(180.f), vec3(0, 0, 1));
             markRight->moveTo(vec3(-BTN_BASE_WIDTH + halfWidth, 0, 0));
@@ -513,7 +514,7 @@ CheckBox::CheckBox(const Factory& factory, string_view caption, float minWidth)
 {
     float halfWidth = buildWidgetWithCaption(*this, factory, caption, minWidth, marker, true);
 
-    checkmark = std::make_shared<Entity>(name + "_checkmark");
+    checkmark = makeEntity(name.str() + "_checkmark");
     checkmark->model = factory.getModel(mesh_names::CHECKMARK);
     checkmark->moveTo(vec3(BTN_BASE_WIDTH - halfWidth, 0, 0));
     checkmark->setVisible(checked);
@@ -649,7 +650,7 @@ namespace {
     double sval = 3;
 }
 
-std::shared_ptr<Window> uiTestWindow(Factory& factory)
+EntityPtr<Window> uiTestWindow(Factory& factory)
 {
     auto wnd = factory.window("test_window", "Testing Window");
 
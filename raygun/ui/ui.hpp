@@ -53,12 +53,12 @@ class Factory {
   public:
     Factory(std::shared_ptr<Font> font);
 
-    std::shared_ptr<Window> window(string_view name, string_view title, float headerScale = 1.f) const;
-    std::shared_ptr<Window> window(string_view name) const;
-    std::shared_ptr<Text> text(string_view text, Alignment align = Alignment::TopLeft) const;
-    std::shared_ptr<Button> button(string_view caption, const std::function<void()>& action, float minWidth = 0.f) const;
-    std::shared_ptr<CheckBox> checkbox(string_view caption, float minWidth = 0.f) const;
-    std::shared_ptr<Slider> slider(float width, double& value, double min = 0, double max = 1, double step = 0.1) const;
+    EntityPtr<Window> window(string_view name, string_view title, float headerScale = 1.f) const;
+    EntityPtr<Window> window(string_view name) const;
+    EntityPtr<Text> text(string_view text, Alignment align = Alignment::TopLeft) const;
+    EntityPtr<Button> button(string_view caption, const std::function<void()>& action, float minWidth = 0.f) const;
+    EntityPtr<CheckBox> checkbox(string_view caption, float minWidth = 0.f) const;
+    EntityPtr<Slider> slider(float width, double& value, double min = 0, double max = 1, double step = 0.1) const;
 
     std::shared_ptr<render::Model> getModel(const char* name) const;
 
@@ -70,7 +70,7 @@ class Factory {
   private:
     std::shared_ptr<Font> font;
     UniqueTextGenerator m_textGen;
-    std::unordered_map<std::string, std::shared_ptr<render::Model>> models;
+    std::unordered_map<Atom, std::shared_ptr<render::Model>> models;
 
     mutable std::optional<Layout> currentLayout;
     mutable Entity* currentContainer = nullptr;
@@ -142,7 +142,7 @@ class Button : public SelectableWidget {
   private:
     const Factory& factory;
     string caption;
-    std::shared_ptr<Entity> marker;
+    EntityPtr<> marker;
     std::function<void()> action;
     double timeSinceClick = 0;
     bool multiPress = false;
@@ -164,8 +164,8 @@ class CheckBox : public SelectableWidget {
     string caption;
     bool checked = false;
     double timeSinceCheck = 0;
-    std::shared_ptr<Entity> marker;
-    std::shared_ptr<Entity> checkmark;
+    EntityPtr<> marker;
+    EntityPtr<> checkmark;
     CheckBox(const Factory& factory, string_view caption, float minWidth);
 };
 
@@ -186,9 +186,9 @@ class Slider : public SelectableWidget {
     double& value;
     double min, max, step;
     float sliderWidth;
-    std::shared_ptr<Entity> marker;
-    std::shared_ptr<Entity> sliderMarker;
-    std::shared_ptr<Entity> sliderMarkerActive;
+    EntityPtr<> marker;
+    EntityPtr<> sliderMarker;
+    EntityPtr<> sliderMarkerActive;
 
     Slider(const Factory& factory, float width, double& value, double min, double max, double step);
     void moveSliderMarkers();
@@ -202,6 +202,6 @@ bool runUI(Entity& root, double deltatime, input::Input input);
 
 /// Returns a window that can be used for UI testing
 
-std::shared_ptr<Window> uiTestWindow(Factory& factory);
+EntityPtr<Window> uiTestWindow(Factory& factory);
 
 } // namespace raygun::ui
@@ -0,0 +1,265 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#pragma once
+
+namespace raygun::utils {
+
+/// Thread-safe map from keys to shared values, meant for caches which are
+/// read far more often than written.
+///
+/// Keys are distributed over shards, each holding an immutable snapshot of
+/// its entries. Lookups are lock-free, writers copy the snapshot, publish the
+/// copy and free replaced snapshots once no reader is active on the shard.
+template<typename Key, typename Value, size_t NumShards = 16>
+class ConcurrentCache {
+  public:
+    using ValuePtr = std::shared_ptr<Value>;
+
+    ConcurrentCache()
+    {
+        for(auto& shard: m_shards) {
+            shard.current = new Map;
+        }
+    }
+
+    ~ConcurrentCache()
+    {
+        for(auto& shard: m_shards) {
+            delete shard.current.load();
+            shard.reclaim();
+        }
+    }
+
+    ConcurrentCache(const ConcurrentCache&) = delete;
+    ConcurrentCache& operator=(const ConcurrentCache&) = delete;
+
+    /// Returns nullptr if key is not present.
+    ValuePtr find(const Key& key) const
+    {
+        const auto& shard = shardOf(key);
+        ReadGuard guard(shard);
+
+        const auto& map = *guard.map;
+        const auto it = map.find(key);
+        return it != map.cend() ? it->second : nullptr;
+    }
+
+    /// Returns the value of key, calling load to create it if not present.
+    /// Concurrent requests for the same key call load only once, the others
+    /// wait for its result. load must not request the same key.
+    template<typename Load>
+    ValuePtr getOrLoad(const Key& key, Load load)
+    {
+        if(auto value = find(key)) return value;
+
+        auto& shard = shardOf(key);
+
+        std::promise<ValuePtr> promise;
+        std::shared_future<ValuePtr> loading;
+
+        {
+            std::lock_guard lock(shard.writeMutex);
+
+            // Another thread may have finished loading in the meantime.
+            const auto& map = *shard.current.load();
+            const auto it = map.find(key);
+            if(it != map.cend()) return it->second;
+
+            const auto inFlight = shard.inFlight.find(key);
+            if(inFlight != shard.inFlight.cend()) {
+                loading = inFlight->second;
+            }
+            else {
+                shard.inFlight.emplace(key, promise.get_future().share());
+            }
+        }
+
+        if(loading.valid()) return loading.get();
+
+        ValuePtr value;
+        try {
+            value = load();
+        }
+        catch(...) {
+            {
+                std::lock_guard lock(shard.writeMutex);
+                shard.inFlight.erase(key);
+            }
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+
+        {
+            std::lock_guard lock(shard.writeMutex);
+            shard.modify([&](Map& map) { map[key] = value; });
+            shard.inFlight.erase(key);
+        }
+
+        promise.set_value(value);
+
+        return value;
+    }
+
+    void insert(const Key& key, ValuePtr value)
+    {
+        auto& shard = shardOf(key);
+
+        std::lock_guard lock(shard.writeMutex);
+        shard.modify([&](Map& map) { map[key] = std::move(value); });
+    }
+
+    /// Removes all entries for which pred(key, value) returns true. While
+    /// no reader is active, the cache holds a single reference per value, so
+    /// use_count() can be used to find unused entries.
+    template<typename Pred>
+    void eraseIf(Pred pred)
+    {
+        std::vector<Key> erased;
+
+        for(auto& shard: m_shards) {
+            std::lock_guard lock(shard.writeMutex);
+
+            shard.tryReclaim();
+
+            erased.clear();
+            for(const auto& [key, value]: *shard.current.load()) {
+                if(pred(key, value)) erased.push_back(key);
+            }
+
+            if(erased.empty()) continue;
+
+            shard.modify([&](Map& copy) {
+                for(const auto& key: erased) {
+                    copy.erase(key);
+                }
+            });
+        }
+    }
+
+    /// Removes key if present and pred(value) returns true. Returns whether
+    /// the entry was removed.
+    template<typename Pred>
+    bool eraseIf(const Key& key, Pred pred)
+    {
+        auto& shard = shardOf(key);
+
+        std::lock_guard lock(shard.writeMutex);
+
+        shard.tryReclaim();
+
+        const auto& map = *shard.current.load();
+        const auto it = map.find(key);
+        if(it == map.cend() || !pred(it->second)) return false;
+
+        shard.modify([&](Map& copy) { copy.erase(key); });
+
+        return true;
+    }
+
+    void clear()
+    {
+        eraseIf([](const auto&, const auto&) { return true; });
+    }
+
+    /// Returns all values present at the time of the call.
+    std::vector<ValuePtr> values() const
+    {
+        std::vector<ValuePtr> result;
+
+        for(const auto& shard: m_shards) {
+            ReadGuard guard(shard);
+
+            for(const auto& [key, value]: *guard.map) {
+                result.push_back(value);
+            }
+        }
+
+        return result;
+    }
+
+  private:
+    using Map = std::unordered_map<Key, ValuePtr>;
+
+    // Aligned to avoid false sharing of reader counts between shards.
+    struct alignas(64) Shard {
+        std::atomic<const Map*> current = nullptr;
+        mutable std::atomic<uint32_t> readers = 0;
+
+        std::mutex writeMutex;
+
+        // Guarded by writeMutex.
+        std::vector<const Map*> retired;
+        std::unordered_map<Key, std::shared_future<ValuePtr>> inFlight;
+
+        /// Publishes a modified copy of the current snapshot, requires
+        /// writeMutex.
+        template<typename Fun>
+        void modify(Fun f)
+        {
+            auto copy = std::make_unique<Map>(*current.load());
+            f(*copy);
+
+            retired.push_back(current.exchange(copy.release()));
+
+            tryReclaim();
+        }
+
+        /// Frees retired snapshots if no reader is active, requires
+        /// writeMutex.
+        void tryReclaim()
+        {
+            // A reader arriving after this check sees the current snapshot.
+            if(readers.load() == 0) {
+                reclaim();
+            }
+        }
+
+        void reclaim()
+        {
+            for(const auto* map: retired) {
+                delete map;
+            }
+            retired.clear();
+        }
+    };
+
+    struct ReadGuard {
+        explicit ReadGuard(const Shard& shard) : shard(shard)
+        {
+            ++shard.readers;
+            map = shard.current.load();
+        }
+
+        ~ReadGuard() { --shard.readers; }
+
+        const Shard& shard;
+        const Map* map;
+    };
+
+    const Shard& shardOf(const Key& key) const { return m_shards[std::hash<Key>{}(key) % NumShards]; }
+    Shard& shardOf(const Key& key) { return m_shards[std::hash<Key>{}(key) % NumShards]; }
+
+    std::array<Shard, NumShards> m_shards;
+};
+
+} // namespace raygun::utils
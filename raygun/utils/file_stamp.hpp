@@ -0,0 +1,74 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#pragma once
+
+#include "raygun/utils/hash_utils.hpp"
+#include "raygun/utils/mapped_file.hpp"
+
+namespace raygun::io {
+
+/// Identifies the contents of a source file, stored alongside data derived
+/// from it to detect when the source changes.
+struct FileStamp {
+    uint64_t size = 0;
+    int64_t time = 0;
+    uint64_t hash = 0;
+};
+
+/// Returns std::nullopt if path does not exist. The file is only read if
+/// withHash is set.
+static inline std::optional<FileStamp> fileStamp(const fs::path& path, bool withHash = true)
+{
+    std::error_code err;
+
+    const auto size = fs::file_size(path, err);
+    if(err) return {};
+
+    const auto time = fs::last_write_time(path, err);
+    if(err) return {};
+
+    FileStamp result = {size, (int64_t)time.time_since_epoch().count(), 0};
+
+    if(withHash) {
+        const MappedFile file(path);
+        result.hash = utils::fnv1a(file.data(), file.size());
+    }
+
+    return result;
+}
+
+/// True if path still has the contents described by stamp. Modification
+/// times change on copies and checkouts, the file is hashed if only its time
+/// differs.
+static inline bool matchesStamp(const fs::path& path, const FileStamp& stamp)
+{
+    const auto current = fileStamp(path, false);
+    if(!current || current->size != stamp.size) return false;
+
+    if(current->time == stamp.time) return true;
+
+    const auto hashed = fileStamp(path);
+    return hashed && hashed->hash == stamp.hash;
+}
+
+} // namespace raygun::io
@@ -0,0 +1,181 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "raygun/utils/file_watcher.hpp"
+
+#include "raygun/logging.hpp"
+
+#ifdef __linux__
+    #include <poll.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+namespace raygun::io {
+
+namespace {
+    /// Upper bound for noticing a stop request.
+    constexpr auto STOP_LATENCY = std::chrono::milliseconds(100);
+} // namespace
+
+FileWatcher::~FileWatcher()
+{
+    m_stopping = true;
+
+    if(m_thread.joinable()) {
+        m_thread.join();
+    }
+
+#ifdef __linux__
+    if(m_inotify >= 0) close(m_inotify);
+#endif
+}
+
+std::vector<fs::path> FileWatcher::changedFiles()
+{
+    std::lock_guard lock(m_mutex);
+
+    std::vector<fs::path> result(m_changed.begin(), m_changed.end());
+    m_changed.clear();
+
+    return result;
+}
+
+void FileWatcher::notify(const fs::path& path)
+{
+    std::lock_guard lock(m_mutex);
+    m_changed.insert(path.lexically_normal());
+}
+
+#ifdef __linux__
+
+FileWatcher::FileWatcher(fs::path root) : m_root(std::move(root))
+{
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(m_inotify < 0) {
+        RAYGUN_WARN("Unable to watch {}: inotify not available", m_root);
+        return;
+    }
+
+    addDirectory(m_root);
+
+    m_thread = std::thread([this] { watch(); });
+}
+
+void FileWatcher::addDirectory(const fs::path& directory)
+{
+    // Only completed writes are of interest, files moved into place cover
+    // editors saving via a temporary file.
+    constexpr uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+
+    const auto descriptor = inotify_add_watch(m_inotify, directory.c_str(), mask);
+    if(descriptor < 0) {
+        RAYGUN_WARN("Unable to watch {}", directory);
+        return;
+    }
+
+    m_directories[descriptor] = directory;
+
+    std::error_code error;
+    for(const auto& entry: fs::directory_iterator(directory, error)) {
+        if(entry.is_directory(error)) addDirectory(entry.path());
+    }
+}
+
+void FileWatcher::watch()
+{
+    alignas(inotify_event) char buffer[4096];
+
+    while(!m_stopping) {
+        pollfd fd = {m_inotify, POLLIN, 0};
+        if(poll(&fd, 1, (int)STOP_LATENCY.count()) <= 0) continue;
+
+        const auto length = read(m_inotify, buffer, sizeof(buffer));
+        if(length <= 0) continue;
+
+        for(auto pos = buffer; pos < buffer + length;) {
+            const auto& event = *reinterpret_cast<const inotify_event*>(pos);
+            pos += sizeof(inotify_event) + event.len;
+
+            if(event.mask & IN_Q_OVERFLOW) {
+                RAYGUN_WARN("File watcher queue overflow, changes in {} may be missed", m_root);
+                continue;
+            }
+
+            const auto directory = m_directories.find(event.wd);
+            if(directory == m_directories.end() || event.len == 0) continue;
+
+            const auto path = directory->second / event.name;
+
+            if(event.mask & IN_ISDIR) {
+                if(event.mask & (IN_CREATE | IN_MOVED_TO)) addDirectory(path);
+            }
+            else if(event.mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                notify(path);
+            }
+        }
+    }
+}
+
+#else
+
+FileWatcher::FileWatcher(fs::path root) : m_root(std::move(root))
+{
+    scan(false);
+
+    m_thread = std::thread([this] { watch(); });
+}
+
+void FileWatcher::scan(bool notifyNew)
+{
+    std::error_code error;
+    for(const auto& entry: fs::recursive_directory_iterator(m_root, error)) {
+        if(!entry.is_regular_file(error)) continue;
+
+        const auto time = entry.last_write_time(error);
+        if(error) continue;
+
+        const auto [it, inserted] = m_timestamps.try_emplace(entry.path(), time);
+        if(inserted ? notifyNew : it->second != time) {
+            it->second = time;
+            notify(entry.path());
+        }
+    }
+}
+
+void FileWatcher::watch()
+{
+    auto nextScan = std::chrono::steady_clock::now() + POLL_INTERVAL;
+
+    while(!m_stopping) {
+        std::this_thread::sleep_for(STOP_LATENCY);
+
+        if(std::chrono::steady_clock::now() < nextScan) continue;
+
+        scan(true);
+        nextScan = std::chrono::steady_clock::now() + POLL_INTERVAL;
+    }
+}
+
+#endif
+
+} // namespace raygun::io
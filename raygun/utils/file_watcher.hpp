@@ -0,0 +1,72 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#pragma once
+
+namespace raygun::io {
+
+/// Watches a directory tree for files being written on a background thread.
+/// Uses inotify on Linux, other platforms compare modification times every
+/// POLL_INTERVAL.
+class FileWatcher {
+  public:
+    explicit FileWatcher(fs::path root);
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    /// Returns the files written since the last call, each listed once.
+    std::vector<fs::path> changedFiles();
+
+  private:
+    static constexpr auto POLL_INTERVAL = std::chrono::milliseconds(500);
+
+    void watch();
+
+    void notify(const fs::path& path);
+
+    fs::path m_root;
+
+    std::mutex m_mutex;
+    std::set<fs::path> m_changed;
+
+    std::atomic<bool> m_stopping = false;
+
+#ifdef __linux__
+    void addDirectory(const fs::path& directory);
+
+    int m_inotify = -1;
+
+    // Only accessed by the watcher thread once started.
+    std::unordered_map<int, fs::path> m_directories;
+#else
+    void scan(bool notifyNew);
+
+    std::map<fs::path, fs::file_time_type> m_timestamps;
+#endif
+
+    // Declared last, the thread must stop before the state above is destroyed.
+    std::thread m_thread;
+};
+
+} // namespace raygun::io
@@ -22,10 +22,20 @@
 
 #pragma once
 
+#include "raygun/atom.hpp"
 #include "raygun/transform.hpp"
 
 namespace fmt {
 
+template<>
+struct formatter<raygun::Atom> : formatter<string_view> {
+    template<typename FormatContext>
+    auto format(const raygun::Atom& atom, FormatContext& ctx)
+    {
+        return formatter<string_view>::format(atom.str(), ctx);
+    }
+};
+
 template<>
 struct formatter<raygun::vec3> {
     template<typename ParseContext>
@@ -0,0 +1,424 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "raygun/utils/inflate.hpp"
+
+namespace raygun::utils {
+
+namespace {
+
+    constexpr uint32_t MAX_CODE_LENGTH = 15;
+    constexpr uint32_t MAX_LITERAL_CODES = 288;
+
+    constexpr std::array<uint16_t, 29> LENGTH_BASE = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    constexpr std::array<uint8_t, 29> LENGTH_EXTRA = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+    constexpr std::array<uint16_t, 30> DISTANCE_BASE = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+                                                        193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    constexpr std::array<uint8_t, 30> DISTANCE_EXTRA = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+    /// Order in which the lengths of the code length code are stored.
+    constexpr std::array<uint8_t, 19> CODE_LENGTH_ORDER = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+    /// Reads DEFLATE's LSB-first bit stream. Reading past the end yields zero
+    /// bits and sets overrun, callers check it once per symbol.
+    class BitReader {
+      public:
+        BitReader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+        uint32_t peek(uint32_t count)
+        {
+            refill();
+            return (uint32_t)(m_buffer & ((1ull << count) - 1));
+        }
+
+        void consume(uint32_t count)
+        {
+            m_buffer >>= count;
+            m_bits -= count;
+        }
+
+        uint32_t read(uint32_t count)
+        {
+            const auto result = peek(count);
+            consume(count);
+            return result;
+        }
+
+        void alignToByte() { consume(m_bits % 8); }
+
+        bool overrun() const { return m_padding > m_bits; }
+
+        /// Copies count bytes, requires alignment to a byte boundary.
+        bool copyBytes(std::vector<uint8_t>& out, size_t count)
+        {
+            while(count > 0 && m_bits >= m_padding + 8) {
+                out.push_back((uint8_t)m_buffer);
+                consume(8);
+                --count;
+            }
+
+            if(count == 0) return true;
+            if(count > m_size - m_pos) return false;
+
+            // The buffer is drained, drop the bits read ahead.
+            m_buffer = 0;
+
+            out.insert(out.end(), m_data + m_pos, m_data + m_pos + count);
+            m_pos += count;
+
+            return true;
+        }
+
+      private:
+        void refill()
+        {
+            if(m_bits > 56) return;
+
+            // Whole little endian word while far from the end, bits beyond
+            // m_bits are stream bits and or'ed in again by the next refill.
+            if(m_pos + 8 <= m_size) {
+                uint64_t word;
+                memcpy(&word, m_data + m_pos, sizeof(word));
+                m_buffer |= word << m_bits;
+
+                const auto bytes = (63 - m_bits) / 8;
+                m_pos += bytes;
+                m_bits += 8 * bytes;
+                return;
+            }
+
+            while(m_bits <= 56) {
+                if(m_pos < m_size) {
+                    m_buffer |= (uint64_t)m_data[m_pos++] << m_bits;
+                }
+                else {
+                    m_padding += 8;
+                }
+                m_bits += 8;
+            }
+        }
+
+        const uint8_t* m_data;
+        size_t m_size;
+        size_t m_pos = 0;
+
+        uint64_t m_buffer = 0;
+        uint32_t m_bits = 0;
+
+        /// Zero bits appended past the end of data.
+        uint32_t m_padding = 0;
+    };
+
+    /// Canonical Huffman code. Codes up to FAST_BITS long are decoded with a
+    /// single table lookup, longer ones bit by bit.
+    class Huffman {
+      public:
+        /// Returns false if the lengths do not form a valid prefix code.
+        /// Incomplete codes are accepted, their unused codes fail to decode.
+        bool build(const uint8_t* lengths, uint32_t count)
+        {
+            m_counts.fill(0);
+            for(uint32_t i = 0; i < count; ++i) {
+                ++m_counts[lengths[i]];
+            }
+            m_counts[0] = 0;
+
+            int32_t left = 1;
+            for(uint32_t length = 1; length <= MAX_CODE_LENGTH; ++length) {
+                left = (left << 1) - m_counts[length];
+                if(left < 0) return false;
+            }
+
+            std::array<uint16_t, MAX_CODE_LENGTH + 2> offsets = {};
+            for(uint32_t length = 1; length <= MAX_CODE_LENGTH; ++length) {
+                offsets[length + 1] = offsets[length] + m_counts[length];
+            }
+
+            for(uint32_t symbol = 0; symbol < count; ++symbol) {
+                if(lengths[symbol] != 0) m_symbols[offsets[lengths[symbol]]++] = (uint16_t)symbol;
+            }
+
+            m_fast.fill(0);
+
+            uint32_t code = 0;
+            uint32_t index = 0;
+            for(uint32_t length = 1; length <= FAST_BITS; ++length) {
+                for(uint32_t i = 0; i < m_counts[length]; ++i, ++code, ++index) {
+                    // Codes are stored MSB-first, the stream is read LSB-first.
+                    uint32_t reversed = 0;
+                    for(uint32_t bit = 0; bit < length; ++bit) {
+                        reversed |= ((code >> bit) & 1) << (length - 1 - bit);
+                    }
+
+                    for(uint32_t fill = reversed; fill < m_fast.size(); fill += 1u << length) {
+                        m_fast[fill] = (uint16_t)(m_symbols[index] << 4 | length);
+                    }
+                }
+                code <<= 1;
+            }
+
+            return true;
+        }
+
+        /// Returns -1 for unused codes.
+        int32_t decode(BitReader& in) const
+        {
+            const auto bits = in.peek(MAX_CODE_LENGTH);
+
+            const auto fast = m_fast[bits & (m_fast.size() - 1)];
+            if(fast != 0) {
+                in.consume(fast & 0xf);
+                return fast >> 4;
+            }
+
+            int32_t code = 0;
+            int32_t first = 0;
+            int32_t index = 0;
+            for(uint32_t length = 1; length <= MAX_CODE_LENGTH; ++length) {
+                code |= (bits >> (length - 1)) & 1;
+
+                const int32_t count = m_counts[length];
+                if(code - first < count) {
+                    in.consume(length);
+                    return m_symbols[index + code - first];
+                }
+
+                index += count;
+                first = (first + count) << 1;
+                code <<= 1;
+            }
+
+            return -1;
+        }
+
+      private:
+        static constexpr uint32_t FAST_BITS = 10;
+
+        std::array<uint16_t, MAX_CODE_LENGTH + 1> m_counts = {};
+        std::array<uint16_t, MAX_LITERAL_CODES> m_symbols = {};
+
+        /// Symbol << 4 | code length, 0 if the code is longer than FAST_BITS.
+        std::array<uint16_t, 1u << FAST_BITS> m_fast = {};
+    };
+
+    bool inflateCodes(BitReader& in, const Huffman& literals, const Huffman& distances, std::vector<uint8_t>& out)
+    {
+        while(true) {
+            const auto symbol = literals.decode(in);
+            if(symbol < 0 || in.overrun()) return false;
+
+            if(symbol < 256) {
+                out.push_back((uint8_t)symbol);
+                continue;
+            }
+
+            if(symbol == 256) return true;
+
+            const auto lengthCode = (uint32_t)symbol - 257;
+            if(lengthCode >= LENGTH_BASE.size()) return false;
+
+            const auto length = LENGTH_BASE[lengthCode] + in.read(LENGTH_EXTRA[lengthCode]);
+
+            const auto distanceCode = distances.decode(in);
+            if(distanceCode < 0 || (uint32_t)distanceCode >= DISTANCE_BASE.size()) return false;
+
+            const auto distance = DISTANCE_BASE[distanceCode] + in.read(DISTANCE_EXTRA[distanceCode]);
+            if(distance > out.size() || in.overrun()) return false;
+
+            // Source and destination may overlap, e.g. for runs.
+            const auto end = out.size();
+            out.resize(end + length);
+
+            auto* dst = out.data() + end;
+            const auto* src = dst - distance;
+            for(uint32_t i = 0; i < length; ++i) {
+                dst[i] = src[i];
+            }
+        }
+    }
+
+    bool inflateFixed(BitReader& in, std::vector<uint8_t>& out)
+    {
+        static const auto codes = [] {
+            std::array<uint8_t, MAX_LITERAL_CODES + 30> lengths;
+            std::fill(lengths.begin(), lengths.begin() + 144, 8);
+            std::fill(lengths.begin() + 144, lengths.begin() + 256, 9);
+            std::fill(lengths.begin() + 256, lengths.begin() + 280, 7);
+            std::fill(lengths.begin() + 280, lengths.begin() + MAX_LITERAL_CODES, 8);
+            std::fill(lengths.begin() + MAX_LITERAL_CODES, lengths.end(), 5);
+
+            std::pair<Huffman, Huffman> result;
+            result.first.build(lengths.data(), MAX_LITERAL_CODES);
+            result.second.build(lengths.data() + MAX_LITERAL_CODES, 30);
+            return result;
+        }();
+
+        return inflateCodes(in, codes.first, codes.second, out);
+    }
+
+    bool inflateDynamic(BitReader& in, std::vector<uint8_t>& out)
+    {
+        const auto literalCount = in.read(5) + 257;
+        const auto distanceCount = in.read(5) + 1;
+        const auto codeLengthCount = in.read(4) + 4;
+        if(literalCount > 286 || distanceCount > 30) return false;
+
+        std::array<uint8_t, CODE_LENGTH_ORDER.size()> codeLengthLengths = {};
+        for(uint32_t i = 0; i < codeLengthCount; ++i) {
+            codeLengthLengths[CODE_LENGTH_ORDER[i]] = (uint8_t)in.read(3);
+        }
+
+        Huffman codeLengths;
+        if(!codeLengths.build(codeLengthLengths.data(), (uint32_t)codeLengthLengths.size())) return false;
+
+        std::array<uint8_t, 286 + 30> lengths = {};
+        for(uint32_t i = 0; i < literalCount + distanceCount;) {
+            const auto symbol = codeLengths.decode(in);
+            if(symbol < 0 || in.overrun()) return false;
+
+            if(symbol < 16) {
+                lengths[i++] = (uint8_t)symbol;
+                continue;
+            }
+
+            uint8_t value = 0;
+            uint32_t repeat;
+            if(symbol == 16) {
+                if(i == 0) return false;
+                value = lengths[i - 1];
+                repeat = 3 + in.read(2);
+            }
+            else if(symbol == 17) {
+                repeat = 3 + in.read(3);
+            }
+            else {
+                repeat = 11 + in.read(7);
+            }
+
+            if(i + repeat > literalCount + distanceCount) return false;
+
+            std::fill_n(lengths.begin() + i, repeat, value);
+            i += repeat;
+        }
+
+        // Without an end of block code, the block would never end.
+        if(lengths[256] == 0) return false;
+
+        Huffman literals, distances;
+        if(!literals.build(lengths.data(), literalCount)) return false;
+        if(!distances.build(lengths.data() + literalCount, distanceCount)) return false;
+
+        return inflateCodes(in, literals, distances, out);
+    }
+
+    bool inflateStored(BitReader& in, std::vector<uint8_t>& out)
+    {
+        in.alignToByte();
+
+        const auto length = in.read(16);
+        const auto lengthComplement = in.read(16);
+        if(length != (~lengthComplement & 0xffff) || in.overrun()) return false;
+
+        return in.copyBytes(out, length);
+    }
+
+    uint32_t adler32(const uint8_t* data, size_t size)
+    {
+        constexpr uint32_t MOD = 65521;
+
+        // Largest block for which the sums cannot overflow before reduction.
+        constexpr size_t BLOCK = 5552;
+
+        uint32_t a = 1, b = 0;
+        while(size > 0) {
+            const auto count = std::min(size, BLOCK);
+            for(size_t i = 0; i < count; ++i) {
+                a += data[i];
+                b += a;
+            }
+            a %= MOD;
+            b %= MOD;
+
+            data += count;
+            size -= count;
+        }
+
+        return b << 16 | a;
+    }
+
+} // namespace
+
+std::optional<std::vector<uint8_t>> zlibDecompress(const void* source, size_t sourceSize, size_t sizeHint)
+{
+    const auto* bytes = static_cast<const uint8_t*>(source);
+
+    // Header and checksum.
+    if(sourceSize < 6) return {};
+
+    const auto method = bytes[0];
+    const auto flags = bytes[1];
+    if((method & 0xf) != 8 || (method >> 4) > 7 || (method << 8 | flags) % 31 != 0) return {};
+
+    // Preset dictionaries are not used by any of our formats.
+    if(flags & 0x20) return {};
+
+    std::vector<uint8_t> out;
+    out.reserve(sizeHint);
+
+    BitReader in(bytes + 2, sourceSize - 2);
+
+    bool last = false;
+    while(!last) {
+        last = in.read(1) != 0;
+
+        bool valid = false;
+        switch(in.read(2)) {
+        case 0:
+            valid = inflateStored(in, out);
+            break;
+        case 1:
+            valid = inflateFixed(in, out);
+            break;
+        case 2:
+            valid = inflateDynamic(in, out);
+            break;
+        default:
+            break;
+        }
+
+        if(!valid || in.overrun()) return {};
+    }
+
+    in.alignToByte();
+
+    uint32_t checksum = 0;
+    for(int i = 0; i < 4; ++i) {
+        checksum = checksum << 8 | in.read(8);
+    }
+
+    if(in.overrun() || checksum != adler32(out.data(), out.size())) return {};
+
+    return out;
+}
+
+} // namespace raygun::utils
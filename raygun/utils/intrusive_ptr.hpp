@@ -0,0 +1,100 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#pragma once
+
+namespace raygun::utils {
+
+/// Shared ownership via a reference count stored in the object itself. The
+/// count is maintained by intrusiveRetain and intrusiveRelease, found via
+/// argument dependent lookup, which also decide how the object is freed.
+/// Unlike std::shared_ptr this needs no control block and the count does not
+/// have to be atomic.
+template<typename T>
+class IntrusivePtr {
+  public:
+    using element_type = T;
+
+    IntrusivePtr() = default;
+    IntrusivePtr(std::nullptr_t) {}
+
+    /// Adds an owner to p, which may already be owned by other pointers.
+    explicit IntrusivePtr(T* p) : m_ptr(p)
+    {
+        if(m_ptr) intrusiveRetain(m_ptr);
+    }
+
+    IntrusivePtr(const IntrusivePtr& other) : IntrusivePtr(other.m_ptr) {}
+    IntrusivePtr(IntrusivePtr&& other) noexcept : m_ptr(std::exchange(other.m_ptr, nullptr)) {}
+
+    template<typename U, std::enable_if_t<std::is_convertible_v<U*, T*>, int> = 0>
+    IntrusivePtr(const IntrusivePtr<U>& other) : IntrusivePtr(other.get())
+    {
+    }
+
+    template<typename U, std::enable_if_t<std::is_convertible_v<U*, T*>, int> = 0>
+    IntrusivePtr(IntrusivePtr<U>&& other) noexcept : m_ptr(std::exchange(other.m_ptr, nullptr))
+    {
+    }
+
+    ~IntrusivePtr()
+    {
+        if(m_ptr) intrusiveRelease(m_ptr);
+    }
+
+    IntrusivePtr& operator=(IntrusivePtr other) noexcept
+    {
+        std::swap(m_ptr, other.m_ptr);
+        return *this;
+    }
+
+    void reset() { *this = nullptr; }
+
+    T* get() const { return m_ptr; }
+    T* operator->() const { return m_ptr; }
+    T& operator*() const { return *m_ptr; }
+
+    explicit operator bool() const { return m_ptr != nullptr; }
+
+    template<typename U>
+    bool operator==(const IntrusivePtr<U>& other) const
+    {
+        return m_ptr == other.get();
+    }
+
+    template<typename U>
+    bool operator!=(const IntrusivePtr<U>& other) const
+    {
+        return m_ptr != other.get();
+    }
+
+    bool operator==(std::nullptr_t) const { return m_ptr == nullptr; }
+    bool operator!=(std::nullptr_t) const { return m_ptr != nullptr; }
+
+  private:
+    template<typename U>
+    friend class IntrusivePtr;
+
+    T* m_ptr = nullptr;
+};
+
+} // namespace raygun::utils
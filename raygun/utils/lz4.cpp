@@ -0,0 +1,196 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "raygun/utils/lz4.hpp"
+
+#include "raygun/assert.hpp"
+
+namespace raygun::utils {
+
+namespace {
+
+    // A block is a series of sequences: a token holding the literal and match
+    // length, the literals, a 16 bit match offset and the match length
+    // remainder. The last sequence consists of literals only.
+
+    constexpr size_t MIN_MATCH = 4;
+
+    /// The last bytes of a block are always literals.
+    constexpr size_t LAST_LITERALS = 5;
+
+    /// Matches must start at least this many bytes before the end.
+    constexpr size_t MATCH_START_LIMIT = 12;
+
+    constexpr size_t MAX_OFFSET = 65535;
+
+    constexpr uint32_t HASH_BITS = 14;
+
+    uint32_t read32(const uint8_t* bytes)
+    {
+        uint32_t result;
+        memcpy(&result, bytes, sizeof(result));
+        return result;
+    }
+
+    uint32_t hash4(uint32_t value)
+    {
+        return (value * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    /// Lengths exceeding the token are continued in bytes of 255.
+    void writeLength(std::vector<char>& out, size_t length)
+    {
+        for(; length >= 255; length -= 255) {
+            out.push_back((char)255);
+        }
+        out.push_back((char)length);
+    }
+
+} // namespace
+
+std::vector<char> lz4Compress(const void* data, size_t size)
+{
+    RAYGUN_ASSERT(size <= std::numeric_limits<uint32_t>::max());
+
+    const auto* src = static_cast<const uint8_t*>(data);
+
+    std::vector<char> out;
+    out.reserve(size / 2 + 16);
+
+    // A matchLength of 0 terminates the block.
+    const auto emit = [&](size_t literalStart, size_t literalCount, size_t offset, size_t matchLength) {
+        const auto literalToken = std::min<size_t>(literalCount, 15);
+        const auto matchToken = matchLength > 0 ? std::min<size_t>(matchLength - MIN_MATCH, 15) : 0;
+        out.push_back((char)((literalToken << 4) | matchToken));
+
+        if(literalCount >= 15) writeLength(out, literalCount - 15);
+        out.insert(out.end(), src + literalStart, src + literalStart + literalCount);
+
+        if(matchLength == 0) return;
+
+        out.push_back((char)(offset & 0xff));
+        out.push_back((char)(offset >> 8));
+
+        if(matchLength - MIN_MATCH >= 15) writeLength(out, matchLength - MIN_MATCH - 15);
+    };
+
+    size_t anchor = 0;
+
+    if(size > MATCH_START_LIMIT) {
+        // Last position seen for each hash of 4 bytes.
+        std::vector<uint32_t> positions(1u << HASH_BITS, 0);
+
+        const auto matchEnd = size - LAST_LITERALS;
+
+        for(size_t pos = 0; pos + MATCH_START_LIMIT <= size;) {
+            const auto value = read32(src + pos);
+            auto& slot = positions[hash4(value)];
+            const size_t candidate = slot;
+            slot = (uint32_t)pos;
+
+            if(candidate >= pos || pos - candidate > MAX_OFFSET || read32(src + candidate) != value) {
+                ++pos;
+                continue;
+            }
+
+            auto length = MIN_MATCH;
+            while(pos + length < matchEnd && src[candidate + length] == src[pos + length]) {
+                ++length;
+            }
+
+            emit(anchor, pos - anchor, pos - candidate, length);
+
+            pos += length;
+            anchor = pos;
+        }
+    }
+
+    emit(anchor, size - anchor, 0, 0);
+
+    return out;
+}
+
+bool lz4Decompress(const void* source, size_t sourceSize, void* destination, size_t destinationSize)
+{
+    const auto* src = static_cast<const uint8_t*>(source);
+    const auto* srcEnd = src + sourceSize;
+
+    auto* dst = static_cast<uint8_t*>(destination);
+    auto* const dstBegin = dst;
+    auto* const dstEnd = dst + destinationSize;
+
+    const auto readLength = [&](size_t& length) {
+        for(;;) {
+            if(src == srcEnd) return false;
+
+            const auto byte = *src++;
+            length += byte;
+            if(byte != 255) return true;
+        }
+    };
+
+    while(src < srcEnd) {
+        const auto token = *src++;
+
+        size_t literalCount = token >> 4;
+        if(literalCount == 15 && !readLength(literalCount)) return false;
+        if(literalCount > (size_t)(srcEnd - src) || literalCount > (size_t)(dstEnd - dst)) return false;
+
+        memcpy(dst, src, literalCount);
+        src += literalCount;
+        dst += literalCount;
+
+        if(src == srcEnd) break;
+
+        if(srcEnd - src < 2) return false;
+        const size_t offset = src[0] | (src[1] << 8);
+        src += 2;
+
+        size_t matchLength = token & 15;
+        if(matchLength == 15 && !readLength(matchLength)) return false;
+        matchLength += MIN_MATCH;
+
+        if(offset == 0 || offset > (size_t)(dst - dstBegin) || matchLength > (size_t)(dstEnd - dst)) return false;
+
+        // Matches may overlap the bytes they produce, e.g. for runs.
+        const auto* match = dst - offset;
+        if(offset >= matchLength) {
+            memcpy(dst, match, matchLength);
+        }
+        else {
+            for(size_t i = 0; i < matchLength; ++i) {
+                dst[i] = match[i];
+            }
+        }
+        dst += matchLength;
+    }
+
+    return dst == dstEnd;
+}
+
+size_t lz4MaxDecompressedSize(size_t sourceSize)
+{
+    // Each length byte adds at most 255 bytes, the best case of any sequence.
+    return sourceSize * 255;
+}
+
+} // namespace raygun::utils
@@ -0,0 +1,38 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#pragma once
+
+namespace raygun::utils {
+
+/// Compresses data into a single block of the LZ4 block format. The result
+/// may be slightly larger than the input for incompressible data.
+std::vector<char> lz4Compress(const void* data, size_t size);
+
+/// Decompresses a single LZ4 block. Returns false if the block is malformed
+/// or does not decompress to exactly destinationSize bytes.
+bool lz4Decompress(const void* source, size_t sourceSize, void* destination, size_t destinationSize);
+
+/// Upper bound of the size a block of sourceSize bytes decompresses to.
+size_t lz4MaxDecompressedSize(size_t sourceSize);
+
+} // namespace raygun::utils
@@ -0,0 +1,166 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#include "raygun/utils/mapped_file.hpp"
+
+#include "raygun/utils/io_utils.hpp"
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace raygun::io {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const fs::path& path, Access access)
+{
+    DWORD flags = FILE_ATTRIBUTE_NORMAL;
+    if(access == Access::Sequential) flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+    if(access == Access::Random) flags |= FILE_FLAG_RANDOM_ACCESS;
+
+    const auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+    if(file == INVALID_HANDLE_VALUE) return;
+    m_file = file;
+
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(file, &size) || size.QuadPart == 0) return;
+
+    m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(!m_mapping) return;
+
+    m_data = static_cast<const std::byte*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if(m_data) m_size = (size_t)size.QuadPart;
+}
+
+MappedFile::~MappedFile()
+{
+    if(m_data) UnmapViewOfFile(m_data);
+    if(m_mapping) CloseHandle(m_mapping);
+    if(m_file) CloseHandle(m_file);
+}
+
+void MappedFile::willNeed([[maybe_unused]] size_t offset, [[maybe_unused]] size_t size) const
+{
+    if(offset >= m_size) return;
+
+    #if _WIN32_WINNT >= 0x0602
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = const_cast<std::byte*>(m_data + offset);
+    range.NumberOfBytes = std::min(size, m_size - offset);
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    #endif
+}
+
+#else
+
+MappedFile::MappedFile(const fs::path& path, Access access)
+{
+    const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) return;
+
+    struct stat info;
+    if(fstat(fd, &info) == 0 && info.st_size > 0) {
+        const auto size = (size_t)info.st_size;
+
+    #ifdef POSIX_FADV_SEQUENTIAL
+        // Read-ahead of the page cache, relevant if the file is not cached yet.
+        if(access == Access::Sequential) posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        if(access == Access::Random) posix_fadvise(fd, 0, 0, POSIX_FADV_RANDOM);
+    #endif
+
+        const auto data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if(data != MAP_FAILED) {
+            m_data = static_cast<const std::byte*>(data);
+            m_size = size;
+
+            // Same for faults on the mapping.
+            if(access == Access::Sequential) {
+                madvise(data, size, MADV_SEQUENTIAL);
+                madvise(data, size, MADV_WILLNEED);
+            }
+            if(access == Access::Random) {
+                madvise(data, size, MADV_RANDOM);
+            }
+        }
+    }
+
+    // The mapping stays valid after closing the descriptor.
+    close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if(m_data) munmap(const_cast<std::byte*>(m_data), m_size);
+}
+
+void MappedFile::willNeed(size_t offset, size_t size) const
+{
+    if(offset >= m_size) return;
+
+    // madvise requires a page aligned start.
+    const auto pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    const auto begin = offset / pageSize * pageSize;
+    const auto end = std::min(offset + size, m_size);
+
+    madvise(const_cast<std::byte*>(m_data + begin), end - begin, MADV_WILLNEED);
+}
+
+#endif
+
+FileData::FileData(std::vector<char> data)
+{
+    const auto owner = std::make_shared<const std::vector<char>>(std::move(data));
+
+    m_data = reinterpret_cast<const std::byte*>(owner->data());
+    m_size = owner->size();
+    m_owner = owner;
+}
+
+FileData::FileData(std::unique_ptr<const MappedFile> file)
+{
+    const std::shared_ptr<const MappedFile> owner = std::move(file);
+
+    m_data = owner->data();
+    m_size = owner->size();
+    m_owner = owner;
+}
+
+FileData mapFile(const fs::path& path, Access access)
+{
+    auto file = std::make_unique<const MappedFile>(path, access);
+    if(*file) return FileData(std::move(file));
+
+    // Empty or not mappable, readFile throws if it cannot be opened at all.
+    return FileData(readFile(path));
+}
+
+} // namespace raygun::io
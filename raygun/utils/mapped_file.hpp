@@ -0,0 +1,100 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#pragma once
+
+namespace raygun::io {
+
+/// How a file is going to be read, passed on to the OS as a hint for
+/// read-ahead and caching.
+enum class Access {
+    Normal,
+
+    /// Read once from start to end, read-ahead is increased and the whole
+    /// file is requested up front.
+    Sequential,
+
+    /// Scattered reads, read-ahead is disabled.
+    Random,
+};
+
+/// Read-only memory mapping of a whole file. Evaluates to false if the file
+/// could not be mapped, e.g. because it does not exist or is empty.
+class MappedFile {
+  public:
+    explicit MappedFile(const fs::path& path, Access access = Access::Normal);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const std::byte* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+    explicit operator bool() const { return m_data != nullptr; }
+
+    /// Asks the OS to read the given range in the background, e.g. before
+    /// handing out a view into it.
+    void willNeed(size_t offset, size_t size) const;
+
+  private:
+    const std::byte* m_data = nullptr;
+    size_t m_size = 0;
+
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+};
+
+/// Read-only contents of a file which keep their source alive, usually a
+/// memory mapping. Copies are cheap and share the source.
+class FileData {
+  public:
+    FileData() = default;
+
+    explicit FileData(std::vector<char> data);
+    explicit FileData(std::unique_ptr<const MappedFile> file);
+
+    /// Refers to memory owned by someone else, e.g. an archive entry, which
+    /// needs to outlive all copies.
+    FileData(const std::byte* data, size_t size) : m_data(data), m_size(size) {}
+
+    const std::byte* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+    bool empty() const { return m_size == 0; }
+
+  private:
+    std::shared_ptr<const void> m_owner;
+
+    const std::byte* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+/// Maps the whole file, empty files yield empty data. Files which cannot be
+/// mapped are read instead. Throws if the file cannot be opened, like
+/// readFile.
+FileData mapFile(const fs::path& path, Access access = Access::Normal);
+
+} // namespace raygun::io
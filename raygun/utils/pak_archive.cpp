@@ -0,0 +1,297 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "raygun/utils/pak_archive.hpp"
+
+#include "raygun/logging.hpp"
+#include "raygun/utils/hash_utils.hpp"
+#include "raygun/utils/lz4.hpp"
+#include "raygun/utils/memory_utils.hpp"
+
+namespace raygun::io {
+
+namespace {
+
+    // File layout: Header, Slot[slotCount], name table, then the contents of
+    // all entries, each aligned to ENTRY_ALIGNMENT bytes. Slots form an open
+    // addressing hash table over the FNV-1a hashes of the entry names.
+
+    constexpr std::array<char, 8> MAGIC = {'R', 'G', 'P', 'A', 'K', '\0', '\0', '\0'};
+    constexpr uint32_t FORMAT_VERSION = 1;
+    constexpr size_t ENTRY_ALIGNMENT = 64;
+
+    constexpr uint32_t SLOT_USED = 1 << 0;
+    constexpr uint32_t SLOT_COMPRESSED = 1 << 1;
+
+    /// Compressed entries need to be at most this fraction of the original.
+    constexpr double MAX_COMPRESSION_RATIO = 0.9;
+
+    struct Header {
+        std::array<char, 8> magic = MAGIC;
+        uint32_t formatVersion = FORMAT_VERSION;
+        uint32_t entryCount = 0;
+        uint32_t slotCount = 0;
+        uint32_t namesSize = 0;
+    };
+
+    struct Slot {
+        uint64_t hash = 0;
+        uint32_t nameOffset = 0;
+        uint32_t nameLength = 0;
+        uint64_t offset = 0;
+        uint64_t storedSize = 0;
+        uint64_t size = 0;
+        uint32_t flags = 0;
+        uint32_t reserved = 0;
+    };
+
+    static_assert(std::is_trivially_copyable_v<Header> && std::is_trivially_copyable_v<Slot>);
+
+    constexpr uint64_t SLOTS_OFFSET = sizeof(Header);
+
+    template<typename T>
+    T readAt(const std::byte* data, size_t offset)
+    {
+        T result;
+        memcpy(&result, data + offset, sizeof(T));
+        return result;
+    }
+
+    /// Keeps the hash table at most half full.
+    uint32_t slotCountFor(size_t entryCount)
+    {
+        uint32_t result = 16;
+        while(result < entryCount * 2) {
+            result *= 2;
+        }
+        return result;
+    }
+
+} // namespace
+
+PakArchive::PakArchive(const fs::path& path) : m_file(path)
+{
+    if(!m_file || m_file.size() < sizeof(Header)) return;
+
+    const auto header = readAt<Header>(m_file.data(), 0);
+    if(header.magic != MAGIC || header.formatVersion != FORMAT_VERSION) {
+        RAYGUN_WARN("Resource archive {} is outdated", path);
+        return;
+    }
+
+    const auto validSlotCount = header.slotCount > 0 && (header.slotCount & (header.slotCount - 1)) == 0 && header.entryCount < header.slotCount;
+    if(!validSlotCount || SLOTS_OFFSET + (uint64_t)header.slotCount * sizeof(Slot) + header.namesSize > m_file.size()) {
+        RAYGUN_WARN("Resource archive {} is corrupt", path);
+        return;
+    }
+
+    m_entryCount = header.entryCount;
+    m_slotCount = header.slotCount;
+}
+
+std::optional<PakArchive::Location> PakArchive::locate(string_view name) const
+{
+    if(!*this) return {};
+
+    const auto data = m_file.data();
+    const auto namesOffset = SLOTS_OFFSET + (uint64_t)m_slotCount * sizeof(Slot);
+    const auto namesSize = readAt<Header>(data, 0).namesSize;
+
+    const auto hash = utils::fnv1a(name);
+
+    // The table is never full, probing ends at an unused slot.
+    for(uint32_t i = 0; i < m_slotCount; ++i) {
+        const auto slot = readAt<Slot>(data, SLOTS_OFFSET + ((hash + i) & (m_slotCount - 1)) * sizeof(Slot));
+        if(!(slot.flags & SLOT_USED)) return {};
+
+        if(slot.hash != hash || slot.nameLength != name.size()) continue;
+        if((uint64_t)slot.nameOffset + slot.nameLength > namesSize) return {};
+        if(memcmp(data + namesOffset + slot.nameOffset, name.data(), name.size()) != 0) continue;
+
+        if(slot.offset > m_file.size() || slot.storedSize > m_file.size() - slot.offset) return {};
+
+        // view and read trust size, read allocates it up front.
+        const auto compressed = (slot.flags & SLOT_COMPRESSED) != 0;
+        if(compressed ? slot.size > utils::lz4MaxDecompressedSize(slot.storedSize) : slot.size != slot.storedSize) return {};
+
+        return Location{slot.offset, slot.storedSize, slot.size, compressed};
+    }
+
+    return {};
+}
+
+std::optional<PakArchive::View> PakArchive::view(string_view name) const
+{
+    const auto location = locate(name);
+    if(!location || location->compressed) return {};
+
+    return View{m_file.data() + location->offset, (size_t)location->size};
+}
+
+bool PakArchive::prefetch(string_view name) const
+{
+    const auto location = locate(name);
+    if(!location) return false;
+
+    m_file.willNeed(location->offset, location->storedSize);
+    return true;
+}
+
+std::optional<std::vector<char>> PakArchive::read(string_view name) const
+{
+    const auto location = locate(name);
+    if(!location) return {};
+
+    const auto stored = m_file.data() + location->offset;
+
+    std::vector<char> result(location->size);
+    if(!location->compressed) {
+        memcpy(result.data(), stored, result.size());
+    }
+    else if(!utils::lz4Decompress(stored, location->storedSize, result.data(), result.size())) {
+        RAYGUN_ERROR("Corrupt archive entry: {}", name);
+        return {};
+    }
+
+    return result;
+}
+
+void PakWriter::add(string name, std::vector<char> data, bool compress)
+{
+    Entry entry;
+    entry.name = std::move(name);
+    entry.size = data.size();
+    entry.compressed = false;
+
+    if(compress) {
+        auto compressed = utils::lz4Compress(data.data(), data.size());
+        if(compressed.size() <= data.size() * MAX_COMPRESSION_RATIO) {
+            data = std::move(compressed);
+            entry.compressed = true;
+        }
+    }
+
+    entry.data = std::move(data);
+
+    std::lock_guard lock(m_mutex);
+    m_entries.push_back(std::move(entry));
+}
+
+size_t PakWriter::entryCount() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_entries.size();
+}
+
+bool PakWriter::write(const fs::path& path) const
+{
+    std::lock_guard lock(m_mutex);
+
+    // Entries arrive in any order, sorting keeps archives reproducible.
+    std::vector<const Entry*> entries;
+    for(const auto& entry: m_entries) {
+        entries.push_back(&entry);
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry* a, const Entry* b) { return a->name < b->name; });
+
+    Header header;
+    header.slotCount = slotCountFor(entries.size());
+
+    std::vector<Slot> slots(header.slotCount);
+    string names;
+
+    uint64_t offset = 0;
+    for(const auto* entry: entries) {
+        const auto hash = utils::fnv1a(entry->name);
+
+        auto index = hash & (header.slotCount - 1);
+        for(; slots[index].flags & SLOT_USED; index = (index + 1) & (header.slotCount - 1)) {
+            const auto& other = slots[index];
+            if(other.hash == hash && names.compare(other.nameOffset, other.nameLength, entry->name) == 0) {
+                RAYGUN_ERROR("Duplicate archive entry: {}", entry->name);
+                return false;
+            }
+        }
+
+        auto& slot = slots[index];
+        slot.hash = hash;
+        slot.nameOffset = (uint32_t)names.size();
+        slot.nameLength = (uint32_t)entry->name.size();
+        slot.offset = offset;
+        slot.storedSize = entry->data.size();
+        slot.size = entry->size;
+        slot.flags = SLOT_USED | (entry->compressed ? SLOT_COMPRESSED : 0);
+
+        names += entry->name;
+        offset = utils::alignUp(offset + entry->data.size(), ENTRY_ALIGNMENT);
+    }
+
+    header.entryCount = (uint32_t)entries.size();
+    header.namesSize = (uint32_t)names.size();
+
+    // Offsets so far are relative to the first entry.
+    const auto dataOffset = utils::alignUp(SLOTS_OFFSET + slots.size() * sizeof(Slot) + names.size(), ENTRY_ALIGNMENT);
+    for(auto& slot: slots) {
+        if(slot.flags & SLOT_USED) slot.offset += dataOffset;
+    }
+
+    std::error_code err;
+    if(path.has_parent_path()) fs::create_directories(path.parent_path(), err);
+
+    auto tempPath = path;
+    tempPath += ".tmp";
+
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+
+        const auto write = [&](const void* bytes, size_t size) { out.write(static_cast<const char*>(bytes), (std::streamsize)size); };
+        const auto pad = [&] {
+            static constexpr std::array<char, ENTRY_ALIGNMENT> zeros = {};
+            write(zeros.data(), utils::alignUp((size_t)out.tellp(), ENTRY_ALIGNMENT) - (size_t)out.tellp());
+        };
+
+        write(&header, sizeof(header));
+        write(slots.data(), slots.size() * sizeof(Slot));
+        write(names.data(), names.size());
+
+        for(const auto* entry: entries) {
+            pad();
+            write(entry->data.data(), entry->data.size());
+        }
+
+        if(!out) {
+            RAYGUN_ERROR("Unable to write archive {}", tempPath);
+            return false;
+        }
+    }
+
+    fs::rename(tempPath, path, err);
+    if(err) {
+        RAYGUN_ERROR("Unable to write archive {}: {}", path, err.message());
+        fs::remove(tempPath, err);
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace raygun::io
@@ -0,0 +1,107 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#pragma once
+
+#include "raygun/utils/mapped_file.hpp"
+
+namespace raygun::io {
+
+/// Read-only archive of resource files (.rgpak) written by PakWriter.
+///
+/// The archive is memory mapped as a whole. Entries are named by their
+/// generic relative path and found through a hash table stored in the file,
+/// uncompressed entries can be accessed in place without copying. All
+/// functions are thread-safe.
+class PakArchive {
+  public:
+    /// Stored bytes of an entry, valid as long as the archive.
+    struct View {
+        const std::byte* data = nullptr;
+        size_t size = 0;
+    };
+
+    /// Evaluates to false if path does not exist or is not a valid archive.
+    explicit PakArchive(const fs::path& path);
+
+    explicit operator bool() const { return m_slotCount > 0; }
+
+    uint32_t entryCount() const { return m_entryCount; }
+
+    bool contains(string_view name) const { return locate(name).has_value(); }
+
+    /// Returns std::nullopt if the entry does not exist or is compressed.
+    std::optional<View> view(string_view name) const;
+
+    /// Asks the OS to read the stored bytes of an entry in the background.
+    /// Returns false if the entry does not exist.
+    bool prefetch(string_view name) const;
+
+    /// Returns a copy of the contents, decompressed if required, or
+    /// std::nullopt if the entry does not exist or is corrupt.
+    std::optional<std::vector<char>> read(string_view name) const;
+
+  private:
+    struct Location {
+        uint64_t offset;
+        uint64_t storedSize;
+        uint64_t size;
+        bool compressed;
+    };
+
+    std::optional<Location> locate(string_view name) const;
+
+    MappedFile m_file;
+
+    uint32_t m_entryCount = 0;
+
+    /// Size of the hash table, a power of two.
+    uint32_t m_slotCount = 0;
+};
+
+/// Collects entries and writes them as a PakArchive, entries may be added
+/// from multiple threads.
+class PakWriter {
+  public:
+    /// Compressing happens on the calling thread. Compressed entries are
+    /// stored uncompressed if compression does not save enough space.
+    void add(string name, std::vector<char> data, bool compress);
+
+    size_t entryCount() const;
+
+    /// Writes the archive via a temporary file, readers never see partial
+    /// archives. Returns false on failure.
+    bool write(const fs::path& path) const;
+
+  private:
+    struct Entry {
+        string name;
+        std::vector<char> data;
+        uint64_t size;
+        bool compressed;
+    };
+
+    mutable std::mutex m_mutex;
+    std::vector<Entry> m_entries;
+};
+
+} // namespace raygun::io
@@ -0,0 +1,98 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#pragma once
+
+#include "raygun/utils/thread_pool.hpp"
+
+namespace raygun::utils {
+
+/// Persistent workers helping out in parallelFor.
+ThreadPool& parallelForPool();
+
+/// Runs f(0) .. f(count - 1) on all available cores, the calling thread
+/// takes part. Returns once all calls finished, exceptions are forwarded.
+///
+/// Helpers run on parallelForPool. The caller only waits for helpers which
+/// already started, so nested calls cannot deadlock on a busy pool.
+template<typename Fun>
+void parallelFor(size_t count, Fun f)
+{
+    if(count == 0) return;
+
+    // Outlives the call, helpers starting late only find it closed.
+    struct Job {
+        std::atomic<size_t> next{0};
+
+        std::mutex mutex;
+        std::condition_variable finished;
+        size_t activeHelpers = 0;
+        bool closed = false;
+        std::exception_ptr error;
+    };
+
+    const auto job = std::make_shared<Job>();
+
+    const auto work = [&job = *job, &f, count] {
+        try {
+            for(auto i = job.next++; i < count; i = job.next++) {
+                f(i);
+            }
+        }
+        catch(...) {
+            job.next = count;
+
+            std::lock_guard lock(job.mutex);
+            if(!job.error) job.error = std::current_exception();
+        }
+    };
+
+    auto& pool = parallelForPool();
+    const auto helpers = std::min(pool.size(), count - 1);
+
+    for(size_t i = 0; i < helpers; ++i) {
+        pool.submit([job, work = &work] {
+            {
+                std::lock_guard lock(job->mutex);
+                if(job->closed) return;
+                ++job->activeHelpers;
+            }
+
+            (*work)();
+
+            std::lock_guard lock(job->mutex);
+            if(--job->activeHelpers == 0) job->finished.notify_all();
+        });
+    }
+
+    work();
+
+    // Helpers reference work and f, running ones have to finish before they
+    // go away.
+    std::unique_lock lock(job->mutex);
+    job->closed = true;
+    job->finished.wait(lock, [&] { return job->activeHelpers == 0; });
+
+    if(job->error) std::rethrow_exception(job->error);
+}
+
+} // namespace raygun::utils
@@ -0,0 +1,114 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "raygun/utils/memory_utils.hpp"
+
+namespace raygun::utils {
+
+/// Thread-safe pool of fixed size slots. Memory is requested in slabs holding
+/// many slots and never returned to the system, freed slots are reused.
+class SlabPool {
+  public:
+    SlabPool(size_t slotSize, size_t slotAlignment)
+        : m_slotSize(alignUp(std::max(slotSize, sizeof(FreeSlot)), std::max(slotAlignment, alignof(FreeSlot))))
+        , m_slotAlignment(std::max(slotAlignment, alignof(FreeSlot)))
+        , m_slotsPerSlab(std::max<size_t>(16, SLAB_SIZE / m_slotSize))
+    {
+    }
+
+    SlabPool(const SlabPool&) = delete;
+    SlabPool& operator=(const SlabPool&) = delete;
+
+    ~SlabPool()
+    {
+        for(auto slab: m_slabs) {
+            ::operator delete(slab, std::align_val_t(m_slotAlignment));
+        }
+    }
+
+    void* allocate()
+    {
+        std::lock_guard lock(m_mutex);
+
+        if(!m_freeList) {
+            addSlab();
+        }
+
+        auto slot = m_freeList;
+        m_freeList = slot->next;
+
+        return slot;
+    }
+
+    void deallocate(void* p)
+    {
+        std::lock_guard lock(m_mutex);
+
+        auto slot = static_cast<FreeSlot*>(p);
+        slot->next = m_freeList;
+        m_freeList = slot;
+    }
+
+  private:
+    static constexpr size_t SLAB_SIZE = 64 * 1024;
+
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    void addSlab()
+    {
+        auto slab = static_cast<std::byte*>(::operator new(m_slotSize * m_slotsPerSlab, std::align_val_t(m_slotAlignment)));
+        m_slabs.push_back(slab);
+
+        // Thread slots in address order so consecutive allocations are
+        // adjacent in memory.
+        for(auto i = m_slotsPerSlab; i > 0; --i) {
+            auto slot = reinterpret_cast<FreeSlot*>(slab + (i - 1) * m_slotSize);
+            slot->next = m_freeList;
+            m_freeList = slot;
+        }
+    }
+
+    const size_t m_slotSize;
+    const size_t m_slotAlignment;
+    const size_t m_slotsPerSlab;
+
+    std::mutex m_mutex;
+    FreeSlot* m_freeList = nullptr;
+    std::vector<std::byte*> m_slabs;
+};
+
+/// Returns the pool shared by all objects of the given size and alignment.
+template<size_t Size, size_t Alignment>
+SlabPool& slabPool()
+{
+    // Intentionally leaked, pooled objects may be destroyed during static
+    // destruction.
+    static auto pool = new SlabPool(Size, Alignment);
+    return *pool;
+}
+
+} // namespace raygun::utils
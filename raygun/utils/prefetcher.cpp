@@ -0,0 +1,487 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "raygun/utils/prefetcher.hpp"
+
+#include "raygun/logging.hpp"
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    #include <sys/uio.h>
+
+    #if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+        #define RAYGUN_IO_URING
+    #endif
+#endif
+
+namespace raygun::io {
+
+namespace {
+    /// Files are read in chunks of this size, the contents are discarded.
+    constexpr size_t CHUNK_SIZE = 128 * 1024;
+
+    /// Reading is bound by the disk, more threads do not help.
+    constexpr size_t WORKER_COUNT = 2;
+
+    /// Reads the whole file with blocking reads, returns the number of bytes
+    /// read.
+    uint64_t readThrough(const fs::path& path)
+    {
+        static thread_local std::vector<char> buffer(CHUNK_SIZE);
+
+        uint64_t total = 0;
+
+#ifdef _WIN32
+        std::ifstream file(path, std::ios::binary);
+        while(file.read(buffer.data(), buffer.size()) || file.gcount() > 0) {
+            total += (uint64_t)file.gcount();
+        }
+#else
+        const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if(fd < 0) return 0;
+
+    #ifdef POSIX_FADV_WILLNEED
+        // Starts read-ahead of the whole file right away.
+        posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    #endif
+
+        for(ssize_t count; (count = read(fd, buffer.data(), buffer.size())) > 0;) {
+            total += (uint64_t)count;
+        }
+
+        close(fd);
+#endif
+
+        return total;
+    }
+} // namespace
+
+#ifdef RAYGUN_IO_URING
+
+/// Reads files through an io_uring with up to QUEUE_DEPTH chunks in flight,
+/// driven by its own thread. Uses the raw system calls, there is no
+/// dependency on liburing.
+class Prefetcher::Ring {
+  public:
+    /// Returns nullptr if io_uring is not available, e.g. on kernels before
+    /// 5.1 or if it is disabled.
+    static std::unique_ptr<Ring> create(Prefetcher& owner)
+    {
+        auto ring = std::unique_ptr<Ring>(new Ring(owner));
+        if(!ring->setup()) return nullptr;
+
+        ring->m_thread = std::thread([ring = ring.get()] { ring->run(); });
+        return ring;
+    }
+
+    ~Ring()
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wakeUp.notify_one();
+
+        if(m_thread.joinable()) {
+            m_thread.join();
+        }
+
+        if(m_sqes) munmap(m_sqes, m_sqesSize);
+        if(m_cqRing && m_cqRing != m_sqRing) munmap(m_cqRing, m_cqRingSize);
+        if(m_sqRing) munmap(m_sqRing, m_sqRingSize);
+        if(m_fd >= 0) close(m_fd);
+    }
+
+    void enqueue(const fs::path& path)
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_queue.push_back(path);
+        }
+        m_wakeUp.notify_one();
+    }
+
+  private:
+    static constexpr uint32_t QUEUE_DEPTH = 16;
+
+    struct File {
+        fs::path path;
+        int fd = -1;
+        uint64_t size = 0;
+
+        /// Offset of the next chunk to request.
+        uint64_t offset = 0;
+
+        uint64_t bytesRead = 0;
+        uint32_t inFlight = 0;
+        bool failed = false;
+    };
+
+    struct Request {
+        File* file = nullptr;
+        iovec buffer = {};
+    };
+
+    explicit Ring(Prefetcher& owner) : m_owner(owner) {}
+
+    bool setup()
+    {
+        io_uring_params params = {};
+        m_fd = (int)syscall(__NR_io_uring_setup, QUEUE_DEPTH, &params);
+        if(m_fd < 0) return false;
+
+        m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+        // Both rings share one mapping on kernels 5.4 and up.
+        const auto singleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if(singleMapping) {
+            m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+        }
+
+        const auto map = [this](size_t size, off_t offset) -> std::byte* {
+            const auto result = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, offset);
+            return result == MAP_FAILED ? nullptr : static_cast<std::byte*>(result);
+        };
+
+        m_sqRing = map(m_sqRingSize, IORING_OFF_SQ_RING);
+        if(!m_sqRing) return false;
+
+        m_cqRing = singleMapping ? m_sqRing : map(m_cqRingSize, IORING_OFF_CQ_RING);
+        if(!m_cqRing) return false;
+
+        m_sqes = reinterpret_cast<io_uring_sqe*>(map(m_sqesSize, IORING_OFF_SQES));
+        if(!m_sqes) return false;
+
+        m_sqTail = reinterpret_cast<uint32_t*>(m_sqRing + params.sq_off.tail);
+        m_sqMask = *reinterpret_cast<uint32_t*>(m_sqRing + params.sq_off.ring_mask);
+        m_sqArray = reinterpret_cast<uint32_t*>(m_sqRing + params.sq_off.array);
+
+        m_cqHead = reinterpret_cast<uint32_t*>(m_cqRing + params.cq_off.head);
+        m_cqTail = reinterpret_cast<uint32_t*>(m_cqRing + params.cq_off.tail);
+        m_cqMask = *reinterpret_cast<uint32_t*>(m_cqRing + params.cq_off.ring_mask);
+        m_cqes = reinterpret_cast<io_uring_cqe*>(m_cqRing + params.cq_off.cqes);
+
+        m_buffers.resize((size_t)QUEUE_DEPTH * CHUNK_SIZE);
+        m_requests.resize(QUEUE_DEPTH);
+        for(uint32_t i = 0; i < QUEUE_DEPTH; ++i) {
+            m_requests[i].buffer = {m_buffers.data() + (size_t)i * CHUNK_SIZE, CHUNK_SIZE};
+            m_freeRequests.push_back(i);
+        }
+
+        return true;
+    }
+
+    void run()
+    {
+        for(;;) {
+            std::vector<fs::path> added;
+            {
+                std::unique_lock lock(m_mutex);
+                m_wakeUp.wait(lock, [this] { return m_stopping || !m_queue.empty() || !m_openFiles.empty(); });
+
+                // Reads in flight still refer to the buffers.
+                if(m_stopping && m_openFiles.empty()) break;
+
+                added.swap(m_queue);
+            }
+
+            if(m_failed) {
+                for(const auto& path: added) {
+                    m_owner.finished(path, readThrough(path));
+                }
+                continue;
+            }
+
+            for(const auto& path: added) {
+                open(path);
+            }
+
+            submitReads();
+
+            if(!wait()) {
+                m_failed = true;
+                abandonAll();
+                continue;
+            }
+
+            retireFinished();
+        }
+    }
+
+    void open(const fs::path& path)
+    {
+        auto file = std::make_unique<File>();
+        file->path = path;
+
+        file->fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+        struct stat info;
+        if(file->fd < 0 || fstat(file->fd, &info) != 0) {
+            file->failed = true;
+        }
+        else {
+            file->size = (uint64_t)info.st_size;
+        }
+
+        m_openFiles.push_back(std::move(file));
+    }
+
+    /// Requests chunks of the files in queue order while requests are free.
+    void submitReads()
+    {
+        const auto stopping = [this] {
+            std::lock_guard lock(m_mutex);
+            return m_stopping;
+        }();
+
+        for(auto& file: m_openFiles) {
+            if(stopping) file->failed = true;
+
+            while(!file->failed && file->offset < file->size && !m_freeRequests.empty()) {
+                const auto index = m_freeRequests.back();
+                m_freeRequests.pop_back();
+
+                auto& request = m_requests[index];
+                request.file = file.get();
+                request.buffer.iov_len = (size_t)std::min<uint64_t>(CHUNK_SIZE, file->size - file->offset);
+
+                push(file->fd, request.buffer, file->offset, index);
+
+                file->offset += request.buffer.iov_len;
+                ++file->inFlight;
+            }
+        }
+    }
+
+    void push(int fd, iovec& buffer, uint64_t offset, uint64_t userData)
+    {
+        // Requests never exceed the queue depth, there is always room.
+        const auto tail = *m_sqTail;
+        const auto index = tail & m_sqMask;
+
+        auto& sqe = m_sqes[index];
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READV;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<uint64_t>(&buffer);
+        sqe.len = 1;
+        sqe.off = offset;
+        sqe.user_data = userData;
+
+        m_sqArray[index] = index;
+
+        // The kernel must see the entry before the new tail.
+        __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+        ++m_unsubmitted;
+    }
+
+    /// Submits pending requests and processes at least one completion if any
+    /// request is in flight. Returns false if the ring failed.
+    bool wait()
+    {
+        const auto inFlight = QUEUE_DEPTH - (uint32_t)m_freeRequests.size();
+        if(m_unsubmitted == 0 && inFlight == 0) return true;
+
+        const auto minComplete = inFlight > 0 ? 1u : 0u;
+
+        for(;;) {
+            const auto result = syscall(__NR_io_uring_enter, m_fd, m_unsubmitted, minComplete, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if(result >= 0) {
+                m_unsubmitted -= (uint32_t)result;
+                break;
+            }
+
+            if(errno != EINTR) {
+                RAYGUN_WARN("io_uring_enter failed: {}", strerror(errno));
+                return false;
+            }
+        }
+
+        auto head = *m_cqHead;
+        const auto tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+
+        for(; head != tail; ++head) {
+            const auto& cqe = m_cqes[head & m_cqMask];
+            auto& request = m_requests[cqe.user_data];
+
+            auto& file = *request.file;
+            --file.inFlight;
+
+            // A short read leaves the rest of the chunk uncached, which is
+            // fine for a hint.
+            if(cqe.res > 0) {
+                file.bytesRead += (uint64_t)cqe.res;
+            }
+            else {
+                file.failed = true;
+            }
+
+            request.file = nullptr;
+            m_freeRequests.push_back((uint32_t)cqe.user_data);
+        }
+
+        __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+
+        return true;
+    }
+
+    void retireFinished()
+    {
+        for(auto it = m_openFiles.begin(); it != m_openFiles.end();) {
+            auto& file = **it;
+
+            if(file.inFlight > 0 || (!file.failed && file.offset < file.size)) {
+                ++it;
+                continue;
+            }
+
+            if(file.fd >= 0) close(file.fd);
+            m_owner.finished(file.path, file.bytesRead);
+
+            it = m_openFiles.erase(it);
+        }
+    }
+
+    /// Reads all open files with blocking reads instead, requests in flight
+    /// are lost.
+    void abandonAll()
+    {
+        for(auto& file: m_openFiles) {
+            if(file->fd >= 0) close(file->fd);
+            m_owner.finished(file->path, readThrough(file->path));
+        }
+
+        m_openFiles.clear();
+    }
+
+    Prefetcher& m_owner;
+
+    int m_fd = -1;
+
+    std::byte* m_sqRing = nullptr;
+    std::byte* m_cqRing = nullptr;
+    io_uring_sqe* m_sqes = nullptr;
+
+    size_t m_sqRingSize = 0;
+    size_t m_cqRingSize = 0;
+    size_t m_sqesSize = 0;
+
+    uint32_t* m_sqTail = nullptr;
+    uint32_t* m_sqArray = nullptr;
+    uint32_t m_sqMask = 0;
+
+    uint32_t* m_cqHead = nullptr;
+    uint32_t* m_cqTail = nullptr;
+    io_uring_cqe* m_cqes = nullptr;
+    uint32_t m_cqMask = 0;
+
+    uint32_t m_unsubmitted = 0;
+
+    /// Set once the ring failed, files are read by the ring thread directly
+    /// from then on.
+    bool m_failed = false;
+
+    // Only accessed by the ring thread.
+    std::vector<char> m_buffers;
+    std::vector<Request> m_requests;
+    std::vector<uint32_t> m_freeRequests;
+    std::vector<std::unique_ptr<File>> m_openFiles;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    std::vector<fs::path> m_queue;
+    bool m_stopping = false;
+
+    // Declared last, the thread must stop before the state above is destroyed.
+    std::thread m_thread;
+};
+
+#else
+
+class Prefetcher::Ring {
+  public:
+    static std::unique_ptr<Ring> create(Prefetcher&) { return nullptr; }
+
+    void enqueue(const fs::path&) {}
+};
+
+#endif
+
+Prefetcher::Prefetcher()
+{
+    m_ring = Ring::create(*this);
+
+    if(!m_ring) {
+        m_workers = std::make_unique<utils::ThreadPool>(WORKER_COUNT);
+    }
+
+    RAYGUN_DEBUG("Prefetching files using {}", m_ring ? "io_uring" : "a thread pool");
+}
+
+Prefetcher::~Prefetcher() = default;
+
+void Prefetcher::prefetch(const fs::path& path)
+{
+    {
+        std::lock_guard lock(m_mutex);
+        if(!m_pending.insert(path).second) return;
+    }
+
+    if(m_ring) {
+        m_ring->enqueue(path);
+    }
+    else {
+        m_workers->submit([this, path] { finished(path, readThrough(path)); });
+    }
+}
+
+void Prefetcher::wait()
+{
+    std::unique_lock lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_pending.empty(); });
+}
+
+void Prefetcher::finished(const fs::path& path, uint64_t bytes)
+{
+    if(bytes > 0) {
+        ++m_files;
+        m_bytes += bytes;
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_pending.erase(path);
+    }
+    m_idle.notify_all();
+}
+
+} // namespace raygun::io
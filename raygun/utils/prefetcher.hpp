@@ -0,0 +1,74 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#pragma once
+
+#include "raygun/utils/thread_pool.hpp"
+
+namespace raygun::io {
+
+/// Reads files into the page cache of the OS ahead of time, so that loading
+/// them later does not wait for the disk. Prefetching is only a hint, errors
+/// are ignored.
+///
+/// On Linux, a background thread keeps many reads in flight through
+/// io_uring. Where io_uring is not available, files are read by a small
+/// thread pool instead. All functions are thread-safe.
+class Prefetcher {
+  public:
+    Prefetcher();
+    ~Prefetcher();
+
+    Prefetcher(const Prefetcher&) = delete;
+    Prefetcher& operator=(const Prefetcher&) = delete;
+
+    /// Queues path for reading, unless it is pending already.
+    void prefetch(const fs::path& path);
+
+    /// Blocks until all queued files have been read.
+    void wait();
+
+    bool usesIoUring() const { return m_ring != nullptr; }
+
+    /// Files and bytes read so far.
+    uint64_t prefetchedFiles() const { return m_files; }
+    uint64_t prefetchedBytes() const { return m_bytes; }
+
+  private:
+    class Ring;
+
+    void finished(const fs::path& path, uint64_t bytes);
+
+    std::mutex m_mutex;
+    std::condition_variable m_idle;
+    std::set<fs::path> m_pending;
+
+    std::atomic<uint64_t> m_files = 0;
+    std::atomic<uint64_t> m_bytes = 0;
+
+    // Declared last, they must stop before the state above is destroyed.
+    // Only one of them is used.
+    std::unique_ptr<Ring> m_ring;
+    std::unique_ptr<utils::ThreadPool> m_workers;
+};
+
+} // namespace raygun::io
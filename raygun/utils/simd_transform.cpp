@@ -0,0 +1,317 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#include "raygun/utils/simd_transform.hpp"
+
+#include "raygun/assert.hpp"
+#include "raygun/logging.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define RAYGUN_SIMD_X64 1
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+#else
+    #define RAYGUN_SIMD_X64 0
+#endif
+
+// GCC and Clang require functions using AVX2 intrinsics to be compiled for
+// that target, MSVC does not.
+#if defined(__clang__)
+    #define RAYGUN_AVX2_BEGIN _Pragma("clang attribute push(__attribute__((target(\"avx2\"))), apply_to = function)")
+    #define RAYGUN_AVX2_END _Pragma("clang attribute pop")
+#elif defined(__GNUC__)
+    #define RAYGUN_AVX2_BEGIN _Pragma("GCC push_options") _Pragma("GCC target(\"avx2\")")
+    #define RAYGUN_AVX2_END _Pragma("GCC pop_options")
+#else
+    #define RAYGUN_AVX2_BEGIN
+    #define RAYGUN_AVX2_END
+#endif
+
+namespace raygun::utils {
+
+namespace {
+
+    inline const float* element(const float* base, size_t stride, size_t index)
+    {
+        return reinterpret_cast<const float*>(reinterpret_cast<const std::byte*>(base) + index * stride);
+    }
+
+    inline float* element(float* base, size_t stride, size_t index)
+    {
+        return reinterpret_cast<float*>(reinterpret_cast<std::byte*>(base) + index * stride);
+    }
+
+    void composeScalar(const AffineInput& in, size_t begin, size_t end, float* out, size_t outStride)
+    {
+        for(auto i = begin; i < end; ++i) {
+            const auto p = element(in.positions, in.positionStride, i);
+            const auto q = element(in.rotations, in.rotationStride, i);
+            const auto s = element(in.scales, in.scaleStride, i);
+
+            const auto x = q[0], y = q[1], z = q[2], w = q[3];
+            const auto xx = x * x, yy = y * y, zz = z * z;
+            const auto xy = x * y, xz = x * z, yz = y * z;
+            const auto wx = w * x, wy = w * y, wz = w * z;
+
+            auto m = element(out, outStride, i);
+
+            m[0] = (1.0f - 2.0f * (yy + zz)) * s[0];
+            m[1] = 2.0f * (xy - wz) * s[1];
+            m[2] = 2.0f * (xz + wy) * s[2];
+            m[3] = p[0];
+
+            m[4] = 2.0f * (xy + wz) * s[0];
+            m[5] = (1.0f - 2.0f * (xx + zz)) * s[1];
+            m[6] = 2.0f * (yz - wx) * s[2];
+            m[7] = p[1];
+
+            m[8] = 2.0f * (xz - wy) * s[0];
+            m[9] = 2.0f * (yz + wx) * s[1];
+            m[10] = (1.0f - 2.0f * (xx + yy)) * s[2];
+            m[11] = p[2];
+        }
+    }
+
+#if RAYGUN_SIMD_X64
+
+    inline __m128 gather4(const float* base, size_t stride, size_t index, int component)
+    {
+        return _mm_setr_ps(element(base, stride, index + 0)[component], element(base, stride, index + 1)[component],
+                           element(base, stride, index + 2)[component], element(base, stride, index + 3)[component]);
+    }
+
+    /// Writes one matrix row for 4 transforms, the columns are given as
+    /// registers holding the values of all 4 transforms.
+    inline void storeRows4(__m128 c0, __m128 c1, __m128 c2, __m128 c3, float* out, size_t outStride, size_t index, int row)
+    {
+        _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+        _mm_storeu_ps(element(out, outStride, index + 0) + row * 4, c0);
+        _mm_storeu_ps(element(out, outStride, index + 1) + row * 4, c1);
+        _mm_storeu_ps(element(out, outStride, index + 2) + row * 4, c2);
+        _mm_storeu_ps(element(out, outStride, index + 3) + row * 4, c3);
+    }
+
+    void composeSSE(const AffineInput& in, size_t begin, size_t end, float* out, size_t outStride)
+    {
+        const auto one = _mm_set1_ps(1.0f);
+        const auto two = _mm_set1_ps(2.0f);
+
+        auto i = begin;
+        for(; i + 4 <= end; i += 4) {
+            const auto x = gather4(in.rotations, in.rotationStride, i, 0);
+            const auto y = gather4(in.rotations, in.rotationStride, i, 1);
+            const auto z = gather4(in.rotations, in.rotationStride, i, 2);
+            const auto w = gather4(in.rotations, in.rotationStride, i, 3);
+
+            const auto sx = gather4(in.scales, in.scaleStride, i, 0);
+            const auto sy = gather4(in.scales, in.scaleStride, i, 1);
+            const auto sz = gather4(in.scales, in.scaleStride, i, 2);
+
+            const auto xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+            const auto xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+            const auto wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+            const auto m00 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+            const auto m01 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+            const auto m02 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+
+            const auto m10 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+            const auto m11 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+            const auto m12 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+
+            const auto m20 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+            const auto m21 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+            const auto m22 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+
+            storeRows4(m00, m01, m02, gather4(in.positions, in.positionStride, i, 0), out, outStride, i, 0);
+            storeRows4(m10, m11, m12, gather4(in.positions, in.positionStride, i, 1), out, outStride, i, 1);
+            storeRows4(m20, m21, m22, gather4(in.positions, in.positionStride, i, 2), out, outStride, i, 2);
+        }
+
+        composeScalar(in, i, end, out, outStride);
+    }
+
+    RAYGUN_AVX2_BEGIN
+
+    inline __m256 gather8(const float* base, __m256i offsets, int component)
+    {
+        return _mm256_i32gather_ps(base + component, offsets, 1);
+    }
+
+    void composeAVX2(const AffineInput& in, size_t begin, size_t end, float* out, size_t outStride)
+    {
+        const auto one = _mm256_set1_ps(1.0f);
+        const auto two = _mm256_set1_ps(2.0f);
+
+        const auto lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const auto positionOffsets = _mm256_mullo_epi32(lanes, _mm256_set1_epi32((int)in.positionStride));
+        const auto rotationOffsets = _mm256_mullo_epi32(lanes, _mm256_set1_epi32((int)in.rotationStride));
+        const auto scaleOffsets = _mm256_mullo_epi32(lanes, _mm256_set1_epi32((int)in.scaleStride));
+
+        auto i = begin;
+        for(; i + 8 <= end; i += 8) {
+            const auto positions = element(in.positions, in.positionStride, i);
+            const auto rotations = element(in.rotations, in.rotationStride, i);
+            const auto scales = element(in.scales, in.scaleStride, i);
+
+            const auto x = gather8(rotations, rotationOffsets, 0);
+            const auto y = gather8(rotations, rotationOffsets, 1);
+            const auto z = gather8(rotations, rotationOffsets, 2);
+            const auto w = gather8(rotations, rotationOffsets, 3);
+
+            const auto sx = gather8(scales, scaleOffsets, 0);
+            const auto sy = gather8(scales, scaleOffsets, 1);
+            const auto sz = gather8(scales, scaleOffsets, 2);
+
+            const auto xx = _mm256_mul_ps(x, x), yy = _mm256_mul_ps(y, y), zz = _mm256_mul_ps(z, z);
+            const auto xy = _mm256_mul_ps(x, y), xz = _mm256_mul_ps(x, z), yz = _mm256_mul_ps(y, z);
+            const auto wx = _mm256_mul_ps(w, x), wy = _mm256_mul_ps(w, y), wz = _mm256_mul_ps(w, z);
+
+            const __m256 m[3][4] = {
+                {
+                    _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(yy, zz))), sx),
+                    _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xy, wz)), sy),
+                    _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xz, wy)), sz),
+                    gather8(positions, positionOffsets, 0),
+                },
+                {
+                    _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xy, wz)), sx),
+                    _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, zz))), sy),
+                    _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(yz, wx)), sz),
+                    gather8(positions, positionOffsets, 1),
+                },
+                {
+                    _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xz, wy)), sx),
+                    _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(yz, wx)), sy),
+                    _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, yy))), sz),
+                    gather8(positions, positionOffsets, 2),
+                },
+            };
+
+            for(auto row = 0; row < 3; ++row) {
+                storeRows4(_mm256_castps256_ps128(m[row][0]), _mm256_castps256_ps128(m[row][1]), _mm256_castps256_ps128(m[row][2]),
+                           _mm256_castps256_ps128(m[row][3]), out, outStride, i, row);
+                storeRows4(_mm256_extractf128_ps(m[row][0], 1), _mm256_extractf128_ps(m[row][1], 1), _mm256_extractf128_ps(m[row][2], 1),
+                           _mm256_extractf128_ps(m[row][3], 1), out, outStride, i + 4, row);
+            }
+        }
+
+        composeSSE(in, i, end, out, outStride);
+    }
+
+    RAYGUN_AVX2_END
+
+#endif // RAYGUN_SIMD_X64
+
+    SimdLevel detectSimdLevel()
+    {
+#if RAYGUN_SIMD_X64
+    #ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 1);
+        const auto osUsesXSave = (info[2] & (1 << 27)) != 0;
+        const auto cpuHasAVX = (info[2] & (1 << 28)) != 0;
+
+        if(osUsesXSave && cpuHasAVX && (_xgetbv(0) & 0x6) == 0x6) {
+            __cpuidex(info, 7, 0);
+            if(info[1] & (1 << 5)) return SimdLevel::AVX2;
+        }
+    #else
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+    #endif
+        // SSE2 is part of x86-64.
+        return SimdLevel::SSE;
+#else
+        return SimdLevel::Scalar;
+#endif
+    }
+
+    using ComposeFunction = void (*)(const AffineInput&, size_t, size_t, float*, size_t);
+
+    ComposeFunction composeFunction(SimdLevel level)
+    {
+#if RAYGUN_SIMD_X64
+        if(level == SimdLevel::AVX2) return composeAVX2;
+        if(level == SimdLevel::SSE) return composeSSE;
+#else
+        (void)level;
+#endif
+
+        return composeScalar;
+    }
+
+    ComposeFunction selectComposeFunction()
+    {
+        const auto compose = composeFunction(simdLevel());
+
+        if(compose == composeScalar) {
+            RAYGUN_INFO("Transform kernel: scalar");
+        }
+        else {
+            RAYGUN_INFO("Transform kernel: {}", simdLevel() == SimdLevel::AVX2 ? "AVX2" : "SSE");
+        }
+
+        return compose;
+    }
+
+} // namespace
+
+SimdLevel simdLevel()
+{
+    static const auto level = detectSimdLevel();
+    return level;
+}
+
+void composeAffine3x4(const AffineInput& input, size_t count, float* out, size_t outStride)
+{
+    static const auto compose = selectComposeFunction();
+    compose(input, 0, count, out, outStride);
+}
+
+void composeAffine3x4(const AffineInput& input, size_t count, float* out, size_t outStride, SimdLevel level)
+{
+    RAYGUN_ASSERT(level <= simdLevel());
+    composeFunction(level)(input, 0, count, out, outStride);
+}
+
+void composeAffine3x4(const Transform* transforms, size_t count, float* out, size_t outStride)
+{
+    static_assert(sizeof(quat) == 4 * sizeof(float), "quaternion expected to be stored as x, y, z, w");
+
+    if(count == 0) return;
+
+    AffineInput input;
+    input.positions = &transforms->position.x;
+    input.positionStride = sizeof(Transform);
+    input.rotations = &transforms->rotation.x;
+    input.rotationStride = sizeof(Transform);
+    input.scales = &transforms->scaling.x;
+    input.scaleStride = sizeof(Transform);
+
+    composeAffine3x4(input, count, out, outStride);
+}
+
+} // namespace raygun::utils
@@ -0,0 +1,66 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "raygun/transform.hpp"
+
+namespace raygun::utils {
+
+enum class SimdLevel {
+    Scalar,
+    SSE,
+    AVX2,
+};
+
+/// Highest instruction set supported by the CPU we are running on.
+SimdLevel simdLevel();
+
+/// Strided input for composeAffine3x4, strides are given in bytes. A stride
+/// of zero repeats the first element for all transforms.
+struct AffineInput {
+    const float* positions = nullptr; ///< vec3
+    size_t positionStride = 0;
+
+    const float* rotations = nullptr; ///< Unit quaternion, stored as x, y, z, w.
+    size_t rotationStride = 0;
+
+    const float* scales = nullptr; ///< vec3
+    size_t scaleStride = 0;
+};
+
+/// Computes translation * rotation * scale for count transforms and writes
+/// each as 3x4 row-major matrix (12 floats) to out, outStride bytes apart.
+/// This is the layout of VkTransformMatrixKHR. The fastest code path
+/// available on the running CPU is used.
+void composeAffine3x4(const AffineInput& input, size_t count, float* out, size_t outStride);
+
+/// Same as above using the code path of the given level, which needs to be
+/// supported by the running CPU. Levels not compiled for this architecture
+/// fall back to scalar code. Used to test all paths.
+void composeAffine3x4(const AffineInput& input, size_t count, float* out, size_t outStride, SimdLevel level);
+
+/// Convenience overload for an array of Transforms.
+void composeAffine3x4(const Transform* transforms, size_t count, float* out, size_t outStride);
+
+} // namespace raygun::utils
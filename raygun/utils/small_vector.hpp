@@ -0,0 +1,207 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#pragma once
+
+namespace raygun::utils {
+
+/// Vector storing up to N elements inline before falling back to the heap.
+/// Provides the subset of the std::vector interface used throughout Raygun.
+template<typename T, size_t N>
+class SmallVector {
+  public:
+    using value_type = T;
+    using size_type = size_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector() = default;
+
+    SmallVector(std::initializer_list<T> init)
+    {
+        reserve(init.size());
+        for(const auto& e: init) {
+            push_back(e);
+        }
+    }
+
+    SmallVector(const SmallVector& other)
+    {
+        reserve(other.size());
+        for(const auto& e: other) {
+            push_back(e);
+        }
+    }
+
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) { takeFrom(other); }
+
+    SmallVector& operator=(const SmallVector& other)
+    {
+        if(&other != this) {
+            clear();
+            reserve(other.size());
+            for(const auto& e: other) {
+                push_back(e);
+            }
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if(&other != this) {
+            clear();
+            releaseHeap();
+            takeFrom(other);
+        }
+        return *this;
+    }
+
+    ~SmallVector()
+    {
+        clear();
+        releaseHeap();
+    }
+
+    iterator begin() { return m_data; }
+    iterator end() { return m_data + m_size; }
+    const_iterator begin() const { return m_data; }
+    const_iterator end() const { return m_data + m_size; }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    size_t size() const { return m_size; }
+    size_t capacity() const { return m_capacity; }
+    bool empty() const { return m_size == 0; }
+
+    T* data() { return m_data; }
+    const T* data() const { return m_data; }
+
+    T& operator[](size_t i) { return m_data[i]; }
+    const T& operator[](size_t i) const { return m_data[i]; }
+
+    T& at(size_t i)
+    {
+        if(i >= m_size) throw std::out_of_range("SmallVector index out of range");
+        return m_data[i];
+    }
+
+    const T& at(size_t i) const
+    {
+        if(i >= m_size) throw std::out_of_range("SmallVector index out of range");
+        return m_data[i];
+    }
+
+    T& front() { return m_data[0]; }
+    const T& front() const { return m_data[0]; }
+    T& back() { return m_data[m_size - 1]; }
+    const T& back() const { return m_data[m_size - 1]; }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+        if(m_size == m_capacity) {
+            // Construct first, args may refer to an element of this vector.
+            T value(std::forward<Args>(args)...);
+            reserve(m_capacity * 2);
+            return *new(m_data + m_size++) T(std::move(value));
+        }
+
+        return *new(m_data + m_size++) T(std::forward<Args>(args)...);
+    }
+
+    void pop_back() { m_data[--m_size].~T(); }
+
+    iterator erase(const_iterator pos)
+    {
+        const auto index = (size_t)(pos - m_data);
+        std::move(m_data + index + 1, m_data + m_size, m_data + index);
+        pop_back();
+        return m_data + index;
+    }
+
+    void clear()
+    {
+        std::destroy(m_data, m_data + m_size);
+        m_size = 0;
+    }
+
+    void reserve(size_t capacity)
+    {
+        if(capacity <= m_capacity) return;
+
+        auto data = std::allocator<T>().allocate(capacity);
+        std::uninitialized_move(m_data, m_data + m_size, data);
+        std::destroy(m_data, m_data + m_size);
+
+        releaseHeap();
+
+        m_data = data;
+        m_capacity = capacity;
+    }
+
+  private:
+    bool isInline() const { return m_data == reinterpret_cast<const T*>(m_inline); }
+
+    void releaseHeap()
+    {
+        if(!isInline()) {
+            std::allocator<T>().deallocate(m_data, m_capacity);
+        }
+
+        m_data = reinterpret_cast<T*>(m_inline);
+        m_capacity = N;
+    }
+
+    // Expects this to be empty and inline.
+    void takeFrom(SmallVector& other)
+    {
+        if(other.isInline()) {
+            std::uninitialized_move(other.begin(), other.end(), m_data);
+            m_size = other.m_size;
+            other.clear();
+        }
+        else {
+            m_data = other.m_data;
+            m_size = other.m_size;
+            m_capacity = other.m_capacity;
+
+            other.m_data = reinterpret_cast<T*>(other.m_inline);
+            other.m_size = 0;
+            other.m_capacity = N;
+        }
+    }
+
+    T* m_data = reinterpret_cast<T*>(m_inline);
+    size_t m_size = 0;
+    size_t m_capacity = N;
+
+    alignas(T) std::byte m_inline[N * sizeof(T)];
+};
+
+} // namespace raygun::utils
@@ -0,0 +1,96 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#include "raygun/utils/thread_pool.hpp"
+
+#include "raygun/utils/parallel_for.hpp"
+
+namespace raygun::utils {
+
+ThreadPool::ThreadPool(size_t threadCount)
+{
+    m_threads.reserve(threadCount);
+    for(size_t i = 0; i < threadCount; ++i) {
+        m_threads.emplace_back([this] { work(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+        m_tasks = {};
+    }
+
+    m_wakeUp.notify_all();
+
+    for(auto& thread: m_threads) {
+        thread.join();
+    }
+}
+
+size_t ThreadPool::defaultThreadCount()
+{
+    const auto cores = std::thread::hardware_concurrency();
+    return cores > 2 ? cores - 1 : 1;
+}
+
+void ThreadPool::enqueue(std::function<void()> task)
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_tasks.push(std::move(task));
+    }
+
+    m_wakeUp.notify_one();
+}
+
+void ThreadPool::work()
+{
+    while(true) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock lock(m_mutex);
+            m_wakeUp.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+
+            if(m_stopping) return;
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+
+        task();
+    }
+}
+
+ThreadPool& parallelForPool()
+{
+    // Intentionally leaked, parallelFor may be used during static
+    // destruction.
+    static auto pool = new ThreadPool();
+    return *pool;
+}
+
+} // namespace raygun::utils
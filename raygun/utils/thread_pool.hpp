@@ -0,0 +1,71 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#pragma once
+
+namespace raygun::utils {
+
+/// Fixed set of worker threads executing submitted tasks in FIFO order.
+class ThreadPool {
+  public:
+    explicit ThreadPool(size_t threadCount = defaultThreadCount());
+
+    /// Tasks not yet started are dropped, their futures report a broken
+    /// promise. Running tasks are waited for.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template<typename Fun>
+    auto submit(Fun f) -> std::future<std::invoke_result_t<Fun>>
+    {
+        using Result = std::invoke_result_t<Fun>;
+
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::move(f));
+        auto future = task->get_future();
+
+        enqueue([task] { (*task)(); });
+
+        return future;
+    }
+
+    size_t size() const { return m_threads.size(); }
+
+    /// One thread per core, leaving one core to the main thread.
+    static size_t defaultThreadCount();
+
+  private:
+    void enqueue(std::function<void()> task);
+
+    void work();
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    std::queue<std::function<void()>> m_tasks;
+    bool m_stopping = false;
+
+    std::vector<std::thread> m_threads;
+};
+
+} // namespace raygun::utils
@@ -295,8 +295,13 @@ void VulkanContext::setupDevice()
         queueInfos.push_back(presentQueueInfo);
     }
 
+    // Textures are indexed by material, see closesthit.rchit.
+    vk::PhysicalDeviceDescriptorIndexingFeatures indexingFeatures;
+    indexingFeatures.setShaderSampledImageArrayNonUniformIndexing(true);
+
     vk::PhysicalDeviceBufferDeviceAddressFeatures addressFeatures;
     addressFeatures.setBufferDeviceAddress(true);
+    addressFeatures.setPNext(&indexingFeatures);
 
     vk::PhysicalDeviceAccelerationStructureFeaturesKHR accelerationStructureFeatures;
     accelerationStructureFeatures.setAccelerationStructure(true);
@@ -308,6 +313,8 @@ void VulkanContext::setupDevice()
 
     vk::PhysicalDeviceFeatures features;
     features.setRobustBufferAccess(true);
+    features.setShaderSampledImageArrayDynamicIndexing(true);
+    features.setTextureCompressionBC(true);
 
     vk::DeviceCreateInfo info;
     info.setQueueCreateInfoCount((uint32_t)queueInfos.size());
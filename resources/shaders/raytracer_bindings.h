@@ -31,3 +31,9 @@
 #define RAYGUN_RAYTRACER_BINDING_INSTANCE_OFFSET_TABLE 6
 #define RAYGUN_RAYTRACER_BINDING_ROUGH_IMAGE 7
 #define RAYGUN_RAYTRACER_BINDING_NORMAL_IMAGE 8
+#define RAYGUN_RAYTRACER_BINDING_PRIMITIVE_MATERIAL_BUFFER 9
+#define RAYGUN_RAYTRACER_BINDING_TEXTURES 10
+
+#define RAYGUN_RAYTRACER_MAX_TEXTURES 1024
+
+#define RAYGUN_RAYTRACER_CONSTANT_COMPRESSED_VERTICES 0
@@ -0,0 +1,186 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+// Compares all code paths of utils::composeAffine3x4 supported by the CPU
+// against Transform::toMat4. Counts up to 17 cover the 8-wide AVX2 loop
+// falling through to the 4-wide SSE loop and the scalar tail.
+
+#include "raygun/utils/simd_transform.hpp"
+
+using namespace raygun;
+using namespace raygun::utils;
+
+namespace {
+
+uint32_t failures = 0;
+
+#define CHECK(_cond, ...) \
+    do { \
+        if(!(_cond)) { \
+            ++failures; \
+            fmt::print("{}:{}: {} failed: {}\n", __FILE__, __LINE__, #_cond, fmt::format(__VA_ARGS__)); \
+        } \
+    } while(0)
+
+constexpr size_t MAX_COUNT = 17;
+constexpr float TOLERANCE = 1e-5f;
+
+/// Written past the requested matrices to detect overruns.
+constexpr float SENTINEL = 12345.0f;
+
+const char* levelName(SimdLevel level)
+{
+    switch(level) {
+    case SimdLevel::Scalar: return "scalar";
+    case SimdLevel::SSE: return "SSE";
+    case SimdLevel::AVX2: return "AVX2";
+    }
+    return "?";
+}
+
+std::vector<Transform> randomTransforms(std::mt19937& rng, size_t count)
+{
+    std::uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> component(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> scale(0.1f, 4.0f);
+
+    std::vector<Transform> result(count);
+    for(auto& transform: result) {
+        transform.position = {coordinate(rng), coordinate(rng), coordinate(rng)};
+        transform.rotation = glm::normalize(quat(component(rng), component(rng), component(rng), component(rng)));
+        transform.scaling = {scale(rng), scale(rng), scale(rng)};
+    }
+    return result;
+}
+
+/// Checks the 3x4 row-major matrices in out, outStride floats apart, against
+/// glm.
+void checkMatrices(const std::vector<Transform>& transforms, const vec3& sharedScaling, bool useShared, const std::vector<float>& out, size_t outStride,
+                   SimdLevel level, const char* layout)
+{
+    const auto count = transforms.size();
+
+    for(size_t i = 0; i < count; ++i) {
+        auto transform = transforms[i];
+        if(useShared) transform.scaling = sharedScaling;
+
+        const auto expected = transform.toMat4();
+        const auto matrix = &out[i * outStride];
+
+        for(auto row = 0; row < 3; ++row) {
+            for(auto column = 0; column < 4; ++column) {
+                const auto actual = matrix[row * 4 + column];
+                const auto reference = expected[column][row];
+                CHECK(std::abs(actual - reference) <= TOLERANCE * std::max(1.0f, std::abs(reference)), "{} {} count {} element {} [{}][{}]: {} != {}",
+                      levelName(level), layout, count, i, row, column, actual, reference);
+            }
+        }
+
+        for(auto k = 12u; k < outStride; ++k) {
+            CHECK(matrix[k] == SENTINEL, "{} {} count {} element {} wrote padding", levelName(level), layout, count, i);
+        }
+    }
+
+    for(auto k = count * outStride; k < out.size(); ++k) {
+        CHECK(out[k] == SENTINEL, "{} {} count {} wrote past the end", levelName(level), layout, count);
+    }
+}
+
+/// Transforms stored as array of Transform, output tightly packed.
+void testTransformArray(std::mt19937& rng, SimdLevel level)
+{
+    for(size_t count = 0; count <= MAX_COUNT; ++count) {
+        const auto transforms = randomTransforms(rng, count);
+
+        AffineInput input;
+        if(count > 0) {
+            input.positions = &transforms[0].position.x;
+            input.positionStride = sizeof(Transform);
+            input.rotations = &transforms[0].rotation.x;
+            input.rotationStride = sizeof(Transform);
+            input.scales = &transforms[0].scaling.x;
+            input.scaleStride = sizeof(Transform);
+        }
+
+        std::vector<float> out((count + 1) * 12, SENTINEL);
+        composeAffine3x4(input, count, out.data(), 12 * sizeof(float), level);
+
+        checkMatrices(transforms, {}, false, out, 12, level, "array");
+    }
+}
+
+/// Separate streams with a shared scaling (stride zero) and padded output,
+/// like instance arrays.
+void testSeparateStreams(std::mt19937& rng, SimdLevel level)
+{
+    constexpr size_t OUT_STRIDE = 16;
+
+    for(size_t count = 0; count <= MAX_COUNT; ++count) {
+        const auto transforms = randomTransforms(rng, count);
+        const vec3 scaling = {0.5f, 2.0f, 3.0f};
+
+        std::vector<vec3> positions;
+        std::vector<quat> rotations;
+        for(const auto& transform: transforms) {
+            positions.push_back(transform.position);
+            rotations.push_back(transform.rotation);
+        }
+
+        AffineInput input;
+        input.positions = count > 0 ? &positions[0].x : nullptr;
+        input.positionStride = sizeof(vec3);
+        input.rotations = count > 0 ? &rotations[0].x : nullptr;
+        input.rotationStride = sizeof(quat);
+        input.scales = &scaling.x;
+        input.scaleStride = 0;
+
+        std::vector<float> out((count + 1) * OUT_STRIDE, SENTINEL);
+        composeAffine3x4(input, count, out.data(), OUT_STRIDE * sizeof(float), level);
+
+        checkMatrices(transforms, scaling, true, out, OUT_STRIDE, level, "streams");
+    }
+}
+
+} // namespace
+
+int main()
+{
+    std::mt19937 rng(29);
+
+    for(const auto level: {SimdLevel::Scalar, SimdLevel::SSE, SimdLevel::AVX2}) {
+        if(level > simdLevel()) {
+            fmt::print("Skipping {}, not supported by this CPU\n", levelName(level));
+            continue;
+        }
+
+        testTransformArray(rng, level);
+        testSeparateStreams(rng, level);
+    }
+
+    if(failures > 0) {
+        fmt::print("{} checks failed\n", failures);
+        return 1;
+    }
+
+    fmt::print("All checks passed\n");
+    return 0;
+}
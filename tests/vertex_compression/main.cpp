@@ -0,0 +1,197 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+// Round-trip tests of the vertex compression: positions are quantized to
+// snorm16 within the bounds of their mesh, normals to 2x16 bit octahedral
+// coordinates (oct32).
+
+#include "raygun/render/vertex_compression.hpp"
+
+using namespace raygun;
+using namespace raygun::render;
+
+namespace {
+
+uint32_t failures = 0;
+
+#define CHECK(_cond, ...) \
+    do { \
+        if(!(_cond)) { \
+            ++failures; \
+            fmt::print("{}:{}: {} failed: {}\n", __FILE__, __LINE__, #_cond, fmt::format(__VA_ARGS__)); \
+        } \
+    } while(0)
+
+/// Half a snorm16 step, plus rounding of the float math.
+constexpr float POSITION_TOLERANCE = 0.5f / 32767.0f + 1e-6f;
+
+/// Rounding moves the octahedral coordinates by at most sqrt(2) half steps.
+/// The map to the sphere stretches them by up to 3 at the face centers.
+constexpr double NORMAL_TOLERANCE = 3.0 * 1.4142136 * 0.5 / 32767.0 + 1e-6;
+
+Vertex makeVertex(vec3 position, vec3 normal)
+{
+    Vertex result = {};
+    result.position = position;
+    result.normal = glm::normalize(normal);
+    result.texCoord = 0x3c003800;
+    result.matIndex = 7;
+    return result;
+}
+
+Mesh makeMesh(const std::vector<vec3>& positions)
+{
+    Mesh result;
+    for(const auto& position: positions) {
+        result.vertices.push_back(makeVertex(position, {0.0f, 0.0f, 1.0f}));
+    }
+    return result;
+}
+
+void checkPositions(const Mesh& mesh, string_view label)
+{
+    const auto bounds = QuantizationBounds::of(mesh);
+
+    for(const auto& vertex: mesh.vertices) {
+        const auto decoded = decompressVertex(compressVertex(vertex, bounds), bounds, vertex.matIndex);
+
+        // Relative to the extent on each axis, degenerate axes need to be
+        // exact.
+        const auto error = glm::abs(decoded.position - vertex.position);
+        const auto tolerance = bounds.halfExtent * POSITION_TOLERANCE + glm::abs(vertex.position) * 1e-6f;
+
+        CHECK(glm::all(glm::lessThanEqual(error, tolerance)), "{}: ({}, {}, {}) decoded as ({}, {}, {})", label, vertex.position.x, vertex.position.y,
+              vertex.position.z, decoded.position.x, decoded.position.y, decoded.position.z);
+
+        CHECK(decoded.texCoord == vertex.texCoord && decoded.matIndex == vertex.matIndex, "{}: attributes changed", label);
+    }
+}
+
+void testAabbCorners()
+{
+    const vec3 lower{-3.0f, 0.5f, 100.0f};
+    const vec3 upper{2.0f, 0.75f, 1000.0f};
+
+    std::vector<vec3> positions;
+    for(uint32_t corner = 0; corner < 8; ++corner) {
+        positions.push_back({corner & 1 ? upper.x : lower.x, corner & 2 ? upper.y : lower.y, corner & 4 ? upper.z : lower.z});
+    }
+
+    positions.push_back((lower + upper) * 0.5f);
+
+    checkPositions(makeMesh(positions), "AABB corners");
+}
+
+void testDegenerateAabbs()
+{
+    checkPositions(makeMesh({{1.0f, 2.0f, 3.0f}}), "single point");
+    checkPositions(makeMesh({{1.0f, 2.0f, 3.0f}, {1.0f, 2.0f, 3.0f}, {1.0f, 2.0f, 3.0f}}), "coincident points");
+    checkPositions(makeMesh({{-1.0f, 5.0f, 0.0f}, {1.0f, 5.0f, 0.0f}, {0.0f, 5.0f, 2.0f}}), "flat in y");
+    checkPositions(makeMesh({{0.0f, 0.0f, -4.0f}, {0.0f, 0.0f, 4.0f}}), "line along z");
+}
+
+void testRandomPositions()
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> coordinate(-50.0f, 50.0f);
+
+    std::vector<vec3> positions;
+    for(uint32_t i = 0; i < 10000; ++i) {
+        positions.push_back({coordinate(rng), coordinate(rng), coordinate(rng)});
+    }
+
+    checkPositions(makeMesh(positions), "random positions");
+}
+
+void checkNormal(vec3 normal)
+{
+    normal = glm::normalize(normal);
+
+    const auto decoded = decodeOctahedral(encodeOctahedral(normal));
+
+    // acos is too coarse close to 1 in float precision.
+    const glm::dvec3 a{normal}, b{decoded};
+    const auto angle = std::atan2(glm::length(glm::cross(a, b)), glm::dot(a, b));
+
+    CHECK(angle <= NORMAL_TOLERANCE, "({}, {}, {}) decoded as ({}, {}, {}), {} rad off", normal.x, normal.y, normal.z, decoded.x, decoded.y, decoded.z,
+          angle);
+}
+
+void testFoldNormals()
+{
+    // Axes, including both poles.
+    for(const auto axis: {vec3{1, 0, 0}, vec3{0, 1, 0}, vec3{0, 0, 1}}) {
+        checkNormal(axis);
+        checkNormal(-axis);
+    }
+
+    // Diagonals of all octants.
+    for(uint32_t octant = 0; octant < 8; ++octant) {
+        checkNormal({octant & 1 ? -1.0f : 1.0f, octant & 2 ? -1.0f : 1.0f, octant & 4 ? -1.0f : 1.0f});
+    }
+
+    // Diagonals within the coordinate planes, the ones with z = 0 lie on the
+    // fold between both hemispheres.
+    for(const auto a: {-1.0f, 1.0f}) {
+        for(const auto b: {-1.0f, 1.0f}) {
+            checkNormal({a, b, 0.0f});
+            checkNormal({a, 0.0f, b});
+            checkNormal({0.0f, a, b});
+        }
+    }
+
+    // Just below and above the fold.
+    for(const auto z: {-1e-3f, -1e-6f, 1e-6f, 1e-3f}) {
+        checkNormal({0.6f, -0.8f, z});
+        checkNormal({-0.3f, 0.9f, z});
+    }
+}
+
+void testRandomNormals()
+{
+    std::mt19937 rng(7);
+    std::normal_distribution<float> component;
+
+    for(uint32_t i = 0; i < 100000; ++i) {
+        const vec3 normal{component(rng), component(rng), component(rng)};
+        if(glm::length(normal) > 1e-3f) checkNormal(normal);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    testAabbCorners();
+    testDegenerateAabbs();
+    testRandomPositions();
+    testFoldNormals();
+    testRandomNormals();
+
+    if(failures > 0) {
+        fmt::print("{} checks failed\n", failures);
+        return 1;
+    }
+
+    fmt::print("All checks passed\n");
+    return 0;
+}
@@ -0,0 +1,194 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+// Converts all files of the resources directory into their cooked form and
+// packs them into a resource archive, see ResourceManager.
+//
+// Usage: cooker [resources directory] [archive]
+
+#include "raygun/config.hpp"
+#include "raygun/logging.hpp"
+#include "raygun/material_table.hpp"
+#include "raygun/render/model_import.hpp"
+#include "raygun/render/texture_compression.hpp"
+#include "raygun/render/texture_io.hpp"
+#include "raygun/resource_manager.hpp"
+#include "raygun/ui/font.hpp"
+#include "raygun/utils/io_utils.hpp"
+#include "raygun/utils/pak_archive.hpp"
+#include "raygun/utils/thread_pool.hpp"
+#include "raygun/utils/timer.hpp"
+
+using namespace raygun;
+
+namespace {
+
+/// Cooked contents of a resource file.
+struct Cooked {
+    std::vector<char> data;
+    bool compress = true;
+
+    /// Replaces the extension of the entry name, for converted files read
+    /// under a different name.
+    string extension;
+};
+
+bool endsWith(string_view str, string_view suffix)
+{
+    return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/// Returns std::nullopt for files not needed at runtime, e.g. shader sources
+/// or Blender files.
+std::optional<Cooked> cook(const fs::path& path, const render::ImportSettings& settings)
+{
+    const auto name = path.filename().string();
+
+    // Compiled into a single table, see MaterialTable.
+    if(endsWith(name, ".rgmat.json")) return {};
+
+    if(endsWith(name, ".spv")) {
+        return Cooked{io::readFile(path)};
+    }
+
+    // Already compressed, stored as is so it can be decoded in place.
+    if(endsWith(name, ".opus")) {
+        return Cooked{io::readFile(path), false};
+    }
+
+    // Fonts are modeled as one node per glyph, see ResourceManager::loadFont.
+    if(endsWith(name, ".obj") && path.parent_path().filename() == "fonts") {
+        const auto imported = render::importModel(path, settings);
+        if(!imported) throw std::runtime_error("Import failed");
+
+        return Cooked{ui::serializeFont(ui::compileFont(Atom{path.stem().string()}, *imported)), true, ".rgfont"};
+    }
+
+    // Block compressed with all mips, read in place by the texture loader.
+    if(endsWith(name, ".png")) {
+        const auto data = io::readFile(path);
+        const auto stem = path.stem().string();
+
+        auto texture = render::decodePng(reinterpret_cast<const std::byte*>(data.data()), data.size(), !render::isNormalMap(stem));
+        if(!texture) throw std::runtime_error("Decoding failed");
+
+        render::generateMips(*texture);
+        const auto compressed = render::compressTexture(*texture, render::compressedFormatFor(*texture, render::isNormalMap(stem)));
+
+        return Cooked{render::writeKtx2(compressed), false, ".ktx2"};
+    }
+
+    if(endsWith(name, ".ktx2")) {
+        return Cooked{io::readFile(path), false};
+    }
+
+    if(endsWith(name, ".dae") || endsWith(name, ".obj") || endsWith(name, ".glb") || endsWith(name, ".gltf")) {
+        const auto imported = render::importModel(path, settings);
+        if(!imported) throw std::runtime_error("Import failed");
+
+        return Cooked{render::cookModel(*imported, render::importerVersion(settings))};
+    }
+
+    return {};
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const fs::path resourcesDir = argc > 1 ? argv[1] : RESOURCES_DIR;
+    const fs::path archivePath = argc > 2 ? argv[2] : RESOURCES_ARCHIVE;
+
+    const ScopedTimer timer("Cooking");
+
+    // Cook meshes the way the game imports them.
+    Config config(configDirectory() / "config.json", false);
+    if(fs::exists(configDirectory() / "config.json")) config.load();
+
+    const render::ImportSettings settings = {config.meshCache, config.meshOptimization, config.meshLods};
+
+    std::vector<fs::path> files;
+    for(const auto& file: fs::recursive_directory_iterator(resourcesDir)) {
+        if(file.is_regular_file()) files.push_back(file.path());
+    }
+
+    io::PakWriter writer;
+    std::atomic<uint32_t> failures = 0;
+
+    {
+        utils::ThreadPool workers(std::max(std::thread::hardware_concurrency(), 1u));
+
+        std::vector<std::future<void>> tasks;
+        for(const auto& path: files) {
+            tasks.push_back(workers.submit([&, path] {
+                auto name = fs::relative(path, resourcesDir).generic_string();
+
+                try {
+                    auto cooked = cook(path, settings);
+                    if(!cooked) return;
+
+                    if(!cooked->extension.empty()) {
+                        name = fs::path(name).replace_extension(cooked->extension).generic_string();
+                    }
+
+                    writer.add(name, std::move(cooked->data), cooked->compress);
+                    RAYGUN_DEBUG("Cooked {}", name);
+                }
+                catch(const std::exception& e) {
+                    RAYGUN_ERROR("Unable to cook {}: {}", name, e.what());
+                    ++failures;
+                }
+            }));
+        }
+
+        if(fs::exists(resourcesDir / "materials")) {
+            tasks.push_back(workers.submit([&] {
+                try {
+                    auto table = compileMaterialTable(resourcesDir / "materials");
+
+                    // Not compressed so it can be used in place.
+                    writer.add(string{MaterialTable::ARCHIVE_ENTRY}, std::move(table), false);
+                    RAYGUN_DEBUG("Cooked {}", MaterialTable::ARCHIVE_ENTRY);
+                }
+                catch(const std::exception& e) {
+                    RAYGUN_ERROR("Unable to compile materials: {}", e.what());
+                    ++failures;
+                }
+            }));
+        }
+
+        for(auto& task: tasks) {
+            task.wait();
+        }
+    }
+
+    if(failures > 0) {
+        RAYGUN_ERROR("{} files could not be cooked", failures.load());
+        return 1;
+    }
+
+    if(!writer.write(archivePath)) return 1;
+
+    RAYGUN_INFO("Packed {} of {} files into {}", writer.entryCount(), files.size(), archivePath);
+
+    return 0;
+}
@@ -28,17 +28,44 @@ class InstantColladaExport(bpy.types.Operator):
         return {'FINISHED'}
 
 
+class InstantGlbExport(bpy.types.Operator):
+    """Instantly export the current scene as binary glTF, which Raygun loads
+    without going through assimp"""
+    bl_idname = "object.instant_glb_export"
+    bl_label = "Instant GLB Export"
+
+    def execute(self, context):
+        filepath = os.path.splitext(bpy.data.filepath)[0]
+        if not filepath:
+            self.report({'ERROR'}, "Save the file!")
+            return {'CANCELLED'}
+
+        # Raygun only reads positions and normals.
+        bpy.ops.export_scene.gltf(filepath=filepath + '.glb',
+                                  export_format='GLB',
+                                  export_apply=True,
+                                  export_yup=True,
+                                  export_texcoords=False,
+                                  export_normals=True,
+                                  export_materials='EXPORT')
+
+        return {'FINISHED'}
+
+
 def menu_func(self, context):
     self.layout.operator(InstantColladaExport.bl_idname)
+    self.layout.operator(InstantGlbExport.bl_idname)
 
 
 def register():
     bpy.utils.register_class(InstantColladaExport)
+    bpy.utils.register_class(InstantGlbExport)
     bpy.types.TOPBAR_MT_file_export.append(menu_func)
 
 
 def unregister():
     bpy.utils.unregister_class(InstantColladaExport)
+    bpy.utils.unregister_class(InstantGlbExport)
     bpy.types.TOPBAR_MT_file_export.remove(menu_func)
 
 
@@ -0,0 +1,170 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019-2021 The Raygun Authors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+// Measures the time of one simulation step of a million particles with
+// gravity, drag and curl noise, on the scalar and SIMD paths, single
+// threaded and split into chunks like ParticleSystem does. Fails if the
+// paths disagree.
+//
+// Usage: particle_benchmark [particle count] [steps]
+
+#include "raygun/particles/particle_simulation.hpp"
+#include "raygun/utils/parallel_for.hpp"
+
+using namespace raygun;
+using namespace raygun::particles;
+
+namespace {
+
+struct Particles {
+    explicit Particles(size_t count) : px(count), py(count), pz(count), vx(count), vy(count), vz(count), age(count) {}
+
+    ParticleStreams streams(size_t begin, size_t end)
+    {
+        return {px.data() + begin, py.data() + begin, pz.data() + begin, vx.data() + begin, vy.data() + begin, vz.data() + begin, age.data() + begin,
+                end - begin};
+    }
+
+    size_t size() const { return px.size(); }
+
+    std::vector<float> px, py, pz;
+    std::vector<float> vx, vy, vz;
+    std::vector<float> age;
+};
+
+Particles makeParticles(size_t count)
+{
+    Particles result(count);
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> velocity(-1.0f, 1.0f);
+
+    for(size_t i = 0; i < count; ++i) {
+        result.px[i] = position(rng);
+        result.py[i] = position(rng);
+        result.pz[i] = position(rng);
+        result.vx[i] = velocity(rng);
+        result.vy[i] = velocity(rng);
+        result.vz[i] = velocity(rng);
+    }
+
+    return result;
+}
+
+IntegrationParams paramsForStep(uint32_t step)
+{
+    IntegrationParams params;
+    params.gravity = {0.0f, -9.81f, 0.0f};
+    params.drag = 0.1f;
+    params.curlStrength = 2.0f;
+    params.curlFrequency = 0.5f;
+    params.timeDelta = 1.0f / 60.0f;
+    params.time = step * params.timeDelta;
+    return params;
+}
+
+struct Result {
+    double meanMs = 0.0;
+    double minMs = 0.0;
+};
+
+Result run(Particles& particles, uint32_t steps, bool simd, bool parallel)
+{
+    const auto step = [&](uint32_t index) {
+        const auto params = paramsForStep(index);
+
+        if(!parallel) {
+            integrateParticles(particles.streams(0, particles.size()), params, simd);
+            return;
+        }
+
+        const auto chunks = (particles.size() + PARTICLE_CHUNK_SIZE - 1) / PARTICLE_CHUNK_SIZE;
+        utils::parallelFor(chunks, [&](size_t chunk) {
+            const auto begin = chunk * PARTICLE_CHUNK_SIZE;
+            integrateParticles(particles.streams(begin, std::min(begin + PARTICLE_CHUNK_SIZE, particles.size())), params, simd);
+        });
+    };
+
+    // Warm up caches and threads.
+    step(0);
+
+    Result result;
+    result.minMs = std::numeric_limits<double>::max();
+
+    for(uint32_t i = 1; i <= steps; ++i) {
+        const auto start = Clock::now();
+        step(i);
+        const auto ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        result.meanMs += ms / steps;
+        result.minMs = std::min(result.minMs, ms);
+    }
+
+    return result;
+}
+
+float maxDifference(const Particles& a, const Particles& b)
+{
+    float result = 0.0f;
+    for(size_t i = 0; i < a.size(); ++i) {
+        result = std::max({result, std::abs(a.px[i] - b.px[i]), std::abs(a.py[i] - b.py[i]), std::abs(a.pz[i] - b.pz[i])});
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const size_t count = argc > 1 ? std::stoul(argv[1]) : 1'000'000;
+    const uint32_t steps = argc > 2 ? (uint32_t)std::stoul(argv[2]) : 100;
+
+    fmt::print("{} particles, {} steps, {} threads\n", count, steps, std::max(1u, std::thread::hardware_concurrency()));
+
+    const auto initial = makeParticles(count);
+    std::optional<Particles> scalarResult;
+
+    for(const auto parallel: {false, true}) {
+        for(const auto simd: {false, true}) {
+            auto particles = initial;
+            const auto result = run(particles, steps, simd, parallel);
+
+            fmt::print("{:6} {:15} {:8.3f} ms/step (min {:.3f} ms)\n", simd ? "SIMD" : "scalar", parallel ? "multithreaded" : "single threaded",
+                       result.meanMs, result.minMs);
+
+            if(!simd) {
+                scalarResult = std::move(particles);
+                continue;
+            }
+
+            // Both paths evaluate the same operations in the same order.
+            const auto difference = maxDifference(*scalarResult, particles);
+            if(difference > 1e-3f) {
+                fmt::print("SIMD and scalar paths disagree by {}\n", difference);
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}